@@ -0,0 +1,46 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <benchmark/benchmark.h>
+#include <filesystem>
+
+#include "bmp_file.hpp"
+#include "corpus.hpp"
+
+using namespace icon_changer;
+
+////////////////////////////////////////////////////////////////////////////////
+// BENCHMARKS
+////////////////////////////////////////////////////////////////////////////////
+
+static void bmp_file_load(benchmark::State& state)
+{
+	const std::int32_t side      = static_cast<std::int32_t>(state.range(0));
+	const std::string  file_path = write_corpus_file("bmp_file_load.bmp", generate_bitmap(side, side, static_cast<std::uint16_t>(state.range(1))));
+
+	for (auto _ : state)
+	{
+		bmp_file bmp_file = { file_path };
+
+		benchmark::DoNotOptimize(bmp_file.get_image().data());
+	}
+
+	state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(file_path));
+	std::filesystem::remove(file_path);
+}
+
+BENCHMARK(bmp_file_load)->ArgNames({ "side", "bit_count" })->ArgsProduct({ { 256, 1024, 4096 }, { 24, 32 } })->Unit(benchmark::kMicrosecond);
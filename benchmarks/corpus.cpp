@@ -0,0 +1,221 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include "corpus.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <random>
+
+#include "bmp_file.hpp"
+#include "executable_builder.hpp"
+#include "ico_file.hpp"
+#include "pe_file.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTANTS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief The sides of the generated icon images, in pixels.
+///
+static constexpr std::array<std::uint32_t, 8> ICON_SIDES = { 16, 24, 32, 48, 64, 96, 128, 256 };
+
+///
+/// \brief The color depths of the generated icon images, in bits per pixel.
+///
+static constexpr std::array<std::uint16_t, 4> ICON_BIT_COUNTS = { 4, 8, 24, 32 };
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Writes a DIB image: BITMAPINFOHEADER, palette and pixel rows.
+/// \details The sequence of std::mt19937_64 is fixed by the standard, unlike
+/// the one of the distributions, so its raw output is used.
+/// \param width: Image width in pixels.
+/// \param height: Image height in pixels, as stored in the header.
+/// \param bit_count: Bits per pixel.
+/// \param generator: The pseudo-random generator filling the palette and pixels.
+/// \param bytes: The buffer receiving the image, the pixel rows fill it up.
+///
+static void write_dib_image(std::int32_t            width,
+                            std::int32_t            height,
+                            std::uint16_t           bit_count,
+                            std::mt19937_64&        generator,
+                            std::span<std::uint8_t> bytes);
+
+///
+/// \brief Computes the size of a DIB image without the AND mask.
+/// \param width: Image width in pixels.
+/// \param height: Image height in pixels.
+/// \param bit_count: Bits per pixel.
+/// \returns The size of the header, palette and pixel rows in bytes.
+///
+static std::size_t dib_image_size(std::uint32_t width,
+                                  std::uint32_t height,
+                                  std::uint16_t bit_count) noexcept;
+
+///
+/// \brief Computes the number of palette colors of a color depth.
+/// \param bit_count: Bits per pixel.
+/// \returns The number of colors, 0 if the pixels are not indexed.
+///
+static std::uint32_t palette_size(std::uint16_t bit_count) noexcept;
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<std::uint8_t> generate_icon(const std::uint16_t images_count,
+                                        const std::uint64_t seed)
+{
+	std::mt19937_64              generator = std::mt19937_64{ seed };
+	std::vector<ico_file::entry> entries   = std::vector<ico_file::entry>(images_count);
+	std::size_t                  offset    = WIRE_SIZE<ico_file::header> + images_count * WIRE_SIZE<ico_file::entry>;
+	std::vector<std::uint8_t>    bytes     = {};
+
+	for (ico_file::entry& entry : entries)
+	{
+		const std::uint32_t side      = ICON_SIDES[generator() % ICON_SIDES.size()];
+		const std::uint16_t bit_count = ICON_BIT_COUNTS[generator() % ICON_BIT_COUNTS.size()];
+		const std::uint32_t mask_size = align_up(side, std::uint32_t{ 32 }) / 8 * side;
+
+		entry.width        = static_cast<std::uint8_t>(side);
+		entry.height       = static_cast<std::uint8_t>(side);
+		entry.color_count  = static_cast<std::uint8_t>(palette_size(bit_count));
+		entry.planes       = 1;
+		entry.bit_count    = bit_count;
+		entry.image_size   = static_cast<std::uint32_t>(dib_image_size(side, side, bit_count) + mask_size);
+		entry.image_offset = static_cast<std::uint32_t>(offset);
+
+		offset += entry.image_size;
+	}
+
+	bytes.resize(offset);
+	serialize(ico_file::header{ 0, 1, images_count }, bytes, 0);
+
+	for (std::size_t index = 0; index < entries.size(); ++index)
+	{
+		const ico_file::entry& entry = entries[index];
+		const std::int32_t     side  = 0 == entry.width ? 256 : entry.width;
+
+		serialize(entry, bytes, WIRE_SIZE<ico_file::header> + index * WIRE_SIZE<ico_file::entry>);
+
+		// The height of an icon image counts the XOR and AND masks.
+		write_dib_image(side, 2 * side, entry.bit_count, generator,
+		                std::span<std::uint8_t>{ bytes }.subspan(entry.image_offset, entry.image_size));
+	}
+
+	return bytes;
+}
+
+std::vector<std::uint8_t> generate_bitmap(const std::int32_t  width,
+                                          const std::int32_t  height,
+                                          const std::uint16_t bit_count,
+                                          const std::uint64_t seed)
+{
+	std::mt19937_64           generator    = std::mt19937_64{ seed };
+	const std::size_t         image_size   = dib_image_size(static_cast<std::uint32_t>(width), static_cast<std::uint32_t>(height), bit_count);
+	const std::size_t         image_offset = WIRE_SIZE<bmp_file::header> + WIRE_SIZE<bmp_file::dib_header> + palette_size(bit_count) * 4;
+	std::vector<std::uint8_t> bytes        = std::vector<std::uint8_t>(WIRE_SIZE<bmp_file::header> + image_size);
+
+	serialize(bmp_file::header{ 0x4D42, static_cast<std::uint32_t>(bytes.size()), 0, 0, static_cast<std::uint32_t>(image_offset) }, bytes, 0);
+	write_dib_image(width, height, bit_count, generator,
+	                std::span<std::uint8_t>{ bytes }.subspan(WIRE_SIZE<bmp_file::header>));
+
+	return bytes;
+}
+
+std::vector<std::uint8_t> generate_executable(const std::uint32_t text_size,
+                                              const std::uint64_t seed)
+{
+	static constexpr std::uint32_t TEXT_OFFSET = 0x400;
+
+	std::mt19937_64                 generator     = std::mt19937_64{ seed };
+	const std::vector<std::uint8_t> resource_data = std::vector<std::uint8_t>(1024, 0xAB);
+	resource_tree                   resources     = {};
+	std::vector<std::uint8_t>       image         = {};
+
+	resources.set(std::uint16_t{ 16 }, std::uint16_t{ 1 }, LANG_NEUTRAL, resource_data);
+	image = build_executable(resources, {}, text_size);
+
+	for (std::uint32_t offset = 0; offset < text_size; offset += sizeof(std::uint64_t))
+	{
+		const std::uint64_t value = generator();
+
+		std::memcpy(image.data() + TEXT_OFFSET + offset, &value, std::min<std::size_t>(sizeof(value), text_size - offset));
+	}
+
+	return image;
+}
+
+std::string write_corpus_file(const std::string_view              file_name,
+                              const std::span<const std::uint8_t> bytes)
+{
+	const std::string file_path = (std::filesystem::temp_directory_path() / file_name).string();
+
+	write_file(file_path, bytes);
+	return file_path;
+}
+
+static void write_dib_image(const std::int32_t            width,
+                            const std::int32_t            height,
+                            const std::uint16_t           bit_count,
+                            std::mt19937_64&              generator,
+                            const std::span<std::uint8_t> bytes)
+{
+	bmp_file::dib_header dib_header = {};
+
+	dib_header.header_size = WIRE_SIZE<bmp_file::dib_header>;
+	dib_header.width       = width;
+	dib_header.height      = height;
+	dib_header.planes      = 1;
+	dib_header.bit_count   = bit_count;
+	dib_header.image_size  = static_cast<std::uint32_t>(bytes.size() - WIRE_SIZE<bmp_file::dib_header> - palette_size(bit_count) * 4);
+	serialize(dib_header, bytes, 0);
+
+	for (std::size_t offset = WIRE_SIZE<bmp_file::dib_header>; offset < bytes.size(); offset += sizeof(std::uint64_t))
+	{
+		const std::uint64_t value = generator();
+
+		std::memcpy(bytes.data() + offset, &value, std::min(sizeof(value), bytes.size() - offset));
+	}
+}
+
+static std::size_t dib_image_size(const std::uint32_t width,
+                                  const std::uint32_t height,
+                                  const std::uint16_t bit_count) noexcept
+{
+	const std::size_t stride = align_up(width * bit_count, std::uint32_t{ 32 }) / 8;
+
+	return WIRE_SIZE<bmp_file::dib_header> + palette_size(bit_count) * 4 + stride * height;
+}
+
+static std::uint32_t palette_size(const std::uint16_t bit_count) noexcept
+{
+	return bit_count <= 8 ? std::uint32_t{ 1 } << bit_count : 0;
+}
+
+} // namespace icon_changer
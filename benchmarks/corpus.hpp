@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DECLARATIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief Generates an ICO file with images of varying sizes and color depths.
+/// \details The images are drawn from 16x16 up to 256x256 pixels, with 4, 8,
+/// 24 or 32 bits per pixel, and hold pseudo-random pixels. The same arguments
+/// always produce the same bytes, on every platform.
+/// \param images_count: Number of images, from 1 to 256.
+/// \param seed: The seed of the pseudo-random generator.
+/// \returns The content of the ICO file.
+///
+extern std::vector<std::uint8_t> generate_icon(std::uint16_t images_count,
+                                               std::uint64_t seed = 0);
+
+///
+/// \brief Generates an uncompressed bottom-up BMP file with pseudo-random pixels.
+/// \details Bit counts up to 8 get a palette. The same arguments always produce
+/// the same bytes, on every platform.
+/// \param width: Image width in pixels.
+/// \param height: Image height in pixels.
+/// \param bit_count: Bits per pixel: 1, 4, 8, 24 or 32.
+/// \param seed: The seed of the pseudo-random generator.
+/// \returns The content of the BMP file.
+///
+extern std::vector<std::uint8_t> generate_bitmap(std::int32_t  width,
+                                                 std::int32_t  height,
+                                                 std::uint16_t bit_count,
+                                                 std::uint64_t seed = 0);
+
+///
+/// \brief Generates a PE32+ executable with a `.text` section of the given size
+/// followed by a `.rsrc` section holding a single resource.
+/// \details The `.text` section holds pseudo-random bytes. The executable is
+/// only meant to be parsed and patched, it cannot run.
+/// \param text_size: Size of the `.text` section in bytes.
+/// \param seed: The seed of the pseudo-random generator.
+/// \returns The content of the executable.
+///
+extern std::vector<std::uint8_t> generate_executable(std::uint32_t text_size,
+                                                     std::uint64_t seed = 0);
+
+///
+/// \brief Writes a generated file into the temporary directory.
+/// \param file_name: The name of the file.
+/// \param bytes: The content of the file.
+/// \returns The path to the written file.
+///
+extern std::string write_corpus_file(std::string_view              file_name,
+                                     std::span<const std::uint8_t> bytes);
+
+} // namespace icon_changer
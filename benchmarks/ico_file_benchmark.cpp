@@ -0,0 +1,79 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <array>
+#include <benchmark/benchmark.h>
+#include <filesystem>
+
+#include "corpus.hpp"
+#include "ico_file.hpp"
+
+using namespace icon_changer;
+
+////////////////////////////////////////////////////////////////////////////////
+// BENCHMARKS
+////////////////////////////////////////////////////////////////////////////////
+
+static void ico_file_parse_stream(benchmark::State& state)
+{
+	const std::string file_path = write_corpus_file("ico_file_parse_stream.ico", generate_icon(static_cast<std::uint16_t>(state.range(0))));
+
+	for (auto _ : state)
+	{
+		ico_file ico_file = { file_path };
+
+		benchmark::DoNotOptimize(ico_file.get_images().data());
+	}
+
+	state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(file_path));
+	std::filesystem::remove(file_path);
+}
+
+static void ico_file_parse_memory(benchmark::State& state)
+{
+	const std::vector<std::uint8_t> bytes = generate_icon(static_cast<std::uint16_t>(state.range(0)));
+
+	for (auto _ : state)
+	{
+		ico_file ico_file = { std::span<const std::uint8_t>{ bytes } };
+
+		benchmark::DoNotOptimize(ico_file.get_images().data());
+	}
+
+	state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+
+// Only the last image is read, as when embedding one size of a large icon.
+static void ico_file_load_one(benchmark::State& state)
+{
+	const std::string file_path = write_corpus_file("ico_file_load_one.ico", generate_icon(static_cast<std::uint16_t>(state.range(0))));
+
+	for (auto _ : state)
+	{
+		ico_file                         ico_file = { file_path };
+		const std::array<std::size_t, 1> indices  = { ico_file.get_entries().size() - 1 };
+
+		ico_file.load_images(indices);
+		benchmark::DoNotOptimize(ico_file.get_images().data());
+	}
+
+	std::filesystem::remove(file_path);
+}
+
+BENCHMARK(ico_file_parse_stream)->Arg(1)->Arg(16)->Arg(256);
+BENCHMARK(ico_file_parse_memory)->Arg(1)->Arg(16)->Arg(256);
+BENCHMARK(ico_file_load_one)->Arg(1)->Arg(16)->Arg(256);
@@ -0,0 +1,232 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <benchmark/benchmark.h>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <new>
+
+#include "corpus.hpp"
+#include "icon.hpp"
+
+using namespace icon_changer;
+
+////////////////////////////////////////////////////////////////////////////////
+// ALLOCATION COUNTING
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Number of global heap allocations made so far.
+///
+static std::atomic<std::size_t> allocations_count = 0;
+
+void* operator new(const std::size_t size)
+{
+	++allocations_count;
+
+	if (void* const address = std::malloc(0 == size ? 1 : size))
+	{
+		return address;
+	}
+
+	throw std::bad_alloc{};
+}
+
+// std::pmr::new_delete_resource() allocates through the aligned overloads.
+void* operator new(const std::size_t size, const std::align_val_t alignment)
+{
+	++allocations_count;
+
+	const std::size_t bytes = static_cast<std::size_t>(alignment);
+
+	if (void* const address = std::aligned_alloc(bytes, (0 == size ? 1 : size + bytes - 1) / bytes * bytes))
+	{
+		return address;
+	}
+
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* const address) noexcept
+{
+	std::free(address);
+}
+
+void operator delete(void* const address, std::size_t) noexcept
+{
+	std::free(address);
+}
+
+void operator delete(void* const address, std::align_val_t) noexcept
+{
+	std::free(address);
+}
+
+void operator delete(void* const address, std::size_t, std::align_val_t) noexcept
+{
+	std::free(address);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Reports the heap allocations made per iteration.
+/// \param state: The state of the benchmark.
+/// \param first_count: The allocation count before the first iteration.
+///
+static void report_allocations(benchmark::State& state,
+                               const std::size_t first_count)
+{
+	state.counters["allocations"] = benchmark::Counter(static_cast<double>(allocations_count - first_count),
+	                                                   benchmark::Counter::kAvgIterations);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// BENCHMARKS
+////////////////////////////////////////////////////////////////////////////////
+
+static void icon_load_default_resource(benchmark::State& state)
+{
+	const std::string file_path   = write_corpus_file("icon_load_default_resource.ico", generate_icon(static_cast<std::uint16_t>(state.range(0))));
+	const std::size_t first_count = allocations_count;
+
+	for (auto _ : state)
+	{
+		const icon icon = { file_path };
+
+		benchmark::DoNotOptimize(icon.get_images().data());
+	}
+
+	report_allocations(state, first_count);
+	state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(file_path));
+	std::filesystem::remove(file_path);
+}
+
+static void icon_load_monotonic_resource(benchmark::State& state)
+{
+	const std::string file_path = write_corpus_file("icon_load_monotonic_resource.ico", generate_icon(static_cast<std::uint16_t>(state.range(0))));
+
+	// One buffer reused by every iteration, as a batch worker would between jobs.
+	std::vector<std::byte> buffer      = std::vector<std::byte>(2 * std::filesystem::file_size(file_path) + 4096);
+	const std::size_t      first_count = allocations_count;
+
+	for (auto _ : state)
+	{
+		std::pmr::monotonic_buffer_resource resource = { buffer.data(), buffer.size() };
+		const icon                          icon     = { file_path, icon::load_mode::stream, &resource };
+
+		benchmark::DoNotOptimize(icon.get_images().data());
+	}
+
+	report_allocations(state, first_count);
+	state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(file_path));
+	std::filesystem::remove(file_path);
+}
+
+static void icon_load_ico(benchmark::State& state)
+{
+	const std::string     file_path = write_corpus_file("icon_load_ico.ico", generate_icon(static_cast<std::uint16_t>(state.range(0))));
+	const icon::load_mode mode      = static_cast<icon::load_mode>(state.range(1));
+
+	for (auto _ : state)
+	{
+		const icon icon = { file_path, mode };
+
+		benchmark::DoNotOptimize(icon.get_images().data());
+	}
+
+	state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(file_path));
+	std::filesystem::remove(file_path);
+}
+
+// Loading a BMP decodes it and converts it into a 32bpp DIB with its AND mask.
+static void icon_load_bmp(benchmark::State& state)
+{
+	const std::string     file_path = write_corpus_file("icon_load_bmp.bmp", generate_bitmap(256, 256, static_cast<std::uint16_t>(state.range(0))));
+	const icon::load_mode mode      = static_cast<icon::load_mode>(state.range(1));
+
+	for (auto _ : state)
+	{
+		const icon icon = { file_path, mode };
+
+		benchmark::DoNotOptimize(icon.get_header().data());
+	}
+
+	state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(file_path));
+	std::filesystem::remove(file_path);
+}
+
+static void icon_load_bmp_batch(benchmark::State& state)
+{
+	static constexpr std::array<std::uint16_t, 5> BIT_COUNTS = { 1, 4, 8, 24, 32 };
+
+	std::vector<std::string> file_paths = {};
+	std::uint64_t            batch_size = 0;
+
+	// Bitmaps of every color depth, as a batch converting the artwork of many executables loads them.
+	for (std::int64_t index = 0; index < state.range(0); ++index)
+	{
+		file_paths.push_back(write_corpus_file(std::format("icon_load_bmp_batch_{}.bmp", index),
+		                                       generate_bitmap(256, 256, BIT_COUNTS[index % BIT_COUNTS.size()], static_cast<std::uint64_t>(index))));
+		batch_size += std::filesystem::file_size(file_paths.back());
+	}
+
+	for (auto _ : state)
+	{
+		for (const std::string& file_path : file_paths)
+		{
+			const icon icon = { file_path, icon::load_mode::stream };
+
+			benchmark::DoNotOptimize(icon.get_images().data());
+		}
+	}
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * batch_size));
+
+	for (const std::string& file_path : file_paths)
+	{
+		std::filesystem::remove(file_path);
+	}
+}
+
+static void icon_resample(benchmark::State& state)
+{
+	const std::int32_t side      = static_cast<std::int32_t>(state.range(0));
+	const std::string  file_path = write_corpus_file("icon_resample.bmp", generate_bitmap(side, side, 32));
+
+	for (auto _ : state)
+	{
+		const icon icon = { file_path, icon::options{ .sizes = { icon::DEFAULT_SIZES.begin(), icon::DEFAULT_SIZES.end() } } };
+
+		benchmark::DoNotOptimize(icon.get_images().data());
+	}
+
+	state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(file_path));
+	std::filesystem::remove(file_path);
+}
+
+BENCHMARK(icon_load_default_resource)->Arg(1)->Arg(8)->Arg(64);
+BENCHMARK(icon_load_monotonic_resource)->Arg(1)->Arg(8)->Arg(64);
+BENCHMARK(icon_load_ico)->ArgNames({ "images", "mode" })->ArgsProduct({ { 1, 16, 256 }, { 0, 1 } });
+BENCHMARK(icon_load_bmp)->ArgNames({ "bit_count", "mode" })->ArgsProduct({ { 8, 24, 32 }, { 0, 1 } });
+BENCHMARK(icon_load_bmp_batch)->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond);
+BENCHMARK(icon_resample)->Arg(512)->Arg(1024)->Arg(4096)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,70 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <benchmark/benchmark.h>
+#include <filesystem>
+
+#include "corpus.hpp"
+#include "icon_changer.hpp"
+
+using namespace icon_changer;
+
+////////////////////////////////////////////////////////////////////////////////
+// BENCHMARKS
+////////////////////////////////////////////////////////////////////////////////
+
+// Every iteration patches a pristine executable, as the first run of a build would.
+static void change_icon_first(benchmark::State& state)
+{
+	const std::string               icon_path       = write_corpus_file("change_icon_first.ico", generate_icon(static_cast<std::uint16_t>(state.range(0))));
+	const std::vector<std::uint8_t> executable      = generate_executable(static_cast<std::uint32_t>(state.range(1)) << 20);
+	const std::string               executable_path = write_corpus_file("change_icon_first.exe", executable);
+
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		write_file(executable_path, executable);
+		state.ResumeTiming();
+
+		benchmark::DoNotOptimize(change_icon(icon_path, executable_path));
+	}
+
+	state.SetBytesProcessed(state.iterations() * executable.size());
+	std::filesystem::remove(icon_path);
+	std::filesystem::remove(executable_path);
+}
+
+// Every iteration patches the executable of the previous one, as a rebuild would.
+static void change_icon_again(benchmark::State& state)
+{
+	const std::string icon_path       = write_corpus_file("change_icon_again.ico", generate_icon(static_cast<std::uint16_t>(state.range(0))));
+	const std::string executable_path = write_corpus_file("change_icon_again.exe", generate_executable(static_cast<std::uint32_t>(state.range(1)) << 20));
+
+	change_icon(icon_path, executable_path);
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(change_icon(icon_path, executable_path));
+	}
+
+	state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(executable_path));
+	std::filesystem::remove(icon_path);
+	std::filesystem::remove(executable_path);
+}
+
+BENCHMARK(change_icon_first)->ArgNames({ "images", "MiB" })->ArgsProduct({ { 1, 16, 256 }, { 1, 64 } })->Unit(benchmark::kMillisecond);
+BENCHMARK(change_icon_again)->ArgNames({ "images", "MiB" })->ArgsProduct({ { 1, 16, 256 }, { 1, 64 } })->Unit(benchmark::kMillisecond);
@@ -0,0 +1,84 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <benchmark/benchmark.h>
+#include <filesystem>
+
+#include "corpus.hpp"
+#include "mapped_file.hpp"
+#include "pe_file.hpp"
+
+using namespace icon_changer;
+
+////////////////////////////////////////////////////////////////////////////////
+// BENCHMARKS
+////////////////////////////////////////////////////////////////////////////////
+
+static void pe_file_read_resources(benchmark::State& state)
+{
+	const std::string file_path = write_corpus_file("pe_file_read_resources.exe", generate_executable(static_cast<std::uint32_t>(state.range(0)) << 20));
+
+	for (auto _ : state)
+	{
+		pe_file pe_file = { file_path };
+
+		benchmark::DoNotOptimize(pe_file.read_resources());
+	}
+
+	state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(file_path));
+	std::filesystem::remove(file_path);
+}
+
+static void pe_file_read_resources_mapped(benchmark::State& state)
+{
+	const std::string file_path = write_corpus_file("pe_file_read_resources_mapped.exe", generate_executable(static_cast<std::uint32_t>(state.range(0)) << 20));
+
+	for (auto _ : state)
+	{
+		const mapped_file mapping = mapped_file{ file_path };
+		pe_file           pe_file = { file_path, mapping.get_bytes() };
+
+		benchmark::DoNotOptimize(pe_file.read_resources());
+	}
+
+	state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(file_path));
+	std::filesystem::remove(file_path);
+}
+
+static void pe_file_save(benchmark::State& state)
+{
+	const std::string               file_path = write_corpus_file("pe_file_save.exe", generate_executable(static_cast<std::uint32_t>(state.range(0)) << 20));
+	const std::vector<std::uint8_t> image     = std::vector<std::uint8_t>(256 * 256 * 4, 0xCD);
+	const std::vector<std::uint8_t> header    = std::vector<std::uint8_t>(20, 0x00);
+
+	for (auto _ : state)
+	{
+		pe_file       pe_file   = { file_path };
+		resource_tree resources = pe_file.read_resources();
+
+		resources.set(RT_ICON, std::uint16_t{ 1 }, LANG_NEUTRAL, image);
+		resources.set(RT_GROUP_ICON, resource_tree::make_identifier("MAINICON"), LANG_NEUTRAL, header);
+		pe_file.save(file_path, resources);
+	}
+
+	state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(file_path));
+	std::filesystem::remove(file_path);
+}
+
+BENCHMARK(pe_file_read_resources)->Arg(1)->Arg(64)->Arg(512)->Unit(benchmark::kMillisecond);
+BENCHMARK(pe_file_read_resources_mapped)->Arg(1)->Arg(64)->Arg(512)->Unit(benchmark::kMillisecond);
+BENCHMARK(pe_file_save)->Arg(1)->Arg(64)->Arg(512)->Unit(benchmark::kMillisecond);
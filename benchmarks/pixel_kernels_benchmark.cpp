@@ -0,0 +1,201 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <benchmark/benchmark.h>
+#include <array>
+#include <random>
+#include <vector>
+
+#include "pixel_kernels.hpp"
+
+using namespace icon_changer;
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Generates pseudo-random bytes, about one in four being 0.
+/// \param size: Number of bytes.
+/// \returns The bytes.
+///
+static std::vector<std::uint8_t> generate_bytes(const std::size_t size)
+{
+	std::mt19937_64           generator = std::mt19937_64{ 0 };
+	std::vector<std::uint8_t> bytes     = std::vector<std::uint8_t>(size);
+
+	for (std::uint8_t& byte : bytes)
+	{
+		const std::uint64_t random = generator();
+
+		byte = 0 == random % 4 ? 0 : static_cast<std::uint8_t>(random >> 8);
+	}
+
+	return bytes;
+}
+
+///
+/// \brief Gets the kernels of an instruction set, skipping the benchmark if the processor lacks it.
+/// \param state: The state of the benchmark.
+/// \param isa: The instruction set.
+/// \returns The kernels, nullptr if the benchmark is skipped.
+///
+static const pixel_kernels* get_kernels(benchmark::State& state,
+                                        const pixel_isa   isa)
+{
+	const pixel_kernels* const kernels = get_pixel_kernels(isa);
+
+	if (nullptr == kernels)
+	{
+		state.SkipWithError("Instruction set not supported");
+	}
+
+	return kernels;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// BENCHMARKS
+////////////////////////////////////////////////////////////////////////////////
+
+// Every benchmark converts a square image row by row, its throughput being counted in BGRA bytes.
+static void expand_bgr(benchmark::State& state,
+                       const pixel_isa   isa)
+{
+	const pixel_kernels* const      kernels = get_kernels(state, isa);
+	const std::size_t               side    = static_cast<std::size_t>(state.range(0));
+	const std::vector<std::uint8_t> source  = generate_bytes(side * side * 3);
+	std::vector<std::uint8_t>       pixels  = std::vector<std::uint8_t>(side * side * 4);
+
+	for (auto _ : state)
+	{
+		for (std::size_t y = 0; y < side; ++y)
+		{
+			kernels->expand_bgr(std::span{ source }.subspan(y * side * 3, side * 3), std::span{ pixels }.subspan(y * side * 4, side * 4));
+		}
+
+		benchmark::DoNotOptimize(pixels.data());
+	}
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * pixels.size()));
+}
+
+static void expand_palette(benchmark::State& state,
+                           const pixel_isa   isa)
+{
+	const pixel_kernels* const      kernels = get_kernels(state, isa);
+	const std::size_t               side    = static_cast<std::size_t>(state.range(0));
+	const std::vector<std::uint8_t> indices = generate_bytes(side * side);
+	std::array<std::uint32_t, 256>  palette = {};
+	std::vector<std::uint8_t>       pixels  = std::vector<std::uint8_t>(side * side * 4);
+
+	for (std::size_t index = 0; index < palette.size(); ++index)
+	{
+		palette[index] = static_cast<std::uint32_t>(index * 0x010101) | 0xFF000000;
+	}
+
+	for (auto _ : state)
+	{
+		for (std::size_t y = 0; y < side; ++y)
+		{
+			kernels->expand_palette(std::span{ indices }.subspan(y * side, side), palette, std::span{ pixels }.subspan(y * side * 4, side * 4));
+		}
+
+		benchmark::DoNotOptimize(pixels.data());
+	}
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * pixels.size()));
+}
+
+static void flip_rows(benchmark::State& state,
+                      const pixel_isa   isa)
+{
+	const pixel_kernels* const      kernels = get_kernels(state, isa);
+	const std::size_t               side    = static_cast<std::size_t>(state.range(0));
+	const std::vector<std::uint8_t> source  = generate_bytes(side * side * 4);
+	std::vector<std::uint8_t>       pixels  = std::vector<std::uint8_t>(side * side * 4);
+
+	for (auto _ : state)
+	{
+		kernels->flip_rows(source, pixels, side * 4);
+		benchmark::DoNotOptimize(pixels.data());
+	}
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * pixels.size()));
+}
+
+static void premultiply(benchmark::State& state,
+                        const pixel_isa   isa)
+{
+	const pixel_kernels* const kernels = get_kernels(state, isa);
+	const std::size_t          side    = static_cast<std::size_t>(state.range(0));
+	std::vector<std::uint8_t>  pixels  = generate_bytes(side * side * 4);
+
+	// Premultiplying again changes the pixels, but not the work done.
+	for (auto _ : state)
+	{
+		for (std::size_t y = 0; y < side; ++y)
+		{
+			kernels->premultiply(std::span{ pixels }.subspan(y * side * 4, side * 4));
+		}
+
+		benchmark::DoNotOptimize(pixels.data());
+	}
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * pixels.size()));
+}
+
+static void pack_and_mask(benchmark::State& state,
+                          const pixel_isa   isa)
+{
+	const pixel_kernels* const      kernels = get_kernels(state, isa);
+	const std::size_t               side    = static_cast<std::size_t>(state.range(0));
+	const std::vector<std::uint8_t> pixels  = generate_bytes(side * side * 4);
+	std::vector<std::uint8_t>       mask    = std::vector<std::uint8_t>((side + 7) / 8 * side);
+
+	for (auto _ : state)
+	{
+		for (std::size_t y = 0; y < side; ++y)
+		{
+			kernels->pack_and_mask(std::span{ pixels }.subspan(y * side * 4, side * 4), std::span{ mask }.subspan(y * ((side + 7) / 8), (side + 7) / 8));
+		}
+
+		benchmark::DoNotOptimize(mask.data());
+	}
+
+	state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * pixels.size()));
+}
+
+BENCHMARK_CAPTURE(expand_bgr, scalar, pixel_isa::scalar)->Arg(256)->Arg(4096);
+BENCHMARK_CAPTURE(expand_bgr, sse4_2, pixel_isa::sse4_2)->Arg(256)->Arg(4096);
+BENCHMARK_CAPTURE(expand_bgr, avx2, pixel_isa::avx2)->Arg(256)->Arg(4096);
+BENCHMARK_CAPTURE(expand_bgr, neon, pixel_isa::neon)->Arg(256)->Arg(4096);
+BENCHMARK_CAPTURE(expand_palette, scalar, pixel_isa::scalar)->Arg(256)->Arg(4096);
+BENCHMARK_CAPTURE(expand_palette, sse4_2, pixel_isa::sse4_2)->Arg(256)->Arg(4096);
+BENCHMARK_CAPTURE(expand_palette, avx2, pixel_isa::avx2)->Arg(256)->Arg(4096);
+BENCHMARK_CAPTURE(expand_palette, neon, pixel_isa::neon)->Arg(256)->Arg(4096);
+BENCHMARK_CAPTURE(flip_rows, scalar, pixel_isa::scalar)->Arg(256)->Arg(4096);
+BENCHMARK_CAPTURE(flip_rows, sse4_2, pixel_isa::sse4_2)->Arg(256)->Arg(4096);
+BENCHMARK_CAPTURE(flip_rows, avx2, pixel_isa::avx2)->Arg(256)->Arg(4096);
+BENCHMARK_CAPTURE(flip_rows, neon, pixel_isa::neon)->Arg(256)->Arg(4096);
+BENCHMARK_CAPTURE(premultiply, scalar, pixel_isa::scalar)->Arg(256)->Arg(4096);
+BENCHMARK_CAPTURE(premultiply, sse4_2, pixel_isa::sse4_2)->Arg(256)->Arg(4096);
+BENCHMARK_CAPTURE(premultiply, avx2, pixel_isa::avx2)->Arg(256)->Arg(4096);
+BENCHMARK_CAPTURE(premultiply, neon, pixel_isa::neon)->Arg(256)->Arg(4096);
+BENCHMARK_CAPTURE(pack_and_mask, scalar, pixel_isa::scalar)->Arg(256)->Arg(4096);
+BENCHMARK_CAPTURE(pack_and_mask, sse4_2, pixel_isa::sse4_2)->Arg(256)->Arg(4096);
+BENCHMARK_CAPTURE(pack_and_mask, avx2, pixel_isa::avx2)->Arg(256)->Arg(4096);
+BENCHMARK_CAPTURE(pack_and_mask, neon, pixel_isa::neon)->Arg(256)->Arg(4096);
@@ -0,0 +1,158 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <random>
+
+#include "deflate.hpp"
+#include "hash.hpp"
+#include "png_encoder.hpp"
+#include "png_file.hpp"
+
+using namespace icon_changer;
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Generates an icon-like image: smooth gradients, a few noisy low bits
+/// and a transparent border.
+/// \param side: The side of the square image in pixels.
+/// \returns The image.
+///
+static bgra_image generate_image(std::uint32_t side);
+
+////////////////////////////////////////////////////////////////////////////////
+// BENCHMARKS
+////////////////////////////////////////////////////////////////////////////////
+
+static void png_crc32(benchmark::State& state)
+{
+	std::mt19937_64           generator = std::mt19937_64{ 1 };
+	std::vector<std::uint8_t> bytes     = std::vector<std::uint8_t>(static_cast<std::size_t>(state.range(0)));
+
+	for (std::uint8_t& byte : bytes)
+	{
+		byte = static_cast<std::uint8_t>(generator());
+	}
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(crc32(bytes));
+	}
+
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+static void png_adler32(benchmark::State& state)
+{
+	std::mt19937_64           generator = std::mt19937_64{ 1 };
+	std::vector<std::uint8_t> bytes     = std::vector<std::uint8_t>(static_cast<std::size_t>(state.range(0)));
+
+	for (std::uint8_t& byte : bytes)
+	{
+		byte = static_cast<std::uint8_t>(generator());
+	}
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(adler32(bytes));
+	}
+
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+static void png_zlib_compress(benchmark::State& state)
+{
+	const bgra_image image      = generate_image(static_cast<std::uint32_t>(state.range(0)));
+	std::size_t      compressed = 0;
+
+	for (auto _ : state)
+	{
+		compressed = zlib_compress(image.pixels).size();
+		benchmark::DoNotOptimize(compressed);
+	}
+
+	state.SetBytesProcessed(state.iterations() * image.pixels.size());
+	state.counters["ratio"] = static_cast<double>(image.pixels.size()) / static_cast<double>(compressed);
+}
+
+static void png_encode(benchmark::State& state)
+{
+	const bgra_image image   = generate_image(static_cast<std::uint32_t>(state.range(0)));
+	std::size_t      encoded = 0;
+
+	for (auto _ : state)
+	{
+		encoded = encode_png(image).size();
+		benchmark::DoNotOptimize(encoded);
+	}
+
+	state.SetBytesProcessed(state.iterations() * image.pixels.size());
+	state.counters["ratio"] = static_cast<double>(image.pixels.size()) / static_cast<double>(encoded);
+}
+
+static void png_decode(benchmark::State& state)
+{
+	const bgra_image                image   = generate_image(static_cast<std::uint32_t>(state.range(0)));
+	const std::vector<std::uint8_t> encoded = encode_png(image);
+	const png_file                  file    = png_file{ encoded };
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(file.decode().pixels.data());
+	}
+
+	state.SetBytesProcessed(state.iterations() * image.pixels.size());
+}
+
+BENCHMARK(png_crc32)->Arg(4096)->Arg(1 << 20);
+BENCHMARK(png_adler32)->Arg(4096)->Arg(1 << 20);
+BENCHMARK(png_zlib_compress)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+BENCHMARK(png_encode)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+BENCHMARK(png_decode)->Arg(256)->Arg(1024)->Unit(benchmark::kMicrosecond);
+
+static bgra_image generate_image(const std::uint32_t side)
+{
+	std::mt19937_64 generator = std::mt19937_64{ side };
+	bgra_image      image     = { side, side, std::vector<std::uint8_t>(static_cast<std::size_t>(side) * side * 4) };
+	const double    center    = side / 2.0;
+
+	for (std::uint32_t y = 0; y < side; ++y)
+	{
+		for (std::uint32_t x = 0; x < side; ++x)
+		{
+			std::uint8_t* const pixel    = image.pixels.data() + (static_cast<std::size_t>(y) * side + x) * 4;
+			const double        distance = std::hypot(x - center, y - center) / center;
+
+			if (0.9 < distance)
+			{
+				continue;
+			}
+
+			pixel[0] = static_cast<std::uint8_t>(255 * x / side ^ (generator() & 3));
+			pixel[1] = static_cast<std::uint8_t>(255 * y / side ^ (generator() & 3));
+			pixel[2] = static_cast<std::uint8_t>(255 * distance);
+			pixel[3] = 0xFF;
+		}
+	}
+
+	return image;
+}
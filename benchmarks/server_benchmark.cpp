@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <array>
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <filesystem>
+#include <thread>
+
+#include "corpus.hpp"
+#include "server.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif // _WIN32
+
+using namespace icon_changer;
+
+////////////////////////////////////////////////////////////////////////////////
+// BENCHMARKS
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _WIN32
+
+// Every iteration starts the executable, which parses the icon before patching a pristine executable.
+static void change_icon_cold_process(benchmark::State& state)
+{
+#ifdef ICON_CHANGER_PATH
+	const std::string               icon_path       = write_corpus_file("cold_process.ico", generate_icon(static_cast<std::uint16_t>(state.range(0))));
+	const std::vector<std::uint8_t> executable      = generate_executable(1 << 20);
+	const std::string               executable_path = write_corpus_file("cold_process.exe", executable);
+	std::array<char*, 4>            arguments       = { const_cast<char*>(ICON_CHANGER_PATH), const_cast<char*>(icon_path.c_str()), const_cast<char*>(executable_path.c_str()), nullptr };
+	posix_spawn_file_actions_t      actions         = {};
+
+	posix_spawn_file_actions_init(&actions);
+	posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+
+	for (auto _ : state)
+	{
+		pid_t        process = 0;
+		std::int32_t status  = 0;
+
+		state.PauseTiming();
+		write_file(executable_path, executable);
+		state.ResumeTiming();
+
+		if (0 != posix_spawn(&process, ICON_CHANGER_PATH, &actions, nullptr, arguments.data(), environ) || -1 == waitpid(process, &status, 0)
+		    || !WIFEXITED(status) || EXIT_SUCCESS != WEXITSTATUS(status))
+		{
+			state.SkipWithError("icon-changer failed!");
+			break;
+		}
+	}
+
+	posix_spawn_file_actions_destroy(&actions);
+	std::filesystem::remove(icon_path);
+	std::filesystem::remove(executable_path);
+#else
+	state.SkipWithError("The path to icon-changer is not known!");
+#endif // ICON_CHANGER_PATH
+}
+
+// Every iteration is forwarded to a server that keeps the parsed icon, then patches a pristine executable.
+static void change_icon_daemon(benchmark::State& state)
+{
+	const std::string                icon_path       = write_corpus_file("daemon.ico", generate_icon(static_cast<std::uint16_t>(state.range(0))));
+	const std::vector<std::uint8_t>  executable      = generate_executable(1 << 20);
+	const std::string                executable_path = write_corpus_file("daemon.exe", executable);
+	const std::string                socket_path     = (std::filesystem::temp_directory_path() / "icon_changer_benchmark.sock").string();
+	const std::array<const char*, 2> arguments       = { icon_path.c_str(), executable_path.c_str() };
+	std::FILE* const                 output          = std::fopen("/dev/null", "w");
+	server                           daemon          = server{ socket_path };
+	std::thread                      listener        = std::thread{ [&daemon]()
+	{
+		daemon.run();
+	} };
+
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		write_file(executable_path, executable);
+		state.ResumeTiming();
+
+		if (EXIT_SUCCESS != forward_cli(socket_path, arguments, output))
+		{
+			state.SkipWithError("The server failed!");
+			break;
+		}
+	}
+
+	daemon.stop();
+	listener.join();
+	std::fclose(output);
+	std::filesystem::remove(icon_path);
+	std::filesystem::remove(executable_path);
+}
+
+BENCHMARK(change_icon_cold_process)->ArgNames({ "images" })->Arg(1)->Arg(16)->Arg(256)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(change_icon_daemon)->ArgNames({ "images" })->Arg(1)->Arg(16)->Arg(256)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+#endif // _WIN32
@@ -0,0 +1,126 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include "fuzz_limits.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <print>
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTANTS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief The bytes in front of every allocation holding its size, keeping it
+/// aligned for any type.
+///
+static constexpr std::size_t SIZE_PREFIX = alignof(std::max_align_t);
+
+////////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief The bytes currently allocated.
+///
+static constinit std::atomic<std::uint64_t> allocated_bytes = 0;
+
+///
+/// \brief The most bytes allocated at once since the last reset.
+///
+static constinit std::atomic<std::uint64_t> peak_bytes = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+// METHOD DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+fuzz_limits::fuzz_limits(const std::string_view target,
+                         const std::uint64_t    max_memory) noexcept
+    : target{ target }
+    , max_memory{ max_memory }
+    , base_memory{ allocated_bytes.load(std::memory_order_relaxed) }
+    , start{ std::chrono::steady_clock::now() }
+{
+	peak_bytes.store(base_memory, std::memory_order_relaxed);
+}
+
+fuzz_limits::~fuzz_limits() noexcept
+{
+	const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+	const std::uint64_t                       peak    = peak_bytes.load(std::memory_order_relaxed) - base_memory;
+
+	if (MAX_PARSE_TIME < elapsed)
+	{
+		std::println(stderr, "{}: parsing took {} ms, more than the {} ms ceiling!", target,
+		             std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(), MAX_PARSE_TIME.count());
+		std::abort();
+	}
+
+	if (BASE_MEMORY + max_memory < peak)
+	{
+		std::println(stderr, "{}: parsing took {} bytes at peak, more than the {} bytes ceiling!", target, peak, BASE_MEMORY + max_memory);
+		std::abort();
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+// The other forms of operator new and delete forward to these, the aligned ones excepted, which the parsers do not use.
+
+void* operator new(const std::size_t size)
+{
+	void* const memory = std::malloc(SIZE_PREFIX + size);
+
+	if (nullptr == memory)
+	{
+		throw std::bad_alloc{};
+	}
+
+	const std::uint64_t allocated = allocated_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+	std::uint64_t       peak      = peak_bytes.load(std::memory_order_relaxed);
+
+	while (peak < allocated && !peak_bytes.compare_exchange_weak(peak, allocated, std::memory_order_relaxed))
+	{
+	}
+
+	*static_cast<std::size_t*>(memory) = size;
+	return static_cast<std::uint8_t*>(memory) + SIZE_PREFIX;
+}
+
+void operator delete(void* const memory) noexcept
+{
+	if (nullptr == memory)
+	{
+		return;
+	}
+
+	void* const block = static_cast<std::uint8_t*>(memory) - SIZE_PREFIX;
+
+	allocated_bytes.fetch_sub(*static_cast<std::size_t*>(block), std::memory_order_relaxed);
+	std::free(block);
+}
+
+void operator delete(void* const memory,
+                     std::size_t) noexcept
+{
+	operator delete(memory);
+}
@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTANTS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief The longest an input may take to be parsed, sanitizers included.
+///
+inline constexpr std::chrono::milliseconds MAX_PARSE_TIME = std::chrono::milliseconds{ 250 };
+
+///
+/// \brief The memory every input may take on top of a multiple of its size
+/// (e.g. the entries of an ICO file and the stack of the parser).
+///
+inline constexpr std::uint64_t BASE_MEMORY = 64 * 1024;
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Aborts, as libFuzzer expects from a crash, when parsing an input
+/// takes longer than MAX_PARSE_TIME or more memory than allowed at peak.
+/// \details The memory is measured by replacing the global operator new, so it
+/// covers every allocation made during the lifetime of this object.
+///
+class fuzz_limits final
+{
+public:
+	///
+	/// \brief Starts measuring.
+	/// \param target: The name of the fuzz target, used for error messages.
+	/// \param max_memory: The bytes the input may take at peak, BASE_MEMORY excluded.
+	///
+	fuzz_limits(std::string_view target,
+	            std::uint64_t    max_memory) noexcept;
+
+	///
+	/// \brief Aborts if a ceiling was exceeded.
+	///
+	~fuzz_limits() noexcept;
+
+	fuzz_limits(const fuzz_limits&)            = delete;
+	fuzz_limits& operator=(const fuzz_limits&) = delete;
+
+private:
+	///
+	/// \brief The name of the fuzz target.
+	///
+	std::string_view target;
+
+	///
+	/// \brief The bytes the input may take at peak.
+	///
+	std::uint64_t max_memory;
+
+	///
+	/// \brief The bytes allocated before the input was parsed.
+	///
+	std::uint64_t base_memory;
+
+	///
+	/// \brief When parsing started.
+	///
+	std::chrono::steady_clock::time_point start;
+};
@@ -0,0 +1,54 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <exception>
+
+#include "fuzz_limits.hpp"
+#include "ico_file.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// FUZZ TARGET
+////////////////////////////////////////////////////////////////////////////////
+
+extern "C" std::int32_t LLVMFuzzerTestOneInput(const std::uint8_t* const data,
+                                               const std::size_t         size)
+{
+	const std::span<const std::uint8_t> input = std::span{ data, size };
+
+	// The entries and the views of the images are both smaller than the entries they are parsed from.
+	const fuzz_limits limits = fuzz_limits{ "ico_file_fuzzer", 2 * size };
+
+	try
+	{
+		icon_changer::ico_file ico_file = icon_changer::ico_file{ input };
+
+		for (const std::span<const std::uint8_t> image : ico_file.get_images())
+		{
+			if (image.data() < input.data() || image.data() + image.size() > input.data() + input.size())
+			{
+				std::abort();
+			}
+		}
+	}
+	catch (const std::exception&)
+	{
+		// Rejecting the input is fine, crashing, hanging or exhausting the memory is not.
+	}
+
+	return 0;
+}
@@ -0,0 +1,55 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <exception>
+#include <span>
+
+#include "png_file.hpp"
+#include "fuzz_limits.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTANTS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief The memory a decoded image may take.
+///
+static constexpr std::uint64_t DECODE_BUDGET = 16 * 1024 * 1024;
+
+////////////////////////////////////////////////////////////////////////////////
+// FUZZ TARGET
+////////////////////////////////////////////////////////////////////////////////
+
+extern "C" std::int32_t LLVMFuzzerTestOneInput(const std::uint8_t* const data,
+                                               const std::size_t         size)
+{
+	icon_changer::memory_budget budget = icon_changer::memory_budget{ DECODE_BUDGET };
+	const fuzz_limits           limits = fuzz_limits{ "png_file_fuzzer", DECODE_BUDGET };
+
+	try
+	{
+		const icon_changer::png_file png_file = icon_changer::png_file{ std::span<const std::uint8_t>{ data, size } };
+
+		static_cast<void>(png_file.decode(&budget));
+	}
+	catch (const std::exception&)
+	{
+		// Rejecting the input is fine, crashing, hanging or exhausting the memory is not.
+	}
+
+	return 0;
+}
@@ -0,0 +1,341 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include "batch.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <print>
+#include <set>
+#include <stdexcept>
+
+#include "icon_changer.hpp"
+#include "thread_pool.hpp"
+#include "utility.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTANTS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief Bytes reserved for the header and tables of an icon, on top of its file size.
+///
+static constexpr std::size_t RESOURCE_SLACK = 4096;
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief An icon shared by the jobs of a batch.
+///
+struct shared_icon final
+{
+	std::unique_ptr<std::pmr::monotonic_buffer_resource> resource; ///< Holds every allocation of the parsed icon.
+	std::unique_ptr<const icon>                          parsed;   ///< The parsed icon, nullptr if parsing failed.
+	std::string                                          error;    ///< The reason parsing failed.
+	stats_sample                                         sample;   ///< The statistics of loading the icon.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Splits a manifest line into paths.
+/// \param line: The line without the line terminator.
+/// \param line_number: The number of the line, used for error messages.
+/// \returns The paths found on the line.
+///
+static std::vector<std::string> split_line(std::string_view line,
+                                           std::size_t      line_number);
+
+///
+/// \brief Parses every distinct icon of the batch in parallel.
+/// \param jobs: The jobs of the batch.
+/// \param options: How the icons are loaded and prepared.
+/// \param cache: The cache the icons are loaded through, nullptr for none.
+/// \param measured: Whether the statistics of loading each icon are recorded.
+/// \param pool: The pool running the parsing.
+/// \returns The parsed icons by path.
+///
+static std::map<std::string, shared_icon> load_icons(const std::vector<batch_job>& jobs,
+                                                     const icon::options&          options,
+                                                     const icon_cache*             cache,
+                                                     bool                          measured,
+                                                     thread_pool&                  pool);
+
+///
+/// \brief Orders the jobs by decreasing executable size.
+/// \param jobs: The jobs of the batch.
+/// \returns The indexes of the jobs, largest executable first.
+///
+static std::vector<std::size_t> order_jobs(const std::vector<batch_job>& jobs);
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<batch_job> read_manifest(const std::string_view manifest_path)
+{
+	const std::vector<std::uint8_t> bytes       = read_file(manifest_path);
+	std::string_view                content     = { reinterpret_cast<const char*>(bytes.data()), bytes.size() };
+	std::vector<batch_job>          jobs        = {};
+	std::size_t                     line_number = 0;
+
+	while (!content.empty())
+	{
+		const std::size_t line_end = std::min(content.find('\n'), content.size());
+		std::string_view  line     = content.substr(0, line_end);
+
+		content.remove_prefix(std::min(line_end + 1, content.size()));
+		++line_number;
+
+		if (line.ends_with('\r'))
+		{
+			line.remove_suffix(1);
+		}
+
+		std::vector<std::string> paths = split_line(line, line_number);
+
+		if (paths.empty() || paths.front().starts_with('#'))
+		{
+			continue;
+		}
+
+		if (2 != paths.size())
+		{
+			throw std::invalid_argument{ std::format("Line {} of \"{}\" has {} path(s), expecting 2!", line_number, manifest_path, paths.size()) };
+		}
+
+		jobs.push_back(batch_job{ std::move(paths[0]), std::move(paths[1]) });
+	}
+
+	return jobs;
+}
+
+std::size_t change_icons(const std::string_view           manifest_path,
+                         const icon::options&             options,
+                         const std::size_t                threads_count,
+                         const icon_cache* const          cache,
+                         std::vector<stats_sample>* const samples)
+{
+	const std::vector<batch_job>             jobs             = read_manifest(manifest_path);
+	thread_pool                              pool             = thread_pool{ threads_count };
+	const std::map<std::string, shared_icon> icons            = load_icons(jobs, options, cache, nullptr != samples, pool);
+	std::set<std::filesystem::path>          executable_paths = {};
+	std::mutex                               output_mutex     = {};
+	std::size_t                              failed_count     = 0;
+
+	for (const auto& [path, icon] : icons)
+	{
+		for (const icon::compression& compression : nullptr != icon.parsed ? icon.parsed->get_compressions() : std::span<const icon::compression>{})
+		{
+			std::println("{}: {}x{} image compressed as PNG: {} -> {} bytes", path, compression.width, compression.height, compression.original_size, compression.size);
+		}
+
+		if (nullptr != icon.parsed && 0 != icon.parsed->get_deduplication().images_count)
+		{
+			std::println("{}: {} duplicate image(s) shared: {} bytes saved", path, icon.parsed->get_deduplication().images_count,
+			             icon.parsed->get_deduplication().saved_size);
+		}
+
+		if (nullptr != samples)
+		{
+			samples->push_back(icon.sample);
+		}
+	}
+
+	for (const std::size_t index : order_jobs(jobs))
+	{
+		const batch_job& job = jobs[index];
+
+		std::error_code             error = {};
+		const std::filesystem::path path  = std::filesystem::weakly_canonical(job.executable_path, error);
+
+		// Two workers writing the same executable would race, the later job is rejected. Links and relative paths are resolved, as they may name the same file.
+		const bool duplicate = !executable_paths.insert(error ? std::filesystem::path{ job.executable_path }.lexically_normal() : path).second;
+
+		pool.submit([&job, &icons, &output_mutex, &failed_count, samples, duplicate]()
+		{
+			const shared_icon&     icon     = icons.at(job.icon_path);
+			stats_record           record   = {};
+			pe_file::save_strategy strategy = pe_file::save_strategy::rewritten;
+			std::string            error    = {};
+
+			try
+			{
+				const stats_scope scope = stats_scope{ nullptr != samples ? &record : nullptr };
+
+				if (duplicate)
+				{
+					throw std::invalid_argument{ "Executable is listed more than once!" };
+				}
+
+				if (nullptr == icon.parsed)
+				{
+					throw std::runtime_error{ icon.error };
+				}
+
+				strategy = change_icon(*icon.parsed, job.executable_path);
+			}
+			catch (const std::exception& exception)
+			{
+				error = exception.what();
+			}
+
+			const std::lock_guard lock = std::lock_guard{ output_mutex };
+
+			if (nullptr != samples)
+			{
+				samples->push_back(record.get_sample());
+			}
+
+			if (error.empty())
+			{
+				std::println(GRN "[done] {} ({})" CRESET, job.executable_path, pe_file::to_string(strategy));
+				return;
+			}
+
+			++failed_count;
+			std::println(RED "[failed] {}: {}" CRESET, job.executable_path, error);
+		});
+	}
+
+	pool.wait();
+	std::println("{} of {} executable(s) patched.", jobs.size() - failed_count, jobs.size());
+
+	return failed_count;
+}
+
+static std::vector<std::string> split_line(const std::string_view line,
+                                           const std::size_t      line_number)
+{
+	std::vector<std::string> paths = {};
+	std::size_t              index = 0;
+
+	while (index < line.size())
+	{
+		if (' ' == line[index] || '\t' == line[index])
+		{
+			++index;
+			continue;
+		}
+
+		if ('"' != line[index])
+		{
+			const std::size_t end = std::min(line.find_first_of(" \t", index), line.size());
+
+			paths.emplace_back(line.substr(index, end - index));
+			index = end;
+			continue;
+		}
+
+		const std::size_t end = line.find('"', index + 1);
+
+		if (std::string_view::npos == end)
+		{
+			throw std::invalid_argument{ std::format("Line {} has an unterminated quote!", line_number) };
+		}
+
+		paths.emplace_back(line.substr(index + 1, end - index - 1));
+		index = end + 1;
+	}
+
+	return paths;
+}
+
+static std::map<std::string, shared_icon> load_icons(const std::vector<batch_job>& jobs,
+                                                     const icon::options&          options,
+                                                     const icon_cache* const       cache,
+                                                     const bool                    measured,
+                                                     thread_pool&                  pool)
+{
+	std::map<std::string, shared_icon> icons = {};
+
+	for (const batch_job& job : jobs)
+	{
+		icons.try_emplace(job.icon_path);
+	}
+
+	// The map is not modified while the workers fill in the entries.
+	for (auto& [path, icon] : icons)
+	{
+		pool.submit([&path, &icon, &options, cache, measured]()
+		{
+			stats_record         record = {};
+			const stats_scope    scope  = stats_scope{ measured ? &record : nullptr };
+			std::error_code      error  = {};
+			const std::uintmax_t size   = icon_changer::icon::load_mode::mapped == options.mode ? 0 : std::filesystem::file_size(path, error);
+
+			try
+			{
+				// Sized after the file, so that the images, header and tables take a single upstream allocation. Mapped images are not copied.
+				icon.resource = std::make_unique<std::pmr::monotonic_buffer_resource>((error ? 0 : size) + RESOURCE_SLACK);
+
+				if (nullptr != cache)
+				{
+					icon.parsed = std::make_unique<const icon_changer::icon>(cache->load(path, options));
+				}
+				else
+				{
+					icon.parsed = std::make_unique<const icon_changer::icon>(path, options, icon.resource.get());
+				}
+			}
+			catch (const std::exception& exception)
+			{
+				icon.error = std::format("\"{}\": {}", path, exception.what());
+			}
+
+			icon.sample = record.get_sample();
+		});
+	}
+
+	pool.wait();
+	return icons;
+}
+
+static std::vector<std::size_t> order_jobs(const std::vector<batch_job>& jobs)
+{
+	std::vector<std::size_t>    indexes = std::vector<std::size_t>(jobs.size());
+	std::vector<std::uintmax_t> sizes   = std::vector<std::uintmax_t>(jobs.size());
+	std::error_code             error   = {};
+
+	for (std::size_t index = 0; index < jobs.size(); ++index)
+	{
+		const std::uintmax_t size = std::filesystem::file_size(jobs[index].executable_path, error);
+
+		indexes[index] = index;
+		sizes[index]   = error ? 0 : size;
+	}
+
+	std::ranges::stable_sort(indexes, [&sizes](const std::size_t left, const std::size_t right)
+	{
+		return sizes[left] > sizes[right];
+	});
+
+	return indexes;
+}
+
+} // namespace icon_changer
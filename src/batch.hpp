@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "icon.hpp"
+#include "icon_cache.hpp"
+#include "stats.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief A single icon replacement of a batch.
+///
+struct batch_job final
+{
+	std::string icon_path;       ///< The path to the icon (ICO, BMP, PNG) file or to the executable it is copied from.
+	std::string executable_path; ///< The path to the target executable file.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DECLARATIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Reads the jobs of a batch from a manifest file.
+/// \details Each line holds an icon path followed by an executable path,
+/// separated by whitespace. Paths containing spaces are enclosed in double
+/// quotes. Empty lines and lines starting with '#' are ignored.
+/// \param manifest_path: The path to the manifest file.
+/// \returns The jobs in manifest order.
+///
+extern std::vector<batch_job> read_manifest(std::string_view manifest_path);
+
+///
+/// \brief Replaces the icons of all executables listed in a manifest.
+/// \details Every distinct icon is parsed once and shared by its jobs. The
+/// executables are patched in parallel, largest first. A failing job is
+/// reported and does not stop the others.
+/// \param manifest_path: The path to the manifest file.
+/// \param options: How the icons are loaded and prepared.
+/// \param threads_count: Number of worker threads, 0 means one per hardware thread.
+/// \param cache: The cache the icons are loaded through, nullptr for none.
+/// \param samples: Receives the statistics of every icon and executable, nullptr to not measure.
+/// \returns The number of failed jobs.
+///
+extern std::size_t change_icons(std::string_view           manifest_path,
+                                const icon::options&       options,
+                                std::size_t                threads_count,
+                                const icon_cache*          cache   = nullptr,
+                                std::vector<stats_sample>* samples = nullptr);
+
+} // namespace icon_changer
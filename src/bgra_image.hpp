@@ -11,15 +11,15 @@
 // For more information, please refer to https://unlicense.org
 ////////////////////////////////////////////////////////////////////////////////
 
+
 #pragma once
 
 ////////////////////////////////////////////////////////////////////////////////
 // HEADER FILE INCLUDES
 ////////////////////////////////////////////////////////////////////////////////
 
-#include <gmock/gmock.h>
-
-#include "icon.hpp"
+#include <cstdint>
+#include <vector>
 
 ////////////////////////////////////////////////////////////////////////////////
 // TYPE DEFINITIONS
@@ -28,39 +28,15 @@
 namespace icon_changer
 {
 
-class icon_mock final
+///
+/// \brief A decoded image with 32 bits per pixel in BGRA order.
+/// \details The rows are stored top-down, without padding.
+///
+struct bgra_image final
 {
-public:
-	MOCK_METHOD(std::vector<std::uint8_t>&, get_header, (), (const));
-	MOCK_METHOD(std::vector<std::vector<std::uint8_t>>&, get_images, (), ());
-
-	icon_mock()
-	{
-		if (nullptr == obj)
-		{
-			return;
-		}
-
-		obj = std::make_unique<icon_mock>();
-	}
-
-	static std::unique_ptr<icon_mock> obj;
+	std::uint32_t             width;  ///< Image width in pixels.
+	std::uint32_t             height; ///< Image height in pixels.
+	std::vector<std::uint8_t> pixels; ///< The pixels, 4 bytes each.
 };
 
-std::unique_ptr<icon_mock> icon_mock::obj = nullptr;
-
-icon::icon(const std::string_view file_path)
-{
-}
-
-std::vector<std::uint8_t>& icon::get_header()
-{
-	return icon_mock::obj->get_header();
-}
-
-std::vector<std::vector<std::uint8_t>>& icon::get_images() noexcept
-{
-	return icon_mock::obj->get_images();
-}
-
 } // namespace icon_changer
@@ -17,19 +17,78 @@
 
 #include "bmp_file.hpp"
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+#include "pixel_kernels.hpp"
+#include "stats.hpp"
+
 ////////////////////////////////////////////////////////////////////////////////
-// METHOD DEFINITIONS
+// TYPE DEFINITIONS
 ////////////////////////////////////////////////////////////////////////////////
 
 namespace icon_changer
 {
 
-bmp_file::bmp_file(const std::string_view file_path)
+///
+/// \brief A color channel of a 16 or 32bpp pixel, as selected by its bit mask.
+///
+struct channel final
 {
-	std::ifstream file = open_file(file_path);
+	std::uint32_t mask;    ///< The bits of the channel in the pixel.
+	std::uint32_t shift;   ///< Position of the lowest bit of the mask.
+	std::uint32_t maximum; ///< Value of the channel with every bit set, 0 if the mask is empty.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
 
-	read_header(file);
-	read_image(file);
+///
+/// \brief Describes the channel selected by a bit mask.
+/// \param mask: The bit mask.
+/// \returns The channel.
+///
+static channel make_channel(std::uint32_t mask) noexcept;
+
+///
+/// \brief Extracts a channel from a pixel and scales it to 8 bits.
+/// \param pixel: The pixel.
+/// \param channel: The channel.
+/// \returns The value of the channel, 0 if the pixel has no such channel.
+///
+static std::uint8_t extract_channel(std::uint32_t  pixel,
+                                    const channel& channel) noexcept;
+
+////////////////////////////////////////////////////////////////////////////////
+// METHOD DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+bmp_file::bmp_file(const std::string_view           file_path,
+                   std::pmr::memory_resource* const resource)
+    : bmp_file{ *open_source(file_path), resource }
+{
+}
+
+bmp_file::bmp_file(byte_source&                     source,
+                   std::pmr::memory_resource* const resource,
+                   memory_budget* const             budget)
+    : header_obj{}
+    , buffer{ resource }
+    , image{}
+{
+	read_all(source, buffer, budget);
+	parse(buffer);
+}
+
+bmp_file::bmp_file(const std::span<std::uint8_t> file_data)
+    : header_obj{}
+    , buffer{}
+    , image{}
+{
+	parse(file_data);
 }
 
 bmp_file::header bmp_file::get_header() const noexcept
@@ -37,41 +96,214 @@ bmp_file::header bmp_file::get_header() const noexcept
 	return header_obj;
 }
 
-std::vector<std::uint8_t>& bmp_file::get_image() noexcept
+std::span<std::uint8_t> bmp_file::get_image() const noexcept
 {
 	return image;
 }
 
-void bmp_file::read_header(std::ifstream& file)
+std::pmr::vector<std::uint8_t> bmp_file::release_buffer() noexcept
 {
-	try
+	return std::move(buffer);
+}
+
+bgra_image bmp_file::decode(memory_budget* const budget) const
+{
+	static constexpr std::uint32_t BI_RGB            = 0;
+	static constexpr std::uint32_t BI_BITFIELDS      = 3;
+	static constexpr std::uint32_t BI_ALPHABITFIELDS = 6;
+	static constexpr std::size_t   V2_HEADER_SIZE    = 52;
+	static constexpr std::size_t   V3_HEADER_SIZE    = 56;
+
+	const dib_header               dib_header   = deserialize<bmp_file::dib_header>(image, 0);
+	const std::size_t              pixel_offset = header_obj.image_offset - WIRE_SIZE<header>;
+	const bool                     top_down     = 0 > dib_header.height;
+	const bool                     indexed      = 8 >= dib_header.bit_count;
+	const bool                     bit_fields   = BI_BITFIELDS == dib_header.compression_method || BI_ALPHABITFIELDS == dib_header.compression_method;
+	const bool                     packed       = bit_fields || 16 == dib_header.bit_count;
+	const pixel_kernels&           kernels      = get_pixel_kernels();
+	std::array<channel, 4>         channels     = {};
+	std::size_t                    colors_count = 0;
+	std::array<std::uint32_t, 256> colors       = {};
+	std::vector<std::uint8_t>      indices      = {};
+	bgra_image                     decoded      = {};
+	bool                           has_alpha    = false;
+
+	if (WIRE_SIZE<bmp_file::dib_header> > dib_header.header_size)
+	{
+		throw std::invalid_argument{ std::format("BMP header of {} bytes is too small!", dib_header.header_size) };
+	}
+
+	if (BI_RGB != dib_header.compression_method && !bit_fields)
+	{
+		throw std::invalid_argument{ std::format("{} compression method is not supported!", dib_header.compression_method) };
+	}
+
+	if (1 != dib_header.bit_count && 4 != dib_header.bit_count && 8 != dib_header.bit_count && 16 != dib_header.bit_count
+	    && 24 != dib_header.bit_count && 32 != dib_header.bit_count)
+	{
+		throw std::invalid_argument{ std::format("{} bits per pixel cannot be decoded!", dib_header.bit_count) };
+	}
+
+	if (bit_fields && 16 != dib_header.bit_count && 32 != dib_header.bit_count)
+	{
+		throw std::invalid_argument{ std::format("{} bits per pixel cannot have bit fields!", dib_header.bit_count) };
+	}
+
+	if (0 >= dib_header.width || 0 == dib_header.height)
 	{
-		file.read(reinterpret_cast<char*>(&header_obj), sizeof(header_obj));
+		throw std::invalid_argument{ std::format("Image of {}x{} pixels is empty!", dib_header.width, dib_header.height) };
 	}
-	catch (const std::exception& exception)
+
+	if (bit_fields)
 	{
-		throw std::runtime_error{ std::format("Failed to read {} bytes from BMP header!", sizeof(header_obj)) };
+		// The masks are stored red first, inside the header from V2 on and after a BITMAPINFOHEADER otherwise.
+		const std::size_t masks_offset   = WIRE_SIZE<bmp_file::dib_header>;
+		const bool        has_alpha_mask = V3_HEADER_SIZE <= dib_header.header_size
+		                                || (V2_HEADER_SIZE > dib_header.header_size && BI_ALPHABITFIELDS == dib_header.compression_method);
+
+		channels[2] = make_channel(deserialize<std::uint32_t>(image, masks_offset));
+		channels[1] = make_channel(deserialize<std::uint32_t>(image, masks_offset + 4));
+		channels[0] = make_channel(deserialize<std::uint32_t>(image, masks_offset + 8));
+		channels[3] = make_channel(has_alpha_mask ? deserialize<std::uint32_t>(image, masks_offset + 12) : 0);
+	}
+	else if (16 == dib_header.bit_count)
+	{
+		channels = { make_channel(0x001F), make_channel(0x03E0), make_channel(0x7C00), make_channel(0) };
 	}
 
+	if (indexed)
+	{
+		colors_count = 0 == dib_header.color_count ? std::size_t{ 1 } << dib_header.bit_count : dib_header.color_count;
+
+		if (dib_header.header_size > image.size() || colors_count * 4 > image.size() - dib_header.header_size)
+		{
+			throw std::runtime_error{ std::format("Palette of {} colors does not fit in the BMP image!", colors_count) };
+		}
+	}
+
+	decoded.width  = static_cast<std::uint32_t>(dib_header.width);
+	decoded.height = static_cast<std::uint32_t>(top_down ? -static_cast<std::int64_t>(dib_header.height) : dib_header.height);
+
+	const std::size_t         stride  = align_up(static_cast<std::size_t>(decoded.width) * dib_header.bit_count, std::size_t{ 32 }) / 8;
+	const std::uint8_t* const palette = image.data() + dib_header.header_size;
+
+	// Divided rather than multiplied, as the sizes declared by a hostile file can overflow the product.
+	if (header_obj.image_offset < WIRE_SIZE<header> || pixel_offset > image.size() || decoded.height > (image.size() - pixel_offset) / stride)
+	{
+		throw std::runtime_error{ std::format("Pixel array of {} bytes does not fit in the BMP image!", stride * decoded.height) };
+	}
+
+	// A 1bpp image takes 32 times more memory decoded than in the file.
+	if (nullptr != budget)
+	{
+		budget->charge(static_cast<std::uint64_t>(decoded.width) * decoded.height * 4, "Decoded image");
+	}
+
+	decoded.pixels.resize(static_cast<std::size_t>(decoded.width) * decoded.height * 4);
+	indices.resize(indexed ? decoded.width : 0);
+
+	// Indices past the end of the palette take its first color.
+	for (std::size_t index = 0; indexed && index < colors.size(); ++index)
+	{
+		colors[index] = load_little_endian<std::uint32_t>(palette + (index < colors_count ? index * 4 : 0)) | 0xFF000000;
+	}
+
+	for (std::uint32_t y = 0; y < decoded.height; ++y)
+	{
+		const std::uint8_t* const     row         = image.data() + pixel_offset + (top_down ? y : decoded.height - 1 - y) * stride;
+		const std::span<std::uint8_t> destination = std::span<std::uint8_t>{ decoded.pixels }.subspan(static_cast<std::size_t>(y) * decoded.width * 4,
+		                                                                                             static_cast<std::size_t>(decoded.width) * 4);
+
+		if (8 == dib_header.bit_count)
+		{
+			kernels.expand_palette(std::span<const std::uint8_t>{ row, decoded.width }, colors, destination);
+		}
+		else if (indexed)
+		{
+			// Indexed pixels are packed starting from the most significant bits.
+			for (std::size_t x = 0; x < decoded.width; ++x)
+			{
+				const std::size_t bit = x * dib_header.bit_count;
+
+				indices[x] = static_cast<std::uint8_t>((row[bit / 8] >> (8 - dib_header.bit_count - bit % 8)) & ((1U << dib_header.bit_count) - 1));
+			}
+
+			kernels.expand_palette(indices, colors, destination);
+		}
+		else if (packed)
+		{
+			for (std::size_t x = 0; x < decoded.width; ++x)
+			{
+				const std::uint32_t pixel = 16 == dib_header.bit_count ? load_little_endian<std::uint16_t>(row + x * 2)
+				                                                       : load_little_endian<std::uint32_t>(row + x * 4);
+
+				destination[x * 4]     = extract_channel(pixel, channels[0]);
+				destination[x * 4 + 1] = extract_channel(pixel, channels[1]);
+				destination[x * 4 + 2] = extract_channel(pixel, channels[2]);
+				destination[x * 4 + 3] = extract_channel(pixel, channels[3]);
+			}
+		}
+		else if (24 == dib_header.bit_count)
+		{
+			kernels.expand_bgr(std::span<const std::uint8_t>{ row, static_cast<std::size_t>(decoded.width) * 3 }, destination);
+		}
+		else
+		{
+			std::memcpy(destination.data(), row, destination.size());
+		}
+	}
+
+	// Stops at the first pixel unless the image has an alpha channel, which it may not use.
+	for (std::size_t offset = 3; offset < decoded.pixels.size() && !has_alpha; offset += 4)
+	{
+		has_alpha = 0 != decoded.pixels[offset];
+	}
+
+	if (!has_alpha)
+	{
+		for (std::size_t offset = 3; offset < decoded.pixels.size(); offset += 4)
+		{
+			decoded.pixels[offset] = 0xFF;
+		}
+	}
+
+	return decoded;
+}
+
+void bmp_file::parse(const std::span<std::uint8_t> file_data)
+{
+	byte_cursor cursor = byte_cursor{ file_data };
+	stats_timer timer  = stats_timer{ stats_phase::parse };
+
+	header_obj = cursor.read<header>("BMP header");
+
 	LOG("type: {}", header_obj.type);
 	LOG("file_size: {}", header_obj.file_size);
 	LOG("reserved1: {}", header_obj.reserved1);
 	LOG("reserved2: {}", header_obj.reserved2);
 	LOG("image_offset: {}\n", header_obj.image_offset);
+
+	timer.next(stats_phase::read);
+	image = cursor.take(std::max<std::size_t>(header_obj.file_size, WIRE_SIZE<header>) - WIRE_SIZE<header>, "BMP image");
 }
 
-void bmp_file::read_image(std::ifstream& file)
+static channel make_channel(const std::uint32_t mask) noexcept
 {
-	image.resize(header_obj.file_size - sizeof(header));
+	const std::uint32_t shift = 0 == mask ? 0 : static_cast<std::uint32_t>(std::countr_zero(mask));
 
-	try
-	{
-		file.read(reinterpret_cast<char*>(image.data()), image.size());
-	}
-	catch (const std::exception& exception)
+	return channel{ mask, shift, mask >> shift };
+}
+
+static std::uint8_t extract_channel(const std::uint32_t pixel,
+                                    const channel&      channel) noexcept
+{
+	if (0 == channel.maximum)
 	{
-		throw std::runtime_error{ std::format("Failed to read {} bytes from BMP image!", image.size()) };
+		return 0;
 	}
+
+	// Rounded to the nearest, so that e.g. the 5 bits of 0x1F scale to 0xFF.
+	return static_cast<std::uint8_t>((static_cast<std::uint64_t>((pixel & channel.mask) >> channel.shift) * 255 + channel.maximum / 2) / channel.maximum);
 }
 
 } // namespace icon_changer
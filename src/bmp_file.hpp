@@ -17,6 +17,13 @@
 // HEADER FILE INCLUDES
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+#include "bgra_image.hpp"
+#include "byte_source.hpp"
+#include "memory_budget.hpp"
 #include "utility.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -36,7 +43,7 @@ public:
 	///
 	/// \brief This data structure corresponds to Bitmap file header.
 	///
-	struct PACKED header final
+	struct header final
 	{
 		std::uint16_t type;         //< Type of the file.
 		std::uint32_t file_size;    //< Size of the file in bytes.
@@ -48,7 +55,7 @@ public:
 	///
 	/// \brief This data structure corresponds to BITMAPINFOHEADER.
 	///
-	struct PACKED dib_header final
+	struct dib_header final
 	{
 		std::uint32_t header_size;           //< Size of the header in bytes.
 		std::int32_t  width;                 //< Image width in pixels.
@@ -65,9 +72,31 @@ public:
 
 	///
 	/// \brief Reads the header and image data of an BMP file.
+	/// \details The file is read with a single read into a buffer owned by this object.
 	/// \param file_path: Path to the BMP file.
+	/// \param resource: The memory resource to allocate from, it must outlive this object.
+	///
+	bmp_file(std::string_view           file_path,
+	         std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+	///
+	/// \brief Reads the header and image data of a BMP file from a byte source.
+	/// \details The source is read until its end into a buffer owned by this object.
+	/// \param source: The byte source (e.g. a file or the standard input).
+	/// \param resource: The memory resource to allocate from, it must outlive this object.
+	/// \param budget: The budget the buffer is charged to, nullptr for none.
+	///
+	bmp_file(byte_source&               source,
+	         std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+	         memory_budget*             budget   = nullptr);
+
 	///
-	bmp_file(std::string_view file_path);
+	/// \brief Parses the header and image data of a BMP file in memory.
+	/// \details No bytes are copied, the image is a view into the given bytes
+	/// which must outlive this object.
+	/// \param file_data: The content of the BMP file (e.g. memory mapped).
+	///
+	bmp_file(std::span<std::uint8_t> file_data);
 
 	///
 	/// \brief Gets the parsed BMP file header.
@@ -77,22 +106,36 @@ public:
 
 	///
 	/// \brief Gets the raw BMP image data (DIB header and pixel array).
-	/// \returns A reference to the image byte buffer.
+	/// \returns A view of the image bytes.
 	///
-	std::vector<std::uint8_t>& get_image() noexcept;
+	std::span<std::uint8_t> get_image() const noexcept;
 
-private:
 	///
-	/// \brief Reads the header from the BMP file.
-	/// \param file: The file to read from.
+	/// \brief Releases the buffer owning the image read from a byte source.
+	/// \details The image view stays valid as long as the buffer lives.
+	/// \returns The image buffer, empty if the BMP file was parsed in memory.
+	///
+	[[nodiscard]] std::pmr::vector<std::uint8_t> release_buffer() noexcept;
+
 	///
-	void read_header(std::ifstream& file);
+	/// \brief Decodes the pixel array into 32bpp BGRA.
+	/// \details Uncompressed 1, 4, 8, 16, 24 and 32bpp images are supported,
+	/// both bottom-up and top-down, and so are the BI_BITFIELDS masks of 16 and
+	/// 32bpp images, following a BITMAPINFOHEADER or inside a V2 to V5 header.
+	/// 16bpp images default to 5 bits per channel. An image whose alpha channel
+	/// is 0 everywhere does not use it and is decoded as opaque.
+	/// \param budget: The budget the decoded pixels are charged to before they
+	/// are allocated, nullptr for none.
+	/// \returns The decoded image.
+	///
+	bgra_image decode(memory_budget* budget = nullptr) const;
 
+private:
 	///
-	/// \brief Reads the image data from BMP file.
-	/// \param file: The file to read from.
+	/// \brief Parses the header and makes a view of the image data of a BMP file in memory.
+	/// \param file_data: The content of the BMP file.
 	///
-	void read_image(std::ifstream& file);
+	void parse(std::span<std::uint8_t> file_data);
 
 private:
 	///
@@ -100,10 +143,35 @@ private:
 	///
 	header header_obj;
 
+	///
+	/// \brief Buffer owning the file read from a byte source.
+	///
+	std::pmr::vector<std::uint8_t> buffer;
+
 	///
 	/// \brief Raw image data of the BMP file (DIB header and pixel array).
 	///
-	std::vector<std::uint8_t> image;
+	std::span<std::uint8_t> image;
+};
+
+///
+/// \brief The layout of the Bitmap file header in the file.
+///
+template <> struct layout<bmp_file::header> final
+    : fields<&bmp_file::header::type, &bmp_file::header::file_size, &bmp_file::header::reserved1, &bmp_file::header::reserved2,
+             &bmp_file::header::image_offset>
+{
+};
+
+///
+/// \brief The layout of BITMAPINFOHEADER in the file.
+///
+template <> struct layout<bmp_file::dib_header> final
+    : fields<&bmp_file::dib_header::header_size, &bmp_file::dib_header::width, &bmp_file::dib_header::height, &bmp_file::dib_header::planes,
+             &bmp_file::dib_header::bit_count, &bmp_file::dib_header::compression_method, &bmp_file::dib_header::image_size,
+             &bmp_file::dib_header::horizontal_resolution, &bmp_file::dib_header::vertical_resolution, &bmp_file::dib_header::color_count,
+             &bmp_file::dib_header::ignored>
+{
 };
 
 } // namespace icon_changer
@@ -0,0 +1,450 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include "byte_source.hpp"
+
+#include <cerrno>
+#include <limits>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTANTS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief Bytes read at once by a sequential source.
+/// \details The kernel is asked to read the following chunk ahead while the
+/// current one is being read.
+///
+static constexpr std::size_t CHUNK_SIZE = 1024 * 1024;
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Reads a regular file, either with a single read or sequentially.
+///
+class file_source final : public byte_source
+{
+public:
+	///
+	/// \brief Opens the file.
+	/// \param file_path: The path to the file.
+	/// \param kind: How the file is read.
+	///
+	file_source(std::string_view file_path,
+	            source_kind      kind);
+
+	///
+	/// \brief Closes the file.
+	///
+	~file_source() noexcept override;
+
+	///
+	/// \brief Gets the size of the file when it was opened.
+	/// \returns The size in bytes.
+	///
+	std::uint64_t get_size() const noexcept override;
+
+private:
+	///
+	/// \brief Reads some of the next bytes of the file.
+	/// \param buffer: The buffer receiving the bytes.
+	/// \returns Number of bytes read, 0 only at the end.
+	///
+	std::size_t read_some(std::span<std::uint8_t> buffer) override;
+
+	///
+	/// \brief Moves to an offset of the file.
+	/// \param offset: Offset from the beginning of the file.
+	///
+	void seek_to(std::uint64_t offset) override;
+
+private:
+#ifdef _WIN32
+	///
+	/// \brief The handle of the file.
+	///
+	void* handle;
+#else
+	///
+	/// \brief The descriptor of the file.
+	///
+	int descriptor;
+#endif // _WIN32
+
+	///
+	/// \brief How the file is read.
+	///
+	source_kind kind;
+
+	///
+	/// \brief The size of the file in bytes.
+	///
+	std::uint64_t size;
+
+	///
+	/// \brief Offset of the next byte to be read.
+	///
+	std::uint64_t offset;
+};
+
+///
+/// \brief Reads the standard input, e.g. a pipe from another program.
+///
+class stdin_source final : public byte_source
+{
+public:
+	///
+	/// \brief Initializes the source, the standard input is left open when it is destroyed.
+	///
+	stdin_source();
+
+	///
+	/// \brief Gets the size of the input, which is not known in advance.
+	/// \returns 0.
+	///
+	std::uint64_t get_size() const noexcept override;
+
+private:
+	///
+	/// \brief Reads some of the next bytes of the input.
+	/// \param buffer: The buffer receiving the bytes.
+	/// \returns Number of bytes read, 0 only at the end.
+	///
+	std::size_t read_some(std::span<std::uint8_t> buffer) override;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// METHOD DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+byte_source::byte_source(const std::string_view name)
+    : name{ name }
+    , lookahead{}
+    , lookahead_offset{ 0 }
+{
+}
+
+std::size_t byte_source::read(const std::span<std::uint8_t> buffer)
+{
+	const std::size_t peeked = std::min(buffer.size(), lookahead.size() - lookahead_offset);
+	std::size_t       count  = peeked;
+
+	std::copy_n(lookahead.begin() + static_cast<std::ptrdiff_t>(lookahead_offset), peeked, buffer.begin());
+	lookahead_offset += peeked;
+
+	while (count < buffer.size())
+	{
+		const std::size_t bytes_count = read_some(buffer.subspan(count));
+
+		if (0 == bytes_count)
+		{
+			break;
+		}
+
+		count += bytes_count;
+	}
+
+	return count;
+}
+
+std::span<const std::uint8_t> byte_source::peek(const std::size_t size)
+{
+	std::size_t count = lookahead.size() - lookahead_offset;
+
+	if (count >= size)
+	{
+		return std::span{ lookahead }.subspan(lookahead_offset, size);
+	}
+
+	lookahead.erase(lookahead.begin(), lookahead.begin() + static_cast<std::ptrdiff_t>(lookahead_offset));
+	lookahead.resize(size);
+	lookahead_offset = 0;
+
+	while (count < size)
+	{
+		const std::size_t bytes_count = read_some(std::span{ lookahead }.subspan(count));
+
+		if (0 == bytes_count)
+		{
+			break;
+		}
+
+		count += bytes_count;
+	}
+
+	lookahead.resize(count);
+	return lookahead;
+}
+
+void byte_source::seek(const std::uint64_t offset)
+{
+	// The bytes peeked at are the ones at the previous offset.
+	lookahead.clear();
+	lookahead_offset = 0;
+
+	seek_to(offset);
+}
+
+std::string_view byte_source::get_name() const noexcept
+{
+	return name;
+}
+
+void byte_source::seek_to(std::uint64_t)
+{
+	throw std::runtime_error{ std::format("\"{}\" cannot be read at random offsets!", name) };
+}
+
+#ifdef _WIN32
+
+file_source::file_source(const std::string_view file_path,
+                         const source_kind      kind)
+    : byte_source{ file_path }
+    , handle{ INVALID_HANDLE_VALUE }
+    , kind{ kind }
+    , size{ 0 }
+    , offset{ 0 }
+{
+	const DWORD   flags     = source_kind::sequential == kind ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL;
+	LARGE_INTEGER file_size = {};
+
+	handle = CreateFileA(std::string{ file_path }.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+
+	if (INVALID_HANDLE_VALUE == handle)
+	{
+		throw std::invalid_argument{ std::format("Failed to open \"{}\"!", file_path) };
+	}
+
+	if (!GetFileSizeEx(handle, &file_size))
+	{
+		CloseHandle(handle);
+		throw std::runtime_error{ std::format("Failed to get the size of \"{}\"!", file_path) };
+	}
+
+	size = static_cast<std::uint64_t>(file_size.QuadPart);
+}
+
+file_source::~file_source() noexcept
+{
+	CloseHandle(handle);
+}
+
+std::size_t file_source::read_some(const std::span<std::uint8_t> buffer)
+{
+	const std::size_t limit      = source_kind::sequential == kind ? CHUNK_SIZE : std::numeric_limits<DWORD>::max();
+	OVERLAPPED        overlapped = {};
+	DWORD             count      = 0;
+
+	// The offset is given explicitly, as pread() does.
+	overlapped.Offset     = static_cast<DWORD>(offset);
+	overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+	if (!ReadFile(handle, buffer.data(), static_cast<DWORD>(std::min(buffer.size(), limit)), &count, &overlapped))
+	{
+		if (ERROR_HANDLE_EOF == GetLastError())
+		{
+			return 0;
+		}
+
+		throw std::runtime_error{ std::format("Failed to read from \"{}\"!", get_name()) };
+	}
+
+	offset += count;
+	return count;
+}
+
+void file_source::seek_to(const std::uint64_t offset)
+{
+	// Every read is given its offset explicitly.
+	this->offset = offset;
+}
+
+stdin_source::stdin_source()
+    : byte_source{ "standard input" }
+{
+}
+
+std::size_t stdin_source::read_some(const std::span<std::uint8_t> buffer)
+{
+	DWORD count = 0;
+
+	if (!ReadFile(GetStdHandle(STD_INPUT_HANDLE), buffer.data(), static_cast<DWORD>(std::min<std::size_t>(buffer.size(), std::numeric_limits<DWORD>::max())),
+	              &count, nullptr))
+	{
+		// The writing end of a pipe was closed.
+		if (ERROR_BROKEN_PIPE == GetLastError())
+		{
+			return 0;
+		}
+
+		throw std::runtime_error{ std::format("Failed to read from \"{}\"!", get_name()) };
+	}
+
+	return count;
+}
+
+#else
+
+file_source::file_source(const std::string_view file_path,
+                         const source_kind      kind)
+    : byte_source{ file_path }
+    , descriptor{ open(std::string{ file_path }.c_str(), O_RDONLY | O_CLOEXEC) }
+    , kind{ kind }
+    , size{ 0 }
+    , offset{ 0 }
+{
+	struct stat status = {};
+
+	if (-1 == descriptor)
+	{
+		throw std::invalid_argument{ std::format("Failed to open \"{}\"!", file_path) };
+	}
+
+	if (-1 == fstat(descriptor, &status))
+	{
+		close(descriptor);
+		throw std::runtime_error{ std::format("Failed to get the size of \"{}\"!", file_path) };
+	}
+
+	size = static_cast<std::uint64_t>(status.st_size);
+
+#ifdef POSIX_FADV_SEQUENTIAL
+	if (source_kind::sequential == kind)
+	{
+		// Doubles the readahead window, which pays off for files not in the page cache.
+		posix_fadvise(descriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+	}
+#endif // POSIX_FADV_SEQUENTIAL
+}
+
+file_source::~file_source() noexcept
+{
+	close(descriptor);
+}
+
+std::size_t file_source::read_some(const std::span<std::uint8_t> buffer)
+{
+	ssize_t count = 0;
+
+	if (source_kind::whole_file == kind)
+	{
+		do
+		{
+			count = ::read(descriptor, buffer.data(), buffer.size());
+		}
+		while (-1 == count && EINTR == errno);
+	}
+	else
+	{
+#ifdef POSIX_FADV_WILLNEED
+		// Starts reading the next chunk in the background while this one is being copied.
+		posix_fadvise(descriptor, static_cast<off_t>(offset + CHUNK_SIZE), static_cast<off_t>(CHUNK_SIZE), POSIX_FADV_WILLNEED);
+#endif // POSIX_FADV_WILLNEED
+
+		do
+		{
+			count = pread(descriptor, buffer.data(), std::min(buffer.size(), CHUNK_SIZE), static_cast<off_t>(offset));
+		}
+		while (-1 == count && EINTR == errno);
+	}
+
+	if (-1 == count)
+	{
+		throw std::runtime_error{ std::format("Failed to read from \"{}\"!", get_name()) };
+	}
+
+	offset += static_cast<std::uint64_t>(count);
+	return static_cast<std::size_t>(count);
+}
+
+void file_source::seek_to(const std::uint64_t offset)
+{
+	// A file read with read() moves with its descriptor, the one read with pread() only with the offset.
+	if (source_kind::whole_file == kind && -1 == lseek(descriptor, static_cast<off_t>(offset), SEEK_SET))
+	{
+		throw std::runtime_error{ std::format("Failed to move to offset {} of \"{}\"!", offset, get_name()) };
+	}
+
+	this->offset = offset;
+}
+
+stdin_source::stdin_source()
+    : byte_source{ "standard input" }
+{
+}
+
+std::size_t stdin_source::read_some(const std::span<std::uint8_t> buffer)
+{
+	ssize_t count = 0;
+
+	do
+	{
+		count = ::read(STDIN_FILENO, buffer.data(), buffer.size());
+	}
+	while (-1 == count && EINTR == errno);
+
+	if (-1 == count)
+	{
+		throw std::runtime_error{ std::format("Failed to read from \"{}\"!", get_name()) };
+	}
+
+	return static_cast<std::size_t>(count);
+}
+
+#endif // _WIN32
+
+std::uint64_t file_source::get_size() const noexcept
+{
+	return size;
+}
+
+std::uint64_t stdin_source::get_size() const noexcept
+{
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+std::unique_ptr<byte_source> open_source(const std::string_view file_path,
+                                         const source_kind      kind)
+{
+	const stats_timer timer = stats_timer{ stats_phase::open };
+
+	if (STDIN_PATH == file_path)
+	{
+		return std::make_unique<stdin_source>();
+	}
+
+	return std::make_unique<file_source>(file_path, kind);
+}
+
+} // namespace icon_changer
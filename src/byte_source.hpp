@@ -0,0 +1,307 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "field_layout.hpp"
+#include "memory_budget.hpp"
+#include "stats.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTANTS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief The path standing for the standard input.
+///
+inline constexpr std::string_view STDIN_PATH = "-";
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief How a file is read.
+///
+enum class source_kind : std::uint8_t
+{
+	whole_file, ///< The file is read with a single system call.
+	sequential  ///< The file is read in chunks at explicit offsets, the kernel being asked to read ahead.
+};
+
+///
+/// \brief A sequence of bytes read from front to back.
+/// \details Backends implement read_some(), the rest is shared: reads are
+/// completed across short reads and the first bytes can be peeked at, so the
+/// format of a pipe can be detected before it is parsed.
+///
+class byte_source
+{
+public:
+	///
+	/// \brief Releases the underlying file.
+	///
+	virtual ~byte_source() noexcept = default;
+
+	byte_source(const byte_source&)            = delete;
+	byte_source& operator=(const byte_source&) = delete;
+
+	///
+	/// \brief Reads the next bytes.
+	/// \param buffer: The buffer receiving the bytes.
+	/// \returns Number of bytes read, less than the buffer size only at the end.
+	///
+	std::size_t read(std::span<std::uint8_t> buffer);
+
+	///
+	/// \brief Gets the next bytes without consuming them.
+	/// \param size: Number of bytes to look at.
+	/// \returns The bytes, fewer than requested only at the end.
+	///
+	std::span<const std::uint8_t> peek(std::size_t size);
+
+	///
+	/// \brief Moves to an offset, the next read starting from it.
+	/// \param offset: Offset from the beginning of the source.
+	/// \throws std::runtime_error if the source cannot be read at random offsets (e.g. pipes).
+	///
+	void seek(std::uint64_t offset);
+
+	///
+	/// \brief Gets the size of the whole source.
+	/// \returns The size in bytes, 0 if it is not known in advance (e.g. pipes).
+	///
+	virtual std::uint64_t get_size() const noexcept = 0;
+
+	///
+	/// \brief Gets the name of the source.
+	/// \returns The name, used for error messages.
+	///
+	std::string_view get_name() const noexcept;
+
+protected:
+	///
+	/// \brief Initializes the source.
+	/// \param name: The name of the source, used for error messages.
+	///
+	explicit byte_source(std::string_view name);
+
+	///
+	/// \brief Reads some of the next bytes.
+	/// \param buffer: The buffer receiving the bytes.
+	/// \returns Number of bytes read, 0 only at the end.
+	///
+	virtual std::size_t read_some(std::span<std::uint8_t> buffer) = 0;
+
+	///
+	/// \brief Moves to an offset of the source.
+	/// \details Sources that cannot be read at random offsets keep the default, which throws.
+	/// \param offset: Offset from the beginning of the source.
+	///
+	virtual void seek_to(std::uint64_t offset);
+
+private:
+	///
+	/// \brief The name of the source.
+	///
+	std::string name;
+
+	///
+	/// \brief The bytes that were peeked at and not consumed yet.
+	///
+	std::vector<std::uint8_t> lookahead;
+
+	///
+	/// \brief Number of lookahead bytes already consumed.
+	///
+	std::size_t lookahead_offset;
+};
+
+///
+/// \brief Reads structures from a byte buffer, checking every access against its end.
+/// \tparam Byte: The byte type, const for read-only buffers.
+///
+template <typename Byte> class byte_cursor final
+{
+public:
+	///
+	/// \brief Places the cursor at the beginning of the buffer.
+	/// \param bytes: The buffer, it must outlive the cursor.
+	///
+	explicit byte_cursor(std::span<Byte> bytes) noexcept;
+
+	///
+	/// \brief Copies a structure and advances past it.
+	/// \param what: What is being read, used for error messages.
+	/// \returns The structure.
+	/// \throws std::runtime_error if the structure does not fit in the rest of the buffer.
+	///
+	template <typename T> T read(std::string_view what);
+
+	///
+	/// \brief Takes a view of the next bytes and advances past them.
+	/// \param size: Number of bytes.
+	/// \param what: What is being read, used for error messages.
+	/// \returns The view.
+	/// \throws std::runtime_error if the bytes do not fit in the rest of the buffer.
+	///
+	std::span<Byte> take(std::size_t      size,
+	                     std::string_view what);
+
+	///
+	/// \brief Gets the position of the cursor.
+	/// \returns The offset from the beginning of the buffer.
+	///
+	std::size_t get_offset() const noexcept;
+
+	///
+	/// \brief Gets the number of bytes after the cursor.
+	/// \returns The number of bytes.
+	///
+	std::size_t get_remaining() const noexcept;
+
+private:
+	///
+	/// \brief The buffer.
+	///
+	std::span<Byte> bytes;
+
+	///
+	/// \brief The position of the cursor.
+	///
+	std::size_t offset;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DECLARATIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Opens a file as a byte source.
+/// \param file_path: The path to the file, STDIN_PATH for the standard input.
+/// \param kind: How the file is read, ignored for the standard input.
+/// \returns The byte source.
+///
+extern std::unique_ptr<byte_source> open_source(std::string_view file_path,
+                                                source_kind      kind = source_kind::whole_file);
+
+///
+/// \brief Reads a byte source until its end.
+/// \details A source of known size is read with a single read() call.
+/// \param source: The byte source.
+/// \param bytes: The container receiving the bytes (e.g. std::vector<std::uint8_t>).
+/// \param budget: The budget the buffer is charged to before it is allocated, nullptr for none.
+///
+template <typename Bytes> void read_all(byte_source&   source,
+                                        Bytes&         bytes,
+                                        memory_budget* budget = nullptr);
+
+////////////////////////////////////////////////////////////////////////////////
+// METHOD DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename Byte> byte_cursor<Byte>::byte_cursor(const std::span<Byte> bytes) noexcept
+    : bytes{ bytes }
+    , offset{ 0 }
+{
+}
+
+template <typename Byte> template <typename T> T byte_cursor<Byte>::read(const std::string_view what)
+{
+	return read_wire<T>(take(WIRE_SIZE<T>, what).data());
+}
+
+template <typename Byte> std::span<Byte> byte_cursor<Byte>::take(const std::size_t      size,
+                                                                 const std::string_view what)
+{
+	if (size > bytes.size() - offset)
+	{
+		throw std::runtime_error{ std::format("Failed to read {} bytes from {}!", size, what) };
+	}
+
+	offset += size;
+	return bytes.subspan(offset - size, size);
+}
+
+template <typename Byte> std::size_t byte_cursor<Byte>::get_offset() const noexcept
+{
+	return offset;
+}
+
+template <typename Byte> std::size_t byte_cursor<Byte>::get_remaining() const noexcept
+{
+	return bytes.size() - offset;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename Bytes> void read_all(byte_source&         source,
+                                        Bytes&               bytes,
+                                        memory_budget* const budget)
+{
+	static constexpr std::size_t MIN_CAPACITY = 64 * 1024;
+
+	const stats_timer   timer  = stats_timer{ stats_phase::read };
+	const std::uint64_t size   = source.get_size();
+	const std::string   what   = std::format("\"{}\"", source.get_name());
+	std::size_t         offset = 0;
+
+	if (nullptr != budget)
+	{
+		budget->charge(0 != size ? size : MIN_CAPACITY, what);
+	}
+
+	bytes.resize(0 != size ? static_cast<std::size_t>(size) : MIN_CAPACITY);
+
+	// A source of unknown size is read into a buffer growing geometrically.
+	while (true)
+	{
+		offset += source.read(std::span{ bytes }.subspan(offset));
+
+		if (offset < bytes.size() || offset == size)
+		{
+			break;
+		}
+
+		if (nullptr != budget)
+		{
+			budget->charge(bytes.size(), what);
+		}
+
+		bytes.resize(bytes.size() * 2);
+	}
+
+	bytes.resize(offset);
+	count_stat(stats_counter::bytes_read, offset);
+}
+
+} // namespace icon_changer
@@ -18,9 +18,20 @@
 #include "cli.hpp"
 
 #include <cassert>
+#include <charconv>
+#include <limits>
+#include <optional>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
+#include "batch.hpp"
+#include "depfile.hpp"
+#include "icon_cache.hpp"
 #include "icon_changer.hpp"
+#include "inventory.hpp"
+#include "server.hpp"
+#include "stats.hpp"
 #include "utility.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -32,52 +43,491 @@ namespace icon_changer
 
 ///
 /// \brief Prints information to the user about the usage of the icon changer.
+/// \param output: The stream the help is printed to.
 ///
-static void print_help();
+static void print_help(std::FILE* output);
 
 ///
 /// \brief Validates the number of command-line arguments.
 /// \details If the argument count is incorrect, help is printed and an exception
 /// is thrown for too few arguments.
 /// \param argument_count: The number of command-line arguments passed.
+/// \param output: The stream help and warnings are printed to.
 ///
-static void validate_argument_count(std::int32_t argument_count);
+static void validate_argument_count(std::int32_t argument_count,
+                                    std::FILE*   output);
+
+///
+/// \brief Gets the value following an option.
+/// \param argument_count: The number of command-line arguments passed.
+/// \param arguments: The command-line arguments.
+/// \param index: The index of the option, advanced past the value.
+/// \param output: The stream help is printed to if the value is missing.
+/// \returns The value of the option.
+///
+static std::string_view get_option_value(std::int32_t       argument_count,
+                                         const char** const arguments,
+                                         std::int32_t&      index,
+                                         std::FILE*         output);
+
+///
+/// \brief Parses the numeric value of an option.
+/// \param option: The name of the option, used for error messages.
+/// \param value: The value of the option.
+/// \returns The parsed number.
+///
+static std::uint64_t parse_number(std::string_view option,
+                                  std::string_view value);
+
+///
+/// \brief Parses a comma separated list of icon sizes.
+/// \param option: The name of the option, used for error messages.
+/// \param value: The value of the option, "all" for the default sizes.
+/// \returns The parsed sizes.
+///
+static std::vector<std::uint16_t> parse_sizes(std::string_view option,
+                                              std::string_view value);
+
+///
+/// \brief Parses a comma separated list of numbers.
+/// \param option: The name of the option, used for error messages.
+/// \param value: The value of the option.
+/// \returns The parsed numbers.
+///
+static std::vector<std::uint16_t> parse_list(std::string_view option,
+                                             std::string_view value);
+
+///
+/// \brief Parses the width from which images are compressed as PNG.
+/// \param option: The name of the option, used for error messages.
+/// \param value: The value of the option, from 1 to 256.
+/// \returns The parsed width.
+///
+static std::uint16_t parse_png_size(std::string_view option,
+                                    std::string_view value);
+
+///
+/// \brief Parses a size given in MiB.
+/// \param option: The name of the option, used for error messages.
+/// \param value: The value of the option.
+/// \returns The parsed size in bytes.
+///
+static std::uint64_t parse_mebibytes(std::string_view option,
+                                     std::string_view value);
+
+///
+/// \brief Parses the format the statistics are printed in.
+/// \param option: The name of the option, used for error messages.
+/// \param value: The value of the option, "text" or "json".
+/// \returns The parsed format.
+///
+static stats_format parse_stats_format(std::string_view option,
+                                       std::string_view value);
+
+///
+/// \brief Parses the format an inventory is printed in.
+/// \param option: The name of the option, used for error messages.
+/// \param value: The value of the option, "json" or "csv".
+/// \returns The parsed format.
+///
+static inventory_format parse_inventory_format(std::string_view option,
+                                               std::string_view value);
+
+///
+/// \brief Parses the name of an icon group.
+/// \param option: The name of the option, used for error messages.
+/// \param name: The name, an integer ID if it is made of digits.
+/// \returns The identifier of the group.
+///
+static resource_tree::identifier parse_identifier(std::string_view option,
+                                                  std::string_view name);
+
+///
+/// \brief Parses an icon group and the path to its icon.
+/// \param option: The name of the option, used for error messages.
+/// \param value: The value of the option, "<name>=<path_to_icon>", the name
+/// being an integer ID if it is made of digits.
+/// \returns The identifier of the group and the path to its icon.
+///
+static std::pair<resource_tree::identifier, std::string_view> parse_group(std::string_view option,
+                                                                          std::string_view value);
+
+///
+/// \brief Prints how an icon was prepared.
+/// \param icon: The loaded icon.
+/// \param prefix: Printed before every line, e.g. the path to the icon.
+/// \param output: The stream it is printed to.
+///
+static void print_preparation(const icon&      icon,
+                              std::string_view prefix,
+                              std::FILE*       output);
 
 ////////////////////////////////////////////////////////////////////////////////
 // FUNCTION DEFINITIONS
 ////////////////////////////////////////////////////////////////////////////////
 
 void change_icon_cli(const std::int32_t argument_count,
-                     const char** const arguments)
+                     const char** const arguments,
+                     std::FILE* const   output,
+                     const icon_loader& loader)
 {
 	assert(0 < argument_count);
 	assert(nullptr != arguments);
 
 	if (2 <= argument_count && ("--help" == std::string_view{ arguments[1] } || "-h" == std::string_view{ arguments[1] }))
 	{
-		print_help();
+		print_help(output);
 		return;
 	}
 
 	if (2 <= argument_count && ("--version" == std::string_view{ arguments[1] } || "-v" == std::string_view{ arguments[1] }))
 	{
-		std::println("icon-changer version {}.{}.{}", VERSION_MAJOR, VERSION_MINOR, VERSION_PATCH);
+		std::println(output, "icon-changer version {}.{}.{}", VERSION_MAJOR, VERSION_MINOR, VERSION_PATCH);
+		return;
+	}
+
+	std::vector<std::string_view> paths         = {};
+	icon::options                 options       = {};
+	std::string_view              manifest_path = {};
+	std::size_t                   threads_count = 0;
+	std::string_view              cache_path    = {};
+	std::string_view              depfile_path  = {};
+	std::string_view              socket_path   = {};
+	std::string_view              scan_path     = {};
+	std::string_view              extract_path  = {};
+	inventory_format              scan_format   = inventory_format::json;
+	std::size_t                   icons_count   = server::DEFAULT_ICONS_CAPACITY;
+	std::uint64_t                 cache_size    = icon_cache::DEFAULT_CAPACITY;
+	std::optional<icon_cache>     cache         = {};
+	std::optional<stats_format>   stats         = {};
+	std::vector<stats_sample>     samples       = {};
+	stats_record                  record        = {};
+
+	std::vector<std::pair<resource_tree::identifier, std::string_view>> group_paths = {};
+
+	for (std::int32_t index = 1; index < argument_count; ++index)
+	{
+		const std::string_view argument = arguments[index];
+
+		if ("--mmap" == argument)
+		{
+			options.mode = icon::load_mode::mapped;
+			continue;
+		}
+
+		if ("--pread" == argument)
+		{
+			options.mode = icon::load_mode::sequential;
+			continue;
+		}
+
+		if ("--batch" == argument)
+		{
+			manifest_path = get_option_value(argument_count, arguments, index, output);
+			continue;
+		}
+
+		if ("--jobs" == argument)
+		{
+			threads_count = parse_number(argument, get_option_value(argument_count, arguments, index, output));
+			continue;
+		}
+
+		if ("--cache" == argument)
+		{
+			cache_path = get_option_value(argument_count, arguments, index, output);
+			continue;
+		}
+
+		if ("--cache-size" == argument)
+		{
+			cache_size = parse_mebibytes(argument, get_option_value(argument_count, arguments, index, output));
+			continue;
+		}
+
+		if ("--resize" == argument)
+		{
+			options.sizes = parse_sizes(argument, get_option_value(argument_count, arguments, index, output));
+			continue;
+		}
+
+		if ("--sizes" == argument)
+		{
+			options.entry_sizes = parse_list(argument, get_option_value(argument_count, arguments, index, output));
+			continue;
+		}
+
+		if ("--depths" == argument)
+		{
+			options.entry_depths = parse_list(argument, get_option_value(argument_count, arguments, index, output));
+			continue;
+		}
+
+		if ("--from-group" == argument)
+		{
+			options.source_group = parse_identifier(argument, get_option_value(argument_count, arguments, index, output));
+			continue;
+		}
+
+		if ("--png" == argument)
+		{
+			options.png_min_size = parse_png_size(argument, get_option_value(argument_count, arguments, index, output));
+			continue;
+		}
+
+		if ("--max-memory" == argument)
+		{
+			options.max_memory = parse_mebibytes(argument, get_option_value(argument_count, arguments, index, output));
+			continue;
+		}
+
+		if ("--stats" == argument)
+		{
+			stats = parse_stats_format(argument, get_option_value(argument_count, arguments, index, output));
+			continue;
+		}
+
+		if ("--depfile" == argument)
+		{
+			depfile_path = get_option_value(argument_count, arguments, index, output);
+			continue;
+		}
+
+		if ("--serve" == argument)
+		{
+			socket_path = get_option_value(argument_count, arguments, index, output);
+			continue;
+		}
+
+		if ("--keep" == argument)
+		{
+			icons_count = parse_number(argument, get_option_value(argument_count, arguments, index, output));
+			continue;
+		}
+
+		if ("--inventory" == argument)
+		{
+			scan_path = get_option_value(argument_count, arguments, index, output);
+			continue;
+		}
+
+		if ("--inventory-format" == argument)
+		{
+			scan_format = parse_inventory_format(argument, get_option_value(argument_count, arguments, index, output));
+			continue;
+		}
+
+		if ("--extract" == argument)
+		{
+			extract_path = get_option_value(argument_count, arguments, index, output);
+			continue;
+		}
+
+		if ("--group" == argument)
+		{
+			group_paths.push_back(parse_group(argument, get_option_value(argument_count, arguments, index, output)));
+			continue;
+		}
+
+		if (argument.starts_with("--"))
+		{
+			print_help(output);
+			throw std::invalid_argument{ std::format("Unknown option \"{}\"!", argument) };
+		}
+
+		paths.push_back(argument);
+	}
+
+	if (!cache_path.empty())
+	{
+		cache.emplace(cache_path, cache_size);
+	}
+
+	if (!socket_path.empty())
+	{
+		server daemon = server{ socket_path, threads_count, icons_count };
+
+		std::println(output, "Serving on \"{}\"...", socket_path);
+		std::fflush(output);
+		daemon.run();
+		return;
+	}
+
+	if (!scan_path.empty())
+	{
+		std::print(output, "{}", format_inventory(scan_icons(scan_path, threads_count, extract_path), scan_format));
+		return;
+	}
+
+	if (!manifest_path.empty())
+	{
+		const std::size_t failed_count = change_icons(manifest_path, options, threads_count, cache ? &cache.value() : nullptr, stats ? &samples : nullptr);
+
+		if (stats.has_value())
+		{
+			std::print(output, "{}", format_stats(samples, *stats));
+		}
+
+		if (0 != failed_count)
+		{
+			throw std::runtime_error{ std::format("{} job(s) failed!", failed_count) };
+		}
+
+		if (!depfile_path.empty())
+		{
+			std::vector<depfile_rule> rules = {};
+
+			for (batch_job& job : read_manifest(manifest_path))
+			{
+				rules.push_back(depfile_rule{ std::move(job.executable_path), { std::string{ manifest_path } } });
+
+				// The standard input is not a file the build can track.
+				if (STDIN_PATH != job.icon_path)
+				{
+					rules.back().inputs.push_back(std::move(job.icon_path));
+				}
+			}
+
+			write_depfile(depfile_path, rules);
+		}
+
 		return;
 	}
 
-	validate_argument_count(argument_count);
-	change_icon(arguments[1], arguments[2]);
-	std::println(GRN "Icon changed successfully!" CRESET);
+	// The groups make the main icon optional, so only the executable can be missing.
+	if (!group_paths.empty() && paths.empty())
+	{
+		print_help(output);
+		throw std::runtime_error{ "Path to the executable is missing!" };
+	}
+
+	// The icon given before the executable becomes the main icon, it can be left out when groups are given.
+	if (group_paths.empty() || 1 != paths.size())
+	{
+		validate_argument_count(static_cast<std::int32_t>(paths.size()) + 1, output);
+
+		group_paths.emplace(group_paths.begin(), resource_tree::make_identifier(MAIN_ICON_NAME), paths.front());
+		paths.erase(paths.begin());
+	}
+
+	const stats_scope                        scope  = stats_scope{ stats.has_value() ? &record : nullptr };
+	std::vector<std::shared_ptr<const icon>> icons  = {};
+	std::vector<icon_group>                  groups = {};
+	icon::deduplication                      shared = {};
+
+	// The icons are loaded here rather than by change_icon() to report how they were prepared.
+	for (const auto& [name, path] : group_paths)
+	{
+		icons.push_back(loader ? loader(path, options, cache ? &cache.value() : nullptr)
+		                       : std::make_shared<const icon>(cache.has_value() ? cache->load(path, options) : icon{ path, options }));
+		print_preparation(*icons.back(), 1 == group_paths.size() ? std::string{} : std::format("{}: ", path), output);
+	}
+
+	for (std::size_t index = 0; index < icons.size(); ++index)
+	{
+		groups.push_back(icon_group{ group_paths[index].first, icons[index].get() });
+	}
+
+	const pe_file::save_strategy strategy = change_icon(groups, paths.front(), &shared);
+
+	if (0 != shared.images_count)
+	{
+		std::println(output, "{} image(s) shared between groups: {} bytes saved", shared.images_count, shared.saved_size);
+	}
+
+	if (!depfile_path.empty())
+	{
+		depfile_rule rule = { std::string{ paths.front() }, {} };
+
+		// The standard input is not a file the build can track.
+		for (const auto& [name, path] : group_paths)
+		{
+			if (STDIN_PATH != path)
+			{
+				rule.inputs.emplace_back(path);
+			}
+		}
+
+		write_depfile(depfile_path, std::span{ &rule, 1 });
+	}
+
+	if (pe_file::save_strategy::unchanged == strategy)
+	{
+		std::println(output, GRN "Icon is already up to date!" CRESET);
+	}
+	else
+	{
+		std::println(output, GRN "Icon changed successfully! ({})" CRESET, pe_file::to_string(strategy));
+	}
+
+	if (stats.has_value())
+	{
+		samples.push_back(record.get_sample());
+		std::print(output, "{}", format_stats(samples, *stats));
+	}
 }
 
-static void print_help()
+static void print_help(std::FILE* const output)
 {
-	std::println("Usage: icon-changer <path_to_icon> <path_to_exe>");
-	std::println("valid icon formats are: ICO (recommended), BMP");
-	std::println("valid program format is: EXE");
+	std::println(output, "Usage: icon-changer [options] <path_to_icon> <path_to_exe>");
+	std::println(output, "       icon-changer [options] - <path_to_exe> < icon");
+	std::println(output, "       icon-changer [options] --group <name>=<path_to_icon> <path_to_exe>");
+	std::println(output, "       icon-changer [options] --batch <path_to_manifest>");
+	std::println(output, "       icon-changer [options] --inventory <path_to_directory>");
+	std::println(output, "       icon-changer --connect <path_to_socket> [options] <path_to_icon> <path_to_exe>");
+	std::println(output, "valid icon formats are: ICO (recommended), BMP, PNG, EXE/DLL");
+	std::println(output, "valid program format is: EXE");
+	std::println(output, "options:");
+	std::println(output, "  --mmap         memory map the icon instead of copying its images");
+	std::println(output, "  --pread        read the icon in chunks with readahead hints, for files that");
+	std::println(output, "                 are not in the page cache");
+	std::println(output, "  --batch <path> change the icons of the executables listed in a manifest,");
+	std::println(output, "                 one \"<path_to_icon> <path_to_exe>\" pair per line");
+	std::println(output, "  --jobs <n>     number of worker threads for --batch and --inventory");
+	std::println(output, "                 (default: all cores)");
+	std::println(output, "  --cache <dir>  reuse parsed icons stored in a directory, keyed by content");
+	std::println(output, "  --cache-size <MiB>");
+	std::println(output, "                 size above which old cache entries are evicted (default: 256)");
+	std::println(output, "  --resize <sizes>");
+	std::println(output, "                 resample a BMP or PNG to several sizes, e.g. \"16,32,256\", or \"all\"");
+	std::println(output, "                 for 16,24,32,48,64,128,256");
+	std::println(output, "  --sizes <sizes>");
+	std::println(output, "                 only embed the ICO entries of the given sizes, e.g. \"16,32,256\",");
+	std::println(output, "                 the other images not being read");
+	std::println(output, "  --depths <bpp> only embed the ICO entries of the given bits per pixel, e.g. \"32\"");
+	std::println(output, "  --from-group <name>");
+	std::println(output, "                 copy the icon group of the given name or integer ID when the");
+	std::println(output, "                 icon is an executable (default: its first group)");
+	std::println(output, "  --png <size>   compress the 24 and 32bpp images at least <size> pixels wide");
+	std::println(output, "                 as PNG, e.g. \"256\"");
+	std::println(output, "  --group <name>=<path_to_icon>");
+	std::println(output, "                 also embed an icon as the group of the given name or integer ID,");
+	std::println(output, "                 e.g. \"2=document.ico\"; repeat it for more groups, the icon");
+	std::println(output, "                 before the executable can then be left out");
+	std::println(output, "  --depfile <path>");
+	std::println(output, "                 write a Make/Ninja depfile listing the icons each executable");
+	std::println(output, "                 depends on");
+	std::println(output, "  --inventory <dir>");
+	std::println(output, "                 list the icons of every executable under a directory, without");
+	std::println(output, "                 modifying them");
+	std::println(output, "  --inventory-format <format>");
+	std::println(output, "                 print the inventory as \"json\" (default) or \"csv\"");
+	std::println(output, "  --extract <dir>");
+	std::println(output, "                 also extract every icon group found by --inventory to an ICO file");
+	std::println(output, "  --max-memory <MiB>");
+	std::println(output, "                 memory an icon and its decoded images may take, larger icons");
+	std::println(output, "                 being rejected before they are read (default: 1024)");
+	std::println(output, "  --serve <path> keep running and change icons on behalf of");
+	std::println(output, "                 \"icon-changer --connect <path> ...\" over a Unix socket, the");
+	std::println(output, "                 parsed icons being kept in memory");
+	std::println(output, "  --keep <n>     number of parsed icons kept by --serve (default: 64)");
+	std::println(output, "  --stats <format>");
+	std::println(output, "                 print the time spent in each phase and the bytes read, written");
+	std::println(output, "                 and allocated, as \"text\" or \"json\"");
 }
 
-static void validate_argument_count(const std::int32_t argument_count)
+static void validate_argument_count(const std::int32_t argument_count,
+                                    std::FILE* const   output)
 {
 	static constexpr std::size_t REQUIRED_ARGUMENT_COUNT = 3;
 
@@ -86,14 +536,199 @@ static void validate_argument_count(const std::int32_t argument_count)
 		return;
 	}
 
-	print_help();
+	print_help(output);
 
 	if (REQUIRED_ARGUMENT_COUNT > argument_count)
 	{
 		throw std::runtime_error{ std::format("{} parameter(s) missing!", REQUIRED_ARGUMENT_COUNT - argument_count) };
 	}
 
-	std::println(YEL "{} parameter(s) will be ignored..." CRESET, argument_count - REQUIRED_ARGUMENT_COUNT);
+	std::println(output, YEL "{} parameter(s) will be ignored..." CRESET, argument_count - REQUIRED_ARGUMENT_COUNT);
+}
+
+static std::string_view get_option_value(const std::int32_t argument_count,
+                                         const char** const arguments,
+                                         std::int32_t&      index,
+                                         std::FILE* const   output)
+{
+	if (argument_count <= index + 1)
+	{
+		print_help(output);
+		throw std::invalid_argument{ std::format("Option \"{}\" requires a value!", arguments[index]) };
+	}
+
+	return arguments[++index];
+}
+
+static std::uint64_t parse_number(const std::string_view option,
+                                  const std::string_view value)
+{
+	std::uint64_t number = 0;
+
+	const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), number);
+
+	if (std::errc{} != error || value.data() + value.size() != end)
+	{
+		throw std::invalid_argument{ std::format("Invalid value \"{}\" for option \"{}\"!", value, option) };
+	}
+
+	return number;
+}
+
+static std::vector<std::uint16_t> parse_sizes(const std::string_view option,
+                                              const std::string_view value)
+{
+	if ("all" == value)
+	{
+		return { icon::DEFAULT_SIZES.begin(), icon::DEFAULT_SIZES.end() };
+	}
+
+	return parse_list(option, value);
+}
+
+static std::vector<std::uint16_t> parse_list(const std::string_view option,
+                                             const std::string_view value)
+{
+	std::vector<std::uint16_t> values    = {};
+	std::string_view           remaining = value;
+
+	while (true)
+	{
+		const std::size_t   end    = std::min(remaining.find(','), remaining.size());
+		const std::uint64_t number = parse_number(option, remaining.substr(0, end));
+
+		if (std::numeric_limits<std::uint16_t>::max() < number)
+		{
+			throw std::invalid_argument{ std::format("Invalid value \"{}\" for option \"{}\"!", value, option) };
+		}
+
+		values.push_back(static_cast<std::uint16_t>(number));
+
+		if (remaining.size() == end)
+		{
+			return values;
+		}
+
+		remaining.remove_prefix(end + 1);
+	}
+}
+
+static std::uint16_t parse_png_size(const std::string_view option,
+                                    const std::string_view value)
+{
+	const std::uint64_t size = parse_number(option, value);
+
+	if (0 == size || 256 < size)
+	{
+		throw std::invalid_argument{ std::format("Invalid value \"{}\" for option \"{}\"!", value, option) };
+	}
+
+	return static_cast<std::uint16_t>(size);
+}
+
+static std::uint64_t parse_mebibytes(const std::string_view option,
+                                     const std::string_view value)
+{
+	static constexpr std::uint64_t MEBIBYTE = 1024 * 1024;
+
+	const std::uint64_t size = parse_number(option, value);
+
+	// A size that does not fit in bytes would wrap around to a tiny one.
+	if (std::numeric_limits<std::uint64_t>::max() / MEBIBYTE < size)
+	{
+		throw std::invalid_argument{ std::format("Invalid value \"{}\" for option \"{}\"!", value, option) };
+	}
+
+	return size * MEBIBYTE;
+}
+
+static stats_format parse_stats_format(const std::string_view option,
+                                       const std::string_view value)
+{
+	if ("text" == value)
+	{
+		return stats_format::text;
+	}
+
+	if ("json" == value)
+	{
+		return stats_format::json;
+	}
+
+	throw std::invalid_argument{ std::format("Invalid value \"{}\" for option \"{}\"!", value, option) };
+}
+
+static inventory_format parse_inventory_format(const std::string_view option,
+                                               const std::string_view value)
+{
+	if ("json" == value)
+	{
+		return inventory_format::json;
+	}
+
+	if ("csv" == value)
+	{
+		return inventory_format::csv;
+	}
+
+	throw std::invalid_argument{ std::format("Invalid value \"{}\" for option \"{}\"!", value, option) };
+}
+
+static resource_tree::identifier parse_identifier(const std::string_view option,
+                                                  const std::string_view name)
+{
+	std::uint64_t id = 0;
+
+	if (name.empty())
+	{
+		throw std::invalid_argument{ std::format("Empty group name for option \"{}\"!", option) };
+	}
+
+	if (name.find_first_not_of("0123456789") != std::string_view::npos)
+	{
+		return resource_tree::make_identifier(name);
+	}
+
+	id = parse_number(option, name);
+
+	if (0 == id || std::numeric_limits<std::uint16_t>::max() < id)
+	{
+		throw std::invalid_argument{ std::format("Group ID {} is not between 1 and {}!", id, std::numeric_limits<std::uint16_t>::max()) };
+	}
+
+	return static_cast<std::uint16_t>(id);
+}
+
+static std::pair<resource_tree::identifier, std::string_view> parse_group(const std::string_view option,
+                                                                          const std::string_view value)
+{
+	const std::size_t      separator = value.find('=');
+	const std::string_view name      = value.substr(0, separator);
+
+	if (std::string_view::npos == separator || name.empty() || separator + 1 == value.size())
+	{
+		throw std::invalid_argument{ std::format("Invalid value \"{}\" for option \"{}\", expecting \"<name>=<path_to_icon>\"!", value, option) };
+	}
+
+	return { parse_identifier(option, name), value.substr(separator + 1) };
+}
+
+static void print_preparation(const icon&            icon,
+                              const std::string_view prefix,
+                              std::FILE* const       output)
+{
+	const icon::deduplication deduplication = icon.get_deduplication();
+
+	for (const icon::compression& compression : icon.get_compressions())
+	{
+		std::println(output, "{}{}x{} image compressed as PNG: {} -> {} bytes", prefix, compression.width, compression.height, compression.original_size,
+		             compression.size);
+	}
+
+	if (0 != deduplication.images_count)
+	{
+		std::println(output, "{}{} duplicate image(s) shared: {} bytes saved", prefix, deduplication.images_count, deduplication.saved_size);
+	}
 }
 
 } // namespace icon_changer
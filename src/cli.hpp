@@ -18,22 +18,44 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string_view>
+
+#include "icon.hpp"
+#include "icon_cache.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
-// FUNCTION DECLARATIONS
+// TYPE DEFINITIONS
 ////////////////////////////////////////////////////////////////////////////////
 
 namespace icon_changer
 {
 
+///
+/// \brief Loads the icon of a command, e.g. from the icons kept by a server.
+/// \details It gets the path to the icon, how it is loaded and prepared, and
+/// the cache given with `--cache`, nullptr if there is none.
+///
+using icon_loader = std::function<std::shared_ptr<const icon>(std::string_view, const icon::options&, const icon_cache*)>;
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DECLARATIONS
+////////////////////////////////////////////////////////////////////////////////
+
 ///
 /// \brief CLI entry point for icon changing.
 /// \details Handles `--version` argument, validates input, and initiates the
 /// icon change.
 /// \param argument_count: Number of arguments.
 /// \param arguments: Argument values.
+/// \param output: The stream messages are printed to.
+/// \param loader: Loads the icons, empty to parse them on every call.
 ///
-extern void change_icon_cli(std::int32_t argument_count,
-                            const char** arguments);
+extern void change_icon_cli(std::int32_t       argument_count,
+                            const char**       arguments,
+                            std::FILE*         output = stdout,
+                            const icon_loader& loader = {});
 
 } // namespace icon_changer
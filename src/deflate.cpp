@@ -0,0 +1,1323 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include "deflate.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstring>
+#include <format>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+#include "field_layout.hpp"
+#include "hash.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTANTS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+static constexpr std::size_t WINDOW_SIZE     = 32768; ///< Farthest distance a match can reach back.
+static constexpr std::size_t MIN_MATCH       = 3;     ///< Shortest match that can be encoded.
+static constexpr std::size_t MAX_MATCH       = 258;   ///< Longest match that can be encoded.
+static constexpr std::size_t FAR_DISTANCE    = 4096;  ///< Distance beyond which a shortest match costs more than its literals.
+static constexpr std::size_t HASH_BITS       = 15;    ///< Bits of the hash of the next 3 bytes.
+static constexpr std::size_t MAX_CHAIN       = 32;    ///< Most candidates tried for a match.
+static constexpr std::size_t NICE_MATCH      = 64;    ///< Length after which no longer match is searched.
+static constexpr std::size_t LAZY_MATCH      = 16;    ///< Length after which the next byte is not tried for a longer match.
+static constexpr std::size_t GOOD_MATCH      = 8;     ///< Length after which the next byte is only tried with a shorter chain.
+static constexpr std::size_t BLOCK_TOKENS    = 16384; ///< Tokens per block, so the codes adapt to the data.
+static constexpr std::size_t MAX_STORED      = 65535; ///< Most bytes of a stored block.
+static constexpr std::size_t END_OF_BLOCK    = 256;   ///< The literal/length symbol ending a block.
+static constexpr std::size_t LITERALS_COUNT  = 286;   ///< Number of literal/length symbols.
+static constexpr std::size_t DISTANCES_COUNT = 30;    ///< Number of distance symbols.
+static constexpr std::size_t LENGTHS_COUNT   = 19;    ///< Number of code length symbols.
+static constexpr std::size_t FIXED_LITERALS  = 288;   ///< Number of literal/length symbols of the fixed code, 2 of them unused.
+static constexpr std::size_t FIXED_DISTANCES = 32;    ///< Number of distance symbols of the fixed code, 2 of them unused.
+static constexpr std::size_t FAST_BITS       = 9;     ///< Bits of the codes decoded with a single table lookup.
+
+///
+/// \brief Longest code of the literal/length and distance alphabets.
+///
+static constexpr std::uint8_t MAX_CODE_LENGTH = 15;
+
+///
+/// \brief Longest code of the code length alphabet.
+///
+static constexpr std::uint8_t MAX_LENGTH_CODE_LENGTH = 7;
+
+static constexpr std::array<std::uint16_t, 29> LENGTH_BASE    = { 3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                                                  31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static constexpr std::array<std::uint8_t, 29>  LENGTH_EXTRA   = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                                                  2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static constexpr std::array<std::uint16_t, 30> DISTANCE_BASE  = { 1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,    65,    97,    129,
+                                                                  193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static constexpr std::array<std::uint8_t, 30>  DISTANCE_EXTRA = { 0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                                                  6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+///
+/// \brief The order in which the code lengths of the code length alphabet are written.
+///
+static constexpr std::array<std::uint8_t, LENGTHS_COUNT> LENGTH_ORDER = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief A literal byte or a match, as found by the LZ77 pass.
+///
+struct token final
+{
+	std::uint16_t value;    ///< The literal byte, or the length of the match.
+	std::uint16_t distance; ///< The distance of the match, 0 for a literal.
+};
+
+///
+/// \brief A repetition of earlier bytes.
+///
+struct match final
+{
+	std::size_t length;   ///< Number of repeated bytes, 0 if there is no match.
+	std::size_t distance; ///< How far back the repeated bytes start.
+};
+
+///
+/// \brief A canonical Huffman code.
+///
+struct huffman_code final
+{
+	std::vector<std::uint8_t>  lengths; ///< The length of the code of each symbol, 0 if unused.
+	std::vector<std::uint16_t> codes;   ///< The code of each symbol, bit-reversed as DEFLATE writes it.
+};
+
+///
+/// \brief Writes bits least significant first, as DEFLATE packs them.
+///
+struct bit_writer final
+{
+	std::vector<std::uint8_t>& bytes; ///< The stream being written.
+	std::uint64_t              bits;  ///< The bits not yet written.
+	std::uint32_t              count; ///< Number of bits not yet written.
+};
+
+///
+/// \brief The hash chains of the positions seen so far.
+///
+struct hash_chains final
+{
+	std::vector<std::int32_t> heads;     ///< The latest position of each hash, -1 for none.
+	std::vector<std::int32_t> previous;  ///< The previous position with the same hash, by position modulo the window.
+};
+
+///
+/// \brief Reads bits least significant first, pulling the stream piece by piece.
+///
+struct bit_reader final
+{
+	const std::function<std::span<const std::uint8_t>()>& input; ///< Returns the next piece of the stream.
+	std::span<const std::uint8_t>                         piece; ///< The rest of the current piece.
+	std::uint64_t                                         bits;  ///< The bits read ahead, the ones past count being the next bytes of the piece.
+	std::uint32_t                                         count; ///< Number of bits read ahead.
+	bool                                                  ended; ///< Whether the stream has no more pieces.
+};
+
+///
+/// \brief A canonical Huffman code, as it is decoded.
+///
+struct huffman_table final
+{
+	std::array<std::uint16_t, std::size_t{ 1 } << FAST_BITS> fast;    ///< Symbol and length of the codes of up to FAST_BITS bits by their next bits, 0 otherwise.
+	std::array<std::uint16_t, MAX_CODE_LENGTH + 1>          counts;  ///< Number of codes of each length.
+	std::array<std::uint16_t, FIXED_LITERALS>               symbols; ///< The symbols, in the order of their codes.
+};
+
+///
+/// \brief The decompressed bytes, the last WINDOW_SIZE of which stay in reach of matches.
+///
+struct output_window final
+{
+	const std::function<void(std::span<const std::uint8_t>)>& output;   ///< Receives the bytes leaving the window.
+	std::vector<std::uint8_t>                                 bytes;    ///< The window, with room for a match past its end.
+	std::size_t                                               position; ///< Where the next byte goes.
+	std::size_t                                               flushed;  ///< Bytes already handed out.
+	std::uint64_t                                             total;    ///< Bytes decompressed so far.
+	std::uint32_t                                             checksum; ///< Adler-32 of the bytes handed out.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Hashes the 3 bytes starting a match.
+/// \param bytes: The first of the 3 bytes.
+/// \returns The hash.
+///
+static std::uint32_t hash_bytes(const std::uint8_t* bytes) noexcept;
+
+///
+/// \brief Adds a position to the hash chains.
+/// \param chains: The hash chains.
+/// \param bytes: The bytes being compressed.
+/// \param position: The position to be added.
+///
+static void insert(hash_chains&                  chains,
+                   std::span<const std::uint8_t> bytes,
+                   std::size_t                   position) noexcept;
+
+///
+/// \brief Finds the longest match of the bytes at a position.
+/// \param chains: The hash chains, not holding the position yet.
+/// \param bytes: The bytes being compressed.
+/// \param position: The position to be matched.
+/// \param chain_limit: The most candidates to be tried.
+/// \returns The longest match found, of length 0 if there is none worth encoding.
+///
+static match find_match(const hash_chains&            chains,
+                        std::span<const std::uint8_t> bytes,
+                        std::size_t                   position,
+                        std::size_t                   chain_limit) noexcept;
+
+///
+/// \brief Writes a block.
+/// \details It is written with its own Huffman codes, or stored if that is shorter.
+/// \param writer: The bit writer.
+/// \param tokens: The tokens of the block.
+/// \param bytes: The bytes the tokens encode.
+/// \param last: Whether this is the last block of the stream.
+///
+static void write_block(bit_writer&                   writer,
+                        std::span<const token>        tokens,
+                        std::span<const std::uint8_t> bytes,
+                        bool                          last);
+
+///
+/// \brief Writes bytes as stored blocks.
+/// \param writer: The bit writer.
+/// \param bytes: The bytes to be stored.
+/// \param last: Whether the last stored block is the last block of the stream.
+///
+static void write_stored(bit_writer&                   writer,
+                         std::span<const std::uint8_t> bytes,
+                         bool                          last);
+
+///
+/// \brief Builds a length-limited canonical Huffman code.
+/// \param frequencies: The number of occurrences of each symbol.
+/// \param limit: The longest code allowed.
+/// \returns The code.
+///
+static huffman_code build_code(std::span<const std::uint32_t> frequencies,
+                               std::uint8_t                   limit);
+
+///
+/// \brief Run-length encodes the code lengths of the literal/length and distance codes.
+/// \param lengths: The code lengths.
+/// \returns The code length symbols, each with the value of its extra bits.
+///
+static std::vector<std::pair<std::uint8_t, std::uint8_t>> encode_lengths(std::span<const std::uint8_t> lengths);
+
+///
+/// \brief Writes bits to the stream.
+/// \param writer: The bit writer.
+/// \param value: The bits, least significant first.
+/// \param count: Number of bits.
+///
+static void write_bits(bit_writer&   writer,
+                       std::uint32_t value,
+                       std::uint32_t count);
+
+///
+/// \brief Pads the stream with zero bits up to the next byte.
+/// \param writer: The bit writer.
+///
+static void align(bit_writer& writer);
+
+///
+/// \brief Reverses the order of the low bits of a code.
+/// \param code: The code.
+/// \param length: Number of bits of the code.
+/// \returns The reversed code.
+///
+static std::uint16_t reverse_bits(std::uint16_t code,
+                                  std::uint8_t  length) noexcept;
+
+///
+/// \brief Gets the index of the code of a match length.
+/// \param length: The length of the match.
+/// \returns The index, from 0 to 28.
+///
+static std::size_t get_length_code(std::size_t length) noexcept;
+
+///
+/// \brief Gets the index of the code of a match distance.
+/// \param distance: The distance of the match.
+/// \returns The index, from 0 to 29.
+///
+static std::size_t get_distance_code(std::size_t distance) noexcept;
+
+///
+/// \brief Reads ahead as many bits as fit, or as the stream has left.
+/// \param reader: The bit reader.
+///
+static void fill_bits(bit_reader& reader);
+
+///
+/// \brief Reads bits from the stream.
+/// \param reader: The bit reader.
+/// \param count: Number of bits, up to 32.
+/// \returns The bits, least significant first.
+/// \throws std::runtime_error if the stream ends first.
+///
+static std::uint32_t read_bits(bit_reader&   reader,
+                               std::uint32_t count);
+
+///
+/// \brief Builds the decoding table of a canonical Huffman code.
+/// \param lengths: The length of the code of each symbol, 0 if unused.
+/// \param table: The table.
+/// \throws std::runtime_error if the lengths use more codes than there are.
+///
+static void build_table(std::span<const std::uint8_t> lengths,
+                        huffman_table&                table);
+
+///
+/// \brief Decodes the next symbol of the stream.
+/// \param reader: The bit reader.
+/// \param table: The decoding table of the code.
+/// \returns The symbol.
+/// \throws std::runtime_error if the next bits are not a code or the stream ends first.
+///
+static std::uint16_t read_symbol(bit_reader&          reader,
+                                 const huffman_table& table);
+
+///
+/// \brief Reads the literal/length and distance codes of a dynamic block.
+/// \param reader: The bit reader.
+/// \param literals: The literal/length code.
+/// \param distances: The distance code.
+///
+static void read_dynamic_tables(bit_reader&    reader,
+                                huffman_table& literals,
+                                huffman_table& distances);
+
+///
+/// \brief Hands out the bytes decompressed since the last time, then slides the window.
+/// \param window: The output window.
+///
+static void flush_window(output_window& window);
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<std::uint8_t> zlib_compress(const std::span<const std::uint8_t> bytes)
+{
+	std::vector<std::uint8_t> stream      = { 0x78, 0x9C };
+	bit_writer                writer      = { stream, 0, 0 };
+	hash_chains               chains      = { std::vector<std::int32_t>(std::size_t{ 1 } << HASH_BITS, -1), std::vector<std::int32_t>(WINDOW_SIZE, -1) };
+	std::vector<token>        tokens      = {};
+	match                     pending     = { 0, 0 };
+	std::size_t               block_start = 0;
+	std::size_t               position    = 0;
+
+	assert(static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max()) >= bytes.size());
+
+	tokens.reserve(BLOCK_TOKENS);
+
+	while (position < bytes.size())
+	{
+		const match current = 0 != pending.length ? pending : find_match(chains, bytes, position, MAX_CHAIN);
+
+		pending = match{ 0, 0 };
+		insert(chains, bytes, position);
+
+		// Lazy matching: a longer match at the next byte is worth a literal.
+		if (MIN_MATCH <= current.length && LAZY_MATCH > current.length)
+		{
+			const match next = find_match(chains, bytes, position + 1, GOOD_MATCH > current.length ? MAX_CHAIN : MAX_CHAIN / 4);
+
+			if (next.length > current.length)
+			{
+				tokens.push_back(token{ bytes[position], 0 });
+				pending = next;
+				++position;
+			}
+		}
+
+		if (0 == pending.length)
+		{
+			if (MIN_MATCH <= current.length)
+			{
+				tokens.push_back(token{ static_cast<std::uint16_t>(current.length), static_cast<std::uint16_t>(current.distance) });
+
+				for (std::size_t index = 1; index < current.length; ++index)
+				{
+					insert(chains, bytes, position + index);
+				}
+
+				position += current.length;
+			}
+			else
+			{
+				tokens.push_back(token{ bytes[position], 0 });
+				++position;
+			}
+		}
+
+		if (BLOCK_TOKENS <= tokens.size())
+		{
+			write_block(writer, tokens, bytes.subspan(block_start, position - block_start), false);
+			tokens.clear();
+			block_start = position;
+		}
+	}
+
+	write_block(writer, tokens, bytes.subspan(block_start), true);
+	align(writer);
+
+	const std::uint32_t checksum = adler32(bytes);
+
+	for (std::size_t shift = 32; 0 != shift; shift -= 8)
+	{
+		stream.push_back(static_cast<std::uint8_t>(checksum >> (shift - 8)));
+	}
+
+	return stream;
+}
+
+void zlib_decompress(const std::function<std::span<const std::uint8_t>()>&       input,
+                     const std::function<void(std::span<const std::uint8_t>)>& output)
+{
+	bit_reader                     reader    = { input, {}, 0, 0, false };
+	output_window                  window    = { output, std::vector<std::uint8_t>(2 * WINDOW_SIZE + MAX_MATCH), 0, 0, 0, 1 };
+	std::unique_ptr<huffman_table> literals  = std::make_unique<huffman_table>();
+	std::unique_ptr<huffman_table> distances = std::make_unique<huffman_table>();
+	bool                           last      = false;
+
+	const std::uint32_t method = read_bits(reader, 8);
+	const std::uint32_t flags  = read_bits(reader, 8);
+
+	// Deflate with a window of up to 32 KiB, no preset dictionary and the header check.
+	if (8 != (method & 0x0F) || 7 < method >> 4 || 0 != (method << 8 | flags) % 31 || 0 != (flags & 0x20))
+	{
+		throw std::runtime_error{ std::format("zlib header 0x{:02X}{:02X} is not supported!", method, flags) };
+	}
+
+	while (!last)
+	{
+		last = 1 == read_bits(reader, 1);
+
+		const std::uint32_t type = read_bits(reader, 2);
+
+		if (0 == type)
+		{
+			static_cast<void>(read_bits(reader, reader.count % 8));
+
+			const std::uint32_t length = read_bits(reader, 16);
+
+			if ((length ^ 0xFFFF) != read_bits(reader, 16))
+			{
+				throw std::runtime_error{ "Stored block length does not match its complement!" };
+			}
+
+			for (std::uint32_t index = 0; index < length; ++index)
+			{
+				window.bytes[window.position++] = static_cast<std::uint8_t>(read_bits(reader, 8));
+
+				if (2 * WINDOW_SIZE <= window.position)
+				{
+					flush_window(window);
+				}
+			}
+
+			window.total += length;
+			continue;
+		}
+
+		if (1 == type)
+		{
+			std::array<std::uint8_t, FIXED_LITERALS>  literal_lengths  = {};
+			std::array<std::uint8_t, FIXED_DISTANCES> distance_lengths = {};
+
+			std::fill(literal_lengths.begin(), literal_lengths.begin() + 144, 8);
+			std::fill(literal_lengths.begin() + 144, literal_lengths.begin() + 256, 9);
+			std::fill(literal_lengths.begin() + 256, literal_lengths.begin() + 280, 7);
+			std::fill(literal_lengths.begin() + 280, literal_lengths.end(), 8);
+			distance_lengths.fill(5);
+
+			build_table(literal_lengths, *literals);
+			build_table(distance_lengths, *distances);
+		}
+		else if (2 == type)
+		{
+			read_dynamic_tables(reader, *literals, *distances);
+		}
+		else
+		{
+			throw std::runtime_error{ "Block type 3 is reserved!" };
+		}
+
+		while (true)
+		{
+			const std::uint16_t symbol = read_symbol(reader, *literals);
+
+			if (END_OF_BLOCK > symbol)
+			{
+				window.bytes[window.position++] = static_cast<std::uint8_t>(symbol);
+				++window.total;
+			}
+			else if (END_OF_BLOCK == symbol)
+			{
+				break;
+			}
+			else
+			{
+				const std::size_t length_code = symbol - END_OF_BLOCK - 1;
+
+				if (LENGTH_BASE.size() <= length_code)
+				{
+					throw std::runtime_error{ std::format("Length symbol {} is invalid!", symbol) };
+				}
+
+				const std::size_t   length        = LENGTH_BASE[length_code] + read_bits(reader, LENGTH_EXTRA[length_code]);
+				const std::uint16_t distance_code = read_symbol(reader, *distances);
+
+				if (DISTANCE_BASE.size() <= distance_code)
+				{
+					throw std::runtime_error{ std::format("Distance symbol {} is invalid!", distance_code) };
+				}
+
+				const std::size_t distance = DISTANCE_BASE[distance_code] + read_bits(reader, DISTANCE_EXTRA[distance_code]);
+
+				if (distance > window.total)
+				{
+					throw std::runtime_error{ std::format("Distance {} reaches before the start of the stream!", distance) };
+				}
+
+				std::uint8_t* const destination = window.bytes.data() + window.position;
+
+				// An overlapping match repeats its own bytes, so it is copied one byte at a time.
+				if (distance >= length)
+				{
+					std::memcpy(destination, destination - distance, length);
+				}
+				else
+				{
+					for (std::size_t index = 0; index < length; ++index)
+					{
+						destination[index] = destination[index - distance];
+					}
+				}
+
+				window.position += length;
+				window.total    += length;
+			}
+
+			if (2 * WINDOW_SIZE <= window.position)
+			{
+				flush_window(window);
+			}
+		}
+	}
+
+	flush_window(window);
+	static_cast<void>(read_bits(reader, reader.count % 8));
+
+	const std::uint32_t checksum = read_bits(reader, 8) << 24 | read_bits(reader, 8) << 16 | read_bits(reader, 8) << 8 | read_bits(reader, 8);
+
+	if (checksum != window.checksum)
+	{
+		throw std::runtime_error{ std::format("Adler-32 checksum 0x{:08X} does not match 0x{:08X}!", window.checksum, checksum) };
+	}
+}
+
+static std::uint32_t hash_bytes(const std::uint8_t* const bytes) noexcept
+{
+	const std::uint32_t value = static_cast<std::uint32_t>(bytes[0]) << 16 | static_cast<std::uint32_t>(bytes[1]) << 8 | bytes[2];
+
+	return (value * 2654435761U) >> (32 - HASH_BITS);
+}
+
+static void insert(hash_chains&                        chains,
+                   const std::span<const std::uint8_t> bytes,
+                   const std::size_t                   position) noexcept
+{
+	if (position + MIN_MATCH > bytes.size())
+	{
+		return;
+	}
+
+	std::int32_t& head = chains.heads[hash_bytes(bytes.data() + position)];
+
+	chains.previous[position % WINDOW_SIZE] = head;
+	head                                    = static_cast<std::int32_t>(position);
+}
+
+static match find_match(const hash_chains&                  chains,
+                        const std::span<const std::uint8_t> bytes,
+                        const std::size_t                   position,
+                        const std::size_t                   chain_limit) noexcept
+{
+	match best = { 0, 0 };
+
+	if (position + MIN_MATCH > bytes.size())
+	{
+		return best;
+	}
+
+	const std::size_t         limit     = std::min(MAX_MATCH, bytes.size() - position);
+	const std::uint8_t* const current   = bytes.data() + position;
+	std::int32_t              candidate = chains.heads[hash_bytes(current)];
+
+	for (std::size_t chain = 0; chain < chain_limit && 0 <= candidate && WINDOW_SIZE >= position - candidate; ++chain)
+	{
+		const std::uint8_t* const earlier = bytes.data() + candidate;
+		std::size_t               length  = 0;
+
+		// Cannot beat the best match unless the byte right after it matches too.
+		if (earlier[best.length] == current[best.length])
+		{
+			for (; length + sizeof(std::uint64_t) <= limit; length += sizeof(std::uint64_t))
+			{
+				std::uint64_t left  = 0;
+				std::uint64_t right = 0;
+
+				std::memcpy(&left, earlier + length, sizeof(left));
+				std::memcpy(&right, current + length, sizeof(right));
+
+				if (left != right)
+				{
+					length += static_cast<std::size_t>(std::countr_zero(left ^ right)) / 8;
+					break;
+				}
+			}
+
+			for (; length < limit && earlier[length] == current[length]; ++length)
+			{
+			}
+		}
+
+		if (length > best.length)
+		{
+			best = match{ length, position - candidate };
+
+			if (NICE_MATCH <= length || limit == length)
+			{
+				break;
+			}
+		}
+
+		const std::int32_t next = chains.previous[candidate % WINDOW_SIZE];
+
+		// The slot was reused by a newer position, the chain ends here.
+		if (next >= candidate)
+		{
+			break;
+		}
+
+		candidate = next;
+	}
+
+	if (MIN_MATCH > best.length || (MIN_MATCH == best.length && FAR_DISTANCE < best.distance))
+	{
+		return match{ 0, 0 };
+	}
+
+	return best;
+}
+
+static void write_block(bit_writer&                         writer,
+                        const std::span<const token>        tokens,
+                        const std::span<const std::uint8_t> bytes,
+                        const bool                          last)
+{
+	std::array<std::uint32_t, LITERALS_COUNT>  literal_frequencies  = {};
+	std::array<std::uint32_t, DISTANCES_COUNT> distance_frequencies = {};
+	std::array<std::uint32_t, LENGTHS_COUNT>   length_frequencies   = {};
+	std::vector<std::uint8_t>                  lengths              = {};
+	std::size_t                                literals_count       = LITERALS_COUNT;
+	std::size_t                                distances_count      = DISTANCES_COUNT;
+	std::size_t                                order_count          = LENGTHS_COUNT;
+	std::uint64_t                              bits                 = 3 + 5 + 5 + 4;
+
+	for (const token& token : tokens)
+	{
+		if (0 == token.distance)
+		{
+			++literal_frequencies[token.value];
+			continue;
+		}
+
+		++literal_frequencies[257 + get_length_code(token.value)];
+		++distance_frequencies[get_distance_code(token.distance)];
+	}
+
+	++literal_frequencies[END_OF_BLOCK];
+
+	// A block without matches still describes one distance code.
+	if (DISTANCES_COUNT == static_cast<std::size_t>(std::ranges::count(distance_frequencies, 0U)))
+	{
+		distance_frequencies[0] = 1;
+	}
+
+	const huffman_code literal_code  = build_code(literal_frequencies, MAX_CODE_LENGTH);
+	const huffman_code distance_code = build_code(distance_frequencies, MAX_CODE_LENGTH);
+
+	for (; 257 < literals_count && 0 == literal_code.lengths[literals_count - 1]; --literals_count)
+	{
+	}
+
+	for (; 1 < distances_count && 0 == distance_code.lengths[distances_count - 1]; --distances_count)
+	{
+	}
+
+	lengths.insert(lengths.end(), literal_code.lengths.begin(), literal_code.lengths.begin() + literals_count);
+	lengths.insert(lengths.end(), distance_code.lengths.begin(), distance_code.lengths.begin() + distances_count);
+
+	const std::vector<std::pair<std::uint8_t, std::uint8_t>> length_symbols = encode_lengths(lengths);
+
+	for (const auto& [symbol, extra] : length_symbols)
+	{
+		++length_frequencies[symbol];
+	}
+
+	const huffman_code length_code = build_code(length_frequencies, MAX_LENGTH_CODE_LENGTH);
+
+	for (; 4 < order_count && 0 == length_code.lengths[LENGTH_ORDER[order_count - 1]]; --order_count)
+	{
+	}
+
+	// Size of the block with Huffman codes, to be compared with storing it.
+	bits += 3 * order_count;
+
+	for (const auto& [symbol, extra] : length_symbols)
+	{
+		bits += length_code.lengths[symbol] + (16 == symbol ? 2 : 17 == symbol ? 3 : 18 == symbol ? 7 : 0);
+	}
+
+	for (std::size_t symbol = 0; symbol < LITERALS_COUNT; ++symbol)
+	{
+		bits += static_cast<std::uint64_t>(literal_frequencies[symbol]) * (literal_code.lengths[symbol] + (257 <= symbol ? LENGTH_EXTRA[symbol - 257] : 0));
+	}
+
+	for (std::size_t symbol = 0; symbol < DISTANCES_COUNT; ++symbol)
+	{
+		bits += static_cast<std::uint64_t>(distance_frequencies[symbol]) * (distance_code.lengths[symbol] + DISTANCE_EXTRA[symbol]);
+	}
+
+	if ((bytes.size() + 5 * (bytes.size() / MAX_STORED + 1)) * 8 + 7 <= bits)
+	{
+		write_stored(writer, bytes, last);
+		return;
+	}
+
+	write_bits(writer, last ? 1 : 0, 1);
+	write_bits(writer, 2, 2);
+	write_bits(writer, static_cast<std::uint32_t>(literals_count - 257), 5);
+	write_bits(writer, static_cast<std::uint32_t>(distances_count - 1), 5);
+	write_bits(writer, static_cast<std::uint32_t>(order_count - 4), 4);
+
+	for (std::size_t index = 0; index < order_count; ++index)
+	{
+		write_bits(writer, length_code.lengths[LENGTH_ORDER[index]], 3);
+	}
+
+	for (const auto& [symbol, extra] : length_symbols)
+	{
+		write_bits(writer, length_code.codes[symbol], length_code.lengths[symbol]);
+
+		if (16 <= symbol)
+		{
+			write_bits(writer, extra, 16 == symbol ? 2 : 17 == symbol ? 3 : 7);
+		}
+	}
+
+	for (const token& token : tokens)
+	{
+		if (0 == token.distance)
+		{
+			write_bits(writer, literal_code.codes[token.value], literal_code.lengths[token.value]);
+			continue;
+		}
+
+		const std::size_t length_index   = get_length_code(token.value);
+		const std::size_t distance_index = get_distance_code(token.distance);
+
+		write_bits(writer, literal_code.codes[257 + length_index], literal_code.lengths[257 + length_index]);
+		write_bits(writer, token.value - LENGTH_BASE[length_index], LENGTH_EXTRA[length_index]);
+		write_bits(writer, distance_code.codes[distance_index], distance_code.lengths[distance_index]);
+		write_bits(writer, token.distance - DISTANCE_BASE[distance_index], DISTANCE_EXTRA[distance_index]);
+	}
+
+	write_bits(writer, literal_code.codes[END_OF_BLOCK], literal_code.lengths[END_OF_BLOCK]);
+}
+
+static void write_stored(bit_writer&                   writer,
+                         std::span<const std::uint8_t> bytes,
+                         const bool                    last)
+{
+	do
+	{
+		const std::span<const std::uint8_t> block = bytes.first(std::min(bytes.size(), MAX_STORED));
+		const std::uint16_t                 size  = static_cast<std::uint16_t>(block.size());
+
+		bytes = bytes.subspan(block.size());
+
+		write_bits(writer, last && bytes.empty() ? 1 : 0, 1);
+		write_bits(writer, 0, 2);
+		align(writer);
+		write_bits(writer, size, 16);
+		write_bits(writer, static_cast<std::uint16_t>(~size), 16);
+		writer.bytes.insert(writer.bytes.end(), block.begin(), block.end());
+	}
+	while (!bytes.empty());
+}
+
+static huffman_code build_code(const std::span<const std::uint32_t> frequencies,
+                               const std::uint8_t                   limit)
+{
+	std::vector<std::pair<std::uint32_t, std::uint16_t>> symbols      = {};
+	std::vector<std::uint32_t>                           depths       = {};
+	std::array<std::uint32_t, 33>                        counts       = {};
+	std::array<std::uint16_t, 16>                        next_codes   = {};
+	huffman_code                                         code         = { std::vector<std::uint8_t>(frequencies.size()), std::vector<std::uint16_t>(frequencies.size()) };
+	std::uint32_t                                        total        = 0;
+	std::uint16_t                                        next_code    = 0;
+
+	for (std::size_t symbol = 0; symbol < frequencies.size(); ++symbol)
+	{
+		if (0 != frequencies[symbol])
+		{
+			symbols.emplace_back(frequencies[symbol], static_cast<std::uint16_t>(symbol));
+		}
+	}
+
+	// A single symbol still needs a complete code, a second unused one is added.
+	if (1 == symbols.size())
+	{
+		symbols.emplace_back(0, 0 == symbols.front().second ? 1 : 0);
+	}
+
+	std::ranges::sort(symbols);
+
+	// In-place minimum redundancy code lengths (Moffat and Katajainen, 1995),
+	// the least frequent symbol getting the longest code.
+	depths.reserve(symbols.size());
+
+	for (const auto& [frequency, symbol] : symbols)
+	{
+		depths.push_back(frequency);
+	}
+
+	if (2 <= depths.size())
+	{
+		const std::int64_t size = static_cast<std::int64_t>(depths.size());
+		std::int64_t       root = 0;
+		std::int64_t       leaf = 2;
+
+		depths[0] += depths[1];
+
+		for (std::int64_t next = 1; next < size - 1; ++next)
+		{
+			if (leaf >= size || depths[root] < depths[leaf])
+			{
+				depths[next]   = depths[root];
+				depths[root++] = static_cast<std::uint32_t>(next);
+			}
+			else
+			{
+				depths[next] = depths[leaf++];
+			}
+
+			if (leaf >= size || (root < next && depths[root] < depths[leaf]))
+			{
+				depths[next]   += depths[root];
+				depths[root++]  = static_cast<std::uint32_t>(next);
+			}
+			else
+			{
+				depths[next] += depths[leaf++];
+			}
+		}
+
+		depths[size - 2] = 0;
+
+		for (std::int64_t next = size - 3; 0 <= next; --next)
+		{
+			depths[next] = depths[depths[next]] + 1;
+		}
+
+		std::int64_t available = 1;
+		std::int64_t used      = 0;
+		std::uint32_t depth    = 0;
+		std::int64_t next      = size - 1;
+
+		root = size - 2;
+
+		while (0 < available)
+		{
+			for (; 0 <= root && depths[root] == depth; --root)
+			{
+				++used;
+			}
+
+			for (; available > used; --available)
+			{
+				depths[next--] = depth;
+			}
+
+			available = 2 * used;
+			used      = 0;
+			++depth;
+		}
+
+		// Codes longer than the limit are shortened, then longer codes are made
+		// out of shorter ones until the code is complete again.
+		for (const std::uint32_t depth : depths)
+		{
+			++counts[std::min(depth, std::uint32_t{ limit })];
+		}
+
+		for (std::uint8_t length = limit; 0 < length; --length)
+		{
+			total += counts[length] << (limit - length);
+		}
+
+		for (; (std::uint32_t{ 1 } << limit) < total; --total)
+		{
+			--counts[limit];
+
+			for (std::uint8_t length = limit - 1; 0 < length; --length)
+			{
+				if (0 != counts[length])
+				{
+					--counts[length];
+					counts[length + 1] += 2;
+					break;
+				}
+			}
+		}
+
+		// The most frequent symbols get the shortest codes.
+		std::size_t index = symbols.size();
+
+		for (std::uint8_t length = 1; length <= limit; ++length)
+		{
+			for (std::uint32_t count = counts[length]; 0 < count; --count)
+			{
+				code.lengths[symbols[--index].second] = length;
+			}
+		}
+	}
+
+	std::ranges::fill(counts, 0);
+
+	for (const std::uint8_t length : code.lengths)
+	{
+		++counts[length];
+	}
+
+	counts[0] = 0;
+
+	for (std::uint8_t length = 1; length <= limit; ++length)
+	{
+		next_code          = static_cast<std::uint16_t>((next_code + counts[length - 1]) << 1);
+		next_codes[length] = next_code;
+	}
+
+	for (std::size_t symbol = 0; symbol < code.lengths.size(); ++symbol)
+	{
+		const std::uint8_t length = code.lengths[symbol];
+
+		if (0 != length)
+		{
+			code.codes[symbol] = reverse_bits(next_codes[length]++, length);
+		}
+	}
+
+	return code;
+}
+
+static std::vector<std::pair<std::uint8_t, std::uint8_t>> encode_lengths(const std::span<const std::uint8_t> lengths)
+{
+	std::vector<std::pair<std::uint8_t, std::uint8_t>> symbols = {};
+	std::size_t                                        index   = 0;
+
+	while (index < lengths.size())
+	{
+		const std::uint8_t length = lengths[index];
+		std::size_t        run    = 1;
+
+		for (; index + run < lengths.size() && lengths[index + run] == length; ++run)
+		{
+		}
+
+		index += run;
+
+		if (0 == length)
+		{
+			for (; 11 <= run; run -= std::min(run, std::size_t{ 138 }))
+			{
+				symbols.emplace_back(18, static_cast<std::uint8_t>(std::min(run, std::size_t{ 138 }) - 11));
+			}
+
+			if (3 <= run)
+			{
+				symbols.emplace_back(17, static_cast<std::uint8_t>(run - 3));
+				run = 0;
+			}
+		}
+		else
+		{
+			symbols.emplace_back(length, 0);
+
+			for (--run; 3 <= run; run -= std::min(run, std::size_t{ 6 }))
+			{
+				symbols.emplace_back(16, static_cast<std::uint8_t>(std::min(run, std::size_t{ 6 }) - 3));
+			}
+		}
+
+		for (; 0 < run; --run)
+		{
+			symbols.emplace_back(length, 0);
+		}
+	}
+
+	return symbols;
+}
+
+static void write_bits(bit_writer&         writer,
+                       const std::uint32_t value,
+                       const std::uint32_t count)
+{
+	writer.bits  |= static_cast<std::uint64_t>(value) << writer.count;
+	writer.count += count;
+
+	for (; 8 <= writer.count; writer.count -= 8)
+	{
+		writer.bytes.push_back(static_cast<std::uint8_t>(writer.bits));
+		writer.bits >>= 8;
+	}
+}
+
+static void align(bit_writer& writer)
+{
+	if (0 != writer.count)
+	{
+		write_bits(writer, 0, 8 - writer.count);
+	}
+}
+
+static std::uint16_t reverse_bits(std::uint16_t      code,
+                                  const std::uint8_t length) noexcept
+{
+	std::uint16_t reversed = 0;
+
+	for (std::uint8_t bit = 0; bit < length; ++bit)
+	{
+		reversed = static_cast<std::uint16_t>(reversed << 1 | (code & 1));
+		code   >>= 1;
+	}
+
+	return reversed;
+}
+
+static std::size_t get_length_code(const std::size_t length) noexcept
+{
+	assert(MIN_MATCH <= length && MAX_MATCH >= length);
+
+	if (MAX_MATCH == length)
+	{
+		return 28;
+	}
+
+	const std::size_t offset = length - MIN_MATCH;
+
+	if (8 > offset)
+	{
+		return offset;
+	}
+
+	// Groups of 4 codes, each group having one more extra bit.
+	const std::size_t extra = static_cast<std::size_t>(std::bit_width(offset)) - 3;
+
+	return 4 + 4 * extra + ((offset >> extra) & 3);
+}
+
+static std::size_t get_distance_code(const std::size_t distance) noexcept
+{
+	assert(1 <= distance && WINDOW_SIZE >= distance);
+
+	const std::size_t offset = distance - 1;
+
+	if (4 > offset)
+	{
+		return offset;
+	}
+
+	// Groups of 2 codes, each group having one more extra bit.
+	const std::size_t extra = static_cast<std::size_t>(std::bit_width(offset)) - 2;
+
+	return 2 * extra + 2 + ((offset >> extra) & 1);
+}
+
+static void fill_bits(bit_reader& reader)
+{
+	while (56 > reader.count)
+	{
+		if (reader.piece.empty())
+		{
+			if (reader.ended)
+			{
+				return;
+			}
+
+			reader.piece = reader.input();
+			reader.ended = reader.piece.empty();
+			continue;
+		}
+
+		// Loading the bytes past the ones taken is harmless, as the next load puts the same bits there.
+		if (sizeof(std::uint64_t) <= reader.piece.size())
+		{
+			const std::size_t bytes = (63 - reader.count) / 8;
+
+			reader.bits  |= load_little_endian<std::uint64_t>(reader.piece.data()) << reader.count;
+			reader.piece  = reader.piece.subspan(bytes);
+			reader.count += static_cast<std::uint32_t>(bytes * 8);
+			continue;
+		}
+
+		reader.bits  |= static_cast<std::uint64_t>(reader.piece[0]) << reader.count;
+		reader.piece  = reader.piece.subspan(1);
+		reader.count += 8;
+	}
+}
+
+static std::uint32_t read_bits(bit_reader&         reader,
+                               const std::uint32_t count)
+{
+	assert(32 >= count);
+
+	if (count > reader.count)
+	{
+		fill_bits(reader);
+
+		if (count > reader.count)
+		{
+			throw std::runtime_error{ "zlib stream is truncated!" };
+		}
+	}
+
+	const std::uint32_t bits = static_cast<std::uint32_t>(reader.bits & ((std::uint64_t{ 1 } << count) - 1));
+
+	reader.bits  >>= count;
+	reader.count  -= count;
+	return bits;
+}
+
+static void build_table(const std::span<const std::uint8_t> lengths,
+                        huffman_table&                      table)
+{
+	std::array<std::uint16_t, MAX_CODE_LENGTH + 2> offsets = {};
+	std::int32_t                                   left    = 1;
+	std::uint32_t                                  code    = 0;
+	std::size_t                                    index   = 0;
+
+	assert(table.symbols.size() >= lengths.size());
+
+	table.fast.fill(0);
+	table.counts.fill(0);
+
+	for (const std::uint8_t length : lengths)
+	{
+		++table.counts[length];
+	}
+
+	table.counts[0] = 0;
+
+	// An incomplete code is accepted, its unused codes failing once read.
+	for (std::size_t length = 1; length <= MAX_CODE_LENGTH; ++length)
+	{
+		left = left * 2 - table.counts[length];
+
+		if (0 > left)
+		{
+			throw std::runtime_error{ "Huffman code lengths are over-subscribed!" };
+		}
+
+		offsets[length + 1] = static_cast<std::uint16_t>(offsets[length] + table.counts[length]);
+	}
+
+	for (std::size_t symbol = 0; symbol < lengths.size(); ++symbol)
+	{
+		if (0 != lengths[symbol])
+		{
+			table.symbols[offsets[lengths[symbol]]++] = static_cast<std::uint16_t>(symbol);
+		}
+	}
+
+	// The short codes fill every entry their bits start, whatever the bits after them.
+	for (std::uint8_t length = 1; length <= FAST_BITS; ++length, code <<= 1)
+	{
+		for (std::uint16_t count = 0; count < table.counts[length]; ++count, ++code, ++index)
+		{
+			const std::uint16_t entry = static_cast<std::uint16_t>(table.symbols[index] << 4 | length);
+
+			for (std::size_t fill = reverse_bits(static_cast<std::uint16_t>(code), length); fill < table.fast.size(); fill += std::size_t{ 1 } << length)
+			{
+				table.fast[fill] = entry;
+			}
+		}
+	}
+}
+
+static std::uint16_t read_symbol(bit_reader&          reader,
+                                 const huffman_table& table)
+{
+	if (MAX_CODE_LENGTH > reader.count)
+	{
+		fill_bits(reader);
+	}
+
+	const std::uint16_t entry = table.fast[reader.bits & (table.fast.size() - 1)];
+
+	if (0 != entry)
+	{
+		static_cast<void>(read_bits(reader, entry & 0x0F));
+		return entry >> 4;
+	}
+
+	std::int32_t code  = 0;
+	std::int32_t first = 0;
+	std::int32_t index = 0;
+
+	// The longer codes are decoded one bit at a time, the canonical way.
+	for (std::uint32_t length = 1; length <= MAX_CODE_LENGTH && length <= reader.count; ++length)
+	{
+		code |= static_cast<std::int32_t>(reader.bits >> (length - 1) & 1);
+
+		if (code - first < table.counts[length])
+		{
+			static_cast<void>(read_bits(reader, length));
+			return table.symbols[static_cast<std::size_t>(index + code - first)];
+		}
+
+		index += table.counts[length];
+		first  = (first + table.counts[length]) << 1;
+		code <<= 1;
+	}
+
+	throw std::runtime_error{ MAX_CODE_LENGTH > reader.count ? "zlib stream is truncated!" : "Huffman code is invalid!" };
+}
+
+static void read_dynamic_tables(bit_reader&    reader,
+                                huffman_table& literals,
+                                huffman_table& distances)
+{
+	const std::size_t                                          literals_count  = read_bits(reader, 5) + END_OF_BLOCK + 1;
+	const std::size_t                                          distances_count = read_bits(reader, 5) + 1;
+	const std::size_t                                          lengths_count   = read_bits(reader, 4) + 4;
+	std::array<std::uint8_t, LENGTHS_COUNT>                    length_lengths  = {};
+	std::array<std::uint8_t, LITERALS_COUNT + DISTANCES_COUNT> lengths         = {};
+	std::size_t                                                index           = 0;
+
+	if (LITERALS_COUNT < literals_count || DISTANCES_COUNT < distances_count)
+	{
+		throw std::runtime_error{ std::format("Dynamic block of {} literal/length and {} distance codes is invalid!", literals_count, distances_count) };
+	}
+
+	for (std::size_t order = 0; order < lengths_count; ++order)
+	{
+		length_lengths[LENGTH_ORDER[order]] = static_cast<std::uint8_t>(read_bits(reader, 3));
+	}
+
+	build_table(length_lengths, literals);
+
+	while (index < literals_count + distances_count)
+	{
+		const std::uint16_t symbol = read_symbol(reader, literals);
+		std::uint8_t        value  = 0;
+		std::size_t         repeat = 0;
+
+		switch (symbol)
+		{
+			case 16:
+				if (0 == index)
+				{
+					throw std::runtime_error{ "Code lengths start with a repetition!" };
+				}
+
+				value  = lengths[index - 1];
+				repeat = 3 + read_bits(reader, 2);
+				break;
+			case 17:
+				repeat = 3 + read_bits(reader, 3);
+				break;
+			case 18:
+				repeat = 11 + read_bits(reader, 7);
+				break;
+			default:
+				value  = static_cast<std::uint8_t>(symbol);
+				repeat = 1;
+				break;
+		}
+
+		if (repeat > literals_count + distances_count - index)
+		{
+			throw std::runtime_error{ "Code lengths repeat past the last code!" };
+		}
+
+		std::fill_n(lengths.begin() + static_cast<std::ptrdiff_t>(index), repeat, value);
+		index += repeat;
+	}
+
+	if (0 == lengths[END_OF_BLOCK])
+	{
+		throw std::runtime_error{ "Dynamic block has no end of block code!" };
+	}
+
+	build_table(std::span<const std::uint8_t>{ lengths }.first(literals_count), literals);
+	build_table(std::span<const std::uint8_t>{ lengths }.subspan(literals_count, distances_count), distances);
+}
+
+static void flush_window(output_window& window)
+{
+	const std::span<const std::uint8_t> bytes = std::span<const std::uint8_t>{ window.bytes }.subspan(window.flushed, window.position - window.flushed);
+
+	window.checksum = adler32(bytes, window.checksum);
+	window.output(bytes);
+
+	if (WINDOW_SIZE < window.position)
+	{
+		std::memmove(window.bytes.data(), window.bytes.data() + window.position - WINDOW_SIZE, WINDOW_SIZE);
+		window.position = WINDOW_SIZE;
+	}
+
+	window.flushed = window.position;
+}
+
+} // namespace icon_changer
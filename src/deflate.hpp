@@ -0,0 +1,56 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DECLARATIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief Compresses bytes into a zlib stream (RFC 1950) of DEFLATE blocks (RFC 1951).
+/// \details Matches are found with hash chains and one step of lazy matching,
+/// then each block gets its own Huffman codes. Blocks that would not shrink are
+/// stored as they are.
+/// \param bytes: The bytes to be compressed.
+/// \returns The zlib stream.
+///
+extern std::vector<std::uint8_t> zlib_compress(std::span<const std::uint8_t> bytes);
+
+///
+/// \brief Decompresses a zlib stream (RFC 1950) as it comes in.
+/// \details The stream is pulled piece by piece (e.g. from the IDAT chunks of a
+/// PNG file) and the bytes are handed out once they leave a 64 KiB window, so
+/// neither the stream nor the bytes are ever held whole. The Adler-32 checksum
+/// is verified.
+/// \param input: Returns the next piece of the stream, empty past its end.
+/// \param output: Receives the decompressed bytes in order, it may throw to stop.
+/// \throws std::runtime_error if the stream is corrupt or truncated.
+///
+extern void zlib_decompress(const std::function<std::span<const std::uint8_t>()>&       input,
+                            const std::function<void(std::span<const std::uint8_t>)>& output);
+
+} // namespace icon_changer
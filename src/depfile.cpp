@@ -0,0 +1,88 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include "depfile.hpp"
+
+#include "utility.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief Appends a path to a depfile, escaping the characters Make and Ninja treat specially.
+/// \param output: The content of the depfile.
+/// \param path: The path.
+///
+static void append_path(std::string&     output,
+                        std::string_view path);
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+std::string format_depfile(const std::span<const depfile_rule> rules)
+{
+	std::string output = {};
+
+	for (const depfile_rule& rule : rules)
+	{
+		append_path(output, rule.target);
+		output += ':';
+
+		for (const std::string& input : rule.inputs)
+		{
+			output += ' ';
+			append_path(output, input);
+		}
+
+		output += '\n';
+	}
+
+	return output;
+}
+
+void write_depfile(const std::string_view              file_path,
+                   const std::span<const depfile_rule> rules)
+{
+	const std::string output = format_depfile(rules);
+
+	write_file(file_path, std::span{ reinterpret_cast<const std::uint8_t*>(output.data()), output.size() });
+}
+
+static void append_path(std::string&           output,
+                        const std::string_view path)
+{
+	for (const char character : path)
+	{
+		if (' ' == character || '#' == character)
+		{
+			output += '\\';
+		}
+		else if ('$' == character)
+		{
+			output += '$';
+		}
+
+		output += character;
+	}
+}
+
+} // namespace icon_changer
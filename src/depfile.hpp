@@ -0,0 +1,62 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief The inputs a build output depends on.
+///
+struct depfile_rule final
+{
+	std::string              target; ///< The path to the output, e.g. the executable.
+	std::vector<std::string> inputs; ///< The paths to the files it was built from.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DECLARATIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Formats rules as a depfile, as read by Make and Ninja.
+/// \details Every rule takes a line, "target: input...". Spaces and '#' are
+/// escaped with a backslash and '$' is doubled.
+/// \param rules: The rules.
+/// \returns The content of the depfile.
+///
+extern std::string format_depfile(std::span<const depfile_rule> rules);
+
+///
+/// \brief Writes a depfile, replacing it atomically.
+/// \param file_path: The path to the depfile.
+/// \param rules: The rules.
+///
+extern void write_depfile(std::string_view              file_path,
+                          std::span<const depfile_rule> rules);
+
+} // namespace icon_changer
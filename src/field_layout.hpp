@@ -0,0 +1,230 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief Describes how a structure is laid out in a file.
+/// \details Specializations derive from fields<> and list the members in file
+/// order. Structures without a layout are copied byte for byte.
+/// \tparam T: The structure.
+///
+template <typename T> struct layout;
+
+///
+/// \brief Gets the type of a member from a pointer to it.
+/// \tparam Member: The pointer to member type.
+///
+template <typename Member> struct member_type;
+
+///
+/// \brief Gets the type of a member from a pointer to it.
+/// \tparam Class: The structure.
+/// \tparam Type: The type of the member.
+///
+template <typename Class, typename Type> struct member_type<Type Class::*> final
+{
+	using type = Type; ///< The type of the member.
+};
+
+///
+/// \brief A structure described by a layout.
+///
+template <typename T> concept described = requires { layout<T>::SIZE; };
+
+///
+/// \brief The fields of a structure, stored back to back in little-endian byte order.
+/// \tparam Fields: Pointers to the integer members, in file order.
+///
+template <auto... Fields> struct fields
+{
+	///
+	/// \brief The size of the structure in the file, without padding.
+	///
+	static constexpr std::size_t SIZE = (sizeof(typename member_type<decltype(Fields)>::type) + ...);
+
+	///
+	/// \brief Reads the fields of a structure.
+	/// \param obj: The structure receiving the fields.
+	/// \param bytes: The SIZE bytes to read from.
+	///
+	template <typename T> static constexpr void read(T&                  obj,
+	                                                 const std::uint8_t* bytes) noexcept;
+
+	///
+	/// \brief Writes the fields of a structure.
+	/// \param obj: The structure to be written.
+	/// \param bytes: The SIZE bytes to write to.
+	///
+	template <typename T> static constexpr void write(const T&      obj,
+	                                                  std::uint8_t* bytes) noexcept;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTANTS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief The size of a structure or integer in a file.
+/// \tparam T: The structure or integer.
+///
+template <typename T> inline constexpr std::size_t WIRE_SIZE = sizeof(T);
+
+///
+/// \brief The size of a described structure in a file, without padding.
+/// \tparam T: The structure.
+///
+template <described T> inline constexpr std::size_t WIRE_SIZE<T> = layout<T>::SIZE;
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DECLARATIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Reads an integer in little-endian byte order.
+/// \param bytes: The bytes to read from.
+/// \returns The integer.
+///
+template <typename T> constexpr T load_little_endian(const std::uint8_t* bytes) noexcept;
+
+///
+/// \brief Writes an integer in little-endian byte order.
+/// \param value: The integer.
+/// \param bytes: The bytes to write to.
+///
+template <typename T> constexpr void store_little_endian(T             value,
+                                                         std::uint8_t* bytes) noexcept;
+
+///
+/// \brief Reads a structure or integer without checking bounds.
+/// \details Described structures and integers are read field by field,
+/// other structures are copied as they are.
+/// \param bytes: The WIRE_SIZE<T> bytes to read from.
+/// \returns The structure or integer.
+///
+template <typename T> constexpr T read_wire(const std::uint8_t* bytes) noexcept;
+
+///
+/// \brief Writes a structure or integer without checking bounds.
+/// \param obj: The structure or integer.
+/// \param bytes: The WIRE_SIZE<T> bytes to write to.
+///
+template <typename T> constexpr void write_wire(const T&      obj,
+                                                std::uint8_t* bytes) noexcept;
+
+////////////////////////////////////////////////////////////////////////////////
+// METHOD DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+template <auto... Fields> template <typename T> constexpr void fields<Fields...>::read(T&                        obj,
+                                                                                       const std::uint8_t* const bytes) noexcept
+{
+	std::size_t offset = 0;
+
+	((obj.*Fields = load_little_endian<typename member_type<decltype(Fields)>::type>(bytes + offset),
+	  offset += sizeof(typename member_type<decltype(Fields)>::type)),
+	 ...);
+}
+
+template <auto... Fields> template <typename T> constexpr void fields<Fields...>::write(const T&            obj,
+                                                                                        std::uint8_t* const bytes) noexcept
+{
+	std::size_t offset = 0;
+
+	((store_little_endian(obj.*Fields, bytes + offset), offset += sizeof(typename member_type<decltype(Fields)>::type)), ...);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename T> constexpr T load_little_endian(const std::uint8_t* const bytes) noexcept
+{
+	using unsigned_type = std::make_unsigned_t<T>;
+
+	unsigned_type value = 0;
+
+	// Compilers turn this into a single load on little-endian targets.
+	for (std::size_t index = 0; index < sizeof(T); ++index)
+	{
+		value |= static_cast<unsigned_type>(static_cast<unsigned_type>(bytes[index]) << (8 * index));
+	}
+
+	return static_cast<T>(value);
+}
+
+template <typename T> constexpr void store_little_endian(const T             value,
+                                                         std::uint8_t* const bytes) noexcept
+{
+	using unsigned_type = std::make_unsigned_t<T>;
+
+	for (std::size_t index = 0; index < sizeof(T); ++index)
+	{
+		bytes[index] = static_cast<std::uint8_t>(static_cast<unsigned_type>(value) >> (8 * index));
+	}
+}
+
+template <typename T> constexpr T read_wire(const std::uint8_t* const bytes) noexcept
+{
+	T obj = {};
+
+	if constexpr (described<T>)
+	{
+		layout<T>::read(obj, bytes);
+	}
+	else if constexpr (std::is_integral_v<T>)
+	{
+		obj = load_little_endian<T>(bytes);
+	}
+	else
+	{
+		std::memcpy(&obj, bytes, sizeof(obj));
+	}
+
+	return obj;
+}
+
+template <typename T> constexpr void write_wire(const T&            obj,
+                                                std::uint8_t* const bytes) noexcept
+{
+	if constexpr (described<T>)
+	{
+		layout<T>::write(obj, bytes);
+	}
+	else if constexpr (std::is_integral_v<T>)
+	{
+		store_little_endian(obj, bytes);
+	}
+	else
+	{
+		std::memcpy(bytes, &obj, sizeof(obj));
+	}
+}
+
+} // namespace icon_changer
@@ -0,0 +1,539 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include "hash.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <smmintrin.h>
+#include <wmmintrin.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTANTS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+static constexpr std::uint64_t PRIME_1 = 0x9E3779B185EBCA87ULL;
+static constexpr std::uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+static constexpr std::uint64_t PRIME_3 = 0x165667B19E3779F9ULL;
+static constexpr std::uint64_t PRIME_4 = 0x85EBCA77C2B2AE63ULL;
+static constexpr std::uint64_t PRIME_5 = 0x27D4EB2F165667C5ULL;
+
+///
+/// \brief The reflected CRC-32 polynomial.
+///
+static constexpr std::uint32_t CRC_POLYNOMIAL = 0xEDB88320;
+
+///
+/// \brief The modulo of the Adler-32 sums.
+///
+static constexpr std::uint32_t ADLER_BASE = 65521;
+
+///
+/// \brief Most bytes whose Adler-32 sums fit in 32 bits before the modulo is applied.
+///
+static constexpr std::size_t ADLER_BLOCK_SIZE = 5552;
+
+///
+/// \brief Size of the blocks SHA-256 compresses.
+///
+static constexpr std::size_t SHA256_BLOCK_SIZE = 64;
+
+///
+/// \brief The initial SHA-256 state, the fractional parts of the square roots of the first 8 primes.
+///
+static constexpr std::array<std::uint32_t, 8> SHA256_STATE = { 0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19 };
+
+///
+/// \brief The SHA-256 round constants, the fractional parts of the cube roots of the first 64 primes.
+///
+static constexpr std::array<std::uint32_t, 64> SHA256_ROUNDS = {
+	0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5, 0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74,
+	0x80DEB1FE, 0x9BDC06A7, 0xC19BF174, 0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA, 0x983E5152, 0xA831C66D,
+	0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967, 0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E,
+	0x92722C85, 0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070, 0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5,
+	0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3, 0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+};
+
+///
+/// \brief Tables processing 8 bytes of CRC-32 at a time (slicing-by-8).
+/// \details Table 0 is the classic byte-wise table, table N advances a byte by
+/// N more positions.
+///
+static constexpr std::array<std::array<std::uint32_t, 256>, 8> CRC_TABLES = []()
+{
+	std::array<std::array<std::uint32_t, 256>, 8> tables = {};
+
+	for (std::uint32_t index = 0; index < 256; ++index)
+	{
+		std::uint32_t crc = index;
+
+		for (std::size_t bit = 0; bit < 8; ++bit)
+		{
+			crc = 0 != (crc & 1) ? (crc >> 1) ^ CRC_POLYNOMIAL : crc >> 1;
+		}
+
+		tables[0][index] = crc;
+	}
+
+	for (std::size_t table = 1; table < tables.size(); ++table)
+	{
+		for (std::size_t index = 0; index < 256; ++index)
+		{
+			tables[table][index] = (tables[table - 1][index] >> 8) ^ tables[0][tables[table - 1][index] & 0xFF];
+		}
+	}
+
+	return tables;
+}();
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Reads a little-endian integer from a possibly unaligned address.
+/// \param bytes: The address to read from.
+/// \returns The integer read.
+///
+template <typename T> static T read(const std::uint8_t* bytes) noexcept;
+
+///
+/// \brief Mixes 8 bytes of input into an accumulator.
+/// \param accumulator: The accumulator.
+/// \param input: The input.
+/// \returns The new value of the accumulator.
+///
+static std::uint64_t accumulate(std::uint64_t accumulator,
+                                std::uint64_t input) noexcept;
+
+///
+/// \brief Merges one of the stripe accumulators into the hash.
+/// \param hash: The hash.
+/// \param accumulator: The accumulator.
+/// \returns The new value of the hash.
+///
+static std::uint64_t merge(std::uint64_t hash,
+                           std::uint64_t accumulator) noexcept;
+
+///
+/// \brief Compresses a block into the SHA-256 state.
+/// \param state: The state.
+/// \param block: The SHA256_BLOCK_SIZE bytes of the block.
+///
+static void sha256_block(std::array<std::uint32_t, 8>& state,
+                         const std::uint8_t*           block) noexcept;
+
+///
+/// \brief Updates a CRC-32 with tables.
+/// \param bytes: The bytes to be checked.
+/// \param crc: The inverted CRC of the preceding bytes.
+/// \returns The inverted CRC of the bytes.
+///
+static std::uint32_t crc32_tables(std::span<const std::uint8_t> bytes,
+                                  std::uint32_t                 crc) noexcept;
+
+#if defined(__x86_64__) || defined(__i386__)
+///
+/// \brief Updates a CRC-32 by folding 64 bytes at a time with carry-less multiplications.
+/// \see "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction", Intel, 2009.
+/// \param bytes: The bytes to be checked, at least 64 and a multiple of 16.
+/// \param crc: The inverted CRC of the preceding bytes.
+/// \returns The inverted CRC of the bytes.
+///
+__attribute__((target("pclmul,sse4.1"))) static std::uint32_t crc32_folding(std::span<const std::uint8_t> bytes,
+                                                                            std::uint32_t                 crc) noexcept;
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+std::uint64_t hash(const std::span<const std::uint8_t> bytes,
+                   const std::uint64_t                 seed) noexcept
+{
+	const std::uint8_t*       input = bytes.data();
+	const std::uint8_t* const end   = bytes.data() + bytes.size();
+	std::uint64_t             hash  = seed + PRIME_5;
+
+	if (32 <= bytes.size())
+	{
+		std::uint64_t accumulator_1 = seed + PRIME_1 + PRIME_2;
+		std::uint64_t accumulator_2 = seed + PRIME_2;
+		std::uint64_t accumulator_3 = seed;
+		std::uint64_t accumulator_4 = seed - PRIME_1;
+
+		// Four independent lanes, so that the multiplications are pipelined.
+		for (; 32 <= end - input; input += 32)
+		{
+			accumulator_1 = accumulate(accumulator_1, read<std::uint64_t>(input));
+			accumulator_2 = accumulate(accumulator_2, read<std::uint64_t>(input + 8));
+			accumulator_3 = accumulate(accumulator_3, read<std::uint64_t>(input + 16));
+			accumulator_4 = accumulate(accumulator_4, read<std::uint64_t>(input + 24));
+		}
+
+		hash = std::rotl(accumulator_1, 1) + std::rotl(accumulator_2, 7) + std::rotl(accumulator_3, 12) + std::rotl(accumulator_4, 18);
+		hash = merge(hash, accumulator_1);
+		hash = merge(hash, accumulator_2);
+		hash = merge(hash, accumulator_3);
+		hash = merge(hash, accumulator_4);
+	}
+
+	hash += bytes.size();
+
+	for (; 8 <= end - input; input += 8)
+	{
+		hash ^= accumulate(0, read<std::uint64_t>(input));
+		hash  = std::rotl(hash, 27) * PRIME_1 + PRIME_4;
+	}
+
+	if (4 <= end - input)
+	{
+		hash  ^= read<std::uint32_t>(input) * PRIME_1;
+		hash   = std::rotl(hash, 23) * PRIME_2 + PRIME_3;
+		input += 4;
+	}
+
+	for (; input < end; ++input)
+	{
+		hash ^= *input * PRIME_5;
+		hash  = std::rotl(hash, 11) * PRIME_1;
+	}
+
+	hash ^= hash >> 33;
+	hash *= PRIME_2;
+	hash ^= hash >> 29;
+	hash *= PRIME_3;
+	hash ^= hash >> 32;
+
+	return hash;
+}
+
+std::uint32_t crc32(std::span<const std::uint8_t> bytes,
+                    const std::uint32_t           crc) noexcept
+{
+	std::uint32_t inverted = ~crc;
+
+#if defined(__x86_64__) || defined(__i386__)
+	static const bool has_pclmul = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+
+	if (has_pclmul && 64 <= bytes.size())
+	{
+		const std::size_t size = bytes.size() & ~std::size_t{ 15 };
+
+		inverted = crc32_folding(bytes.first(size), inverted);
+		bytes    = bytes.subspan(size);
+	}
+#endif
+
+	return ~crc32_tables(bytes, inverted);
+}
+
+std::uint32_t adler32(std::span<const std::uint8_t> bytes,
+                      const std::uint32_t           adler) noexcept
+{
+	std::uint32_t sum_1 = adler & 0xFFFF;
+	std::uint32_t sum_2 = adler >> 16;
+
+	while (!bytes.empty())
+	{
+		const std::span<const std::uint8_t> block = bytes.first(std::min(bytes.size(), ADLER_BLOCK_SIZE));
+		std::size_t                         index = 0;
+
+#if defined(__SSE2__)
+		// Each byte adds its value to the first sum and its value times its distance from the end to the second one.
+		const __m128i weights_low  = _mm_setr_epi16(16, 15, 14, 13, 12, 11, 10, 9);
+		const __m128i weights_high = _mm_setr_epi16(8, 7, 6, 5, 4, 3, 2, 1);
+		__m128i       vector_1     = _mm_setzero_si128();
+		__m128i       vector_2     = _mm_setzero_si128();
+		__m128i       previous_1   = _mm_setzero_si128();
+		std::uint32_t lanes[4]     = {};
+
+		for (; index + 16 <= block.size(); index += 16)
+		{
+			const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block.data() + index));
+
+			previous_1 = _mm_add_epi32(previous_1, vector_1);
+			vector_1   = _mm_add_epi32(vector_1, _mm_sad_epu8(chunk, _mm_setzero_si128()));
+			vector_2   = _mm_add_epi32(vector_2, _mm_madd_epi16(_mm_unpacklo_epi8(chunk, _mm_setzero_si128()), weights_low));
+			vector_2   = _mm_add_epi32(vector_2, _mm_madd_epi16(_mm_unpackhi_epi8(chunk, _mm_setzero_si128()), weights_high));
+		}
+
+		vector_2 = _mm_add_epi32(vector_2, _mm_slli_epi32(previous_1, 4));
+
+		sum_2 += sum_1 * static_cast<std::uint32_t>(index);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), vector_1);
+		sum_1 += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), vector_2);
+		sum_2 += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+
+		for (; index < block.size(); ++index)
+		{
+			sum_1 += block[index];
+			sum_2 += sum_1;
+		}
+
+		sum_1 %= ADLER_BASE;
+		sum_2 %= ADLER_BASE;
+		bytes  = bytes.subspan(block.size());
+	}
+
+	return sum_2 << 16 | sum_1;
+}
+
+sha256_digest sha256(const std::span<const std::span<const std::uint8_t>> pieces) noexcept
+{
+	std::array<std::uint32_t, 8>                    state    = SHA256_STATE;
+	std::array<std::uint8_t, 2 * SHA256_BLOCK_SIZE> block    = {};
+	std::size_t                                     buffered = 0;
+	std::uint64_t                                   size     = 0;
+	sha256_digest                                   digest   = {};
+
+	for (const std::span<const std::uint8_t> piece : pieces)
+	{
+		const std::uint8_t*       input = piece.data();
+		const std::uint8_t* const end   = piece.data() + piece.size();
+
+		size += piece.size();
+
+		// Pieces need not be multiples of the block size, the remainder is kept for the next one.
+		if (0 != buffered)
+		{
+			const std::size_t count = std::min<std::size_t>(SHA256_BLOCK_SIZE - buffered, piece.size());
+
+			std::copy(input, input + count, block.data() + buffered);
+			buffered += count;
+			input    += count;
+
+			if (SHA256_BLOCK_SIZE != buffered)
+			{
+				continue;
+			}
+
+			sha256_block(state, block.data());
+			buffered = 0;
+		}
+
+		for (; SHA256_BLOCK_SIZE <= static_cast<std::size_t>(end - input); input += SHA256_BLOCK_SIZE)
+		{
+			sha256_block(state, input);
+		}
+
+		std::copy(input, end, block.data());
+		buffered = static_cast<std::size_t>(end - input);
+	}
+
+	// A 1 bit, zeros and the size in bits, spilling over to a second block if the size does not fit.
+	const std::size_t padded = buffered + 1 + sizeof(std::uint64_t) > SHA256_BLOCK_SIZE ? 2 * SHA256_BLOCK_SIZE : SHA256_BLOCK_SIZE;
+
+	std::fill(block.begin() + static_cast<std::ptrdiff_t>(buffered), block.end(), 0);
+	block[buffered] = 0x80;
+
+	for (std::size_t index = 0; index < sizeof(std::uint64_t); ++index)
+	{
+		block[padded - 1 - index] = static_cast<std::uint8_t>((size * 8) >> (index * 8));
+	}
+
+	for (std::size_t offset = 0; offset < padded; offset += SHA256_BLOCK_SIZE)
+	{
+		sha256_block(state, block.data() + offset);
+	}
+
+	for (std::size_t index = 0; index < state.size(); ++index)
+	{
+		const std::uint32_t word = std::byteswap(state[index]);
+
+		std::memcpy(digest.data() + index * sizeof(word), &word, sizeof(word));
+	}
+
+	return digest;
+}
+
+template <typename T> static T read(const std::uint8_t* const bytes) noexcept
+{
+	static_assert(std::endian::little == std::endian::native, "Only little-endian hosts are supported!");
+
+	T value = 0;
+
+	std::memcpy(&value, bytes, sizeof(value));
+	return value;
+}
+
+static std::uint64_t accumulate(std::uint64_t       accumulator,
+                                const std::uint64_t input) noexcept
+{
+	accumulator += input * PRIME_2;
+	accumulator  = std::rotl(accumulator, 31);
+
+	return accumulator * PRIME_1;
+}
+
+static std::uint64_t merge(const std::uint64_t hash,
+                           const std::uint64_t accumulator) noexcept
+{
+	return (hash ^ accumulate(0, accumulator)) * PRIME_1 + PRIME_4;
+}
+
+static void sha256_block(std::array<std::uint32_t, 8>& state,
+                         const std::uint8_t* const     block) noexcept
+{
+	std::array<std::uint32_t, SHA256_ROUNDS.size()> schedule = {};
+
+	for (std::size_t index = 0; index < 16; ++index)
+	{
+		schedule[index] = std::byteswap(read<std::uint32_t>(block + index * sizeof(std::uint32_t)));
+	}
+
+	for (std::size_t index = 16; index < schedule.size(); ++index)
+	{
+		const std::uint32_t sigma_0 = std::rotr(schedule[index - 15], 7) ^ std::rotr(schedule[index - 15], 18) ^ (schedule[index - 15] >> 3);
+		const std::uint32_t sigma_1 = std::rotr(schedule[index - 2], 17) ^ std::rotr(schedule[index - 2], 19) ^ (schedule[index - 2] >> 10);
+
+		schedule[index] = schedule[index - 16] + sigma_0 + schedule[index - 7] + sigma_1;
+	}
+
+	auto [a, b, c, d, e, f, g, h] = state;
+
+	for (std::size_t index = 0; index < SHA256_ROUNDS.size(); ++index)
+	{
+		const std::uint32_t sum_1     = std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25);
+		const std::uint32_t choice    = (e & f) ^ (~e & g);
+		const std::uint32_t temporary = h + sum_1 + choice + SHA256_ROUNDS[index] + schedule[index];
+		const std::uint32_t sum_0     = std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22);
+		const std::uint32_t majority  = (a & b) ^ (a & c) ^ (b & c);
+
+		h = g;
+		g = f;
+		f = e;
+		e = d + temporary;
+		d = c;
+		c = b;
+		b = a;
+		a = temporary + sum_0 + majority;
+	}
+
+	state = { state[0] + a, state[1] + b, state[2] + c, state[3] + d, state[4] + e, state[5] + f, state[6] + g, state[7] + h };
+}
+
+static std::uint32_t crc32_tables(const std::span<const std::uint8_t> bytes,
+                                  std::uint32_t                       crc) noexcept
+{
+	const std::uint8_t*       input = bytes.data();
+	const std::uint8_t* const end   = bytes.data() + bytes.size();
+
+	for (; 8 <= end - input; input += 8)
+	{
+		const std::uint32_t low  = read<std::uint32_t>(input) ^ crc;
+		const std::uint32_t high = read<std::uint32_t>(input + 4);
+
+		crc = CRC_TABLES[7][low & 0xFF] ^ CRC_TABLES[6][(low >> 8) & 0xFF] ^ CRC_TABLES[5][(low >> 16) & 0xFF] ^ CRC_TABLES[4][low >> 24]
+		    ^ CRC_TABLES[3][high & 0xFF] ^ CRC_TABLES[2][(high >> 8) & 0xFF] ^ CRC_TABLES[1][(high >> 16) & 0xFF] ^ CRC_TABLES[0][high >> 24];
+	}
+
+	for (; input < end; ++input)
+	{
+		crc = (crc >> 8) ^ CRC_TABLES[0][(crc ^ *input) & 0xFF];
+	}
+
+	return crc;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+__attribute__((target("pclmul,sse4.1"))) static std::uint32_t crc32_folding(std::span<const std::uint8_t> bytes,
+                                                                            const std::uint32_t           crc) noexcept
+{
+	// Powers of x modulo the polynomial, bit-reflected: x^(4*128+32) and x^(4*128-32), x^(128+32) and
+	// x^(128-32), x^64, then the Barrett reduction constants.
+	const __m128i k1_k2      = _mm_set_epi64x(0x01C6E41596, 0x0154442BD4);
+	const __m128i k3_k4      = _mm_set_epi64x(0x00CCAA009E, 0x01751997D0);
+	const __m128i k5         = _mm_set_epi64x(0, 0x0163CD6124);
+	const __m128i polynomial = _mm_set_epi64x(0x01F7011641, 0x01DB710641);
+	const __m128i low_mask   = _mm_setr_epi32(~0, 0, ~0, 0);
+	__m128i       fold[4]    = {};
+	__m128i       folded     = {};
+	__m128i       product    = {};
+
+	for (std::size_t index = 0; index < 4; ++index)
+	{
+		fold[index] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes.data() + index * 16));
+	}
+
+	fold[0] = _mm_xor_si128(fold[0], _mm_cvtsi32_si128(static_cast<std::int32_t>(crc)));
+	bytes   = bytes.subspan(64);
+
+	// Four independent 128-bit lanes, each folded 512 bits forward per iteration.
+	for (; 64 <= bytes.size(); bytes = bytes.subspan(64))
+	{
+		for (std::size_t index = 0; index < 4; ++index)
+		{
+			product     = _mm_clmulepi64_si128(fold[index], k1_k2, 0x00);
+			fold[index] = _mm_clmulepi64_si128(fold[index], k1_k2, 0x11);
+			fold[index] = _mm_xor_si128(_mm_xor_si128(fold[index], product),
+			                            _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes.data() + index * 16)));
+		}
+	}
+
+	folded = fold[0];
+
+	for (std::size_t index = 1; index < 4; ++index)
+	{
+		product = _mm_clmulepi64_si128(folded, k3_k4, 0x00);
+		folded  = _mm_clmulepi64_si128(folded, k3_k4, 0x11);
+		folded  = _mm_xor_si128(_mm_xor_si128(folded, product), fold[index]);
+	}
+
+	for (; 16 <= bytes.size(); bytes = bytes.subspan(16))
+	{
+		product = _mm_clmulepi64_si128(folded, k3_k4, 0x00);
+		folded  = _mm_clmulepi64_si128(folded, k3_k4, 0x11);
+		folded  = _mm_xor_si128(_mm_xor_si128(folded, product), _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes.data())));
+	}
+
+	// 128 bits down to 64, then to 32 with a Barrett reduction.
+	product = _mm_clmulepi64_si128(folded, k3_k4, 0x10);
+	folded  = _mm_xor_si128(_mm_srli_si128(folded, 8), product);
+
+	product = _mm_srli_si128(folded, 4);
+	folded  = _mm_clmulepi64_si128(_mm_and_si128(folded, low_mask), k5, 0x00);
+	folded  = _mm_xor_si128(folded, product);
+
+	product = _mm_clmulepi64_si128(_mm_and_si128(folded, low_mask), polynomial, 0x10);
+	product = _mm_clmulepi64_si128(_mm_and_si128(product, low_mask), polynomial, 0x00);
+	folded  = _mm_xor_si128(folded, product);
+
+	return static_cast<std::uint32_t>(_mm_extract_epi32(folded, 1));
+}
+
+#endif
+
+} // namespace icon_changer
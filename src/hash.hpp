@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief A SHA-256 digest.
+///
+using sha256_digest = std::array<std::uint8_t, 32>;
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DECLARATIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Computes the 64-bit xxHash (XXH64) of a byte buffer.
+/// \details It is not cryptographic, it identifies content whose origin is
+/// trusted (e.g. cache keys) at several GB/s.
+/// \param bytes: The bytes to be hashed.
+/// \param seed: The seed of the hash.
+/// \returns The hash of the bytes.
+///
+extern std::uint64_t hash(std::span<const std::uint8_t> bytes,
+                          std::uint64_t                 seed = 0) noexcept;
+
+///
+/// \brief Computes the SHA-256 (FIPS 180-4) digest of byte buffers, as if they
+/// were concatenated.
+/// \details It is cryptographic, it identifies content from untrusted origins
+/// (e.g. uploaded icons) where a collision would be crafted on purpose.
+/// \param pieces: The byte buffers, in order.
+/// \returns The digest of the bytes.
+///
+extern sha256_digest sha256(std::span<const std::span<const std::uint8_t>> pieces) noexcept;
+
+///
+/// \brief Computes the CRC-32 (ISO 3309, as used by PNG and zlib) of a byte buffer.
+/// \details Carry-less multiplication folds 64 bytes per iteration on CPUs
+/// supporting it, other CPUs use tables 8 bytes at a time.
+/// \param bytes: The bytes to be checked.
+/// \param crc: The CRC of the preceding bytes, to compute it in pieces.
+/// \returns The CRC of the bytes.
+///
+extern std::uint32_t crc32(std::span<const std::uint8_t> bytes,
+                           std::uint32_t                 crc = 0) noexcept;
+
+///
+/// \brief Computes the Adler-32 checksum (as used by zlib) of a byte buffer.
+/// \param bytes: The bytes to be checked.
+/// \param adler: The checksum of the preceding bytes, to compute it in pieces.
+/// \returns The checksum of the bytes.
+///
+extern std::uint32_t adler32(std::span<const std::uint8_t> bytes,
+                             std::uint32_t                 adler = 1) noexcept;
+
+} // namespace icon_changer
@@ -17,6 +17,13 @@
 
 #include "ico_file.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <numeric>
+
+#include "stats.hpp"
+
 ////////////////////////////////////////////////////////////////////////////////
 // METHOD DEFINITIONS
 ////////////////////////////////////////////////////////////////////////////////
@@ -24,16 +31,47 @@
 namespace icon_changer
 {
 
-ico_file::ico_file(const std::string_view file_path)
+ico_file::ico_file(const std::string_view           file_path,
+                   std::pmr::memory_resource* const resource)
+    : header_obj{}
+    , entries{ resource }
+    , arena{ resource }
+    , images{ resource }
+    , owned_source{ open_source(file_path) }
+    , source{ owned_source.get() }
+    , budget{ nullptr }
+    , loaded{ false }
+{
+	read_directory();
+}
+
+ico_file::ico_file(byte_source&                     source,
+                   std::pmr::memory_resource* const resource,
+                   memory_budget* const             budget)
     : header_obj{}
-    , entries{}
-    , images{}
+    , entries{ resource }
+    , arena{ resource }
+    , images{ resource }
+    , owned_source{}
+    , source{ &source }
+    , budget{ budget }
+    , loaded{ false }
 {
-	std::ifstream file = open_file(file_path);
+	read_directory();
+}
 
-	read_header(file);
-	read_entries(file);
-	read_images(file);
+ico_file::ico_file(const std::span<const std::uint8_t> file_data,
+                   std::pmr::memory_resource* const    resource)
+    : header_obj{}
+    , entries{ resource }
+    , arena{ resource }
+    , images{ resource }
+    , owned_source{}
+    , source{ nullptr }
+    , budget{ nullptr }
+    , loaded{ true }
+{
+	parse(file_data);
 }
 
 ico_file::header ico_file::get_header() const noexcept
@@ -41,49 +79,111 @@ ico_file::header ico_file::get_header() const noexcept
 	return header_obj;
 }
 
-std::vector<ico_file::entry>& ico_file::get_entries() noexcept
+std::pmr::vector<ico_file::entry>& ico_file::get_entries() noexcept
 {
 	return entries;
 }
 
-std::vector<std::vector<std::uint8_t>>& ico_file::get_images() noexcept
+void ico_file::load_images(const std::span<const std::size_t> indices)
 {
-	return images;
-}
+	const stats_timer timer = stats_timer{ stats_phase::read };
 
-std::vector<std::uint8_t> ico_file::read_image(std::ifstream&      file,
-                                               const std::uint32_t size)
-{
-	std::vector<std::uint8_t> image = {};
+	// A file parsed in memory already has every image.
+	if (nullptr == source)
+	{
+		return;
+	}
+
+	assert(!loaded);
+	loaded = true;
 
-	image.resize(size);
+	for (const std::size_t index : indices)
+	{
+		assert(index < entries.size());
+		validate_entry(entries[index]);
+	}
 
-	try
+	if (0 != source->get_size())
+	{
+		read_images_at(indices);
+	}
+	else
 	{
-		file.read(reinterpret_cast<char*>(image.data()), image.size());
+		read_images_until_end(indices);
 	}
-	catch (const std::exception& exception)
+}
+
+std::pmr::vector<std::span<const std::uint8_t>>& ico_file::get_images()
+{
+	if (!loaded)
 	{
-		throw std::runtime_error{ std::format("Failed to read {} bytes from ICO image!", image.size()) };
+		std::vector<std::size_t> indices = std::vector<std::size_t>(entries.size());
+
+		std::iota(indices.begin(), indices.end(), std::size_t{ 0 });
+		load_images(indices);
 	}
 
-	return image;
+	return images;
+}
+
+std::pmr::vector<std::uint8_t> ico_file::release_arena() noexcept
+{
+	return std::move(arena);
 }
 
-void ico_file::read_header(std::ifstream& file)
+void ico_file::parse(const std::span<const std::uint8_t> file_data)
 {
-	static constexpr std::uint16_t ICO_IMAGE_TYPE = 1;
-	static constexpr std::uint16_t CUR_IMAGE_TYPE = 2;
+	byte_cursor cursor = byte_cursor{ file_data };
+	stats_timer timer  = stats_timer{ stats_phase::parse };
+
+	read_header(cursor);
+	read_entries(cursor);
 
-	try
+	timer.next(stats_phase::read);
+	images.reserve(entries.size());
+
+	for (const entry& entry : entries)
 	{
-		file.read(reinterpret_cast<char*>(&header_obj), sizeof(header_obj));
+		validate_entry(entry);
+		images.push_back(get_image(entry, file_data.subspan(cursor.get_offset()), file_data.size()));
 	}
-	catch (const std::exception& exception)
+}
+
+void ico_file::read_directory()
+{
+	const stats_timer                           timer        = stats_timer{ stats_phase::parse };
+	std::array<std::uint8_t, WIRE_SIZE<header>> header_bytes = {};
+	std::pmr::vector<std::uint8_t>              entry_bytes  = std::pmr::vector<std::uint8_t>{ entries.get_allocator() };
+	byte_cursor<const std::uint8_t>             cursor       = byte_cursor<const std::uint8_t>{ std::span{ header_bytes }.first(source->read(header_bytes)) };
+
+	read_header(cursor);
+
+	// The entries are charged before they are allocated, their count being read from the file.
+	if (nullptr != budget)
 	{
-		throw std::runtime_error{ std::format("Failed to read {} bytes from ICO header!", sizeof(header_obj)) };
+		budget->charge(2 * static_cast<std::uint64_t>(header_obj.entries_count) * WIRE_SIZE<entry>, "ICO entries");
 	}
 
+	entry_bytes.resize(header_obj.entries_count * WIRE_SIZE<entry>);
+	entry_bytes.resize(source->read(entry_bytes));
+	cursor = byte_cursor<const std::uint8_t>{ entry_bytes };
+
+	read_entries(cursor);
+	images.resize(entries.size());
+	count_stat(stats_counter::bytes_read, header_bytes.size() + entry_bytes.size());
+}
+
+void ico_file::read_header(byte_cursor<const std::uint8_t>& cursor)
+{
+	header_obj = cursor.read<header>("ICO header");
+	validate_header();
+}
+
+void ico_file::validate_header() const
+{
+	static constexpr std::uint16_t ICO_IMAGE_TYPE = 1;
+	static constexpr std::uint16_t CUR_IMAGE_TYPE = 2;
+
 	if (0 != header_obj.reserved)
 	{
 		throw std::invalid_argument{ std::format("Header reserved bytes are 0x{:X}, expecting 0x{:X}!", header_obj.reserved, 0) };
@@ -105,37 +205,117 @@ void ico_file::read_header(std::ifstream& file)
 	}
 }
 
-void ico_file::read_entries(std::ifstream& file)
+void ico_file::read_entries(byte_cursor<const std::uint8_t>& cursor)
 {
+	byte_cursor<const std::uint8_t> entries_cursor = byte_cursor{ cursor.take(header_obj.entries_count * WIRE_SIZE<entry>, "ICO entry") };
+
 	entries.resize(header_obj.entries_count);
 
-	try
+	for (entry& entry : entries)
 	{
-		file.read(reinterpret_cast<char*>(entries.data()), entries.size() * sizeof(entry));
-	}
-	catch (const std::exception& exception)
-	{
-		throw std::runtime_error{ std::format("Failed to read {} bytes from ICO entry!", entries.size() * sizeof(entry)) };
+		entry = entries_cursor.read<ico_file::entry>("ICO entry");
 	}
 }
 
-void ico_file::read_images(std::ifstream& file)
+void ico_file::read_images_at(const std::span<const std::size_t> indices)
 {
-	std::vector<std::uint8_t> image = {};
+	std::vector<std::size_t> order  = { indices.begin(), indices.end() };
+	std::uint64_t            size   = 0;
+	std::size_t              offset = 0;
 
-	for (const entry& entry : entries)
+	// Checked and sized before anything is read, the offsets and sizes being untrusted.
+	for (const std::size_t index : order)
 	{
-		if (0 != entry.reserved)
-		{
-			throw std::invalid_argument{ std::format("Entry's reserved byte is 0x{:X}, excepting 0x{:X}!", entry.reserved, 0) };
-		}
+		static_cast<void>(get_image(entries[index], {}, source->get_size()));
+		size += entries[index].image_size;
+	}
+
+	if (nullptr != budget)
+	{
+		budget->charge(size, "ICO images");
+	}
+
+	arena.resize(static_cast<std::size_t>(size));
+
+	// In file order, so that the kernel reads ahead what comes next.
+	std::ranges::sort(order, {}, [this](const std::size_t index)
+	{
+		return entries[index].image_offset;
+	});
 
-		if (0 != entry.planes && 1 != entry.planes)
+	for (const std::size_t index : order)
+	{
+		const std::span<std::uint8_t> image = std::span{ arena }.subspan(offset, entries[index].image_size);
+
+		source->seek(entries[index].image_offset);
+
+		// The file may have been truncated since its size was taken.
+		if (source->read(image) != image.size())
 		{
-			throw std::invalid_argument{ std::format("Entry's color planes is 0x{:X}, expecting 0x{:X} or 0x{:X}!", entry.planes, 0, 1) };
+			throw std::runtime_error{ std::format("Failed to read {} bytes from ICO image!", image.size()) };
 		}
 
-		images.push_back(read_image(file, entry.image_size));
+		images[index] = image;
+		offset += image.size();
+	}
+
+	count_stat(stats_counter::bytes_read, size);
+}
+
+void ico_file::read_images_until_end(const std::span<const std::size_t> indices)
+{
+	const std::size_t directory_size = get_directory_size();
+
+	read_all(*source, arena, budget);
+
+	for (const std::size_t index : indices)
+	{
+		images[index] = get_image(entries[index], arena, directory_size + arena.size());
+	}
+}
+
+std::span<const std::uint8_t> ico_file::get_image(const entry&                        entry,
+                                                  const std::span<const std::uint8_t> file_data,
+                                                  const std::uint64_t                 file_size) const
+{
+	const std::size_t directory_size = get_directory_size();
+
+	if (entry.image_offset < directory_size)
+	{
+		throw std::runtime_error{ std::format("ICO image at offset {} overlaps the {} bytes of the header and entries!", entry.image_offset,
+		                                      directory_size) };
+	}
+
+	if (entry.image_offset > file_size || entry.image_size > file_size - entry.image_offset)
+	{
+		throw std::runtime_error{ std::format("ICO image of {} bytes at offset {} does not fit in the {} bytes of the file!", entry.image_size,
+		                                      entry.image_offset, file_size) };
+	}
+
+	// Only the bounds are checked when the image is read later.
+	if (file_data.empty())
+	{
+		return {};
+	}
+
+	return file_data.subspan(entry.image_offset - directory_size, entry.image_size);
+}
+
+std::size_t ico_file::get_directory_size() const noexcept
+{
+	return WIRE_SIZE<header> + entries.size() * WIRE_SIZE<entry>;
+}
+
+void ico_file::validate_entry(const entry& entry)
+{
+	if (0 != entry.reserved)
+	{
+		throw std::invalid_argument{ std::format("Entry's reserved byte is 0x{:X}, excepting 0x{:X}!", entry.reserved, 0) };
+	}
+
+	if (0 != entry.planes && 1 != entry.planes)
+	{
+		throw std::invalid_argument{ std::format("Entry's color planes is 0x{:X}, expecting 0x{:X} or 0x{:X}!", entry.planes, 0, 1) };
 	}
 }
 
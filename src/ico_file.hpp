@@ -17,8 +17,13 @@
 // HEADER FILE INCLUDES
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <memory>
+#include <memory_resource>
+#include <span>
 #include <vector>
 
+#include "byte_source.hpp"
+#include "memory_budget.hpp"
 #include "utility.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -40,7 +45,7 @@ public:
 	/// \brief This data structure corresponds to ICONDIR.
 	/// \details It also corresponds to NEWHEADER, because it's the same.
 	///
-	struct PACKED header final
+	struct header final
 	{
 		std::uint16_t reserved;      ///< Reserved 2 bytes, must be 0.
 		std::uint16_t type;          ///< Image type: 1 - ICO, 2 - CUR, other values are invalid.
@@ -50,7 +55,7 @@ public:
 	///
 	/// \brief This data structure corresponds to ICONDIRENTRY.
 	///
-	struct PACKED entry final
+	struct entry final
 	{
 		std::uint8_t  width;        ///< Image width in pixels, 0 means 256.
 		std::uint8_t  height;       ///< Image height in pixels, 0 means 256.
@@ -64,10 +69,38 @@ public:
 
 public:
 	///
-	/// \brief Reads the header, entries and images of an ICO file.
+	/// \brief Reads the header and entries of an ICO file.
+	/// \details The images are read when they are requested, at the offsets
+	/// given by their entries.
 	/// \param file_path: Path to the ICO file.
+	/// \param resource: The memory resource to allocate from, it must outlive this object.
 	///
-	ico_file(std::string_view file_path);
+	ico_file(std::string_view           file_path,
+	         std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+	///
+	/// \brief Reads the header and entries of an ICO file from a byte source.
+	/// \details The images are read when they are requested: a file is read at
+	/// their offsets only, a source that cannot seek (e.g. a pipe) until its end.
+	/// \param source: The byte source (e.g. a file or the standard input), it
+	/// must outlive the loading of the images.
+	/// \param resource: The memory resource to allocate from, it must outlive this object.
+	/// \param budget: The budget the entries and images are charged to, nullptr
+	/// for none, it must outlive the loading of the images.
+	///
+	ico_file(byte_source&               source,
+	         std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+	         memory_budget*             budget   = nullptr);
+
+	///
+	/// \brief Parses the header, entries and images of an ICO file in memory.
+	/// \details No bytes are copied, the images are views into the given bytes
+	/// which must outlive this object.
+	/// \param file_data: The content of the ICO file (e.g. memory mapped).
+	/// \param resource: The memory resource to allocate from, it must outlive this object.
+	///
+	ico_file(std::span<const std::uint8_t> file_data,
+	         std::pmr::memory_resource*    resource = std::pmr::get_default_resource());
 
 	///
 	/// \brief Gets the ICO file header.
@@ -79,43 +112,96 @@ public:
 	/// \brief Gets the list of image directory entries.
 	/// \returns A reference to the directory entries.
 	///
-	std::vector<entry>& get_entries() noexcept;
+	std::pmr::vector<entry>& get_entries() noexcept;
+
+	///
+	/// \brief Loads the images of some entries, the other images not being read.
+	/// \details It can be called once, before the images are gotten. A file
+	/// parsed in memory already has every image.
+	/// \param indices: The distinct indices of the entries.
+	///
+	void load_images(std::span<const std::size_t> indices);
 
 	///
 	/// \brief Gets the raw image data for all icon images.
-	/// \returns A reference to the image byte buffers.
+	/// \details Every image is loaded, unless load_images() was called before.
+	/// \returns A reference to the views of the images, empty for the entries not loaded.
 	///
-	std::vector<std::vector<std::uint8_t>>& get_images() noexcept;
+	std::pmr::vector<std::span<const std::uint8_t>>& get_images();
+
+	///
+	/// \brief Releases the arena owning the images read from a byte source.
+	/// \details The image views stay valid as long as the arena lives.
+	/// \returns The arena, empty if the ICO file was parsed in memory.
+	///
+	[[nodiscard]] std::pmr::vector<std::uint8_t> release_arena() noexcept;
 
 private:
 	///
-	/// \brief Reads raw image bytes from the file stream.
-	/// \param file: The file to read from.
-	/// \param size: Number of bytes to read.
-	/// \returns The image data in binary format.
+	/// \brief Parses the header, entries and images of an ICO file in memory.
+	/// \param file_data: The content of the ICO file.
+	///
+	void parse(std::span<const std::uint8_t> file_data);
+
+	///
+	/// \brief Reads the header and entries of the ICO file from the byte source.
 	///
-	[[nodiscard]] static std::vector<std::uint8_t> read_image(std::ifstream& file,
-	                                                          std::uint32_t  size);
+	void read_directory();
 
 	///
 	/// \brief Reads the header of the ICO file and validates its content.
-	/// \param file: The file to read from.
+	/// \param cursor: The cursor at the beginning of the file.
+	///
+	void read_header(byte_cursor<const std::uint8_t>& cursor);
+
+	///
+	/// \brief Checks the content of the header.
 	///
-	void read_header(std::ifstream& file);
+	void validate_header() const;
 
 	///
-	/// \brief Reads the icon header and entries from the ICO file.
+	/// \brief Reads the icon entries from the ICO file.
 	/// \details The sanity check is not performed.
-	/// \param file: The file to read from.
+	/// \param cursor: The cursor following the header.
+	///
+	void read_entries(byte_cursor<const std::uint8_t>& cursor);
+
+	///
+	/// \brief Reads the images of some entries from a file, at their offsets.
+	/// \param indices: The indices of the entries.
 	///
-	void read_entries(std::ifstream& file);
+	void read_images_at(std::span<const std::size_t> indices);
 
 	///
-	/// \brief Reads the image data for each entry in the ICO file.
-	/// \details It also checks the integrity of the metadata.
-	/// \param file: The file to read from.
+	/// \brief Reads the rest of a source that cannot seek and makes views of the
+	/// images of some entries into it.
+	/// \param indices: The indices of the entries.
 	///
-	void read_images(std::ifstream& file);
+	void read_images_until_end(std::span<const std::size_t> indices);
+
+	///
+	/// \brief Makes the view of the image of an entry, checking that it lies in
+	/// the file after the header and entries.
+	/// \param entry: The entry.
+	/// \param file_data: The bytes following the entries.
+	/// \param file_size: The size of the whole file.
+	/// \returns The view.
+	///
+	std::span<const std::uint8_t> get_image(const entry&                  entry,
+	                                        std::span<const std::uint8_t> file_data,
+	                                        std::uint64_t                 file_size) const;
+
+	///
+	/// \brief Gets the size of the header and entries.
+	/// \returns The size in bytes.
+	///
+	std::size_t get_directory_size() const noexcept;
+
+	///
+	/// \brief Checks the integrity of an entry's metadata.
+	/// \param entry: The entry to be checked.
+	///
+	static void validate_entry(const entry& entry);
 
 private:
 	///
@@ -128,12 +214,55 @@ private:
 	/// \brief The metadata for each image in the ICO file.
 	/// \details Is actually stored as PE resource format.
 	///
-	std::vector<entry> entries;
+	std::pmr::vector<entry> entries;
+
+	///
+	/// \brief The arena owning the file read from a byte source.
+	/// \details The images are views into it.
+	///
+	std::pmr::vector<std::uint8_t> arena;
+
+	///
+	/// \brief The views of the image data for the ICO file.
+	///
+	std::pmr::vector<std::span<const std::uint8_t>> images;
+
+	///
+	/// \brief The byte source opened from a path, empty otherwise.
+	///
+	std::unique_ptr<byte_source> owned_source;
+
+	///
+	/// \brief The byte source the images are read from, nullptr if the file is in memory.
+	///
+	byte_source* source;
 
 	///
-	/// \brief The image data for the ICO file.
+	/// \brief The budget the entries and images are charged to, nullptr for none.
 	///
-	std::vector<std::vector<std::uint8_t>> images;
+	memory_budget* budget;
+
+	///
+	/// \brief Whether the images were loaded.
+	///
+	bool loaded;
+};
+
+///
+/// \brief The layout of ICONDIR in the file.
+///
+template <> struct layout<ico_file::header> final
+    : fields<&ico_file::header::reserved, &ico_file::header::type, &ico_file::header::entries_count>
+{
+};
+
+///
+/// \brief The layout of ICONDIRENTRY in the file.
+///
+template <> struct layout<ico_file::entry> final
+    : fields<&ico_file::entry::width, &ico_file::entry::height, &ico_file::entry::color_count, &ico_file::entry::reserved, &ico_file::entry::planes,
+             &ico_file::entry::bit_count, &ico_file::entry::image_size, &ico_file::entry::image_offset>
+{
 };
 
 } // namespace icon_changer
@@ -17,11 +17,23 @@
 
 #include "icon.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <filesystem>
 #include <format>
+#include <future>
+#include <limits>
+#include <unordered_map>
 
 #include "bmp_file.hpp"
+#include "hash.hpp"
+#include "pe_file.hpp"
+#include "pixel_kernels.hpp"
+#include "png_encoder.hpp"
+#include "png_file.hpp"
+#include "resampler.hpp"
+#include "stats.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
 // METHOD DEFINITIONS
@@ -30,47 +42,191 @@
 namespace icon_changer
 {
 
-icon::icon(const std::string_view file_path)
-    : header{}
-    , images{}
+icon::icon(const std::string_view           file_path,
+           const load_mode                  mode,
+           std::pmr::memory_resource* const resource)
+    : icon{ file_path, options{ .mode = mode }, resource }
 {
-	const std::string file_type = std::filesystem::path{ file_path }.extension().string();
+}
+
+icon::icon(const std::string_view           file_path,
+           const options&                   options,
+           std::pmr::memory_resource* const resource)
+    : mapping{}
+    , arena{ resource }
+    , encoded{ resource }
+    , header{ resource }
+    , images{ resource }
+    , compressions{ resource }
+    , deduplicated{}
+{
+	const source_kind            kind      = load_mode::sequential == options.mode ? source_kind::sequential : source_kind::whole_file;
+	std::unique_ptr<byte_source> source    = {};
+	std::string                  file_type = std::filesystem::path{ file_path }.extension().string();
+	memory_budget                budget    = memory_budget{ options.max_memory };
 
-	if (".ico" == file_type)
+	// The standard input cannot be mapped and has no extension, its format is told by its first bytes.
+	if (STDIN_PATH == file_path)
 	{
-		load_ico(file_path);
-		return;
+		source    = open_source(file_path);
+		file_type = get_file_type(source->peek(WIRE_SIZE<ico_file::header>));
+	}
+	else if (load_mode::mapped != options.mode && options.sizes.empty() && (".ico" == file_type || ".bmp" == file_type || ".png" == file_type))
+	{
+		source = open_source(file_path, kind);
 	}
 
-	if (".bmp" == file_type)
+	// Executables are mapped whatever the mode, only their icons being read.
+	const bool executable = ".exe" == file_type || ".dll" == file_type;
+
+	if (options.source_group.has_value() && !executable)
 	{
-		load_bmp(file_path);
-		return;
+		throw std::invalid_argument{ std::format("An icon group cannot be selected from file type \"{}\", expecting an executable!", file_type) };
+	}
+
+	if (!options.sizes.empty())
+	{
+		load_resampled(file_path, source.get(), file_type, options.sizes, budget);
+	}
+	else if (".ico" == file_type)
+	{
+		load_ico(file_path, source.get(), options, resource, budget);
+	}
+	else if (executable)
+	{
+		load_pe(file_path, source.get(), options, budget);
+	}
+	else if (!options.entry_sizes.empty() || !options.entry_depths.empty())
+	{
+		throw std::invalid_argument{ std::format("Entries cannot be selected from file type \"{}\", expecting an ICO file or an executable!", file_type) };
+	}
+	else if (".bmp" == file_type)
+	{
+		load_bmp(file_path, source.get(), resource, budget);
+	}
+	else if (".png" == file_type)
+	{
+		load_png(file_path, source.get(), resource, budget);
+	}
+	else
+	{
+		throw std::invalid_argument{ std::format("File type \"{}\" is not supported!", file_type) };
 	}
 
-	throw std::invalid_argument{ std::format("File type \"{}\" is not supported!", file_type) };
+	if (0 != options.png_min_size)
+	{
+		compress(options.png_min_size);
+	}
+
+	// Compressing first, so that the images are compared as they are stored.
+	deduplicate();
 }
 
-std::vector<std::uint8_t>& icon::get_header()
+icon::icon(mapped_file                                          mapping,
+           const std::span<const std::uint8_t>                  header,
+           const std::span<const std::span<const std::uint8_t>> images)
+    : mapping{ std::move(mapping) }
+    , arena{}
+    , encoded{}
+    , header{ header.begin(), header.end() }
+    , images{ images.begin(), images.end() }
+    , compressions{}
+    , deduplicated{}
+{
+}
+
+std::span<const std::uint8_t> icon::get_header() const noexcept
 {
 	return header;
 }
 
-std::vector<std::vector<std::uint8_t>>& icon::get_images() noexcept
+std::vector<std::uint8_t> icon::get_header(const std::span<const std::uint16_t> ids) const
+{
+	std::vector<std::uint8_t> renumbered = { header.begin(), header.end() };
+
+	assert(images.size() == ids.size());
+
+	for (std::size_t offset = WIRE_SIZE<ico_file::header>; offset + WIRE_SIZE<group_entry> <= renumbered.size(); offset += WIRE_SIZE<group_entry>)
+	{
+		group_entry entry = deserialize<group_entry>(renumbered, offset);
+
+		// The entries of a loaded icon refer to their images by position, from 1.
+		if (0 == entry.id || ids.size() < entry.id)
+		{
+			throw std::runtime_error{ std::format("Icon entry refers to image {} out of {}!", entry.id, ids.size()) };
+		}
+
+		entry.id = ids[entry.id - 1];
+		serialize(entry, renumbered, offset);
+	}
+
+	return renumbered;
+}
+
+std::vector<std::uint16_t> icon::get_image_ids(const std::span<const std::uint8_t> header)
+{
+	std::vector<std::uint16_t> ids = {};
+
+	for (std::size_t offset = WIRE_SIZE<ico_file::header>; offset + WIRE_SIZE<group_entry> <= header.size(); offset += WIRE_SIZE<group_entry>)
+	{
+		ids.push_back(deserialize<group_entry>(header, offset).id);
+	}
+
+	return ids;
+}
+
+std::span<const std::span<const std::uint8_t>> icon::get_images() const noexcept
 {
 	return images;
 }
 
-void icon::load_ico(const std::string_view file_path)
+std::span<const icon::compression> icon::get_compressions() const noexcept
+{
+	return compressions;
+}
+
+icon::deduplication icon::get_deduplication() const noexcept
+{
+	return deduplicated;
+}
+
+void icon::load_ico(const std::string_view           file_path,
+                    byte_source* const               source,
+                    const options&                   options,
+                    std::pmr::memory_resource* const resource,
+                    memory_budget&                   budget)
 {
-	ico_file                  ico_file = { file_path };
-	std::vector<std::uint8_t> bytes    = {};
-	std::uint16_t             id       = 0;
+	ico_file ico_file = nullptr == source ? icon_changer::ico_file{ map(file_path, budget), resource } : icon_changer::ico_file{ *source, resource, &budget };
 
-	header = serialize(ico_file.get_header());
+	const std::pmr::vector<ico_file::entry>& entries  = ico_file.get_entries();
+	std::vector<std::size_t>                 selected = {};
 
-	for (ico_file::entry entry : ico_file.get_entries())
+	for (std::size_t index = 0; index < entries.size(); ++index)
 	{
+		if (is_selected(entries[index], options))
+		{
+			selected.push_back(index);
+		}
+	}
+
+	if (selected.empty())
+	{
+		throw std::invalid_argument{ std::format("None of the {} entries of the icon has the selected sizes and bits per pixel!", entries.size()) };
+	}
+
+	// Loading the images validates their entries, the other images are not read.
+	ico_file.load_images(selected);
+	arena = ico_file.release_arena();
+
+	// Sized once, the header and entries are serialized in place.
+	header.resize(WIRE_SIZE<ico_file::header> + selected.size() * WIRE_SIZE<group_entry>);
+	serialize(ico_file::header{ ico_file.get_header().reserved, ico_file.get_header().type, static_cast<std::uint16_t>(selected.size()) }, header, 0);
+	images.reserve(selected.size());
+
+	for (std::size_t index = 0; index < selected.size(); ++index)
+	{
+		const ico_file::entry& entry = entries[selected[index]];
+
 		assert(0 == entry.reserved);
 		assert(0 == entry.planes || 1 == entry.planes);
 
@@ -82,86 +238,556 @@ void icon::load_ico(const std::string_view file_path)
 		LOG("bit_count: {}", entry.bit_count);
 		LOG("image_size: {}", entry.image_size);
 		LOG("image_offset: {}", entry.image_offset);
+		LOG("image_id: {}\n", index + 1);
 
-		entry.image_offset = ++id;
-		LOG("image_id: {}\n", *reinterpret_cast<std::uint16_t*>(&entry.image_offset));
+		// The IDs follow the kept entries, as set_images() expects from a loaded icon.
+		serialize(group_entry{ entry.width, entry.height, entry.color_count, entry.reserved, entry.planes, entry.bit_count,
+		                       entry.image_size, static_cast<std::uint16_t>(index + 1) },
+		          header, WIRE_SIZE<ico_file::header> + index * WIRE_SIZE<group_entry>);
 
-		bytes = serialize(entry);
-		header.insert(header.end(), bytes.begin(), bytes.end() - 2);
+		images.push_back(ico_file.get_images()[selected[index]]);
 	}
+}
+
+bool icon::is_selected(const ico_file::entry& entry,
+                       const options&         options) noexcept
+{
+	const std::uint16_t size = 0 == entry.width ? 256 : entry.width;
 
-	images = std::move(ico_file.get_images());
+	return (options.entry_sizes.empty() || options.entry_sizes.end() != std::ranges::find(options.entry_sizes, size))
+	    && (options.entry_depths.empty() || options.entry_depths.end() != std::ranges::find(options.entry_depths, entry.bit_count));
 }
 
-void icon::load_bmp(const std::string_view file_path)
+void icon::load_bmp(const std::string_view           file_path,
+                    byte_source* const               source,
+                    std::pmr::memory_resource* const resource,
+                    memory_budget&                   budget)
 {
-	bmp_file                  bmp_file = { file_path };
-	std::vector<std::uint8_t> bytes    = {};
+	const bmp_file             bitmap     = nullptr == source ? bmp_file{ map(file_path, budget) } : bmp_file{ *source, resource, &budget };
+	const bmp_file::dib_header dib_header = deserialize<bmp_file::dib_header>(bitmap.get_image(), 0);
+	const stats_timer          timer      = stats_timer{ stats_phase::convert };
+
+	// Larger images need to be resampled, see load_resampled().
+	if (256 < dib_header.width)
+	{
+		throw std::invalid_argument{ std::format("Width {} is larger than the 256 limit!", dib_header.width) };
+	}
+
+	if (256 < dib_header.height || -256 > dib_header.height)
+	{
+		throw std::invalid_argument{ std::format("Height {} is larger than the 256 limit!", dib_header.height) };
+	}
+
+	const bgra_image    decoded    = bitmap.decode(&budget);
+	const std::uint32_t image_size = get_dib_size(decoded.width, decoded.height);
+
+	header.resize(WIRE_SIZE<ico_file::header> + WIRE_SIZE<group_entry>);
+	serialize(ico_file::header{ 0, 1, 1 }, header, 0);
+	serialize(group_entry{ static_cast<std::uint8_t>(decoded.width), static_cast<std::uint8_t>(decoded.height), 0, 0, 1, 32, image_size, 1 }, header,
+	          WIRE_SIZE<ico_file::header>);
+
+	budget.charge(image_size, "Converted image");
+	arena.resize(image_size);
+	write_decoded_image(decoded, arena);
+
+	images.push_back(arena);
+}
+
+void icon::load_png(const std::string_view           file_path,
+                    byte_source* const               source,
+                    std::pmr::memory_resource* const resource,
+                    memory_budget&                   budget)
+{
+	png_file               png        = nullptr == source ? png_file{ map(file_path, budget) } : png_file{ *source, resource, &budget };
+	const png_file::header png_header = png.get_header();
+	const std::size_t      file_size  = png.get_file().size();
+
+	// Larger images need to be resampled, see load_resampled().
+	if (256 < png_header.width)
+	{
+		throw std::invalid_argument{ std::format("Width {} is larger than the 256 limit!", png_header.width) };
+	}
+
+	if (256 < png_header.height)
+	{
+		throw std::invalid_argument{ std::format("Height {} is larger than the 256 limit!", png_header.height) };
+	}
+
+	if (std::numeric_limits<std::uint32_t>::max() < file_size)
+	{
+		throw std::invalid_argument{ std::format("PNG file of {} bytes does not fit in an icon!", file_size) };
+	}
 
-	header = serialize(ico_file::header{ 0, 1, 1 });
+	// The sides are stored modulo 256, 0 standing for 256.
+	header.resize(WIRE_SIZE<ico_file::header> + WIRE_SIZE<group_entry>);
+	serialize(ico_file::header{ 0, 1, 1 }, header, 0);
+	serialize(group_entry{ static_cast<std::uint8_t>(png_header.width), static_cast<std::uint8_t>(png_header.height), 0, 0, 1, 32,
+	                       static_cast<std::uint32_t>(file_size), 1 },
+	          header, WIRE_SIZE<ico_file::header>);
 
-	bytes = serialize(dib_header_to_entry(bmp_file.get_image()));
-	header.insert(header.end(), bytes.begin(), bytes.end() - 2);
+	if (nullptr == source)
+	{
+		images.push_back(png.get_file());
+		return;
+	}
 
-	images.push_back(std::move(bmp_file.get_image()));
+	arena = png.release_buffer();
+	images.push_back(arena);
 }
 
-ico_file::entry icon::dib_header_to_entry(std::vector<std::uint8_t>& dib_image)
+void icon::load_pe(const std::string_view file_path,
+                   byte_source* const     source,
+                   const options&         options,
+                   memory_budget&         budget)
 {
-	static constexpr std::size_t   HEIGHT_OFFSET = sizeof(std::uint32_t) + sizeof(std::int32_t);
-	static constexpr std::uint32_t BI_RGB        = 0;
-	static constexpr std::uint16_t DEFAULT_ID    = 1;
+	std::span<const std::uint8_t> bytes = {};
+
+	// Only the headers, the resource directory and the images of the group are touched, so only the images are charged.
+	if (nullptr == source)
+	{
+		bytes = mapping.emplace(file_path).get_bytes();
+	}
+	else
+	{
+		read_all(*source, arena, &budget);
+		bytes = arena;
+	}
+
+	const pe_file                                 pe_file   = { file_path, bytes };
+	const resource_tree                           resources = pe_file.read_resources();
+	const resource_tree::type_map&                types     = resources.get_types();
+	const resource_tree::type_map::const_iterator groups    = types.find(RT_GROUP_ICON);
+	const resource_tree::type_map::const_iterator icons     = types.find(RT_ICON);
+	std::vector<group_entry>                      selected  = {};
+	std::uint64_t                                 size      = 0;
+
+	if (types.end() == groups || groups->second.empty())
+	{
+		throw std::invalid_argument{ std::format("\"{}\" does not have any icon group!", file_path) };
+	}
+
+	// The first group is the one Windows shows for the executable.
+	const resource_tree::name_map::const_iterator group = options.source_group.has_value() ? groups->second.find(*options.source_group) : groups->second.begin();
+
+	if (groups->second.end() == group)
+	{
+		throw std::invalid_argument{ std::format("\"{}\" does not have the icon group {}!", file_path, resource_tree::to_string(*options.source_group)) };
+	}
+
+	const auto& [language, resource]     = *group->second.begin();
+	const std::span<const std::uint8_t> group_header = resource.data;
+	const ico_file::header              icon_header  = deserialize<ico_file::header>(group_header, 0);
+
+	for (std::size_t index = 0; index < icon_header.entries_count; ++index)
+	{
+		const group_entry     entry     = deserialize<group_entry>(group_header, WIRE_SIZE<ico_file::header> + index * WIRE_SIZE<group_entry>);
+		const ico_file::entry ico_entry = { entry.width, entry.height, entry.color_count, entry.reserved, entry.planes, entry.bit_count, entry.image_size, 0 };
+
+		if (is_selected(ico_entry, options))
+		{
+			selected.push_back(entry);
+		}
+	}
+
+	if (selected.empty())
+	{
+		throw std::invalid_argument{ std::format("None of the {} entries of the icon group has the selected sizes and bits per pixel!", icon_header.entries_count) };
+	}
+
+	header.resize(WIRE_SIZE<ico_file::header> + selected.size() * WIRE_SIZE<group_entry>);
+	serialize(ico_file::header{ icon_header.reserved, icon_header.type, static_cast<std::uint16_t>(selected.size()) }, header, 0);
+	images.reserve(selected.size());
+
+	for (std::size_t index = 0; index < selected.size(); ++index)
+	{
+		group_entry entry = selected[index];
+
+		if (types.end() == icons || !icons->second.contains(entry.id) || icons->second.at(entry.id).empty())
+		{
+			throw std::invalid_argument{ std::format("Icon group {} refers to image {} which \"{}\" does not have!", resource_tree::to_string(group->first), entry.id, file_path) };
+		}
 
-	ico_file::entry      entry      = {};
+		const resource_tree::language_map& languages = icons->second.at(entry.id);
+		const std::span<const std::uint8_t> image    = (languages.contains(language) ? languages.at(language) : languages.begin()->second).data;
+
+		// The size is the one of the image, and the IDs follow the kept entries, as set_images() expects from a loaded icon.
+		entry.image_size = static_cast<std::uint32_t>(image.size());
+		entry.id         = static_cast<std::uint16_t>(index + 1);
+		serialize(entry, header, WIRE_SIZE<ico_file::header> + index * WIRE_SIZE<group_entry>);
+
+		images.push_back(image);
+		size += image.size();
+	}
+
+	budget.charge(size, std::format("Images of \"{}\"", file_path));
+}
+
+void icon::load_resampled(const std::string_view               file_path,
+                          byte_source* const                   source,
+                          const std::string_view               file_type,
+                          const std::span<const std::uint16_t> sizes,
+                          memory_budget&                       budget)
+{
+	std::vector<std::future<void>> workers = {};
+	std::size_t                    offset  = 0;
+
+	if (".bmp" != file_type && ".png" != file_type)
+	{
+		throw std::invalid_argument{ std::format("File type \"{}\" cannot be resampled, expecting a BMP or PNG file!", file_type) };
+	}
+
+	if (sizes.empty())
+	{
+		throw std::invalid_argument{ "No size to resample the image to!" };
+	}
+
+	for (std::size_t index = 0; index < sizes.size(); ++index)
+	{
+		if (0 == sizes[index] || 256 < sizes[index])
+		{
+			throw std::invalid_argument{ std::format("Size {} is not between 1 and 256!", sizes[index]) };
+		}
+
+		if (sizes.end() != std::find(sizes.begin() + index + 1, sizes.end(), sizes[index]))
+		{
+			throw std::invalid_argument{ std::format("Size {} is listed more than once!", sizes[index]) };
+		}
+	}
+
+	const bgra_image  decoded = decode(file_path, source, file_type, budget);
+	const stats_timer timer   = stats_timer{ stats_phase::convert };
+
+	header.resize(WIRE_SIZE<ico_file::header> + sizes.size() * WIRE_SIZE<group_entry>);
+	serialize(ico_file::header{ 0, 1, static_cast<std::uint16_t>(sizes.size()) }, header, 0);
+
+	for (std::size_t index = 0; index < sizes.size(); ++index)
+	{
+		const std::uint8_t side = static_cast<std::uint8_t>(sizes[index]);
+
+		serialize(group_entry{ side, side, 0, 0, 1, 32, get_dib_size(sizes[index], sizes[index]), static_cast<std::uint16_t>(index + 1) }, header,
+		          WIRE_SIZE<ico_file::header> + index * WIRE_SIZE<group_entry>);
+
+		offset += get_dib_size(sizes[index], sizes[index]);
+	}
+
+	// Sized once and zeroed, every worker fills in its own image.
+	budget.charge(offset, "Resampled images");
+	arena.resize(offset);
+	offset = 0;
+
+	for (const std::uint16_t size : sizes)
+	{
+		const std::span<std::uint8_t> image = std::span<std::uint8_t>{ arena }.subspan(offset, get_dib_size(size, size));
+
+		images.push_back(image);
+		offset += image.size();
+
+		workers.push_back(std::async(std::launch::async, [&decoded, size, image, record = stats_scope::get_current()]()
+		{
+			const stats_scope scope = stats_scope{ record };
+
+			write_resampled_image(decoded, size, image);
+		}));
+	}
+
+	for (std::future<void>& worker : workers)
+	{
+		worker.get();
+	}
+}
+
+bgra_image icon::decode(const std::string_view file_path,
+                        byte_source* const     source,
+                        const std::string_view file_type,
+                        memory_budget&         budget)
+{
+	if (".png" == file_type)
+	{
+		const png_file    png   = nullptr == source ? png_file{ map(file_path, budget) } : png_file{ *source, std::pmr::get_default_resource(), &budget };
+		const stats_timer timer = stats_timer{ stats_phase::convert };
+
+		return png.decode(&budget);
+	}
+
+	const bmp_file    bitmap = nullptr == source ? bmp_file{ map(file_path, budget) } : bmp_file{ *source, std::pmr::get_default_resource(), &budget };
+	const stats_timer timer  = stats_timer{ stats_phase::convert };
+
+	return bitmap.decode(&budget);
+}
+
+std::string icon::get_file_type(const std::span<const std::uint8_t> bytes)
+{
+	static constexpr std::array<std::uint8_t, 4> ICO_SIGNATURE = { 0x00, 0x00, 0x01, 0x00 };
+	static constexpr std::array<std::uint8_t, 2> BMP_SIGNATURE = { 'B', 'M' };
+	static constexpr std::array<std::uint8_t, 4> PNG_SIGNATURE = { 0x89, 'P', 'N', 'G' };
+	static constexpr std::array<std::uint8_t, 2> MZ_SIGNATURE  = { 'M', 'Z' };
+
+	if (bytes.size() >= ICO_SIGNATURE.size() && std::ranges::equal(bytes.first(ICO_SIGNATURE.size()), ICO_SIGNATURE))
+	{
+		return ".ico";
+	}
+
+	if (bytes.size() >= BMP_SIGNATURE.size() && std::ranges::equal(bytes.first(BMP_SIGNATURE.size()), BMP_SIGNATURE))
+	{
+		return ".bmp";
+	}
+
+	if (bytes.size() >= PNG_SIGNATURE.size() && std::ranges::equal(bytes.first(PNG_SIGNATURE.size()), PNG_SIGNATURE))
+	{
+		return ".png";
+	}
+
+	if (bytes.size() >= MZ_SIGNATURE.size() && std::ranges::equal(bytes.first(MZ_SIGNATURE.size()), MZ_SIGNATURE))
+	{
+		return ".exe";
+	}
+
+	throw std::invalid_argument{ "Input is neither an ICO, a BMP, a PNG nor an executable file!" };
+}
+
+void icon::write_resampled_image(const bgra_image&             source,
+                                 const std::uint16_t           size,
+                                 const std::span<std::uint8_t> image)
+{
+	write_dib_header(size, size, image);
+	resample(source, size, size, image.subspan(WIRE_SIZE<bmp_file::dib_header>, static_cast<std::size_t>(size) * size * 4));
+	write_and_mask(size, size, image);
+}
+
+void icon::write_decoded_image(const bgra_image&             source,
+                               const std::span<std::uint8_t> image)
+{
+	write_dib_header(source.width, source.height, image);
+
+	// The decoded rows are top-down, the ones of a DIB bottom-up.
+	get_pixel_kernels().flip_rows(source.pixels, image.subspan(WIRE_SIZE<bmp_file::dib_header>, source.pixels.size()),
+	                              static_cast<std::size_t>(source.width) * 4);
+
+	write_and_mask(source.width, source.height, image);
+}
+
+void icon::write_dib_header(const std::uint32_t           width,
+                            const std::uint32_t           height,
+                            const std::span<std::uint8_t> image)
+{
 	bmp_file::dib_header dib_header = {};
 
-	std::memcpy(&dib_header, dib_image.data(), sizeof(dib_header));
+	// The height of an icon image counts the XOR and AND masks.
+	dib_header.header_size = WIRE_SIZE<bmp_file::dib_header>;
+	dib_header.width       = static_cast<std::int32_t>(width);
+	dib_header.height      = static_cast<std::int32_t>(2 * height);
+	dib_header.planes      = 1;
+	dib_header.bit_count   = 32;
+	dib_header.image_size  = static_cast<std::uint32_t>(image.size() - WIRE_SIZE<bmp_file::dib_header>);
+	serialize(dib_header, image, 0);
+}
 
-	LOG("header_size: {}", dib_header.header_size);
-	LOG("width: {}", dib_header.width);
-	LOG("height: {}", dib_header.height);
-	LOG("planes: {}", dib_header.planes);
-	LOG("bit_count: {}", dib_header.bit_count);
-	LOG("compression_method: {}", dib_header.compression_method);
-	LOG("image_size: {}", dib_header.image_size);
-	LOG("horizontal_resolution: {}", dib_header.horizontal_resolution);
-	LOG("vertical_resolution: {}", dib_header.vertical_resolution);
-	LOG("color_count: {}", dib_header.color_count);
-	LOG("ignored: {}\n", dib_header.ignored);
+void icon::write_and_mask(const std::uint32_t           width,
+                          const std::uint32_t           height,
+                          const std::span<std::uint8_t> image)
+{
+	const pixel_kernels&                kernels     = get_pixel_kernels();
+	const std::size_t                   pixels_size = static_cast<std::size_t>(width) * height * 4;
+	const std::size_t                   mask_stride = align_up(static_cast<std::size_t>(width), std::size_t{ 32 }) / 8;
+	const std::span<const std::uint8_t> pixels      = image.subspan(WIRE_SIZE<bmp_file::dib_header>, pixels_size);
+	const std::span<std::uint8_t>       mask        = image.subspan(WIRE_SIZE<bmp_file::dib_header> + pixels_size);
+
+	// Renderers ignoring the alpha channel rely on the AND mask for transparency.
+	for (std::size_t y = 0; y < height; ++y)
+	{
+		kernels.pack_and_mask(pixels.subspan(y * width * 4, static_cast<std::size_t>(width) * 4), mask.subspan(y * mask_stride, mask_stride));
+	}
+}
 
-	if (sizeof(dib_header) != dib_header.header_size)
+std::uint32_t icon::get_dib_size(const std::uint32_t width,
+                                 const std::uint32_t height) noexcept
+{
+	const std::uint32_t mask_stride = align_up(width, std::uint32_t{ 32 }) / 8;
+
+	return WIRE_SIZE<bmp_file::dib_header> + width * height * 4 + mask_stride * height;
+}
+
+void icon::compress(const std::uint16_t min_size)
+{
+	const stats_timer                                   timer        = stats_timer{ stats_phase::convert };
+	std::vector<std::size_t>                            indexes      = {};
+	std::vector<std::future<std::vector<std::uint8_t>>> workers      = {};
+	std::vector<std::vector<std::uint8_t>>              pngs         = {};
+	std::size_t                                         encoded_size = 0;
+
+	for (std::size_t index = 0; index < images.size(); ++index)
 	{
-		throw std::invalid_argument{ std::format("BMP header is not BITMAPINFOHEADER! (size: {})", sizeof(dib_header.header_size)) };
+		const group_entry entry = deserialize<group_entry>(header, WIRE_SIZE<ico_file::header> + index * WIRE_SIZE<group_entry>);
+
+		if ((0 == entry.width ? 256 : entry.width) < min_size)
+		{
+			continue;
+		}
+
+		indexes.push_back(index);
+		workers.push_back(std::async(std::launch::async, [image = images[index], record = stats_scope::get_current()]()
+		{
+			const stats_scope scope = stats_scope{ record };
+
+			return encode_image(image);
+		}));
 	}
 
-	if (256 < dib_header.width)
+	for (std::size_t worker = 0; worker < workers.size(); ++worker)
 	{
-		throw std::invalid_argument{ std::format("Width {} is larger than the 256 limit!", dib_header.width) };
+		std::vector<std::uint8_t> png = workers[worker].get();
+
+		// Images that cannot be decoded, or would not shrink, are kept as they are.
+		if (png.empty() || png.size() >= images[indexes[worker]].size())
+		{
+			png.clear();
+		}
+
+		encoded_size += png.size();
+		pngs.push_back(std::move(png));
+	}
+
+	// Reserved once, so that the views into the arena stay valid while it is filled in.
+	encoded.reserve(encoded_size);
+
+	for (std::size_t worker = 0; worker < workers.size(); ++worker)
+	{
+		const std::size_t index  = indexes[worker];
+		const std::size_t offset = WIRE_SIZE<ico_file::header> + index * WIRE_SIZE<group_entry>;
+		group_entry       entry  = deserialize<group_entry>(header, offset);
+
+		if (pngs[worker].empty())
+		{
+			continue;
+		}
+
+		compressions.push_back(compression{ static_cast<std::uint16_t>(0 == entry.width ? 256 : entry.width),
+		                                    static_cast<std::uint16_t>(0 == entry.height ? 256 : entry.height), entry.image_size,
+		                                    static_cast<std::uint32_t>(pngs[worker].size()) });
+
+		entry.planes     = 1;
+		entry.bit_count  = 32;
+		entry.image_size = static_cast<std::uint32_t>(pngs[worker].size());
+		serialize(entry, header, offset);
+
+		images[index] = std::span<const std::uint8_t>{ encoded.data() + encoded.size(), pngs[worker].size() };
+		encoded.insert(encoded.end(), pngs[worker].begin(), pngs[worker].end());
 	}
+}
 
-	if (256 < dib_header.height)
+std::vector<std::uint8_t> icon::encode_image(const std::span<const std::uint8_t> image)
+{
+	static constexpr std::uint32_t BI_RGB = 0;
+
+	if (WIRE_SIZE<bmp_file::dib_header> > image.size())
 	{
-		throw std::invalid_argument{ std::format("Height {} is larger than the 256 limit!", dib_header.height) };
+		return {};
 	}
 
-	if (BI_RGB != dib_header.compression_method)
+	const bmp_file::dib_header dib_header = deserialize<bmp_file::dib_header>(image, 0);
+
+	// PNG images start with a signature instead of a DIB header.
+	if (WIRE_SIZE<bmp_file::dib_header> != dib_header.header_size || BI_RGB != dib_header.compression_method || (24 != dib_header.bit_count && 32 != dib_header.bit_count)
+	    || 0 >= dib_header.width || 256 < dib_header.width || 0 >= dib_header.height || 512 < dib_header.height)
 	{
-		throw std::invalid_argument{ std::format("{} compression method is not supported!", dib_header.compression_method) };
+		return {};
 	}
 
-	entry.width        = static_cast<std::uint8_t>(dib_header.width);
-	entry.height       = static_cast<std::uint8_t>(dib_header.height);
-	entry.color_count  = static_cast<std::uint8_t>(dib_header.color_count);
-	entry.reserved     = 0;
-	entry.planes       = dib_header.planes;
-	entry.bit_count    = dib_header.bit_count;
-	entry.image_size   = static_cast<std::uint32_t>(dib_image.size());
-	entry.image_offset = DEFAULT_ID;
+	const std::size_t bytes_per_pixel = dib_header.bit_count / 8;
+	const std::size_t width           = static_cast<std::size_t>(dib_header.width);
+	const std::size_t height          = static_cast<std::size_t>(dib_header.height) / 2;
+	const std::size_t stride          = align_up(width * dib_header.bit_count, std::size_t{ 32 }) / 8;
+	const std::size_t mask_stride     = align_up(width, std::size_t{ 32 }) / 8;
+	const std::size_t pixels_offset   = WIRE_SIZE<bmp_file::dib_header> + static_cast<std::size_t>(dib_header.color_count) * 4;
+	const std::size_t mask_offset     = pixels_offset + stride * height;
+	const bool        has_mask        = mask_offset + mask_stride * height <= image.size();
+	bool              has_alpha       = false;
+	bgra_image        decoded         = { static_cast<std::uint32_t>(width), static_cast<std::uint32_t>(height), std::vector<std::uint8_t>(width * height * 4) };
+
+	if (mask_offset > image.size())
+	{
+		return {};
+	}
+
+	for (std::size_t y = 0; y < height; ++y)
+	{
+		// DIB rows are stored bottom-up.
+		const std::uint8_t* const row         = image.data() + pixels_offset + (height - 1 - y) * stride;
+		std::uint8_t* const       destination = decoded.pixels.data() + y * width * 4;
+
+		for (std::size_t x = 0; x < width; ++x)
+		{
+			std::memcpy(destination + x * 4, row + x * bytes_per_pixel, 3);
+			destination[x * 4 + 3]  = 4 == bytes_per_pixel ? row[x * 4 + 3] : 0;
+			has_alpha              |= 0 != destination[x * 4 + 3];
+		}
+	}
+
+	for (std::size_t y = 0; !has_alpha && y < height; ++y)
+	{
+		const std::uint8_t* const mask = image.data() + mask_offset + (height - 1 - y) * mask_stride;
+
+		for (std::size_t x = 0; x < width; ++x)
+		{
+			const bool transparent = has_mask && 0 != (mask[x / 8] & (0x80 >> (x % 8)));
+
+			decoded.pixels[(y * width + x) * 4 + 3] = transparent ? 0 : 0xFF;
+		}
+	}
+
+	return encode_png(decoded);
+}
+
+void icon::deduplicate()
+{
+	std::unordered_multimap<std::uint64_t, std::size_t> unique_indexes = {};
+	std::pmr::vector<std::span<const std::uint8_t>>     unique_images  = std::pmr::vector<std::span<const std::uint8_t>>{ images.get_allocator() };
+
+	for (std::size_t index = 0; index < images.size(); ++index)
+	{
+		const std::size_t   offset    = WIRE_SIZE<ico_file::header> + index * WIRE_SIZE<group_entry>;
+		const std::uint64_t image_key = hash(images[index]);
+		group_entry         entry     = deserialize<group_entry>(header, offset);
+		std::size_t         unique    = unique_images.size();
+
+		// A hash match is only a candidate, the bytes are compared to rule out collisions.
+		for (auto [candidate, end] = unique_indexes.equal_range(image_key); candidate != end; ++candidate)
+		{
+			if (std::ranges::equal(unique_images[candidate->second], images[index]))
+			{
+				unique = candidate->second;
+				break;
+			}
+		}
+
+		if (unique_images.size() == unique)
+		{
+			unique_indexes.emplace(image_key, unique);
+			unique_images.push_back(images[index]);
+		}
+		else
+		{
+			++deduplicated.images_count;
+			deduplicated.saved_size += images[index].size();
+		}
+
+		// The RT_ICON resources are numbered from 1 in the order of the images.
+		entry.id = static_cast<std::uint16_t>(unique + 1);
+		serialize(entry, header, offset);
+	}
+
+	images = std::move(unique_images);
+}
+
+std::span<std::uint8_t> icon::map(const std::string_view file_path,
+                                  memory_budget&         budget)
+{
+	const std::span<std::uint8_t> bytes = mapping.emplace(file_path).get_bytes();
 
-	dib_header.height *= 2;
-	std::memcpy(dib_image.data() + HEIGHT_OFFSET, &dib_header.height, sizeof(dib_header.height));
+	// Mapping costs no memory until the pages are touched, which parsing and copying them does.
+	budget.charge(bytes.size(), std::format("\"{}\"", file_path));
 
-	return entry;
+	return bytes;
 }
 
 } // namespace icon_changer
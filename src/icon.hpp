@@ -17,10 +17,19 @@
 // HEADER FILE INCLUDES
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <array>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string>
 #include <string_view>
 #include <vector>
 
+#include "bgra_image.hpp"
+#include "byte_source.hpp"
 #include "ico_file.hpp"
+#include "mapped_file.hpp"
+#include "resource_tree.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
 // TYPE DEFINITIONS
@@ -30,64 +39,403 @@ namespace icon_changer
 {
 
 ///
-/// \brief Class to handle and manipulate icon (ICO, BMP) files.
+/// \brief Class to handle and manipulate icon (ICO, BMP, PNG) files.
 /// \details This class allows for reading, extracting metadata and images,
 /// as well as serializing the data back into PE resource format.
 ///
 class icon final
 {
 public:
+	///
+	/// \brief How the icon file is brought into memory.
+	///
+	enum class load_mode
+	{
+		stream,     ///< The file is read with a single read and images are views into the buffer.
+		sequential, ///< The file is read in chunks with readahead hints, for files not in the page cache.
+		mapped      ///< The file is memory mapped and images are views into the mapping.
+	};
+
+	///
+	/// \brief The sizes an image is resampled to when none are given.
+	///
+	static constexpr std::array<std::uint16_t, 7> DEFAULT_SIZES = { 16, 24, 32, 48, 64, 128, 256 };
+
+	///
+	/// \brief The memory an icon file may take by default, far above what an icon needs.
+	///
+	static constexpr std::uint64_t DEFAULT_MAX_MEMORY = 1024 * 1024 * 1024;
+
+	///
+	/// \brief How an icon is loaded and prepared.
+	///
+	struct options final
+	{
+		load_mode                                mode         = load_mode::stream;  ///< How the icon file is brought into memory.
+		std::vector<std::uint16_t>               sizes        = {};                 ///< The sizes a BMP or PNG file is resampled to, empty to embed it as is.
+		std::vector<std::uint16_t>               entry_sizes  = {};                 ///< The sizes of the ICO or executable entries kept, empty for all.
+		std::vector<std::uint16_t>               entry_depths = {};                 ///< The bits per pixel of the ICO or executable entries kept, empty for all.
+		std::uint16_t                            png_min_size = 0;                  ///< The width from which images are compressed as PNG, 0 for none.
+		std::uint64_t                            max_memory   = DEFAULT_MAX_MEMORY; ///< The bytes the file and its decoded images may take, the file being untrusted.
+		std::optional<resource_tree::identifier> source_group = {};                 ///< The icon group copied from an executable, empty for its first one.
+	};
+
+	///
+	/// \brief An image that was compressed as PNG.
+	///
+	struct compression final
+	{
+		std::uint16_t width;         ///< Image width in pixels.
+		std::uint16_t height;        ///< Image height in pixels.
+		std::uint32_t original_size; ///< Size of the DIB image in bytes.
+		std::uint32_t size;          ///< Size of the PNG image in bytes.
+	};
+
+	///
+	/// \brief The images that were shared by several entries.
+	///
+	struct deduplication final
+	{
+		std::uint16_t images_count; ///< Number of entries referring to an image of another entry.
+		std::uint64_t saved_size;   ///< Size of the images that are not stored twice in bytes.
+	};
+
+	///
+	/// \brief This data structure corresponds to GRPICONDIRENTRY.
+	///
+	struct group_entry final
+	{
+		std::uint8_t  width;       ///< Image width in pixels, 0 means 256.
+		std::uint8_t  height;      ///< Image height in pixels, 0 means 256.
+		std::uint8_t  color_count; ///< Number of colors in the color palette.
+		std::uint8_t  reserved;    ///< Reserved byte, must be 0.
+		std::uint16_t planes;      ///< Color planes, 0 or 1.
+		std::uint16_t bit_count;   ///< Bits per pixel.
+		std::uint32_t image_size;  ///< Image data size in bytes.
+		std::uint16_t id;          ///< The ID of the RT_ICON resource holding the image.
+	};
+
 	///
 	/// \brief Constructor to initialize icon object from a file.
 	/// \details Reads the ICO file, parses the header, entries, and images.
 	/// \param file_path: The path to the ICO file to be loaded.
+	/// \param mode: How the file is brought into memory.
+	/// \param resource: The memory resource the header, the image table and, in
+	/// stream mode, the image arena are allocated from. It must outlive this object.
+	///
+	icon(std::string_view           file_path,
+	     load_mode                  mode     = load_mode::stream,
+	     std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
 	///
-	icon(std::string_view file_path);
+	/// \brief Constructor to initialize icon object from a file, with options.
+	/// \details If sizes are given, the BMP or PNG file is resampled to every size
+	/// with an area filter, the sizes being computed in parallel. Each image is
+	/// then stored as a 32bpp DIB, with an AND mask covering its fully
+	/// transparent pixels. If a PNG size is given, the 24 and 32bpp images at
+	/// least that wide are compressed as PNG in parallel, each one only if it
+	/// gets smaller. Byte-identical images are stored once, their entries
+	/// referring to the same image. An icon group of an executable is copied
+	/// as it is, its images being views into the mapped executable.
+	/// \param file_path: The path to the ICO, BMP or PNG file or the executable
+	/// (EXE, DLL) to be loaded, STDIN_PATH to read it from the standard input
+	/// (e.g. a pipe), its format being detected.
+	/// \param options: How the icon is loaded and prepared.
+	/// \param resource: The memory resource the header, the image table and the
+	/// image arenas are allocated from. It must outlive this object.
+	///
+	icon(std::string_view           file_path,
+	     const options&             options,
+	     std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+	icon(const icon&)            = delete;
+	icon(icon&&)                 = default;
+	icon& operator=(const icon&) = delete;
+	icon& operator=(icon&&)      = delete;
 
 	///
 	/// \brief Gets the serialized header data for a PE icon resource.
 	/// \details It follows the NEWHEADER and RESDIR format.
-	/// \returns A vector of bytes representing the serialized header data.
+	/// \returns A view of the serialized header data.
+	///
+	std::span<const std::uint8_t> get_header() const noexcept;
+
+	///
+	/// \brief Copies the header with the images stored under other RT_ICON IDs.
+	/// \details Used when several icons share the RT_ICON IDs of an executable.
+	/// \param ids: The RT_ICON ID of every image, in the order of get_images().
+	/// \returns The header, every entry referring to the ID of its image.
 	///
-	std::vector<std::uint8_t>& get_header();
+	std::vector<std::uint8_t> get_header(std::span<const std::uint16_t> ids) const;
+
+	///
+	/// \brief Reads the RT_ICON IDs the entries of a group icon header refer to.
+	/// \details Entries beyond the end of the header are ignored.
+	/// \param header: The group icon header, e.g. of an RT_GROUP_ICON resource.
+	/// \returns The ID of every entry.
+	///
+	static std::vector<std::uint16_t> get_image_ids(std::span<const std::uint8_t> header);
 
 	///
 	/// \brief Gets a reference to the image data of the icon file.
-	/// \returns A vector of vectors of bytes, where each inner vector
-	/// represents the data for one image.
+	/// \returns The views of the images, one per image. The views are valid
+	/// as long as this object lives.
 	///
-	std::vector<std::vector<std::uint8_t>>& get_images() noexcept;
+	std::span<const std::span<const std::uint8_t>> get_images() const noexcept;
+
+	///
+	/// \brief Gets the images that were compressed as PNG.
+	/// \returns The compressed images, in the order of the icon entries.
+	///
+	std::span<const compression> get_compressions() const noexcept;
+
+	///
+	/// \brief Gets the images that were shared by several entries.
+	/// \returns The number of entries sharing an image and the bytes saved.
+	///
+	deduplication get_deduplication() const noexcept;
 
 private:
+	friend class icon_cache;
+
+	///
+	/// \brief Constructor to initialize icon object from a cache entry.
+	/// \param mapping: The mapping of the cache entry.
+	/// \param header: The group icon header.
+	/// \param images: The views of the images, inside the mapping.
+	///
+	icon(mapped_file                                    mapping,
+	     std::span<const std::uint8_t>                  header,
+	     std::span<const std::span<const std::uint8_t>> images);
+
 	///
 	/// \brief Loads an ICO file and prepares it for use as a PE icon resource.
+	/// \details Only the images of the selected entries are read, their IDs
+	/// following the order of the entries.
 	/// \param file_path: Path to the ICO file.
+	/// \param source: The byte source the file is read from, nullptr to map it.
+	/// \param options: The options selecting the entries.
+	/// \param resource: The memory resource to allocate from.
+	/// \param budget: The budget the file is charged to.
 	///
-	void load_ico(std::string_view file_path);
+	void load_ico(std::string_view           file_path,
+	              byte_source*               source,
+	              const options&             options,
+	              std::pmr::memory_resource* resource,
+	              memory_budget&             budget);
+
+	///
+	/// \brief Checks whether an ICO entry is selected by the options.
+	/// \param entry: The entry.
+	/// \param options: The options selecting the entries.
+	/// \returns true if the entry is kept, false otherwise.
+	///
+	static bool is_selected(const ico_file::entry& entry,
+	                        const options&         options) noexcept;
 
 	///
 	/// \brief Loads a BMP file and converts it into a single-entry ICO resource.
+	/// \details Whatever its bits per pixel, header version and row order, the
+	/// image is decoded and stored as a 32bpp DIB with its AND mask.
 	/// \param file_path: Path to the BMP file.
+	/// \param source: The byte source the file is read from, nullptr to map it.
+	/// \param resource: The memory resource to allocate from.
+	/// \param budget: The budget the file is charged to.
 	///
-	void load_bmp(std::string_view file_path);
+	void load_bmp(std::string_view           file_path,
+	              byte_source*               source,
+	              std::pmr::memory_resource* resource,
+	              memory_budget&             budget);
 
 	///
-	/// \brief Converts a DIB header into an ICO directory entry.
-	/// \param dib_image: Raw DIB image data.
-	/// \returns A populated ICO directory entry corresponding to the DIB.
+	/// \brief Loads a PNG file into a single-entry ICO resource.
+	/// \details The file is stored as it is, without being decoded, as Windows
+	/// Vista and later read PNG images inside icons.
+	/// \param file_path: Path to the PNG file.
+	/// \param source: The byte source the file is read from, nullptr to map it.
+	/// \param resource: The memory resource to allocate from.
+	/// \param budget: The budget the file is charged to.
 	///
-	ico_file::entry dib_header_to_entry(std::vector<std::uint8_t>& dib_image);
+	void load_png(std::string_view           file_path,
+	              byte_source*               source,
+	              std::pmr::memory_resource* resource,
+	              memory_budget&             budget);
+
+	///
+	/// \brief Copies an icon group of an executable (EXE, DLL).
+	/// \details The executable is mapped and only its headers, its resource
+	/// directory and the images of the group are read. The images are views into
+	/// the mapping, so nothing is copied until the target executable is written.
+	/// The image of an entry in the language of the group is preferred.
+	/// \param file_path: Path to the executable.
+	/// \param source: The byte source the file is read from, nullptr to map it.
+	/// \param options: The options selecting the group and its entries.
+	/// \param budget: The budget the images are charged to.
+	///
+	void load_pe(std::string_view file_path,
+	             byte_source*     source,
+	             const options&   options,
+	             memory_budget&   budget);
+
+	///
+	/// \brief Resamples a BMP or PNG file into one image per size.
+	/// \param file_path: Path to the BMP or PNG file.
+	/// \param source: The byte source the file is read from, nullptr to map it.
+	/// \param file_type: The extension of the file.
+	/// \param sizes: The sides of the square images.
+	/// \param budget: The budget the file and the decoded image are charged to.
+	///
+	void load_resampled(std::string_view               file_path,
+	                    byte_source*                   source,
+	                    std::string_view               file_type,
+	                    std::span<const std::uint16_t> sizes,
+	                    memory_budget&                 budget);
+
+	///
+	/// \brief Reads and decodes a BMP or PNG file.
+	/// \param file_path: Path to the file.
+	/// \param source: The byte source the file is read from, nullptr to map it.
+	/// \param file_type: The extension of the file, ".bmp" or ".png".
+	/// \param budget: The budget the file and the decoded image are charged to.
+	/// \returns The decoded image.
+	///
+	bgra_image decode(std::string_view file_path,
+	                  byte_source*     source,
+	                  std::string_view file_type,
+	                  memory_budget&   budget);
+
+	///
+	/// \brief Detects the format of a file from its first bytes.
+	/// \param bytes: The first bytes of the file.
+	/// \returns The extension of the format, ".ico", ".bmp", ".png" or ".exe".
+	///
+	static std::string get_file_type(std::span<const std::uint8_t> bytes);
+
+	///
+	/// \brief Writes a resampled image as a 32bpp DIB with its AND mask.
+	/// \param source: The decoded source image.
+	/// \param size: The side of the square image.
+	/// \param image: The zeroed buffer receiving the DIB, sized by get_dib_size().
+	///
+	static void write_resampled_image(const bgra_image&       source,
+	                                  std::uint16_t           size,
+	                                  std::span<std::uint8_t> image);
+
+	///
+	/// \brief Writes a decoded image as a 32bpp DIB with its AND mask.
+	/// \param source: The decoded image.
+	/// \param image: The zeroed buffer receiving the DIB, sized by get_dib_size().
+	///
+	static void write_decoded_image(const bgra_image&       source,
+	                                std::span<std::uint8_t> image);
+
+	///
+	/// \brief Writes the BITMAPINFOHEADER of a 32bpp icon image.
+	/// \param width: Width of the image in pixels.
+	/// \param height: Height of the image in pixels, without the AND mask.
+	/// \param image: The buffer receiving the DIB, sized by get_dib_size().
+	///
+	static void write_dib_header(std::uint32_t           width,
+	                             std::uint32_t           height,
+	                             std::span<std::uint8_t> image);
+
+	///
+	/// \brief Builds the AND mask of a 32bpp icon image from its alpha channel.
+	/// \param width: Width of the image in pixels.
+	/// \param height: Height of the image in pixels.
+	/// \param image: The DIB, its pixels written and its mask zeroed.
+	///
+	static void write_and_mask(std::uint32_t           width,
+	                           std::uint32_t           height,
+	                           std::span<std::uint8_t> image);
+
+	///
+	/// \brief Computes the size of a 32bpp icon image.
+	/// \param width: Width of the image in pixels.
+	/// \param height: Height of the image in pixels.
+	/// \returns The size of the DIB header, pixels and AND mask in bytes.
+	///
+	static std::uint32_t get_dib_size(std::uint32_t width,
+	                                  std::uint32_t height) noexcept;
+
+	///
+	/// \brief Compresses the large images as PNG.
+	/// \details Only 24 and 32bpp DIB images are compressed. The group entries
+	/// of the compressed images are updated in the header.
+	/// \param min_size: The width from which an image is compressed.
+	///
+	void compress(std::uint16_t min_size);
+
+	///
+	/// \brief Encodes a DIB image as PNG.
+	/// \details The alpha channel is taken from the AND mask if the image has
+	/// none or does not use it.
+	/// \param image: The DIB image, 24 or 32bpp, with its AND mask.
+	/// \returns The PNG image.
+	///
+	static std::vector<std::uint8_t> encode_image(std::span<const std::uint8_t> image);
+
+	///
+	/// \brief Stores byte-identical images once.
+	/// \details The images are hashed and the ones matching an earlier image
+	/// are dropped, the group entries being renumbered so that every entry
+	/// refers to the RT_ICON ID of the image it holds.
+	///
+	void deduplicate();
+
+	///
+	/// \brief Memory maps the icon file.
+	/// \param file_path: Path to the icon file.
+	/// \param budget: The budget the mapped bytes are charged to.
+	/// \returns The mapped bytes of the file.
+	///
+	std::span<std::uint8_t> map(std::string_view file_path,
+	                            memory_budget&   budget);
 
 private:
+	///
+	/// \brief The mapping of the icon file, only in mapped mode.
+	///
+	std::optional<mapped_file> mapping;
+
+	///
+	/// \brief The arena owning the image data back to back, in stream mode or once converted.
+	///
+	std::pmr::vector<std::uint8_t> arena;
+
+	///
+	/// \brief The arena owning the images compressed as PNG.
+	///
+	std::pmr::vector<std::uint8_t> encoded;
+
 	///
 	/// \brief The header of the ICO file for PE resource format.
 	///
-	std::vector<std::uint8_t> header;
+	std::pmr::vector<std::uint8_t> header;
+
+	///
+	/// \brief The views of the image data for the ICO file, into the arena or the mapping.
+	///
+	std::pmr::vector<std::span<const std::uint8_t>> images;
+
+	///
+	/// \brief The images that were compressed as PNG.
+	///
+	std::pmr::vector<compression> compressions;
 
 	///
-	/// \brief The image data for the ICO file.
+	/// \brief The images that were shared by several entries.
 	///
-	std::vector<std::vector<std::uint8_t>> images;
+	deduplication deduplicated;
+};
+
+///
+/// \brief The layout of GRPICONDIRENTRY in the resource.
+///
+template <> struct layout<icon::group_entry> final
+    : fields<&icon::group_entry::width, &icon::group_entry::height, &icon::group_entry::color_count, &icon::group_entry::reserved,
+             &icon::group_entry::planes, &icon::group_entry::bit_count, &icon::group_entry::image_size, &icon::group_entry::id>
+{
 };
 
 } // namespace icon_changer
@@ -0,0 +1,327 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include "icon_cache.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <limits>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "byte_source.hpp"
+#include "hash.hpp"
+#include "mapped_file.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTANTS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief Identifies a cache entry ("ICC1" in little-endian).
+///
+static constexpr std::uint32_t ENTRY_MAGIC = 0x31434349;
+
+///
+/// \brief Version of the entry layout, entries of other versions are rebuilt.
+///
+static constexpr std::uint32_t ENTRY_VERSION = 2;
+
+///
+/// \brief Extension of the cache entries.
+///
+static constexpr std::string_view ENTRY_EXTENSION = ".icc";
+
+///
+/// \brief Age after which a temporary file is considered abandoned.
+///
+static constexpr std::chrono::hours TEMPORARY_LIFETIME = std::chrono::hours{ 1 };
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Serializes the options changing the content of an icon.
+/// \details The mode does not change the icon, so it is left out.
+/// \param options: The options the icon is loaded with.
+/// \returns The key of the options, empty for the default options.
+///
+static std::vector<std::uint8_t> get_options_key(const icon::options& options);
+
+////////////////////////////////////////////////////////////////////////////////
+// METHOD DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+icon_cache::icon_cache(const std::string_view directory_path,
+                       const std::uint64_t    capacity)
+    : directory_path{ directory_path }
+    , capacity{ capacity }
+{
+	std::filesystem::create_directories(this->directory_path);
+}
+
+icon icon_cache::load(const std::string_view file_path,
+                      const icon::options&   options) const
+{
+	// The standard input can be read only once, it is not worth hashing.
+	if (STDIN_PATH == file_path)
+	{
+		return icon{ file_path, options };
+	}
+
+	const mapped_file                   source        = mapped_file{ file_path };
+	const std::span<const std::uint8_t> bytes         = source.get_bytes();
+	const std::vector<std::uint8_t>     options_key   = get_options_key(options);
+	const std::span<const std::uint8_t> pieces[]      = { bytes, options_key };
+	const std::uint64_t                 source_hash   = hash(bytes, options_key.empty() ? 0 : hash(options_key));
+	const sha256_digest                 source_digest = sha256(pieces);
+	const std::filesystem::path         entry_path    = get_entry_path(source_hash);
+	std::optional<icon>                 cached        = find(entry_path, source_hash, source_digest, bytes.size());
+	std::error_code                     error         = {};
+
+	if (cached.has_value())
+	{
+		// The modification time orders the entries for eviction.
+		std::filesystem::last_write_time(entry_path, std::filesystem::file_time_type::clock::now(), error);
+		LOG("Cache hit: {}", entry_path.string());
+
+		return std::move(cached.value());
+	}
+
+	icon icon = { file_path, options };
+
+	try
+	{
+		store(entry_path, source_hash, source_digest, bytes.size(), icon);
+		evict();
+	}
+	catch (const std::exception& exception)
+	{
+		LOG("Failed to cache \"{}\": {}", file_path, exception.what());
+	}
+
+	return icon;
+}
+
+std::filesystem::path icon_cache::get_entry_path(const std::uint64_t source_hash) const
+{
+	return directory_path / std::format("{:016x}{}", source_hash, ENTRY_EXTENSION);
+}
+
+std::optional<icon> icon_cache::find(const std::filesystem::path& entry_path,
+                                     const std::uint64_t          source_hash,
+                                     const sha256_digest&         source_digest,
+                                     const std::uint64_t          source_size)
+{
+	std::optional<mapped_file>                 mapping = {};
+	std::vector<std::span<const std::uint8_t>> images  = {};
+	std::span<const std::uint8_t>              bytes   = {};
+	entry_header                               header  = {};
+
+	try
+	{
+		bytes  = mapping.emplace(entry_path.string()).get_bytes();
+		header = deserialize<entry_header>(bytes, 0);
+
+		// The digest tells apart icons crafted to collide with the hash naming the entry.
+		if (ENTRY_MAGIC != header.magic || ENTRY_VERSION != header.version || source_hash != header.source_hash
+		    || source_digest != header.source_digest || source_size != header.source_size)
+		{
+			return std::nullopt;
+		}
+
+		const std::size_t header_offset = sizeof(entry_header) + static_cast<std::size_t>(header.images_count) * sizeof(image_entry);
+
+		if (header_offset > bytes.size() || header.header_size > bytes.size() - header_offset)
+		{
+			return std::nullopt;
+		}
+
+		for (std::uint32_t index = 0; index < header.images_count; ++index)
+		{
+			const image_entry image = deserialize<image_entry>(bytes, sizeof(entry_header) + index * sizeof(image_entry));
+
+			if (image.offset > bytes.size() || image.size > bytes.size() - image.offset)
+			{
+				return std::nullopt;
+			}
+
+			images.push_back(bytes.subspan(image.offset, image.size));
+		}
+
+		const std::span<const std::uint8_t> group_header = bytes.subspan(header_offset, header.header_size);
+
+		return icon{ std::move(mapping.value()), group_header, images };
+	}
+	catch (const std::exception&)
+	{
+		// Missing, truncated by another tool or being evicted: treated as a miss.
+		return std::nullopt;
+	}
+}
+
+void icon_cache::store(const std::filesystem::path& entry_path,
+                       const std::uint64_t          source_hash,
+                       const sha256_digest&         source_digest,
+                       const std::uint64_t          source_size,
+                       const icon&                  icon)
+{
+	const std::span<const std::uint8_t>                  group_header = icon.get_header();
+	const std::span<const std::span<const std::uint8_t>> images       = icon.get_images();
+	std::vector<std::uint8_t>                            bytes        = {};
+	std::size_t                                          offset       = sizeof(entry_header) + images.size() * sizeof(image_entry);
+	std::size_t                                          size         = offset + group_header.size();
+
+	for (const std::span<const std::uint8_t> image : images)
+	{
+		size += image.size();
+	}
+
+	if (std::numeric_limits<std::uint32_t>::max() < size)
+	{
+		throw std::invalid_argument{ std::format("Icon of {} bytes is too large to be cached!", size) };
+	}
+
+	bytes.resize(size);
+	serialize(entry_header{ ENTRY_MAGIC, ENTRY_VERSION, source_hash, source_digest, source_size, static_cast<std::uint32_t>(group_header.size()),
+	                        static_cast<std::uint32_t>(images.size()) },
+	          bytes, 0);
+
+	std::ranges::copy(group_header, bytes.begin() + offset);
+	offset += group_header.size();
+
+	for (std::size_t index = 0; index < images.size(); ++index)
+	{
+		serialize(image_entry{ static_cast<std::uint32_t>(offset), static_cast<std::uint32_t>(images[index].size()) }, bytes,
+		          sizeof(entry_header) + index * sizeof(image_entry));
+
+		std::ranges::copy(images[index], bytes.begin() + offset);
+		offset += images[index].size();
+	}
+
+	// Published with a rename, so other processes never see a partial entry.
+	write_file(entry_path.string(), bytes);
+}
+
+void icon_cache::evict() const
+{
+	struct entry final
+	{
+		std::filesystem::file_time_type time; ///< The time of the last use.
+		std::uint64_t                   size; ///< The size of the entry.
+		std::filesystem::path           path; ///< The path of the entry.
+	};
+
+	const std::filesystem::file_time_type now     = std::filesystem::file_time_type::clock::now();
+	std::vector<entry>                    entries = {};
+	std::uint64_t                         size    = 0;
+	std::error_code                       error   = {};
+
+	// Entries may be removed by other processes at any time, so errors are ignored.
+	for (const std::filesystem::directory_entry& file : std::filesystem::directory_iterator{ directory_path, error })
+	{
+		std::error_code                       size_error = {};
+		const std::filesystem::file_time_type time       = file.last_write_time(error);
+		const std::uint64_t                   file_size  = file.file_size(size_error);
+
+		if (error || size_error)
+		{
+			continue;
+		}
+
+		if (".tmp" == file.path().extension())
+		{
+			if (TEMPORARY_LIFETIME < now - time)
+			{
+				std::filesystem::remove(file.path(), error);
+			}
+
+			continue;
+		}
+
+		if (ENTRY_EXTENSION == file.path().extension())
+		{
+			entries.push_back(entry{ time, file_size, file.path() });
+			size += file_size;
+		}
+	}
+
+	if (capacity >= size)
+	{
+		return;
+	}
+
+	std::ranges::sort(entries, {}, &entry::time);
+
+	for (const entry& entry : entries)
+	{
+		if (capacity >= size)
+		{
+			break;
+		}
+
+		LOG("Cache evict: {}", entry.path.string());
+
+		std::filesystem::remove(entry.path, error);
+		size -= entry.size;
+	}
+}
+
+static std::vector<std::uint8_t> get_options_key(const icon::options& options)
+{
+	std::vector<std::uint16_t> key = options.sizes;
+
+	if (key.empty() && 0 == options.png_min_size && options.entry_sizes.empty() && options.entry_depths.empty() && !options.source_group.has_value())
+	{
+		return {};
+	}
+
+	key.push_back(options.png_min_size);
+
+	// Appended only when entries are selected, so that the other cache entries keep their keys. 0 is neither a size nor a depth.
+	if (!options.entry_sizes.empty() || !options.entry_depths.empty())
+	{
+		key.push_back(0);
+		key.insert(key.end(), options.entry_sizes.begin(), options.entry_sizes.end());
+		key.push_back(0);
+		key.insert(key.end(), options.entry_depths.begin(), options.entry_depths.end());
+	}
+
+	const std::uint8_t* const key_bytes = reinterpret_cast<const std::uint8_t*>(key.data());
+	std::vector<std::uint8_t> result    = { key_bytes, key_bytes + key.size() * sizeof(std::uint16_t) };
+
+	if (!options.source_group.has_value())
+	{
+		return result;
+	}
+
+	// Integer IDs are prefixed, so that they do not share keys with names made of digits. The sizes end with a 0, which no name holds.
+	const std::string group = (std::holds_alternative<std::uint16_t>(*options.source_group) ? "#" : "") + resource_tree::to_string(*options.source_group);
+
+	result.push_back(0);
+	result.insert(result.end(), group.begin(), group.end());
+	return result;
+}
+
+} // namespace icon_changer
@@ -0,0 +1,153 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <filesystem>
+#include <optional>
+#include <string_view>
+
+#include "hash.hpp"
+#include "icon.hpp"
+#include "utility.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief Persistent cache of parsed icons, keyed by the content of the icon file.
+/// \details Each entry is a flat file holding the group icon header and the
+/// images ready to be embedded, so a hit is served by mapping the entry
+/// without parsing or converting anything. Entries are published with an
+/// atomic rename and the least recently used ones are evicted once the cache
+/// outgrows its capacity, so several processes can share the directory.
+/// An entry is named after a fast hash of the icon file but only served if
+/// the SHA-256 digest it holds matches, as icons may be crafted to collide.
+///
+class icon_cache final
+{
+public:
+	///
+	/// \brief Default capacity of the cache in bytes.
+	///
+	static constexpr std::uint64_t DEFAULT_CAPACITY = 256ULL * 1024ULL * 1024ULL;
+
+	///
+	/// \brief Opens the cache, creating its directory if needed.
+	/// \param directory_path: The directory holding the cache entries.
+	/// \param capacity: Size in bytes above which entries are evicted.
+	///
+	icon_cache(std::string_view directory_path,
+	           std::uint64_t    capacity = DEFAULT_CAPACITY);
+
+	///
+	/// \brief Loads an icon from the cache, parsing and storing it on a miss.
+	/// \details Failing to store an entry is not an error, the cache is only
+	/// an optimization.
+	/// \param file_path: The path to the icon (ICO, BMP, PNG) file or to the executable it is copied from.
+	/// \param options: How the icon is loaded and prepared on a miss. The sizes
+	/// and the PNG size are part of the key, so each combination gets its own entry.
+	/// \returns The icon.
+	///
+	icon load(std::string_view     file_path,
+	          const icon::options& options) const;
+
+private:
+	///
+	/// \brief The header at the beginning of each cache entry.
+	/// \details It is followed by an image_entry per image, the group icon
+	/// header and the images.
+	///
+	struct PACKED entry_header final
+	{
+		std::uint32_t magic;        ///< Identifies the file as a cache entry.
+		std::uint32_t version;      ///< Version of the entry layout.
+		std::uint64_t source_hash;   ///< The hash of the icon file.
+		sha256_digest source_digest; ///< The digest of the icon file and of the options.
+		std::uint64_t source_size;   ///< The size of the icon file.
+		std::uint32_t header_size;   ///< The size of the group icon header.
+		std::uint32_t images_count;  ///< The number of images.
+	};
+
+	///
+	/// \brief Location of an image inside a cache entry.
+	///
+	struct PACKED image_entry final
+	{
+		std::uint32_t offset; ///< Offset of the image from the beginning of the entry.
+		std::uint32_t size;   ///< Size of the image in bytes.
+	};
+
+	///
+	/// \brief Gets the path of the entry of an icon file.
+	/// \param source_hash: The hash of the icon file.
+	/// \returns The path of the entry.
+	///
+	std::filesystem::path get_entry_path(std::uint64_t source_hash) const;
+
+	///
+	/// \brief Loads an icon from its cache entry.
+	/// \param entry_path: The path of the entry.
+	/// \param source_hash: The hash of the icon file.
+	/// \param source_digest: The digest of the icon file and of the options.
+	/// \param source_size: The size of the icon file.
+	/// \returns The icon, std::nullopt if the entry is missing, not valid or
+	/// made from other content.
+	///
+	static std::optional<icon> find(const std::filesystem::path& entry_path,
+	                                std::uint64_t                source_hash,
+	                                const sha256_digest&         source_digest,
+	                                std::uint64_t                source_size);
+
+	///
+	/// \brief Writes the cache entry of an icon.
+	/// \param entry_path: The path of the entry.
+	/// \param source_hash: The hash of the icon file.
+	/// \param source_digest: The digest of the icon file and of the options.
+	/// \param source_size: The size of the icon file.
+	/// \param icon: The parsed icon.
+	///
+	static void store(const std::filesystem::path& entry_path,
+	                  std::uint64_t                source_hash,
+	                  const sha256_digest&         source_digest,
+	                  std::uint64_t                source_size,
+	                  const icon&                  icon);
+
+	///
+	/// \brief Removes the least recently used entries until the cache fits its
+	/// capacity, along with temporary files abandoned by crashed processes.
+	///
+	void evict() const;
+
+private:
+	///
+	/// \brief The directory holding the cache entries.
+	///
+	std::filesystem::path directory_path;
+
+	///
+	/// \brief Size in bytes above which entries are evicted.
+	///
+	std::uint64_t capacity;
+};
+
+} // namespace icon_changer
@@ -19,56 +19,138 @@
 
 #include <cassert>
 #include <filesystem>
+#include <map>
 #include <print>
+#include <set>
 #include <stdexcept>
+#include <unordered_map>
 #include <vector>
-#include <windows.h>
 
+#include "byte_source.hpp"
+#include "hash.hpp"
 #include "icon.hpp"
+#include "mapped_file.hpp"
+#include "pe_file.hpp"
+#include "resource_tree.hpp"
+#include "stats.hpp"
 #include "utility.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
-// LOCAL FUNCTIONS
+// TYPE DEFINITIONS
 ////////////////////////////////////////////////////////////////////////////////
 
 namespace icon_changer
 {
 
+///
+/// \brief Which RT_ICON resources of an executable are still needed.
+///
+struct icon_index final
+{
+	std::set<std::uint16_t> kept_ids;     ///< The IDs referred to by the groups that are not replaced.
+	std::set<std::uint16_t> released_ids; ///< The IDs referred to only by replaced groups, or by no group at all.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
 ///
 /// \brief Secure version of icon replacement with rollback on failure.
-/// \details Opens the executable's resources, sets the icon images and header,
-/// and commits the changes.
+/// \details Parses the executable's resources, sets the icon images and header,
+/// and writes the executable once. It is left untouched if anything fails.
 /// \param icon_path: The path to the `.ico` file.
 /// \param executable_path: The path to the target `.exe` file.
+/// \param mode: How the icon file is brought into memory.
+/// \returns How the executable was written.
 ///
-static void change_icon_s(std::string_view icon_path,
-                          std::string_view executable_path);
+static pe_file::save_strategy change_icon_s(std::string_view icon_path,
+                                            std::string_view executable_path,
+                                            icon::load_mode  mode);
 
 ///
-/// \brief Adds the individual icon image resources to the executable.
-/// \details Iterates over all images and adds them with appropriate resource IDs.
-/// \param exe_resource: Handle to the open resource section of the executable.
-/// \param icon: The parsed icon object containing image data.
+/// \brief Writes the icon groups into the executable.
+/// \details Parses the executable's resources, removes the groups being
+/// replaced along with the images no other group uses, sets the images and
+/// headers of every group, and writes the executable once. If it already
+/// holds exactly these icons, it is not written at all.
+/// \param groups: The icon groups.
+/// \param executable_path: The path to the target `.exe` file.
+/// \param shared: Receives the images shared between groups.
+/// \returns How the executable was written.
 ///
-static void set_images(void*                                   exe_resource,
-                       std::vector<std::vector<std::uint8_t>>& icon_images);
+static pe_file::save_strategy write_icons(std::span<const icon_group> groups,
+                                          std::string_view            executable_path,
+                                          icon::deduplication&        shared);
 
 ///
-/// \brief Adds the group icon header (NEWHEADER + RESDIR) to the executable.
-/// \param exe_resource: Handle to the open resource section of the executable.
-/// \param icon: The parsed icon object containing the group icon header.
+/// \brief Adds the individual icon image resources to the resource tree.
+/// \details RT_ICON IDs are allocated from 1 in the order of the groups and
+/// their images, skipping the IDs of the groups that are kept, and an image
+/// identical to one already added, or to one of a group that is kept, reuses
+/// its ID.
+/// \param resources: The resource tree of the executable.
+/// \param groups: The icon groups.
+/// \param kept_ids: The IDs of the images of the groups that are kept.
+/// \param shared: Receives the images shared between groups.
+/// \returns The header of every group, its entries referring to the allocated IDs.
 ///
-static void set_icon_header(void*                      exe_resource,
-                            std::vector<std::uint8_t>& icon_header);
+static std::vector<std::vector<std::uint8_t>> set_images(resource_tree&                 resources,
+                                                         std::span<const icon_group>    groups,
+                                                         const std::set<std::uint16_t>& kept_ids,
+                                                         icon::deduplication&           shared);
+
+///
+/// \brief Indexes the RT_ICON resources by the groups referring to them.
+/// \details Images no group refers to (e.g. left behind by tools that did
+/// not remove them) are released as well.
+/// \param resources: The resource tree of the executable.
+/// \param groups: The icon groups replacing groups of the same name.
+/// \returns The IDs which must be kept and the ones which can be removed.
+///
+static icon_index index_icons(const resource_tree&        resources,
+                              std::span<const icon_group> groups);
+
+///
+/// \brief Removes the groups being replaced, in every language, and the released images.
+/// \param resources: The resource tree of the executable.
+/// \param groups: The icon groups replacing groups of the same name.
+/// \param index: The index of the RT_ICON resources.
+///
+static void remove_icons(resource_tree&              resources,
+                         std::span<const icon_group> groups,
+                         const icon_index&           index);
+
+///
+/// \brief Checks whether two resource trees hold the same icons.
+/// \details The RT_ICON and RT_GROUP_ICON resources are compared name by name
+/// and language by language, data and code page included.
+/// \param original: The resource tree of the executable as it was read.
+/// \param resources: The resource tree with the icon groups set.
+/// \returns Whether the icons are the same, so that nothing needs to be written.
+///
+static bool has_same_icons(const resource_tree& original,
+                           const resource_tree& resources);
+
+///
+/// \brief Adds the group icon header (NEWHEADER + RESDIR) to the resource tree.
+/// \param resources: The resource tree of the executable.
+/// \param name: The name or integer ID of the group.
+/// \param icon_header: The group icon header, must outlive the tree.
+///
+static void set_icon_header(resource_tree&                   resources,
+                            const resource_tree::identifier& name,
+                            std::span<const std::uint8_t>    icon_header);
 
 ////////////////////////////////////////////////////////////////////////////////
 // FUNCTION DEFINITIONS
 ////////////////////////////////////////////////////////////////////////////////
 
-void change_icon(const std::string_view icon_path,
-                 const std::string_view executable_path)
+pe_file::save_strategy change_icon(const std::string_view icon_path,
+                                   const std::string_view executable_path,
+                                   const icon::load_mode  mode)
 {
-	if (!std::filesystem::exists(icon_path))
+	if (STDIN_PATH != icon_path && !std::filesystem::exists(icon_path))
 	{
 		throw std::invalid_argument{ std::format("\"{}\" does not exist!", icon_path) };
 	}
@@ -78,63 +160,268 @@ void change_icon(const std::string_view icon_path,
 		throw std::invalid_argument{ std::format("\"{}\" does not exist!", executable_path) };
 	}
 
-	change_icon_s(icon_path, executable_path);
+	return change_icon_s(icon_path, executable_path, mode);
+}
+
+pe_file::save_strategy change_icon(const icon&            icon,
+                                   const std::string_view executable_path)
+{
+	const icon_group group = { resource_tree::make_identifier(MAIN_ICON_NAME), &icon };
+
+	return change_icon(std::span{ &group, 1 }, executable_path);
 }
 
-static void change_icon_s(const std::string_view icon_path,
-                          const std::string_view executable_path)
+pe_file::save_strategy change_icon(const std::span<const icon_group> groups,
+                                   const std::string_view            executable_path,
+                                   icon::deduplication* const        shared)
 {
-	icon        icon         = { icon_path };
-	void* const exe_resource = BeginUpdateResourceA(executable_path.data(), false);
+	icon::deduplication deduplication = {};
 
-	if (nullptr == exe_resource)
+	if (groups.empty())
 	{
-		throw std::runtime_error{ "Failed to get executable's resource handle!" };
+		throw std::invalid_argument{ "No icon group to embed!" };
 	}
 
-	try
+	for (std::size_t index = 0; index < groups.size(); ++index)
 	{
-		set_images(exe_resource, icon.get_images());
-		set_icon_header(exe_resource, icon.get_header());
+		assert(nullptr != groups[index].icon);
+
+		if (groups.end() != std::find_if(groups.begin() + index + 1, groups.end(), [&groups, index](const icon_group& group)
+		{
+			return group.name == groups[index].name;
+		}))
+		{
+			throw std::invalid_argument{ std::format("Icon group \"{}\" is listed more than once!", resource_tree::to_string(groups[index].name)) };
+		}
 	}
-	catch (const std::exception& exception)
+
+	if (!std::filesystem::exists(executable_path))
 	{
-		EndUpdateResourceA(exe_resource, true);
-		throw;
+		throw std::invalid_argument{ std::format("\"{}\" does not exist!", executable_path) };
 	}
 
-	if (!EndUpdateResourceA(exe_resource, false))
+	const pe_file::save_strategy strategy = write_icons(groups, executable_path, deduplication);
+
+	if (nullptr != shared)
 	{
-		throw std::runtime_error{ "Failed to commit the changes to the executable!" };
+		*shared = deduplication;
 	}
+
+	return strategy;
+}
+
+static pe_file::save_strategy change_icon_s(const std::string_view icon_path,
+                                            const std::string_view executable_path,
+                                            const icon::load_mode  mode)
+{
+	const icon icon = { icon_path, mode };
+
+	return change_icon(icon, executable_path);
 }
 
-static void set_images(void* const                             exe_resource,
-                       std::vector<std::vector<std::uint8_t>>& icon_images)
+static pe_file::save_strategy write_icons(const std::span<const icon_group> groups,
+                                          const std::string_view            executable_path,
+                                          icon::deduplication&              shared)
 {
-	assert(nullptr != exe_resource);
+	// Mapped rather than read, so that patching a large installer only brings its headers and resources into memory.
+	const mapped_file   mapping   = mapped_file{ executable_path };
+	const pe_file       pe_file   = { executable_path, mapping.get_bytes() };
+	const resource_tree original  = pe_file.read_resources();
+	resource_tree       resources = original;
+	const icon_index    index     = index_icons(resources, groups);
+
+	remove_icons(resources, groups, index);
 
-	std::size_t id = 0;
+	const std::vector<std::vector<std::uint8_t>> headers = set_images(resources, groups, index.kept_ids, shared);
 
-	for (std::vector<std::uint8_t>& image : icon_images)
+	for (std::size_t index = 0; index < groups.size(); ++index)
 	{
-		// We rely on the fact that we know IDs start from 1 in the header entries.
-		if (!UpdateResourceA(exe_resource, RT_ICON, reinterpret_cast<char*>(++id), LANG_NEUTRAL, image.data(), image.size()))
+		set_icon_header(resources, groups[index].name, headers[index]);
+	}
+
+	// Incremental builds patch the same executable over and over, leaving it alone keeps its modification time.
+	if (has_same_icons(original, resources))
+	{
+		return pe_file::save_strategy::unchanged;
+	}
+
+	return pe_file.save(executable_path, resources);
+}
+
+static std::vector<std::vector<std::uint8_t>> set_images(resource_tree&                    resources,
+                                                         const std::span<const icon_group> groups,
+                                                         const std::set<std::uint16_t>&    kept_ids,
+                                                         icon::deduplication&              shared)
+{
+	const stats_timer                                      timer         = stats_timer{ stats_phase::write };
+	std::unordered_multimap<std::uint64_t, std::uint16_t>  unique_ids    = {};
+	std::map<std::uint16_t, std::span<const std::uint8_t>> unique_images = {};
+	std::vector<std::vector<std::uint8_t>>                 headers       = {};
+	std::uint16_t                                          next_id       = 1;
+
+	// The images of the groups that are kept can be shared too, they do not change.
+	for (const std::uint16_t id : kept_ids)
+	{
+		const resource_tree::type_map::const_iterator images = resources.get_types().find(RT_ICON);
+
+		if (resources.get_types().end() == images || !images->second.contains(id) || images->second.at(id).empty())
 		{
-			throw std::runtime_error{ std::format("Failed to add RT_ICON resource with id {} to executable!", id) };
+			continue;
 		}
+
+		unique_images.emplace(id, images->second.at(id).begin()->second.data);
+		unique_ids.emplace(hash(unique_images.at(id)), id);
+	}
+
+	for (const icon_group& group : groups)
+	{
+		std::vector<std::uint16_t> ids = {};
+
+		for (const std::span<const std::uint8_t> image : group.icon->get_images())
+		{
+			const std::uint64_t image_key = hash(image);
+			std::uint16_t       id        = 0;
+
+			// A hash match is only a candidate, the bytes are compared to rule out collisions.
+			for (auto [candidate, end] = unique_ids.equal_range(image_key); candidate != end; ++candidate)
+			{
+				if (std::ranges::equal(unique_images.at(candidate->second), image))
+				{
+					id = candidate->second;
+					break;
+				}
+			}
+
+			if (0 != id)
+			{
+				++shared.images_count;
+				shared.saved_size += image.size();
+			}
+			else
+			{
+				while (kept_ids.contains(next_id))
+				{
+					++next_id;
+				}
+
+				if (0 == next_id)
+				{
+					throw std::invalid_argument{ "The icon groups hold more images than there are RT_ICON IDs!" };
+				}
+
+				id = next_id++;
+
+				unique_images.emplace(id, image);
+				unique_ids.emplace(image_key, id);
+				resources.set(RT_ICON, id, LANG_NEUTRAL, image);
+			}
+
+			ids.push_back(id);
+		}
+
+		headers.push_back(group.icon->get_header(ids));
+	}
+
+	return headers;
+}
+
+static icon_index index_icons(const resource_tree&              resources,
+                              const std::span<const icon_group> groups)
+{
+	const resource_tree::type_map&                types  = resources.get_types();
+	const resource_tree::type_map::const_iterator group  = types.find(RT_GROUP_ICON);
+	const resource_tree::type_map::const_iterator images = types.find(RT_ICON);
+	icon_index                                    index  = {};
+
+	if (types.end() != group)
+	{
+		for (const auto& [name, languages] : group->second)
+		{
+			if (groups.end() != std::ranges::find(groups, name, &icon_group::name))
+			{
+				continue;
+			}
+
+			for (const auto& [language, resource] : languages)
+			{
+				for (const std::uint16_t id : icon::get_image_ids(resource.data))
+				{
+					index.kept_ids.insert(id);
+				}
+			}
+		}
+	}
+
+	if (types.end() == images)
+	{
+		return index;
+	}
+
+	for (const auto& [name, languages] : images->second)
+	{
+		// Named images cannot be referred to by a group, they are left alone.
+		if (std::holds_alternative<std::uint16_t>(name) && !index.kept_ids.contains(std::get<std::uint16_t>(name)))
+		{
+			index.released_ids.insert(std::get<std::uint16_t>(name));
+		}
+	}
+
+	return index;
+}
+
+static void remove_icons(resource_tree&                    resources,
+                         const std::span<const icon_group> groups,
+                         const icon_index&                 index)
+{
+	for (const icon_group& group : groups)
+	{
+		resources.remove(RT_GROUP_ICON, group.name);
+	}
+
+	for (const std::uint16_t id : index.released_ids)
+	{
+		resources.remove(RT_ICON, id);
 	}
 }
 
-static void set_icon_header(void* const                exe_resource,
-                            std::vector<std::uint8_t>& icon_header)
+static bool has_same_icons(const resource_tree& original,
+                           const resource_tree& resources)
 {
-	assert(nullptr != exe_resource);
+	const auto same_languages = [](const resource_tree::name_map::value_type& left, const resource_tree::name_map::value_type& right)
+	{
+		return left.first == right.first && std::ranges::equal(left.second, right.second, [](const auto& left_language, const auto& right_language)
+		{
+			return left_language.first == right_language.first && left_language.second.code_page == right_language.second.code_page
+			    && std::ranges::equal(left_language.second.data, right_language.second.data);
+		});
+	};
 
-	if (!UpdateResourceA(exe_resource, RT_GROUP_ICON, "MAINICON", LANG_NEUTRAL, icon_header.data(), icon_header.size()))
+	for (const std::uint16_t type : { RT_ICON, RT_GROUP_ICON })
 	{
-		throw std::runtime_error{ "Failed to add RT_GROUP_ICON resource to executable!" };
+		const resource_tree::type_map::const_iterator left  = original.get_types().find(type);
+		const resource_tree::type_map::const_iterator right = resources.get_types().find(type);
+
+		if ((original.get_types().end() == left) != (resources.get_types().end() == right))
+		{
+			return false;
+		}
+
+		if (original.get_types().end() != left && !std::ranges::equal(left->second, right->second, same_languages))
+		{
+			return false;
+		}
 	}
+
+	return true;
+}
+
+static void set_icon_header(resource_tree&                      resources,
+                            const resource_tree::identifier&    name,
+                            const std::span<const std::uint8_t> icon_header)
+{
+	const stats_timer timer = stats_timer{ stats_phase::write };
+
+	resources.set(RT_GROUP_ICON, name, LANG_NEUTRAL, icon_header);
 }
 
 } // namespace icon_changer
@@ -17,23 +17,78 @@
 // HEADER FILE INCLUDES
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <span>
 #include <string_view>
 
+#include "icon.hpp"
+#include "pe_file.hpp"
+#include "resource_tree.hpp"
+
 ////////////////////////////////////////////////////////////////////////////////
-// FUNCTION DECLARATIONS
+// CONSTANTS
 ////////////////////////////////////////////////////////////////////////////////
 
 namespace icon_changer
 {
 
+///
+/// \brief The name of the icon group Windows shows for the executable.
+///
+inline constexpr std::string_view MAIN_ICON_NAME = "MAINICON";
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief An icon embedded as an RT_GROUP_ICON resource.
+///
+struct icon_group final
+{
+	resource_tree::identifier name; ///< The name or integer ID of the group.
+	const icon_changer::icon* icon; ///< The parsed icon, must outlive the call it is passed to.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DECLARATIONS
+////////////////////////////////////////////////////////////////////////////////
+
 ///
 /// \brief Entry point to initiate the icon replacement in an executable.
 /// \details Verifies files existence and forwards the call to the secure
 /// version.
-/// \param icon_path: The path to the icon (ICO, BMP) file.
+/// \param icon_path: The path to the icon (ICO, BMP, PNG) file or to the executable it is copied from.
+/// \param executable_path: The path to the target executable file.
+/// \param mode: How the icon file is brought into memory.
+/// \returns How the executable was written.
+///
+extern pe_file::save_strategy change_icon(std::string_view icon_path,
+                                          std::string_view executable_path,
+                                          icon::load_mode  mode = icon::load_mode::stream);
+
+///
+/// \brief Replaces the icon of an executable with an already parsed icon.
+/// \details The icon is only read, so it can be shared between threads
+/// patching different executables.
+/// \param icon: The parsed icon.
+/// \param executable_path: The path to the target executable file.
+/// \returns How the executable was written.
+///
+extern pe_file::save_strategy change_icon(const icon&      icon,
+                                          std::string_view executable_path);
+
+///
+/// \brief Embeds several icon groups into an executable at once.
+/// \details RT_ICON IDs are allocated from 1 over all groups, so the groups do
+/// not overwrite each other's images, and byte-identical images of different
+/// groups are stored once. The executable is written a single time.
+/// \param groups: The groups, each one replacing the group of the same name.
 /// \param executable_path: The path to the target executable file.
+/// \param shared: Receives the images shared between groups, may be nullptr.
+/// \returns How the executable was written.
 ///
-extern void change_icon(std::string_view icon_path,
-                        std::string_view executable_path);
+extern pe_file::save_strategy change_icon(std::span<const icon_group> groups,
+                                          std::string_view            executable_path,
+                                          icon::deduplication*        shared = nullptr);
 
 } // namespace icon_changer
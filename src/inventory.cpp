@@ -0,0 +1,527 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include "inventory.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <optional>
+#include <stdexcept>
+#include <unordered_set>
+#include <variant>
+
+#include "hash.hpp"
+#include "icon.hpp"
+#include "mapped_file.hpp"
+#include "pe_file.hpp"
+#include "thread_pool.hpp"
+#include "utility.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTANTS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief The first line of a CSV inventory.
+///
+static constexpr std::string_view CSV_HEADER = "path,group,language,group_hash,id,width,height,color_count,planes,bit_count,size,hash,error\n";
+
+///
+/// \brief The type of an ICO file in its header.
+///
+static constexpr std::uint16_t ICO_TYPE = 1;
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Lists the icons of an executable and extracts them.
+/// \param file_path: The path to the file.
+/// \param directory_path: The directory being scanned.
+/// \param extract_path: The directory the icon groups are extracted to, empty to not extract.
+/// \returns The icons of the executable, nothing if the file is not one.
+///
+static std::optional<inventory_entry> scan_executable(const std::filesystem::path& file_path,
+                                                      const std::filesystem::path& directory_path,
+                                                      const std::filesystem::path& extract_path);
+
+///
+/// \brief Reads an icon group and hashes its images.
+/// \param types: The resources of the executable.
+/// \param name: The name or integer ID of the group.
+/// \param language: The language of the group.
+/// \param header: The data of the RT_GROUP_ICON resource.
+/// \param images: Receives the data of every image found, in the order of the group entries.
+/// \returns The group.
+///
+static inventory_group read_group(const resource_tree::type_map&              types,
+                                  const resource_tree::identifier&            name,
+                                  const resource_tree::identifier&            language,
+                                  std::span<const std::uint8_t>               header,
+                                  std::vector<std::span<const std::uint8_t>>& images);
+
+///
+/// \brief Assembles the ICO file of an icon group.
+/// \param group: The icon group.
+/// \param images: The data of every image found, in the order of the group entries.
+/// \returns The content of the ICO file.
+///
+static std::vector<std::uint8_t> make_ico(const inventory_group&                          group,
+                                          std::span<const std::span<const std::uint8_t>> images);
+
+///
+/// \brief Gets the name of the ICO file an icon group is extracted to.
+/// \details Characters that may not be allowed in file names are replaced and
+/// integer IDs are prefixed with '#', as in resource scripts. A name already
+/// taken by another group of the executable gets a suffix.
+/// \param group: The icon group.
+/// \param file_names: The names taken so far, in lower case, receives the new one.
+/// \returns The file name, e.g. "MAINICON.1033.ico" or "#1.1033.ico".
+///
+static std::string get_file_name(const inventory_group&           group,
+                                 std::unordered_set<std::string>& file_names);
+
+///
+/// \brief Appends a string to a JSON document, quoted and escaped.
+/// \param output: The JSON document.
+/// \param value: The string.
+///
+static void append_json_string(std::string&     output,
+                               std::string_view value);
+
+///
+/// \brief Appends an identifier to a JSON document, a number for an integer ID.
+/// \param output: The JSON document.
+/// \param identifier: The identifier.
+///
+static void append_json_identifier(std::string&                     output,
+                                   const resource_tree::identifier& identifier);
+
+///
+/// \brief Appends a field to a CSV row, quoted if needed.
+/// \param output: The CSV table.
+/// \param value: The field.
+///
+static void append_csv_field(std::string&     output,
+                             std::string_view value);
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<inventory_entry> scan_icons(const std::string_view directory_path,
+                                        const std::size_t      threads_count,
+                                        const std::string_view extract_path)
+{
+	const std::filesystem::path                 directory   = directory_path;
+	const std::filesystem::path                 extract     = extract_path;
+	std::vector<std::filesystem::path>          file_paths  = {};
+	std::vector<std::filesystem::path>          directories = { directory };
+	std::vector<std::optional<inventory_entry>> scanned     = {};
+	std::vector<inventory_entry>                entries     = {};
+	std::error_code                             error       = {};
+
+	if (!std::filesystem::is_directory(directory_path, error))
+	{
+		throw std::invalid_argument{ std::format("\"{}\" is not a directory!", directory_path) };
+	}
+
+	// The tree is walked first, so that the workers only map and read files. Each directory gets its own iterator, as a recursive one
+	// ends at its first error and a single unreadable directory would cut the walk short.
+	while (!directories.empty())
+	{
+		const std::filesystem::path current = std::move(directories.back());
+
+		directories.pop_back();
+
+		for (std::filesystem::directory_iterator iterator =
+		         std::filesystem::directory_iterator{ current, std::filesystem::directory_options::skip_permission_denied, error };
+		     !error && std::filesystem::directory_iterator{} != iterator; iterator.increment(error))
+		{
+			std::error_code entry_error = {};
+
+			// Links to directories are not followed, same as a recursive walk by default.
+			if (!iterator->is_symlink(entry_error) && iterator->is_directory(entry_error))
+			{
+				directories.push_back(iterator->path());
+			}
+			else if (iterator->is_regular_file(entry_error))
+			{
+				file_paths.push_back(iterator->path());
+			}
+		}
+
+		error.clear();
+	}
+
+	std::ranges::sort(file_paths);
+	scanned.resize(file_paths.size());
+
+	{
+		thread_pool pool = thread_pool{ threads_count };
+
+		for (std::size_t index = 0; index < file_paths.size(); ++index)
+		{
+			pool.submit([&file_paths, &scanned, &directory, &extract, index]()
+			{
+				scanned[index] = scan_executable(file_paths[index], directory, extract);
+			});
+		}
+
+		pool.wait();
+	}
+
+	for (std::optional<inventory_entry>& entry : scanned)
+	{
+		if (entry.has_value())
+		{
+			entries.push_back(std::move(*entry));
+		}
+	}
+
+	return entries;
+}
+
+std::string format_inventory(const std::span<const inventory_entry> entries,
+                             const inventory_format                 format)
+{
+	const auto get_pixels = [](const std::uint8_t size)
+	{
+		return 0 == size ? 256U : size;
+	};
+
+	std::string output = inventory_format::json == format ? std::string{ "{\"executables\":[" } : std::string{ CSV_HEADER };
+
+	for (const inventory_entry& entry : entries)
+	{
+		if (inventory_format::json == format)
+		{
+			output += &entry == entries.data() ? "\n{\"path\":" : ",\n{\"path\":";
+			append_json_string(output, entry.executable_path);
+			output += ",\"groups\":[";
+
+			for (const inventory_group& group : entry.groups)
+			{
+				output += &group == entry.groups.data() ? "{\"name\":" : ",{\"name\":";
+				append_json_identifier(output, group.name);
+				output += ",\"language\":";
+				append_json_identifier(output, group.language);
+				output += std::format(",\"hash\":\"{:016x}\",\"images\":[", group.hash);
+
+				for (const inventory_image& image : group.images)
+				{
+					output += std::format("{}{{\"id\":{},\"width\":{},\"height\":{},\"color_count\":{},\"planes\":{},\"bit_count\":{}", &image == group.images.data() ? "" : ",",
+					                      image.id, get_pixels(image.entry.width), get_pixels(image.entry.height), image.entry.color_count, image.entry.planes,
+					                      image.entry.bit_count);
+					output += image.found ? std::format(",\"size\":{},\"hash\":\"{:016x}\"}}", image.entry.image_size, image.hash) : ",\"size\":null,\"hash\":null}";
+				}
+
+				output += "]}";
+			}
+
+			output += "]";
+
+			if (!entry.error.empty())
+			{
+				output += ",\"error\":";
+				append_json_string(output, entry.error);
+			}
+
+			output += "}";
+			continue;
+		}
+
+		// An executable without icons still gets a row, so that every scanned executable is listed.
+		if (entry.groups.empty())
+		{
+			append_csv_field(output, entry.executable_path);
+			output += ",,,,,,,,,,,,";
+			append_csv_field(output, entry.error);
+			output += '\n';
+		}
+
+		for (const inventory_group& group : entry.groups)
+		{
+			for (const inventory_image& image : group.images)
+			{
+				append_csv_field(output, entry.executable_path);
+				output += ',';
+				append_csv_field(output, resource_tree::to_string(group.name));
+				output += std::format(",{},{:016x},{},{},{},{},{},{},", resource_tree::to_string(group.language), group.hash, image.id, get_pixels(image.entry.width),
+				                      get_pixels(image.entry.height), image.entry.color_count, image.entry.planes, image.entry.bit_count);
+				output += image.found ? std::format("{},{:016x},", image.entry.image_size, image.hash) : std::string{ ",," };
+				append_csv_field(output, entry.error);
+				output += '\n';
+			}
+		}
+	}
+
+	if (inventory_format::json == format)
+	{
+		output += "\n]}\n";
+	}
+
+	return output;
+}
+
+static std::optional<inventory_entry> scan_executable(const std::filesystem::path& file_path,
+                                                      const std::filesystem::path& directory_path,
+                                                      const std::filesystem::path& extract_path)
+{
+	inventory_entry entry = { file_path.string(), {}, {} };
+
+	try
+	{
+		const mapped_file                   mapping = mapped_file{ file_path.string() };
+		const std::span<const std::uint8_t> bytes   = mapping.get_bytes();
+
+		// Only the first page is read to tell executables from the other files of the tree.
+		if (2 > bytes.size() || 'M' != bytes[0] || 'Z' != bytes[1])
+		{
+			return std::nullopt;
+		}
+
+		const pe_file                                 pe_file   = { entry.executable_path, bytes };
+		const resource_tree                           resources = pe_file.read_resources();
+		const resource_tree::type_map&                types     = resources.get_types();
+		const resource_tree::type_map::const_iterator groups    = types.find(RT_GROUP_ICON);
+
+		if (types.end() == groups)
+		{
+			return entry;
+		}
+
+		std::unordered_set<std::string> file_names = {};
+
+		for (const auto& [name, languages] : groups->second)
+		{
+			for (const auto& [language, resource] : languages)
+			{
+				std::vector<std::span<const std::uint8_t>> images = {};
+
+				entry.groups.push_back(read_group(types, name, language, resource.data, images));
+
+				if (!extract_path.empty())
+				{
+					const std::filesystem::path ico_path = extract_path / file_path.lexically_relative(directory_path) / get_file_name(entry.groups.back(), file_names);
+
+					std::filesystem::create_directories(ico_path.parent_path());
+					write_file(ico_path.string(), make_ico(entry.groups.back(), images));
+				}
+			}
+		}
+	}
+	catch (const std::exception& exception)
+	{
+		entry.error = exception.what();
+	}
+
+	return entry;
+}
+
+static inventory_group read_group(const resource_tree::type_map&              types,
+                                  const resource_tree::identifier&            name,
+                                  const resource_tree::identifier&            language,
+                                  const std::span<const std::uint8_t>         header,
+                                  std::vector<std::span<const std::uint8_t>>& images)
+{
+	const resource_tree::type_map::const_iterator icons        = types.find(RT_ICON);
+	inventory_group                               group        = { name, language, deserialize<ico_file::header>(header, 0), 0, {} };
+	std::uint32_t                                 image_offset = 0;
+
+	// Entries beyond the end of the header are ignored, same as when the executable is patched.
+	for (std::size_t offset = WIRE_SIZE<ico_file::header>; offset + WIRE_SIZE<icon::group_entry> <= header.size() && group.images.size() < group.header.entries_count;
+	     offset += WIRE_SIZE<icon::group_entry>)
+	{
+		const icon::group_entry group_entry = deserialize<icon::group_entry>(header, offset);
+		inventory_image         image       = { { group_entry.width, group_entry.height, group_entry.color_count, group_entry.reserved, group_entry.planes,
+		                                          group_entry.bit_count, 0, 0 },
+		                                        group_entry.id,
+		                                        0,
+		                                        false };
+
+		if (types.end() != icons)
+		{
+			const resource_tree::name_map::const_iterator languages = icons->second.find(group_entry.id);
+
+			if (icons->second.end() != languages && !languages->second.empty())
+			{
+				// The image in the language of the group is preferred.
+				const resource_tree::language_map::const_iterator resource =
+				    languages->second.contains(language) ? languages->second.find(language) : languages->second.begin();
+
+				image.entry.image_size = static_cast<std::uint32_t>(resource->second.data.size());
+				image.hash             = hash(resource->second.data);
+				image.found            = true;
+				group.hash             = hash(resource->second.data, group.hash);
+				images.push_back(resource->second.data);
+			}
+		}
+
+		group.images.push_back(image);
+	}
+
+	// The images are laid out after the header and the entries of the images found.
+	image_offset = static_cast<std::uint32_t>(WIRE_SIZE<ico_file::header> + images.size() * WIRE_SIZE<ico_file::entry>);
+
+	for (inventory_image& image : group.images)
+	{
+		if (image.found)
+		{
+			image.entry.image_offset  = image_offset;
+			image_offset             += image.entry.image_size;
+		}
+	}
+
+	return group;
+}
+
+static std::vector<std::uint8_t> make_ico(const inventory_group&                               group,
+                                          const std::span<const std::span<const std::uint8_t>> images)
+{
+	std::vector<std::uint8_t> bytes  = std::vector<std::uint8_t>(WIRE_SIZE<ico_file::header> + images.size() * WIRE_SIZE<ico_file::entry>);
+	std::size_t               offset = WIRE_SIZE<ico_file::header>;
+
+	serialize(ico_file::header{ 0, ICO_TYPE, static_cast<std::uint16_t>(images.size()) }, bytes, 0);
+
+	for (const inventory_image& image : group.images)
+	{
+		if (image.found)
+		{
+			serialize(image.entry, bytes, offset);
+			offset += WIRE_SIZE<ico_file::entry>;
+		}
+	}
+
+	for (const std::span<const std::uint8_t> image : images)
+	{
+		bytes.insert(bytes.end(), image.begin(), image.end());
+	}
+
+	return bytes;
+}
+
+static std::string get_file_name(const inventory_group&           group,
+                                 std::unordered_set<std::string>& file_names)
+{
+	std::string name      = resource_tree::to_string(group.name);
+	std::string file_name = {};
+
+	for (char& character : name)
+	{
+		if (!('0' <= character && '9' >= character) && !('A' <= character && 'Z' >= character) && !('a' <= character && 'z' >= character) && '-' != character &&
+		    '_' != character)
+		{
+			character = '_';
+		}
+	}
+
+	// Sanitized names never hold a '#', so an integer ID cannot take the file of a name made of digits.
+	if (std::holds_alternative<std::uint16_t>(group.name))
+	{
+		name.insert(0, 1, '#');
+	}
+
+	// The names are compared in lower case, as file systems often ignore the case.
+	for (std::size_t suffix = 1; file_name.empty(); ++suffix)
+	{
+		std::string candidate = 1 == suffix ? std::format("{}.{}.ico", name, resource_tree::to_string(group.language))
+		                                    : std::format("{}_{}.{}.ico", name, suffix, resource_tree::to_string(group.language));
+		std::string key       = candidate;
+
+		std::ranges::transform(key, key.begin(), [](const char character)
+		{
+			return 'A' <= character && 'Z' >= character ? static_cast<char>(character - 'A' + 'a') : character;
+		});
+
+		if (file_names.insert(std::move(key)).second)
+		{
+			file_name = std::move(candidate);
+		}
+	}
+
+	return file_name;
+}
+
+static void append_json_string(std::string&           output,
+                               const std::string_view value)
+{
+	output += '"';
+
+	for (const char character : value)
+	{
+		if ('"' == character || '\\' == character)
+		{
+			output += '\\';
+			output += character;
+		}
+		else if (0x20 > static_cast<unsigned char>(character))
+		{
+			output += std::format("\\u{:04x}", static_cast<unsigned char>(character));
+		}
+		else
+		{
+			output += character;
+		}
+	}
+
+	output += '"';
+}
+
+static void append_json_identifier(std::string&                     output,
+                                   const resource_tree::identifier& identifier)
+{
+	if (std::holds_alternative<std::uint16_t>(identifier))
+	{
+		output += resource_tree::to_string(identifier);
+		return;
+	}
+
+	append_json_string(output, resource_tree::to_string(identifier));
+}
+
+static void append_csv_field(std::string&           output,
+                             const std::string_view value)
+{
+	if (std::string_view::npos == value.find_first_of(",\"\r\n"))
+	{
+		output += value;
+		return;
+	}
+
+	output += '"';
+
+	for (const char character : value)
+	{
+		output += character;
+
+		if ('"' == character)
+		{
+			output += '"';
+		}
+	}
+
+	output += '"';
+}
+
+} // namespace icon_changer
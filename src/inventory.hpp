@@ -0,0 +1,112 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ico_file.hpp"
+#include "resource_tree.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief How an inventory is printed.
+///
+enum class inventory_format : std::uint8_t
+{
+	json, ///< A JSON object, one executable per line.
+	csv   ///< A CSV table, one image per row.
+};
+
+///
+/// \brief An image of an icon group found in an executable.
+///
+struct inventory_image final
+{
+	ico_file::entry entry; ///< The directory entry, its offset being the one of the image in the extracted ICO file.
+	std::uint16_t   id;    ///< The ID of the RT_ICON resource holding the image.
+	std::uint64_t   hash;  ///< The XXH64 hash of the image data.
+	bool            found; ///< Whether the executable has the RT_ICON resource, the size and hash being 0 otherwise.
+};
+
+///
+/// \brief An icon group found in an executable.
+///
+struct inventory_group final
+{
+	resource_tree::identifier    name;     ///< The name or integer ID of the RT_GROUP_ICON resource.
+	resource_tree::identifier    language; ///< The language of the RT_GROUP_ICON resource.
+	ico_file::header             header;   ///< The group header (NEWHEADER).
+	std::uint64_t                hash;     ///< The hash of the images in order, the same for identical icons whatever their IDs.
+	std::vector<inventory_image> images;   ///< The images, in the order of the group entries.
+};
+
+///
+/// \brief The icons of an executable.
+///
+struct inventory_entry final
+{
+	std::string                  executable_path; ///< The path to the executable.
+	std::vector<inventory_group> groups;          ///< The icon groups, by name and language.
+	std::string                  error;           ///< The reason the executable could not be scanned or extracted, empty if it was.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DECLARATIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Lists the icons of every executable under a directory.
+/// \details The executables are scanned in parallel, each one being mapped
+/// and read without being modified: only its headers, its resource directory
+/// and its icon images are brought into memory. Files that do not start with
+/// the MZ signature are skipped, as are directories that cannot be read. A
+/// failing executable is reported in its entry and does not stop the others.
+/// \param directory_path: The directory, walked recursively.
+/// \param threads_count: Number of worker threads, 0 means one per hardware thread.
+/// \param extract_path: The directory every icon group is extracted to as an
+/// ICO file, in a directory named after the path of its executable relative to
+/// the scanned one, empty to not extract.
+/// \returns The icons of every executable, ordered by path.
+///
+extern std::vector<inventory_entry> scan_icons(std::string_view directory_path,
+                                               std::size_t      threads_count,
+                                               std::string_view extract_path = {});
+
+///
+/// \brief Formats an inventory.
+/// \details Sizes are given in pixels (256 rather than 0) and hashes as 16
+/// hexadecimal digits.
+/// \param entries: The icons of every executable.
+/// \param format: How the inventory is printed.
+/// \returns The formatted inventory.
+///
+extern std::string format_inventory(std::span<const inventory_entry> entries,
+                                    inventory_format                 format);
+
+} // namespace icon_changer
@@ -17,12 +17,50 @@
 
 #include <cassert>
 #include <cstdlib>
+#include <new>
 #include <print>
+#include <span>
+#include <string_view>
 
 #include "cli.hpp"
 #include "gui.hpp"
+#include "server.hpp"
+#include "stats.hpp"
 #include "utility.hpp"
 
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+// The allocations are counted for --stats by the executable only, so that the library does not replace the
+// allocation functions of the programs linking it. The other forms of operator new and delete forward to these.
+
+void* operator new(const std::size_t size)
+{
+	void* const memory = std::malloc(0 == size ? 1 : size);
+
+	if (nullptr == memory)
+	{
+		throw std::bad_alloc{};
+	}
+
+	icon_changer::count_stat(icon_changer::stats_counter::allocations, 1);
+	icon_changer::count_stat(icon_changer::stats_counter::allocated_bytes, size);
+
+	return memory;
+}
+
+void operator delete(void* const memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* const memory,
+                     std::size_t) noexcept
+{
+	std::free(memory);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // ENTRY POINT
 ////////////////////////////////////////////////////////////////////////////////
@@ -43,6 +81,12 @@ std::int32_t main(const std::int32_t argument_count,
 			return EXIT_SUCCESS;
 		}
 
+		// The command is run by a server started with --serve, the icons it already parsed being reused.
+		if (3 <= argument_count && "--connect" == std::string_view{ arguments[1] })
+		{
+			return forward_cli(arguments[2], std::span{ arguments + 3, static_cast<std::size_t>(argument_count - 3) });
+		}
+
 		change_icon_cli(argument_count, arguments);
 	}
 	catch (const std::exception& exception)
@@ -0,0 +1,168 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mapped_file.hpp"
+
+#include <format>
+#include <stdexcept>
+#include <string>
+
+#include "stats.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+////////////////////////////////////////////////////////////////////////////////
+// METHOD DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+#ifdef _WIN32
+
+mapped_file::mapped_file(const std::string_view file_path)
+    : address{ nullptr }
+    , size{ 0 }
+{
+	const stats_timer timer = stats_timer{ stats_phase::open };
+
+	// The view keeps the file open, sharing it for writing lets an executable mapped to be read be patched in place or replaced.
+	LARGE_INTEGER file_size = {};
+	void* const   file      = CreateFileA(std::string{ file_path }.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+	                                      FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (INVALID_HANDLE_VALUE == file)
+	{
+		throw std::invalid_argument{ std::format("Failed to open \"{}\"!", file_path) };
+	}
+
+	if (!GetFileSizeEx(file, &file_size))
+	{
+		CloseHandle(file);
+		throw std::runtime_error{ std::format("Failed to get the size of \"{}\"!", file_path) };
+	}
+
+	size = static_cast<std::size_t>(file_size.QuadPart);
+
+	if (0 == size)
+	{
+		CloseHandle(file);
+		return;
+	}
+
+	void* const mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+
+	CloseHandle(file);
+
+	if (nullptr == mapping)
+	{
+		throw std::runtime_error{ std::format("Failed to map \"{}\" into memory!", file_path) };
+	}
+
+	address = static_cast<std::uint8_t*>(MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0));
+	CloseHandle(mapping);
+
+	if (nullptr == address)
+	{
+		throw std::runtime_error{ std::format("Failed to map \"{}\" into memory!", file_path) };
+	}
+
+	count_stat(stats_counter::bytes_read, size);
+}
+
+mapped_file::~mapped_file() noexcept
+{
+	if (nullptr != address)
+	{
+		UnmapViewOfFile(address);
+	}
+}
+
+#else
+
+mapped_file::mapped_file(const std::string_view file_path)
+    : address{ nullptr }
+    , size{ 0 }
+{
+	const stats_timer timer = stats_timer{ stats_phase::open };
+
+	struct stat status     = {};
+	const int   descriptor = open(std::string{ file_path }.c_str(), O_RDONLY | O_CLOEXEC);
+
+	if (-1 == descriptor)
+	{
+		throw std::invalid_argument{ std::format("Failed to open \"{}\"!", file_path) };
+	}
+
+	if (-1 == fstat(descriptor, &status))
+	{
+		close(descriptor);
+		throw std::runtime_error{ std::format("Failed to get the size of \"{}\"!", file_path) };
+	}
+
+	size = static_cast<std::size_t>(status.st_size);
+
+	if (0 == size)
+	{
+		close(descriptor);
+		return;
+	}
+
+	void* const mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, descriptor, 0);
+
+	close(descriptor);
+
+	if (MAP_FAILED == mapping)
+	{
+		throw std::runtime_error{ std::format("Failed to map \"{}\" into memory!", file_path) };
+	}
+
+	address = static_cast<std::uint8_t*>(mapping);
+	count_stat(stats_counter::bytes_read, size);
+}
+
+mapped_file::~mapped_file() noexcept
+{
+	if (nullptr != address)
+	{
+		munmap(address, size);
+	}
+}
+
+#endif // _WIN32
+
+mapped_file::mapped_file(mapped_file&& other) noexcept
+    : address{ other.address }
+    , size{ other.size }
+{
+	other.address = nullptr;
+	other.size    = 0;
+}
+
+std::span<std::uint8_t> mapped_file::get_bytes() const noexcept
+{
+	return std::span{ address, size };
+}
+
+} // namespace icon_changer
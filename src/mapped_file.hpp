@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief Maps a whole file into memory.
+/// \details The mapping is private (copy-on-write): the bytes can be modified,
+/// only the touched pages get copied and the file itself is never changed.
+///
+class mapped_file final
+{
+public:
+	///
+	/// \brief Maps the file into memory.
+	/// \param file_path: The path to the file to be mapped.
+	///
+	mapped_file(std::string_view file_path);
+
+	///
+	/// \brief Takes over the mapping of another object.
+	/// \param other: The object to be moved, it is left empty.
+	///
+	mapped_file(mapped_file&& other) noexcept;
+
+	///
+	/// \brief Unmaps the file.
+	///
+	~mapped_file() noexcept;
+
+	mapped_file(const mapped_file&)            = delete;
+	mapped_file& operator=(const mapped_file&) = delete;
+	mapped_file& operator=(mapped_file&&)      = delete;
+
+	///
+	/// \brief Gets the mapped bytes of the file.
+	/// \returns A view of the whole file.
+	///
+	std::span<std::uint8_t> get_bytes() const noexcept;
+
+private:
+	///
+	/// \brief Address where the file is mapped, nullptr for empty files.
+	///
+	std::uint8_t* address;
+
+	///
+	/// \brief Size of the file in bytes.
+	///
+	std::size_t size;
+};
+
+} // namespace icon_changer
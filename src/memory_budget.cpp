@@ -0,0 +1,52 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include "memory_budget.hpp"
+
+#include <format>
+#include <stdexcept>
+
+////////////////////////////////////////////////////////////////////////////////
+// METHOD DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+memory_budget::memory_budget(const std::uint64_t capacity) noexcept
+    : capacity{ capacity }
+    , used{ 0 }
+{
+}
+
+void memory_budget::charge(const std::uint64_t    size,
+                           const std::string_view what)
+{
+	if (size > capacity - used)
+	{
+		throw std::runtime_error{ std::format("{} of {} bytes exceeds the memory budget ({} of {} bytes left)!", what, size, capacity - used, capacity) };
+	}
+
+	used += size;
+}
+
+std::uint64_t memory_budget::get_used() const noexcept
+{
+	return used;
+}
+
+} // namespace icon_changer
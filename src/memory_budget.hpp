@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <string_view>
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief Bounds the memory an untrusted file may make the parser allocate.
+/// \details Sizes read from a file are charged before anything is allocated
+/// for them, so a file declaring gigabytes fails fast instead of exhausting
+/// the memory.
+///
+class memory_budget final
+{
+public:
+	///
+	/// \brief No limit, the default for trusted files.
+	///
+	static constexpr std::uint64_t UNLIMITED = UINT64_MAX;
+
+	///
+	/// \brief Initializes an empty budget.
+	/// \param capacity: Number of bytes that can be charged.
+	///
+	explicit memory_budget(std::uint64_t capacity = UNLIMITED) noexcept;
+
+	///
+	/// \brief Charges bytes about to be allocated.
+	/// \param size: Number of bytes.
+	/// \param what: What is being allocated, used for error messages.
+	/// \throws std::runtime_error if the bytes do not fit in what is left of the budget.
+	///
+	void charge(std::uint64_t    size,
+	            std::string_view what);
+
+	///
+	/// \brief Gets the number of bytes charged so far.
+	/// \returns The number of bytes.
+	///
+	std::uint64_t get_used() const noexcept;
+
+private:
+	///
+	/// \brief Number of bytes that can be charged.
+	///
+	std::uint64_t capacity;
+
+	///
+	/// \brief Number of bytes charged so far.
+	///
+	std::uint64_t used;
+};
+
+} // namespace icon_changer
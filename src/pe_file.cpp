@@ -0,0 +1,574 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include "pe_file.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+
+#include "stats.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTANTS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief Offsets of the optional header fields which are the same for PE32
+/// and PE32+, relative to the beginning of the optional header.
+///
+namespace optional_header
+{
+
+static constexpr std::size_t MAGIC                  = 0;
+static constexpr std::size_t SIZE_OF_INITIALIZED    = 8;
+static constexpr std::size_t SECTION_ALIGNMENT      = 32;
+static constexpr std::size_t FILE_ALIGNMENT         = 36;
+static constexpr std::size_t SIZE_OF_IMAGE          = 56;
+static constexpr std::size_t SIZE_OF_HEADERS        = 60;
+static constexpr std::size_t CHECKSUM               = 64;
+static constexpr std::size_t PE32_DIRECTORIES_COUNT = 92;
+static constexpr std::size_t PE64_DIRECTORIES_COUNT = 108;
+
+} // namespace optional_header
+
+///
+/// \brief Index of the resource table in the data directories.
+///
+static constexpr std::size_t RESOURCE_DIRECTORY = 2;
+
+///
+/// \brief Index of the attribute certificate table in the data directories.
+/// \details Unlike the other directories, it holds a file offset, not an RVA.
+///
+static constexpr std::size_t SECURITY_DIRECTORY = 4;
+
+///
+/// \brief Section flags of a resource section: initialized data, readable.
+///
+static constexpr std::uint32_t RESOURCE_CHARACTERISTICS = 0x40000040;
+
+///
+/// \brief Size of the chunks the data following a grown section is moved in.
+///
+static constexpr std::size_t MOVE_CHUNK_SIZE = 1024 * 1024;
+
+////////////////////////////////////////////////////////////////////////////////
+// METHOD DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+pe_file::pe_file(const std::string_view file_path)
+    : path{ file_path }
+    , buffer{ read_file(file_path) }
+    , bytes{ buffer }
+    , coff_header_obj{}
+    , coff_header_offset{ 0 }
+    , optional_header_offset{ 0 }
+    , data_directories_offset{ 0 }
+    , data_directories_count{ 0 }
+    , section_alignment{ 0 }
+    , file_alignment{ 0 }
+    , sections{}
+{
+	const stats_timer timer = stats_timer{ stats_phase::parse };
+
+	read_headers();
+	read_sections();
+}
+
+pe_file::pe_file(const std::string_view              file_path,
+                 const std::span<const std::uint8_t> file_data)
+    : path{ file_path }
+    , buffer{}
+    , bytes{ file_data }
+    , coff_header_obj{}
+    , coff_header_offset{ 0 }
+    , optional_header_offset{ 0 }
+    , data_directories_offset{ 0 }
+    , data_directories_count{ 0 }
+    , section_alignment{ 0 }
+    , file_alignment{ 0 }
+    , sections{}
+{
+	const stats_timer timer = stats_timer{ stats_phase::parse };
+
+	read_headers();
+	read_sections();
+}
+
+resource_tree pe_file::read_resources() const
+{
+	const stats_timer                timer = stats_timer{ stats_phase::parse };
+	const std::optional<std::size_t> index = find_resource_section();
+
+	if (!index.has_value())
+	{
+		return resource_tree{};
+	}
+
+	const section_header&  section   = sections[*index];
+	const data_directory   directory = deserialize<data_directory>(bytes, data_directory_offset(RESOURCE_DIRECTORY));
+	const std::span<const std::uint8_t> raw_data =
+	    std::span{ bytes }.subspan(section.raw_data_offset, std::min<std::size_t>(section.raw_data_size, bytes.size() - section.raw_data_offset));
+
+	return resource_tree{ raw_data, directory.virtual_address - section.virtual_address, section.virtual_address };
+}
+
+pe_file::save_strategy pe_file::save(const std::string_view file_path,
+                                     const resource_tree&   resources) const
+{
+	static constexpr char RESOURCE_SECTION_NAME[] = ".rsrc";
+
+	stats_timer                      timer          = stats_timer{ stats_phase::write };
+	const std::optional<std::size_t> resource_index = find_resource_section();
+	const std::size_t                overlay_offset = get_overlay_offset();
+	std::error_code                  error          = {};
+	const bool                       same_file      = std::filesystem::equivalent(path, file_path, error);
+	std::vector<std::uint8_t>        section_data   = {};
+	section_header                   section        = {};
+	std::size_t                      section_index  = sections.size();
+	save_strategy                    strategy       = save_strategy::rewritten;
+
+	if (RESOURCE_DIRECTORY >= data_directories_count)
+	{
+		throw std::invalid_argument{ "Executable does not have a resource data directory!" };
+	}
+
+	if (resource_index.has_value())
+	{
+		section      = sections[*resource_index];
+		section_data = resources.serialize(section.virtual_address);
+
+		const bool last_in_file   = overlay_offset == std::min<std::size_t>(bytes.size(), static_cast<std::size_t>(section.raw_data_offset) + section.raw_data_size);
+		const bool last_in_memory = std::ranges::none_of(sections, [&section](const section_header& other)
+		{
+			return other.virtual_address > section.virtual_address;
+		});
+
+		if (fits_in_place(*resource_index, section_data.size()))
+		{
+			section_index = *resource_index;
+			strategy      = save_strategy::patched;
+		}
+		else if (last_in_file && last_in_memory)
+		{
+			// The resource section is the last one in the file and in memory, so it can grow where it is.
+			section_index = *resource_index;
+			strategy      = save_strategy::extended;
+		}
+	}
+
+	if (sections.size() == section_index)
+	{
+		const section_header& last_section = sections.back();
+		const std::size_t     table_end    = optional_header_offset + coff_header_obj.optional_header_size + (sections.size() + 1) * sizeof(section_header);
+		std::size_t           headers_end  = deserialize<std::uint32_t>(bytes, optional_header_offset + optional_header::SIZE_OF_HEADERS);
+
+		// The new section header must not overwrite the data of the first section.
+		for (const section_header& header : sections)
+		{
+			if (0 != header.raw_data_size)
+			{
+				headers_end = std::min<std::size_t>(headers_end, header.raw_data_offset);
+			}
+		}
+
+		if (table_end > headers_end)
+		{
+			throw std::runtime_error{ "There is no room in the headers for a new resource section!" };
+		}
+
+		section = {};
+		std::memcpy(section.name, RESOURCE_SECTION_NAME, sizeof(RESOURCE_SECTION_NAME));
+		section.virtual_address = align_up(last_section.virtual_address + std::max(last_section.virtual_size, last_section.raw_data_size), section_alignment);
+		section.raw_data_offset = align_up(static_cast<std::uint32_t>(overlay_offset), file_alignment);
+		section.characteristics = RESOURCE_CHARACTERISTICS;
+		section_data            = resources.serialize(section.virtual_address);
+	}
+
+	const bool          appended         = sections.size() == section_index;
+	const std::uint32_t old_raw_size     = appended ? 0 : section.raw_data_size;
+	const std::size_t   following_offset = appended ? overlay_offset : std::min<std::size_t>(bytes.size(), static_cast<std::size_t>(section.raw_data_offset) + old_raw_size);
+	const std::size_t   prefix_end       = std::min<std::size_t>(section.raw_data_offset, following_offset);
+
+	section.virtual_size = static_cast<std::uint32_t>(section_data.size());
+
+	// A patched section keeps its raw size, so nothing after it moves.
+	if (save_strategy::patched != strategy)
+	{
+		section.raw_data_size = align_up(section.virtual_size, file_alignment);
+	}
+
+	section_data.resize(section.raw_data_size);
+
+	const std::size_t  new_following_offset = static_cast<std::size_t>(section.raw_data_offset) + section.raw_data_size;
+	const std::int64_t following_shift      = static_cast<std::int64_t>(new_following_offset) - static_cast<std::int64_t>(following_offset);
+	const std::size_t  headers_size         = std::min(bytes.size(), align_up(optional_header_offset + coff_header_obj.optional_header_size +
+	                                                                              (sections.size() + (appended ? 1 : 0)) * sizeof(section_header),
+	                                                                          sizeof(std::uint16_t)));
+	std::vector<std::uint8_t> headers        = { bytes.begin(), bytes.begin() + headers_size };
+	std::uint32_t             image_size     = deserialize<std::uint32_t>(bytes, optional_header_offset + optional_header::SIZE_OF_IMAGE);
+	std::uint32_t             initialized    = deserialize<std::uint32_t>(bytes, optional_header_offset + optional_header::SIZE_OF_INITIALIZED);
+	const std::uint32_t       checksum       = deserialize<std::uint32_t>(bytes, optional_header_offset + optional_header::CHECKSUM);
+
+	// Only the headers change outside of the section and the data following it.
+	if (appended)
+	{
+		coff_header header = coff_header_obj;
+
+		++header.sections_count;
+		serialize(header, headers, coff_header_offset);
+	}
+
+	image_size   = std::max(image_size, align_up(section.virtual_address + section.virtual_size, section_alignment));
+	initialized += section.raw_data_size - old_raw_size;
+
+	serialize(section, headers, optional_header_offset + coff_header_obj.optional_header_size + section_index * sizeof(section_header));
+	serialize(image_size, headers, optional_header_offset + optional_header::SIZE_OF_IMAGE);
+	serialize(initialized, headers, optional_header_offset + optional_header::SIZE_OF_INITIALIZED);
+	serialize(data_directory{ section.virtual_address, section.virtual_size }, headers, data_directory_offset(RESOURCE_DIRECTORY));
+
+	// File offsets pointing into the moved data have to follow it.
+	if (SECURITY_DIRECTORY < data_directories_count)
+	{
+		data_directory security = deserialize<data_directory>(headers, data_directory_offset(SECURITY_DIRECTORY));
+
+		if (0 != security.virtual_address && following_offset <= security.virtual_address)
+		{
+			security.virtual_address += static_cast<std::uint32_t>(following_shift);
+			serialize(security, headers, data_directory_offset(SECURITY_DIRECTORY));
+		}
+	}
+
+	if (0 != coff_header_obj.symbol_table_offset && following_offset <= coff_header_obj.symbol_table_offset)
+	{
+		coff_header header = deserialize<coff_header>(headers, coff_header_offset);
+
+		header.symbol_table_offset += static_cast<std::uint32_t>(following_shift);
+		serialize(header, headers, coff_header_offset);
+	}
+
+	const std::span<const std::uint8_t>       prefix    = std::span{ bytes }.subspan(headers_size, prefix_end - std::min(prefix_end, headers_size));
+	const std::vector<std::uint8_t>           padding   = std::vector<std::uint8_t>(section.raw_data_offset - std::max(prefix_end, headers_size));
+	const std::span<const std::uint8_t>       following = std::span{ bytes }.subspan(following_offset);
+	const std::span<const std::uint8_t>       pieces[]  = { headers, prefix, padding, section_data, following };
+
+	if (0 != checksum)
+	{
+		serialize(std::uint32_t{ 0 }, headers, optional_header_offset + optional_header::CHECKSUM);
+		serialize(compute_checksum(pieces), headers, optional_header_offset + optional_header::CHECKSUM);
+	}
+
+	if (save_strategy::rewritten != strategy && same_file)
+	{
+		timer.next(stats_phase::commit);
+		write_in_place(file_path, headers, section.raw_data_offset, section_data, following, new_following_offset);
+		return strategy;
+	}
+
+	// The image is assembled in memory and written with a single write.
+	std::vector<std::uint8_t> image = {};
+
+	image.reserve(new_following_offset + following.size());
+
+	for (const std::span<const std::uint8_t> piece : pieces)
+	{
+		image.insert(image.end(), piece.begin(), piece.end());
+	}
+
+	timer.next(stats_phase::commit);
+	write_file(file_path, image);
+	return save_strategy::rewritten;
+}
+
+std::string_view pe_file::to_string(const save_strategy strategy) noexcept
+{
+	switch (strategy)
+	{
+		case save_strategy::patched:
+			return "resource section patched in place";
+		case save_strategy::extended:
+			return "resource section extended in place";
+		case save_strategy::rewritten:
+			return "executable rewritten";
+		case save_strategy::unchanged:
+			return "executable already up to date";
+	}
+
+	return "unknown";
+}
+
+void pe_file::read_headers()
+{
+	static constexpr std::uint16_t MZ_SIGNATURE = 0x5A4D;
+	static constexpr std::uint32_t PE_SIGNATURE = 0x00004550;
+	static constexpr std::uint16_t PE32_MAGIC   = 0x010B;
+	static constexpr std::uint16_t PE64_MAGIC   = 0x020B;
+
+	const dos_header dos_header_obj = deserialize<dos_header>(bytes, 0);
+
+	if (MZ_SIGNATURE != dos_header_obj.magic)
+	{
+		throw std::invalid_argument{ "Executable does not start with the MZ signature!" };
+	}
+
+	if (PE_SIGNATURE != deserialize<std::uint32_t>(bytes, dos_header_obj.pe_header_offset))
+	{
+		throw std::invalid_argument{ "Executable does not have the PE signature!" };
+	}
+
+	coff_header_offset     = dos_header_obj.pe_header_offset + sizeof(PE_SIGNATURE);
+	coff_header_obj        = deserialize<coff_header>(bytes, coff_header_offset);
+	optional_header_offset = coff_header_offset + sizeof(coff_header);
+
+	const std::uint16_t magic = deserialize<std::uint16_t>(bytes, optional_header_offset + optional_header::MAGIC);
+
+	if (PE32_MAGIC != magic && PE64_MAGIC != magic)
+	{
+		throw std::invalid_argument{ std::format("Optional header magic 0x{:X} is invalid!", magic) };
+	}
+
+	const std::size_t directories_count_offset =
+	    optional_header_offset + (PE64_MAGIC == magic ? optional_header::PE64_DIRECTORIES_COUNT : optional_header::PE32_DIRECTORIES_COUNT);
+
+	data_directories_count  = deserialize<std::uint32_t>(bytes, directories_count_offset);
+	data_directories_offset = directories_count_offset + sizeof(data_directories_count);
+	section_alignment       = deserialize<std::uint32_t>(bytes, optional_header_offset + optional_header::SECTION_ALIGNMENT);
+	file_alignment          = deserialize<std::uint32_t>(bytes, optional_header_offset + optional_header::FILE_ALIGNMENT);
+
+	if (data_directories_offset + data_directories_count * sizeof(data_directory) > optional_header_offset + coff_header_obj.optional_header_size)
+	{
+		throw std::invalid_argument{ std::format("{} data directories do not fit in the optional header!", data_directories_count) };
+	}
+
+	if (0 == section_alignment || 0 != (section_alignment & (section_alignment - 1)))
+	{
+		throw std::invalid_argument{ std::format("Section alignment 0x{:X} is not a power of 2!", section_alignment) };
+	}
+
+	if (0 == file_alignment || 0 != (file_alignment & (file_alignment - 1)))
+	{
+		throw std::invalid_argument{ std::format("File alignment 0x{:X} is not a power of 2!", file_alignment) };
+	}
+}
+
+void pe_file::read_sections()
+{
+	const std::size_t section_table_offset = optional_header_offset + coff_header_obj.optional_header_size;
+	const std::size_t headers_size         = std::max<std::size_t>(deserialize<std::uint32_t>(bytes, optional_header_offset + optional_header::SIZE_OF_HEADERS),
+	                                                               section_table_offset + coff_header_obj.sections_count * sizeof(section_header));
+
+	if (0 == coff_header_obj.sections_count)
+	{
+		throw std::invalid_argument{ "Executable does not have sections!" };
+	}
+
+	for (std::size_t index = 0; index < coff_header_obj.sections_count; ++index)
+	{
+		const section_header section = deserialize<section_header>(bytes, section_table_offset + index * sizeof(section_header));
+
+		if (section.raw_data_offset > bytes.size())
+		{
+			throw std::invalid_argument{ std::format("Section {} starts beyond the end of file!", index) };
+		}
+
+		// Empty sections (e.g. uninitialized data) have no raw data, whatever their offset.
+		if (0 != section.raw_data_size && headers_size > section.raw_data_offset)
+		{
+			throw std::invalid_argument{ std::format("Section {} starts at offset 0x{:X}, inside the 0x{:X} bytes of headers!", index,
+			                                         section.raw_data_offset, headers_size) };
+		}
+
+		sections.push_back(section);
+	}
+}
+
+std::optional<std::size_t> pe_file::find_resource_section() const
+{
+	if (RESOURCE_DIRECTORY >= data_directories_count)
+	{
+		return std::nullopt;
+	}
+
+	const data_directory directory = deserialize<data_directory>(bytes, data_directory_offset(RESOURCE_DIRECTORY));
+
+	if (0 == directory.virtual_address)
+	{
+		return std::nullopt;
+	}
+
+	for (std::size_t index = 0; index < sections.size(); ++index)
+	{
+		const section_header& section = sections[index];
+
+		if (section.virtual_address <= directory.virtual_address &&
+		    directory.virtual_address - section.virtual_address < std::max(section.virtual_size, section.raw_data_size))
+		{
+			return index;
+		}
+	}
+
+	throw std::invalid_argument{ std::format("Resource directory at RVA 0x{:X} is not inside any section!", directory.virtual_address) };
+}
+
+std::size_t pe_file::get_overlay_offset() const noexcept
+{
+	std::size_t overlay_offset = 0;
+
+	for (const section_header& header : sections)
+	{
+		overlay_offset = std::max<std::size_t>(overlay_offset, static_cast<std::size_t>(header.raw_data_offset) + header.raw_data_size);
+	}
+
+	return std::min(overlay_offset, bytes.size());
+}
+
+bool pe_file::fits_in_place(const std::size_t index,
+                            const std::size_t size) const noexcept
+{
+	const section_header& section = sections[index];
+
+	if (size > section.raw_data_size || static_cast<std::size_t>(section.raw_data_offset) + section.raw_data_size > bytes.size())
+	{
+		return false;
+	}
+
+	// The section must not grow into the address range of the next one.
+	for (const section_header& other : sections)
+	{
+		if (other.virtual_address > section.virtual_address && size > other.virtual_address - section.virtual_address)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void pe_file::write_in_place(const std::string_view              file_path,
+                             const std::span<const std::uint8_t> headers,
+                             const std::size_t                   section_offset,
+                             const std::span<const std::uint8_t> section_data,
+                             const std::span<const std::uint8_t> following,
+                             const std::size_t                   following_offset) const
+{
+	const std::size_t old_following_offset = bytes.size() - following.size();
+	std::fstream      file                 = std::fstream{ std::filesystem::path{ file_path }, std::ios::in | std::ios::out | std::ios::binary };
+
+	if (!file.is_open())
+	{
+		throw std::runtime_error{ std::format("Failed to open \"{}\" for writing!", file_path) };
+	}
+
+	try
+	{
+		file.exceptions(std::fstream::failbit | std::fstream::badbit);
+
+		// The data following the section is read back from the file a chunk at a time rather than through a mapping of it, the last chunk
+		// first when it moves forward: no chunk then overwrites data that was not read yet.
+		if (following_offset != old_following_offset)
+		{
+			const bool        forward = following_offset > old_following_offset;
+			std::vector<char> chunk   = std::vector<char>(std::min(following.size(), MOVE_CHUNK_SIZE));
+
+			for (std::size_t moved = 0; moved < following.size(); moved += chunk.size())
+			{
+				chunk.resize(std::min(chunk.size(), following.size() - moved));
+
+				const std::size_t offset = forward ? following.size() - moved - chunk.size() : moved;
+
+				file.seekg(static_cast<std::streamoff>(old_following_offset + offset));
+				file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+				file.seekp(static_cast<std::streamoff>(following_offset + offset));
+				file.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+			}
+
+			count_stat(stats_counter::bytes_read, following.size());
+		}
+
+		file.seekp(static_cast<std::streamoff>(section_offset));
+		file.write(reinterpret_cast<const char*>(section_data.data()), static_cast<std::streamsize>(section_data.size()));
+
+		file.seekp(0);
+		file.write(reinterpret_cast<const char*>(headers.data()), static_cast<std::streamsize>(headers.size()));
+		file.close();
+
+		count_stat(stats_counter::bytes_written, (following_offset != old_following_offset ? following.size() : 0) + section_data.size() + headers.size());
+	}
+	catch (const std::exception& exception)
+	{
+		throw std::runtime_error{ std::format("Failed to patch \"{}\" in place!", file_path) };
+	}
+}
+
+std::size_t pe_file::data_directory_offset(const std::size_t index) const
+{
+	assert(index < data_directories_count);
+	return data_directories_offset + index * sizeof(data_directory);
+}
+
+std::uint32_t pe_file::compute_checksum(const std::span<const std::span<const std::uint8_t>> pieces) noexcept
+{
+	std::uint64_t sum      = 0;
+	std::size_t   size     = 0;
+	std::uint16_t word     = 0;
+	bool          low_byte = false;
+
+	// Words may straddle two pieces, so the image is summed as one byte stream.
+	for (const std::span<const std::uint8_t> piece : pieces)
+	{
+		std::size_t offset = 0;
+
+		if (low_byte && !piece.empty())
+		{
+			word     |= static_cast<std::uint16_t>(piece.front() << 8);
+			sum      += word;
+			sum       = (sum & 0xFFFF) + (sum >> 16);
+			low_byte  = false;
+			offset    = 1;
+		}
+
+		for (; offset + sizeof(word) <= piece.size(); offset += sizeof(word))
+		{
+			std::memcpy(&word, piece.data() + offset, sizeof(word));
+			sum += word;
+			sum  = (sum & 0xFFFF) + (sum >> 16);
+		}
+
+		if (offset < piece.size())
+		{
+			word     = piece[offset];
+			low_byte = true;
+		}
+
+		size += piece.size();
+	}
+
+	if (low_byte)
+	{
+		sum += word;
+		sum  = (sum & 0xFFFF) + (sum >> 16);
+	}
+
+	sum = (sum & 0xFFFF) + (sum >> 16);
+	return static_cast<std::uint32_t>(sum + size);
+}
+
+} // namespace icon_changer
@@ -0,0 +1,279 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "resource_tree.hpp"
+#include "utility.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief Represents a Windows executable in PE32 or PE32+ format.
+/// \details It parses the headers and the section table, reads the resource
+/// directory and writes the executable back with the new resource section,
+/// touching as little of the file as possible.
+/// \see https://learn.microsoft.com/en-us/windows/win32/debug/pe-format
+///
+class pe_file final
+{
+public:
+	///
+	/// \brief This data structure corresponds to IMAGE_DOS_HEADER.
+	///
+	struct PACKED dos_header final
+	{
+		std::uint16_t magic;            ///< Signature, must be "MZ".
+		std::uint8_t  unused[58];       ///< Fields used only by MS-DOS.
+		std::uint32_t pe_header_offset; ///< Offset of the PE signature from the beginning of file.
+	};
+
+	///
+	/// \brief This data structure corresponds to IMAGE_FILE_HEADER.
+	///
+	struct PACKED coff_header final
+	{
+		std::uint16_t machine;              ///< Type of the target machine.
+		std::uint16_t sections_count;       ///< Number of entries in the section table.
+		std::uint32_t time_date_stamp;      ///< Time the file was created.
+		std::uint32_t symbol_table_offset;  ///< Offset of the COFF symbol table, 0 if not present.
+		std::uint32_t symbols_count;        ///< Number of entries in the symbol table.
+		std::uint16_t optional_header_size; ///< Size of the optional header in bytes.
+		std::uint16_t characteristics;      ///< Flags indicating the attributes of the file.
+	};
+
+	///
+	/// \brief This data structure corresponds to IMAGE_DATA_DIRECTORY.
+	///
+	struct PACKED data_directory final
+	{
+		std::uint32_t virtual_address; ///< Relative virtual address of the table.
+		std::uint32_t size;            ///< Size of the table in bytes.
+	};
+
+	///
+	/// \brief This data structure corresponds to IMAGE_SECTION_HEADER.
+	///
+	struct PACKED section_header final
+	{
+		char          name[8];             ///< Name of the section, padded with null bytes.
+		std::uint32_t virtual_size;        ///< Size of the section when loaded into memory.
+		std::uint32_t virtual_address;     ///< Relative virtual address of the section.
+		std::uint32_t raw_data_size;       ///< Size of the initialized data on disk.
+		std::uint32_t raw_data_offset;     ///< Offset of the section data from the beginning of file.
+		std::uint32_t relocations_offset;  ///< Offset of the relocation entries, 0 for executables.
+		std::uint32_t line_numbers_offset; ///< Offset of the line-number entries, deprecated.
+		std::uint16_t relocations_count;   ///< Number of relocation entries.
+		std::uint16_t line_numbers_count;  ///< Number of line-number entries.
+		std::uint32_t characteristics;     ///< Flags describing the characteristics of the section.
+	};
+
+	///
+	/// \brief How the executable was written by save().
+	///
+	enum class save_strategy
+	{
+		patched,   ///< The resource section was overwritten where it is, within its raw size.
+		extended,  ///< The resource section is the last one and was grown in place.
+		rewritten, ///< The whole executable was written to a new file which replaced it.
+		unchanged  ///< The executable already had the resources, so it was not written.
+	};
+
+public:
+	///
+	/// \brief Reads the executable and parses its headers and section table.
+	/// \param file_path: Path to the executable.
+	///
+	pe_file(std::string_view file_path);
+
+	///
+	/// \brief Parses the headers and section table of an executable in memory.
+	/// \details No bytes are copied, so a mapped executable only has the pages
+	/// of its headers, and of the resources that are read, brought into memory.
+	/// Saving it over its own file in place only writes the changed parts, the
+	/// data that moves being read back from the file in small chunks.
+	/// \param file_path: Path to the executable, used for error messages.
+	/// \param file_data: The content of the executable (e.g. memory mapped), it
+	/// must outlive this object and the resource trees read from it.
+	///
+	pe_file(std::string_view              file_path,
+	        std::span<const std::uint8_t> file_data);
+
+	///
+	/// \brief Parses the resource directory of the executable.
+	/// \returns The resource tree, empty if the executable has no resources.
+	/// The tree keeps views into this object which must outlive it.
+	///
+	[[nodiscard]] resource_tree read_resources() const;
+
+	///
+	/// \brief Writes the executable with the given resources.
+	/// \details When saving over the file that was read, a resource section
+	/// whose raw size fits the new resources is overwritten where it is and a
+	/// last resource section is grown in place, so only the headers, the
+	/// section and the data following it are written. Otherwise the whole
+	/// executable is written to a temporary file which then replaces the
+	/// original, with the resources in the last section or in a new one.
+	/// Data following the last section (e.g. signatures, installer payloads)
+	/// is preserved.
+	/// \param file_path: Path of the executable to be written.
+	/// \param resources: The complete resource tree of the new executable.
+	/// \returns How the executable was written.
+	///
+	save_strategy save(std::string_view     file_path,
+	                   const resource_tree& resources) const;
+
+	///
+	/// \brief Gets a description of a save strategy for the user.
+	/// \param strategy: The save strategy.
+	/// \returns The description.
+	///
+	[[nodiscard]] static std::string_view to_string(save_strategy strategy) noexcept;
+
+private:
+	///
+	/// \brief Reads the DOS, COFF and optional headers and validates them.
+	///
+	void read_headers();
+
+	///
+	/// \brief Reads the section table.
+	///
+	void read_sections();
+
+	///
+	/// \brief Finds the section containing the resource directory.
+	/// \returns The index of the section or nothing if there are no resources.
+	///
+	[[nodiscard]] std::optional<std::size_t> find_resource_section() const;
+
+	///
+	/// \brief Gets the offset of a data directory from the beginning of file.
+	/// \param index: The index of the data directory (e.g. 2 for resources).
+	/// \returns The file offset of the data directory.
+	///
+	[[nodiscard]] std::size_t data_directory_offset(std::size_t index) const;
+
+	///
+	/// \brief Gets the offset where the data following the last section starts.
+	/// \returns The offset of the overlay, the file size if there is none.
+	///
+	[[nodiscard]] std::size_t get_overlay_offset() const noexcept;
+
+	///
+	/// \brief Checks whether new resources can overwrite a resource section
+	/// without moving anything.
+	/// \param index: The index of the resource section.
+	/// \param size: The size of the new resource data.
+	/// \returns true if the data fits the raw size and the virtual space of the section.
+	///
+	[[nodiscard]] bool fits_in_place(std::size_t index,
+	                                 std::size_t size) const noexcept;
+
+	///
+	/// \brief Writes the changed parts of the executable over the original file.
+	/// \details The data is written before the headers pointing to it.
+	/// \param file_path: Path of the executable.
+	/// \param headers: The new headers, written at the beginning of file.
+	/// \param section_offset: Offset of the resource section in the file.
+	/// \param section_data: The new raw data of the resource section.
+	/// \param following: The data following the resource section, moved only if its offset changed.
+	/// \param following_offset: The new offset of the data following the resource section.
+	///
+	void write_in_place(std::string_view              file_path,
+	                    std::span<const std::uint8_t> headers,
+	                    std::size_t                   section_offset,
+	                    std::span<const std::uint8_t> section_data,
+	                    std::span<const std::uint8_t> following,
+	                    std::size_t                   following_offset) const;
+
+	///
+	/// \brief Computes the PE checksum of an executable image.
+	/// \param pieces: The raw bytes of the executable, in consecutive pieces.
+	/// The checksum field must be zero.
+	/// \returns The checksum as computed by the Windows image loader.
+	///
+	[[nodiscard]] static std::uint32_t compute_checksum(std::span<const std::span<const std::uint8_t>> pieces) noexcept;
+
+private:
+	///
+	/// \brief The path of the executable.
+	///
+	std::filesystem::path path;
+
+	///
+	/// \brief The executable read into memory, empty if it was given in memory.
+	///
+	std::vector<std::uint8_t> buffer;
+
+	///
+	/// \brief The raw bytes of the executable, in the buffer or given in memory.
+	///
+	std::span<const std::uint8_t> bytes;
+
+	///
+	/// \brief The COFF file header.
+	///
+	coff_header coff_header_obj;
+
+	///
+	/// \brief Offset of the COFF file header from the beginning of file.
+	///
+	std::size_t coff_header_offset;
+
+	///
+	/// \brief Offset of the optional header from the beginning of file.
+	///
+	std::size_t optional_header_offset;
+
+	///
+	/// \brief Offset of the first data directory from the beginning of file.
+	///
+	std::size_t data_directories_offset;
+
+	///
+	/// \brief Number of data directories in the optional header.
+	///
+	std::uint32_t data_directories_count;
+
+	///
+	/// \brief Alignment of the sections when loaded into memory.
+	///
+	std::uint32_t section_alignment;
+
+	///
+	/// \brief Alignment of the raw data of sections in the file.
+	///
+	std::uint32_t file_alignment;
+
+	///
+	/// \brief The section table.
+	///
+	std::vector<section_header> sections;
+};
+
+} // namespace icon_changer
@@ -0,0 +1,980 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include "pixel_kernels.hpp"
+
+#include <array>
+#include <cstdlib>
+#include <cstring>
+
+#include "field_layout.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTANTS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief Every byte with its bits in reverse order.
+/// \details The vector mask of a byte has its first pixel in the least
+/// significant bit, a DIB mask in the most significant one.
+///
+static constexpr std::array<std::uint8_t, 256> REVERSED_BITS = []()
+{
+	std::array<std::uint8_t, 256> table = {};
+
+	for (std::size_t index = 0; index < table.size(); ++index)
+	{
+		for (std::size_t bit = 0; bit < 8; ++bit)
+		{
+			table[index] |= static_cast<std::uint8_t>(((index >> bit) & 1) << (7 - bit));
+		}
+	}
+
+	return table;
+}();
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Expands 24bpp BGR pixels into opaque 32bpp BGRA ones, see pixel_kernels::expand_bgr.
+/// \param source: The BGR pixels.
+/// \param destination: The BGRA pixels.
+///
+static void expand_bgr_scalar(std::span<const std::uint8_t> source,
+                              std::span<std::uint8_t>       destination) noexcept;
+
+///
+/// \brief Looks up palette indices into BGRA pixels, see pixel_kernels::expand_palette.
+/// \param indices: The indices.
+/// \param palette: The colors.
+/// \param destination: The BGRA pixels.
+///
+static void expand_palette_scalar(std::span<const std::uint8_t>       indices,
+                                  std::span<const std::uint32_t, 256> palette,
+                                  std::span<std::uint8_t>             destination) noexcept;
+
+///
+/// \brief Copies rows in reverse order, see pixel_kernels::flip_rows.
+/// \param source: The rows.
+/// \param destination: The flipped rows.
+/// \param row_size: Size of a row in bytes.
+///
+static void flip_rows_scalar(std::span<const std::uint8_t> source,
+                             std::span<std::uint8_t>       destination,
+                             std::size_t                   row_size) noexcept;
+
+///
+/// \brief Multiplies colors by their alpha, see pixel_kernels::premultiply.
+/// \param pixels: The BGRA pixels.
+///
+static void premultiply_scalar(std::span<std::uint8_t> pixels) noexcept;
+
+///
+/// \brief Packs a row of the AND mask, see pixel_kernels::pack_and_mask.
+/// \param pixels: The BGRA pixels of the row.
+/// \param mask: The mask row.
+///
+static void pack_and_mask_scalar(std::span<const std::uint8_t> pixels,
+                                 std::span<std::uint8_t>       mask) noexcept;
+
+///
+/// \brief Swaps the red and blue channels, see pixel_kernels::swap_red_blue.
+/// \param source: The pixels.
+/// \param destination: The swapped pixels.
+///
+static void swap_red_blue_scalar(std::span<const std::uint8_t> source,
+                                 std::span<std::uint8_t>       destination) noexcept;
+
+///
+/// \brief Reverses the filter of a PNG row, see pixel_kernels::unfilter.
+/// \param filter: The filter type.
+/// \param row: The filtered row.
+/// \param previous: The row above.
+/// \param pixel_size: Bytes per pixel.
+///
+static void unfilter_scalar(std::uint8_t                  filter,
+                            std::span<std::uint8_t>       row,
+                            std::span<const std::uint8_t> previous,
+                            std::size_t                   pixel_size) noexcept;
+
+///
+/// \brief Predicts a byte with the Paeth filter.
+/// \param left: The byte of the pixel to the left.
+/// \param up: The byte of the pixel above.
+/// \param up_left: The byte of the pixel above and to the left.
+/// \returns Whichever of the 3 is closest to left + up - up_left.
+///
+static std::uint8_t predict_paeth(std::uint8_t left,
+                                  std::uint8_t up,
+                                  std::uint8_t up_left) noexcept;
+
+#if defined(__x86_64__) || defined(__i386__)
+///
+/// \brief expand_bgr_scalar() 4 pixels at a time, with a byte shuffle.
+///
+__attribute__((target("sse4.2"))) static void expand_bgr_sse4_2(std::span<const std::uint8_t> source,
+                                                                std::span<std::uint8_t>       destination) noexcept;
+
+///
+/// \brief expand_palette_scalar() storing 4 pixels at a time.
+///
+__attribute__((target("sse4.2"))) static void expand_palette_sse4_2(std::span<const std::uint8_t>       indices,
+                                                                    std::span<const std::uint32_t, 256> palette,
+                                                                    std::span<std::uint8_t>             destination) noexcept;
+
+///
+/// \brief flip_rows_scalar() copying 16 bytes at a time.
+///
+__attribute__((target("sse4.2"))) static void flip_rows_sse4_2(std::span<const std::uint8_t> source,
+                                                               std::span<std::uint8_t>       destination,
+                                                               std::size_t                   row_size) noexcept;
+
+///
+/// \brief premultiply_scalar() 4 pixels at a time, in 16-bit lanes.
+///
+__attribute__((target("sse4.2"))) static void premultiply_sse4_2(std::span<std::uint8_t> pixels) noexcept;
+
+///
+/// \brief pack_and_mask_scalar() 16 pixels at a time.
+///
+__attribute__((target("sse4.2"))) static void pack_and_mask_sse4_2(std::span<const std::uint8_t> pixels,
+                                                                   std::span<std::uint8_t>       mask) noexcept;
+
+///
+/// \brief swap_red_blue_scalar() 4 pixels at a time, with a byte shuffle.
+///
+__attribute__((target("sse4.2"))) static void swap_red_blue_sse4_2(std::span<const std::uint8_t> source,
+                                                                   std::span<std::uint8_t>       destination) noexcept;
+
+///
+/// \brief unfilter_scalar() 16 bytes at a time for Up, a 3 or 4 byte pixel at a time otherwise.
+///
+__attribute__((target("sse4.2"))) static void unfilter_sse4_2(std::uint8_t                  filter,
+                                                              std::span<std::uint8_t>       row,
+                                                              std::span<const std::uint8_t> previous,
+                                                              std::size_t                   pixel_size) noexcept;
+
+///
+/// \brief Loads a pixel of up to 4 bytes into the low lane of a register.
+/// \param bytes: The pixel.
+/// \param size: Bytes of the pixel.
+/// \returns The register, the bytes past the pixel being 0.
+///
+__attribute__((target("sse4.2"))) static __m128i load_pixel_sse4_2(const std::uint8_t* bytes,
+                                                                   std::size_t         size) noexcept;
+
+///
+/// \brief Stores a pixel of up to 4 bytes from the low lane of a register.
+/// \param pixel: The register.
+/// \param bytes: Where the pixel goes.
+/// \param size: Bytes of the pixel.
+///
+__attribute__((target("sse4.2"))) static void store_pixel_sse4_2(__m128i       pixel,
+                                                                 std::uint8_t* bytes,
+                                                                 std::size_t   size) noexcept;
+
+///
+/// \brief expand_bgr_scalar() 8 pixels at a time, with a byte shuffle.
+///
+__attribute__((target("avx2"))) static void expand_bgr_avx2(std::span<const std::uint8_t> source,
+                                                            std::span<std::uint8_t>       destination) noexcept;
+
+///
+/// \brief expand_palette_scalar() gathering 8 pixels at a time.
+///
+__attribute__((target("avx2"))) static void expand_palette_avx2(std::span<const std::uint8_t>       indices,
+                                                                std::span<const std::uint32_t, 256> palette,
+                                                                std::span<std::uint8_t>             destination) noexcept;
+
+///
+/// \brief flip_rows_scalar() copying 32 bytes at a time.
+///
+__attribute__((target("avx2"))) static void flip_rows_avx2(std::span<const std::uint8_t> source,
+                                                           std::span<std::uint8_t>       destination,
+                                                           std::size_t                   row_size) noexcept;
+
+///
+/// \brief premultiply_scalar() 8 pixels at a time, in 16-bit lanes.
+///
+__attribute__((target("avx2"))) static void premultiply_avx2(std::span<std::uint8_t> pixels) noexcept;
+
+///
+/// \brief pack_and_mask_scalar() 32 pixels at a time.
+///
+__attribute__((target("avx2"))) static void pack_and_mask_avx2(std::span<const std::uint8_t> pixels,
+                                                               std::span<std::uint8_t>       mask) noexcept;
+
+///
+/// \brief swap_red_blue_scalar() 8 pixels at a time, with a byte shuffle.
+///
+__attribute__((target("avx2"))) static void swap_red_blue_avx2(std::span<const std::uint8_t> source,
+                                                               std::span<std::uint8_t>       destination) noexcept;
+
+///
+/// \brief unfilter_scalar() 32 bytes at a time for Up, as unfilter_sse4_2() otherwise.
+///
+__attribute__((target("avx2"))) static void unfilter_avx2(std::uint8_t                  filter,
+                                                          std::span<std::uint8_t>       row,
+                                                          std::span<const std::uint8_t> previous,
+                                                          std::size_t                   pixel_size) noexcept;
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+///
+/// \brief expand_bgr_scalar() 16 pixels at a time, with interleaved loads and stores.
+///
+static void expand_bgr_neon(std::span<const std::uint8_t> source,
+                            std::span<std::uint8_t>       destination) noexcept;
+
+///
+/// \brief flip_rows_scalar() copying 16 bytes at a time.
+///
+static void flip_rows_neon(std::span<const std::uint8_t> source,
+                           std::span<std::uint8_t>       destination,
+                           std::size_t                   row_size) noexcept;
+
+///
+/// \brief premultiply_scalar() 16 pixels at a time, one channel per register.
+///
+static void premultiply_neon(std::span<std::uint8_t> pixels) noexcept;
+
+///
+/// \brief pack_and_mask_scalar() 16 pixels at a time.
+///
+static void pack_and_mask_neon(std::span<const std::uint8_t> pixels,
+                               std::span<std::uint8_t>       mask) noexcept;
+
+///
+/// \brief swap_red_blue_scalar() 16 pixels at a time, with interleaved loads and stores.
+///
+static void swap_red_blue_neon(std::span<const std::uint8_t> source,
+                               std::span<std::uint8_t>       destination) noexcept;
+
+///
+/// \brief unfilter_scalar() 16 bytes at a time for Up.
+///
+static void unfilter_neon(std::uint8_t                  filter,
+                          std::span<std::uint8_t>       row,
+                          std::span<const std::uint8_t> previous,
+                          std::size_t                   pixel_size) noexcept;
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief The portable kernels.
+///
+static constexpr pixel_kernels SCALAR_KERNELS = { pixel_isa::scalar, expand_bgr_scalar, expand_palette_scalar, flip_rows_scalar, premultiply_scalar, pack_and_mask_scalar,
+                                                  swap_red_blue_scalar, unfilter_scalar };
+
+#if defined(__x86_64__) || defined(__i386__)
+///
+/// \brief The SSE4.2 kernels.
+///
+static constexpr pixel_kernels SSE4_2_KERNELS = { pixel_isa::sse4_2, expand_bgr_sse4_2, expand_palette_sse4_2, flip_rows_sse4_2, premultiply_sse4_2, pack_and_mask_sse4_2,
+                                                  swap_red_blue_sse4_2, unfilter_sse4_2 };
+
+///
+/// \brief The AVX2 kernels.
+///
+static constexpr pixel_kernels AVX2_KERNELS = { pixel_isa::avx2, expand_bgr_avx2, expand_palette_avx2, flip_rows_avx2, premultiply_avx2, pack_and_mask_avx2,
+                                                swap_red_blue_avx2, unfilter_avx2 };
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+///
+/// \brief The NEON kernels.
+/// \details NEON has no gather, its palette lookup is the scalar one.
+///
+static constexpr pixel_kernels NEON_KERNELS = { pixel_isa::neon, expand_bgr_neon, expand_palette_scalar, flip_rows_neon, premultiply_neon, pack_and_mask_neon,
+                                                swap_red_blue_neon, unfilter_neon };
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+const pixel_kernels& get_pixel_kernels() noexcept
+{
+	static const pixel_kernels& selected = []() -> const pixel_kernels&
+	{
+		for (const pixel_isa isa : { pixel_isa::avx2, pixel_isa::neon, pixel_isa::sse4_2 })
+		{
+			if (const pixel_kernels* const kernels = get_pixel_kernels(isa); nullptr != kernels)
+			{
+				return *kernels;
+			}
+		}
+
+		return SCALAR_KERNELS;
+	}();
+
+	return selected;
+}
+
+const pixel_kernels* get_pixel_kernels(const pixel_isa isa) noexcept
+{
+	switch (isa)
+	{
+		case pixel_isa::scalar:
+			return &SCALAR_KERNELS;
+#if defined(__x86_64__) || defined(__i386__)
+		case pixel_isa::sse4_2:
+			return __builtin_cpu_supports("sse4.2") ? &SSE4_2_KERNELS : nullptr;
+		case pixel_isa::avx2:
+			return __builtin_cpu_supports("avx2") ? &AVX2_KERNELS : nullptr;
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+		case pixel_isa::neon:
+			return &NEON_KERNELS;
+#endif
+		default:
+			return nullptr;
+	}
+}
+
+static void expand_bgr_scalar(const std::span<const std::uint8_t> source,
+                              const std::span<std::uint8_t>       destination) noexcept
+{
+	for (std::size_t x = 0; x < destination.size() / 4; ++x)
+	{
+		destination[x * 4]     = source[x * 3];
+		destination[x * 4 + 1] = source[x * 3 + 1];
+		destination[x * 4 + 2] = source[x * 3 + 2];
+		destination[x * 4 + 3] = 0xFF;
+	}
+}
+
+static void expand_palette_scalar(const std::span<const std::uint8_t>       indices,
+                                  const std::span<const std::uint32_t, 256> palette,
+                                  const std::span<std::uint8_t>             destination) noexcept
+{
+	for (std::size_t x = 0; x < destination.size() / 4; ++x)
+	{
+		store_little_endian(palette[indices[x]], destination.data() + x * 4);
+	}
+}
+
+static void flip_rows_scalar(const std::span<const std::uint8_t> source,
+                             const std::span<std::uint8_t>       destination,
+                             const std::size_t                   row_size) noexcept
+{
+	const std::size_t rows = source.size() / row_size;
+
+	for (std::size_t y = 0; y < rows; ++y)
+	{
+		std::memcpy(destination.data() + (rows - 1 - y) * row_size, source.data() + y * row_size, row_size);
+	}
+}
+
+static void premultiply_scalar(const std::span<std::uint8_t> pixels) noexcept
+{
+	for (std::size_t offset = 0; offset + 4 <= pixels.size(); offset += 4)
+	{
+		for (std::size_t channel = 0; channel < 3; ++channel)
+		{
+			// Dividing by 255 rounded to the nearest, exactly, without a division.
+			const std::uint32_t product = static_cast<std::uint32_t>(pixels[offset + channel]) * pixels[offset + 3] + 128;
+
+			pixels[offset + channel] = static_cast<std::uint8_t>((product + (product >> 8)) >> 8);
+		}
+	}
+}
+
+static void pack_and_mask_scalar(const std::span<const std::uint8_t> pixels,
+                                 const std::span<std::uint8_t>       mask) noexcept
+{
+	for (std::size_t x = 0; x < pixels.size() / 4; ++x)
+	{
+		if (0 == x % 8)
+		{
+			mask[x / 8] = 0;
+		}
+
+		if (0 == pixels[x * 4 + 3])
+		{
+			mask[x / 8] |= static_cast<std::uint8_t>(0x80 >> (x % 8));
+		}
+	}
+}
+
+static void swap_red_blue_scalar(const std::span<const std::uint8_t> source,
+                                 const std::span<std::uint8_t>       destination) noexcept
+{
+	for (std::size_t offset = 0; offset + 4 <= destination.size(); offset += 4)
+	{
+		const std::uint8_t red = source[offset];
+
+		destination[offset]     = source[offset + 2];
+		destination[offset + 1] = source[offset + 1];
+		destination[offset + 2] = red;
+		destination[offset + 3] = source[offset + 3];
+	}
+}
+
+static void unfilter_scalar(const std::uint8_t                  filter,
+                            const std::span<std::uint8_t>       row,
+                            const std::span<const std::uint8_t> previous,
+                            const std::size_t                   pixel_size) noexcept
+{
+	// The first pixel has no left neighbour, which the filters take as 0.
+	switch (filter)
+	{
+		case 1:
+			for (std::size_t x = pixel_size; x < row.size(); ++x)
+			{
+				row[x] = static_cast<std::uint8_t>(row[x] + row[x - pixel_size]);
+			}
+			break;
+		case 2:
+			for (std::size_t x = 0; x < row.size(); ++x)
+			{
+				row[x] = static_cast<std::uint8_t>(row[x] + previous[x]);
+			}
+			break;
+		case 3:
+			for (std::size_t x = 0; x < row.size(); ++x)
+			{
+				const std::uint32_t left = x >= pixel_size ? row[x - pixel_size] : 0;
+
+				row[x] = static_cast<std::uint8_t>(row[x] + ((left + previous[x]) >> 1));
+			}
+			break;
+		case 4:
+			for (std::size_t x = 0; x < row.size(); ++x)
+			{
+				const bool has_left = x >= pixel_size;
+
+				row[x] = static_cast<std::uint8_t>(row[x] + predict_paeth(has_left ? row[x - pixel_size] : 0, previous[x], has_left ? previous[x - pixel_size] : 0));
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+static std::uint8_t predict_paeth(const std::uint8_t left,
+                                  const std::uint8_t up,
+                                  const std::uint8_t up_left) noexcept
+{
+	const std::int32_t left_distance    = std::abs(static_cast<std::int32_t>(up) - up_left);
+	const std::int32_t up_distance      = std::abs(static_cast<std::int32_t>(left) - up_left);
+	const std::int32_t up_left_distance = std::abs(static_cast<std::int32_t>(left) + up - 2 * up_left);
+
+	if (left_distance <= up_distance && left_distance <= up_left_distance)
+	{
+		return left;
+	}
+
+	return up_distance <= up_left_distance ? up : up_left;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+__attribute__((target("sse4.2"))) static void expand_bgr_sse4_2(const std::span<const std::uint8_t> source,
+                                                                const std::span<std::uint8_t>       destination) noexcept
+{
+	const __m128i     shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m128i     alpha   = _mm_set1_epi32(static_cast<int>(0xFF000000));
+	const std::size_t count   = destination.size() / 4;
+	std::size_t       x       = 0;
+
+	// The 16 bytes loaded hold 4 pixels and the first bytes of the next ones, which must exist.
+	for (; x + 4 <= count && x * 3 + 16 <= source.size(); x += 4)
+	{
+		const __m128i bgr = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source.data() + x * 3));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination.data() + x * 4), _mm_or_si128(_mm_shuffle_epi8(bgr, shuffle), alpha));
+	}
+
+	expand_bgr_scalar(source.subspan(x * 3), destination.subspan(x * 4));
+}
+
+__attribute__((target("sse4.2"))) static void expand_palette_sse4_2(const std::span<const std::uint8_t>       indices,
+                                                                    const std::span<const std::uint32_t, 256> palette,
+                                                                    const std::span<std::uint8_t>             destination) noexcept
+{
+	const std::size_t count = destination.size() / 4;
+	std::size_t       x     = 0;
+
+	for (; x + 4 <= count; x += 4)
+	{
+		const __m128i colors = _mm_setr_epi32(static_cast<int>(palette[indices[x]]), static_cast<int>(palette[indices[x + 1]]),
+		                                      static_cast<int>(palette[indices[x + 2]]), static_cast<int>(palette[indices[x + 3]]));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination.data() + x * 4), colors);
+	}
+
+	expand_palette_scalar(indices.subspan(x), palette, destination.subspan(x * 4));
+}
+
+__attribute__((target("sse4.2"))) static void flip_rows_sse4_2(const std::span<const std::uint8_t> source,
+                                                               const std::span<std::uint8_t>       destination,
+                                                               const std::size_t                   row_size) noexcept
+{
+	const std::size_t rows = source.size() / row_size;
+
+	for (std::size_t y = 0; y < rows; ++y)
+	{
+		const std::uint8_t* const row    = source.data() + y * row_size;
+		std::uint8_t* const       target = destination.data() + (rows - 1 - y) * row_size;
+		std::size_t               offset = 0;
+
+		for (; offset + 16 <= row_size; offset += 16)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(target + offset), _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + offset)));
+		}
+
+		std::memcpy(target + offset, row + offset, row_size - offset);
+	}
+}
+
+__attribute__((target("sse4.2"))) static void premultiply_sse4_2(const std::span<std::uint8_t> pixels) noexcept
+{
+	// The alpha of each pixel is spread over its 16-bit lanes, the alpha lane being multiplied by 255 to stay as it is.
+	const __m128i alpha_low  = _mm_setr_epi8(3, -1, 3, -1, 3, -1, -1, -1, 7, -1, 7, -1, 7, -1, -1, -1);
+	const __m128i alpha_high = _mm_setr_epi8(11, -1, 11, -1, 11, -1, -1, -1, 15, -1, 15, -1, 15, -1, -1, -1);
+	const __m128i opaque     = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+	const __m128i rounding   = _mm_set1_epi16(128);
+	std::size_t   offset     = 0;
+
+	for (; offset + 16 <= pixels.size(); offset += 16)
+	{
+		const __m128i bgra = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels.data() + offset));
+		__m128i       low  = _mm_mullo_epi16(_mm_unpacklo_epi8(bgra, _mm_setzero_si128()), _mm_or_si128(_mm_shuffle_epi8(bgra, alpha_low), opaque));
+		__m128i       high = _mm_mullo_epi16(_mm_unpackhi_epi8(bgra, _mm_setzero_si128()), _mm_or_si128(_mm_shuffle_epi8(bgra, alpha_high), opaque));
+
+		low  = _mm_add_epi16(low, rounding);
+		high = _mm_add_epi16(high, rounding);
+		low  = _mm_srli_epi16(_mm_add_epi16(low, _mm_srli_epi16(low, 8)), 8);
+		high = _mm_srli_epi16(_mm_add_epi16(high, _mm_srli_epi16(high, 8)), 8);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels.data() + offset), _mm_packus_epi16(low, high));
+	}
+
+	premultiply_scalar(pixels.subspan(offset));
+}
+
+__attribute__((target("sse4.2"))) static void pack_and_mask_sse4_2(const std::span<const std::uint8_t> pixels,
+                                                                   const std::span<std::uint8_t>       mask) noexcept
+{
+	const __m128i alpha_mask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+	std::size_t   x          = 0;
+
+	// The alpha of each pixel is compared to 0 and the results narrowed to a byte each.
+	for (; x + 16 <= pixels.size() / 4; x += 16)
+	{
+		const __m128i* const source      = reinterpret_cast<const __m128i*>(pixels.data() + x * 4);
+		const __m128i        transparent = _mm_packs_epi16(
+		    _mm_packs_epi32(_mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128(source), alpha_mask), _mm_setzero_si128()),
+		                    _mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128(source + 1), alpha_mask), _mm_setzero_si128())),
+		    _mm_packs_epi32(_mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128(source + 2), alpha_mask), _mm_setzero_si128()),
+		                    _mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128(source + 3), alpha_mask), _mm_setzero_si128())));
+		const std::uint32_t  bits        = static_cast<std::uint32_t>(_mm_movemask_epi8(transparent));
+
+		mask[x / 8]     = REVERSED_BITS[bits & 0xFF];
+		mask[x / 8 + 1] = REVERSED_BITS[bits >> 8];
+	}
+
+	pack_and_mask_scalar(pixels.subspan(x * 4), mask.subspan(x / 8));
+}
+
+__attribute__((target("sse4.2"))) static void swap_red_blue_sse4_2(const std::span<const std::uint8_t> source,
+                                                                   const std::span<std::uint8_t>       destination) noexcept
+{
+	const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+	std::size_t   offset  = 0;
+
+	for (; offset + 16 <= destination.size(); offset += 16)
+	{
+		const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source.data() + offset));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination.data() + offset), _mm_shuffle_epi8(pixels, shuffle));
+	}
+
+	swap_red_blue_scalar(source.subspan(offset), destination.subspan(offset));
+}
+
+__attribute__((target("sse4.2"))) static void unfilter_sse4_2(const std::uint8_t                  filter,
+                                                              const std::span<std::uint8_t>       row,
+                                                              const std::span<const std::uint8_t> previous,
+                                                              const std::size_t                   pixel_size) noexcept
+{
+	const __m128i low_bits = _mm_set1_epi16(0x00FF);
+	const __m128i ones     = _mm_set1_epi8(1);
+	__m128i       left     = _mm_setzero_si128();
+	__m128i       up_left  = _mm_setzero_si128();
+	std::size_t   x        = 0;
+
+	if (2 == filter)
+	{
+		for (; x + 16 <= row.size(); x += 16)
+		{
+			__m128i* const bytes = reinterpret_cast<__m128i*>(row.data() + x);
+
+			_mm_storeu_si128(bytes, _mm_add_epi8(_mm_loadu_si128(bytes), _mm_loadu_si128(reinterpret_cast<const __m128i*>(previous.data() + x))));
+		}
+
+		unfilter_scalar(filter, row.subspan(x), previous.subspan(x), pixel_size);
+		return;
+	}
+
+	if ((3 != pixel_size && 4 != pixel_size) || 0 == filter || 4 < filter)
+	{
+		unfilter_scalar(filter, row, previous, pixel_size);
+		return;
+	}
+
+	// Each pixel depends on the one to its left, which stays in a register. Paeth works in 16-bit lanes.
+	for (; x + pixel_size <= row.size(); x += pixel_size)
+	{
+		const __m128i filtered = load_pixel_sse4_2(row.data() + x, pixel_size);
+		const __m128i up       = load_pixel_sse4_2(previous.data() + x, pixel_size);
+
+		if (1 == filter)
+		{
+			left = _mm_add_epi8(filtered, left);
+		}
+		else if (3 == filter)
+		{
+			// The rounded up average, less the bit lost by the truncating one.
+			const __m128i average = _mm_sub_epi8(_mm_avg_epu8(left, up), _mm_and_si128(_mm_xor_si128(left, up), ones));
+
+			left = _mm_add_epi8(filtered, average);
+		}
+		else
+		{
+			const __m128i up_wide          = _mm_cvtepu8_epi16(up);
+			const __m128i left_difference  = _mm_sub_epi16(up_wide, up_left);
+			const __m128i up_difference    = _mm_sub_epi16(left, up_left);
+			const __m128i left_distance    = _mm_abs_epi16(left_difference);
+			const __m128i up_distance      = _mm_abs_epi16(up_difference);
+			const __m128i up_left_distance = _mm_abs_epi16(_mm_add_epi16(left_difference, up_difference));
+			const __m128i smallest         = _mm_min_epi16(up_left_distance, _mm_min_epi16(left_distance, up_distance));
+			const __m128i predicted        = _mm_blendv_epi8(_mm_blendv_epi8(up_left, up_wide, _mm_cmpeq_epi16(smallest, up_distance)), left,
+			                                                 _mm_cmpeq_epi16(smallest, left_distance));
+
+			left    = _mm_and_si128(_mm_add_epi16(_mm_cvtepu8_epi16(filtered), predicted), low_bits);
+			up_left = up_wide;
+			store_pixel_sse4_2(_mm_packus_epi16(left, left), row.data() + x, pixel_size);
+			continue;
+		}
+
+		store_pixel_sse4_2(left, row.data() + x, pixel_size);
+	}
+}
+
+__attribute__((target("sse4.2"))) static __m128i load_pixel_sse4_2(const std::uint8_t* const bytes,
+                                                                   const std::size_t         size) noexcept
+{
+	std::uint32_t pixel = 0;
+
+	std::memcpy(&pixel, bytes, size);
+	return _mm_cvtsi32_si128(static_cast<int>(pixel));
+}
+
+__attribute__((target("sse4.2"))) static void store_pixel_sse4_2(const __m128i       pixel,
+                                                                 std::uint8_t* const bytes,
+                                                                 const std::size_t   size) noexcept
+{
+	const std::uint32_t value = static_cast<std::uint32_t>(_mm_cvtsi128_si32(pixel));
+
+	std::memcpy(bytes, &value, size);
+}
+
+__attribute__((target("avx2"))) static void expand_bgr_avx2(const std::span<const std::uint8_t> source,
+                                                            const std::span<std::uint8_t>       destination) noexcept
+{
+	const __m256i     shuffle = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m256i     alpha   = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+	const std::size_t count   = destination.size() / 4;
+	std::size_t       x       = 0;
+
+	// Each half of the register gets 4 pixels, the second load overreading like the SSE4.2 one.
+	for (; x + 8 <= count && x * 3 + 28 <= source.size(); x += 8)
+	{
+		const __m128i* const bgr    = reinterpret_cast<const __m128i*>(source.data() + x * 3);
+		const __m256i        halves = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(bgr)),
+		                                                      _mm_loadu_si128(reinterpret_cast<const __m128i*>(source.data() + x * 3 + 12)), 1);
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination.data() + x * 4), _mm256_or_si256(_mm256_shuffle_epi8(halves, shuffle), alpha));
+	}
+
+	expand_bgr_scalar(source.subspan(x * 3), destination.subspan(x * 4));
+}
+
+__attribute__((target("avx2"))) static void expand_palette_avx2(const std::span<const std::uint8_t>       indices,
+                                                                const std::span<const std::uint32_t, 256> palette,
+                                                                const std::span<std::uint8_t>             destination) noexcept
+{
+	const int* const  colors = reinterpret_cast<const int*>(palette.data());
+	const std::size_t count  = destination.size() / 4;
+	std::size_t       x      = 0;
+
+	for (; x + 8 <= count; x += 8)
+	{
+		const __m256i offsets = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(indices.data() + x)));
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination.data() + x * 4), _mm256_i32gather_epi32(colors, offsets, 4));
+	}
+
+	expand_palette_scalar(indices.subspan(x), palette, destination.subspan(x * 4));
+}
+
+__attribute__((target("avx2"))) static void flip_rows_avx2(const std::span<const std::uint8_t> source,
+                                                           const std::span<std::uint8_t>       destination,
+                                                           const std::size_t                   row_size) noexcept
+{
+	const std::size_t rows = source.size() / row_size;
+
+	for (std::size_t y = 0; y < rows; ++y)
+	{
+		const std::uint8_t* const row    = source.data() + y * row_size;
+		std::uint8_t* const       target = destination.data() + (rows - 1 - y) * row_size;
+		std::size_t               offset = 0;
+
+		for (; offset + 32 <= row_size; offset += 32)
+		{
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(target + offset), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + offset)));
+		}
+
+		std::memcpy(target + offset, row + offset, row_size - offset);
+	}
+}
+
+__attribute__((target("avx2"))) static void premultiply_avx2(const std::span<std::uint8_t> pixels) noexcept
+{
+	// Shuffles and unpacks work within each half of the register, so both halves use the SSE4.2 constants.
+	const __m256i alpha_low  = _mm256_setr_epi8(3, -1, 3, -1, 3, -1, -1, -1, 7, -1, 7, -1, 7, -1, -1, -1, 3, -1, 3, -1, 3, -1, -1, -1, 7, -1, 7, -1, 7, -1, -1, -1);
+	const __m256i alpha_high = _mm256_setr_epi8(11, -1, 11, -1, 11, -1, -1, -1, 15, -1, 15, -1, 15, -1, -1, -1, 11, -1, 11, -1, 11, -1, -1, -1, 15, -1, 15, -1, 15, -1,
+	                                            -1, -1);
+	const __m256i opaque     = _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255);
+	const __m256i rounding   = _mm256_set1_epi16(128);
+	std::size_t   offset     = 0;
+
+	for (; offset + 32 <= pixels.size(); offset += 32)
+	{
+		const __m256i bgra = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels.data() + offset));
+		__m256i       low  = _mm256_mullo_epi16(_mm256_unpacklo_epi8(bgra, _mm256_setzero_si256()), _mm256_or_si256(_mm256_shuffle_epi8(bgra, alpha_low), opaque));
+		__m256i       high = _mm256_mullo_epi16(_mm256_unpackhi_epi8(bgra, _mm256_setzero_si256()), _mm256_or_si256(_mm256_shuffle_epi8(bgra, alpha_high), opaque));
+
+		low  = _mm256_add_epi16(low, rounding);
+		high = _mm256_add_epi16(high, rounding);
+		low  = _mm256_srli_epi16(_mm256_add_epi16(low, _mm256_srli_epi16(low, 8)), 8);
+		high = _mm256_srli_epi16(_mm256_add_epi16(high, _mm256_srli_epi16(high, 8)), 8);
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels.data() + offset), _mm256_packus_epi16(low, high));
+	}
+
+	premultiply_scalar(pixels.subspan(offset));
+}
+
+__attribute__((target("avx2"))) static void pack_and_mask_avx2(const std::span<const std::uint8_t> pixels,
+                                                               const std::span<std::uint8_t>       mask) noexcept
+{
+	const __m256i alpha_mask = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+	const __m256i order      = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	std::size_t   x          = 0;
+
+	// Packing works within each half of the register, the pixels being put back in order before the bits are taken.
+	for (; x + 32 <= pixels.size() / 4; x += 32)
+	{
+		const __m256i* const source      = reinterpret_cast<const __m256i*>(pixels.data() + x * 4);
+		const __m256i        transparent = _mm256_packs_epi16(
+		    _mm256_packs_epi32(_mm256_cmpeq_epi32(_mm256_and_si256(_mm256_loadu_si256(source), alpha_mask), _mm256_setzero_si256()),
+		                       _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_loadu_si256(source + 1), alpha_mask), _mm256_setzero_si256())),
+		    _mm256_packs_epi32(_mm256_cmpeq_epi32(_mm256_and_si256(_mm256_loadu_si256(source + 2), alpha_mask), _mm256_setzero_si256()),
+		                       _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_loadu_si256(source + 3), alpha_mask), _mm256_setzero_si256())));
+		const std::uint32_t  bits        = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_permutevar8x32_epi32(transparent, order)));
+
+		mask[x / 8]     = REVERSED_BITS[bits & 0xFF];
+		mask[x / 8 + 1] = REVERSED_BITS[(bits >> 8) & 0xFF];
+		mask[x / 8 + 2] = REVERSED_BITS[(bits >> 16) & 0xFF];
+		mask[x / 8 + 3] = REVERSED_BITS[bits >> 24];
+	}
+
+	pack_and_mask_scalar(pixels.subspan(x * 4), mask.subspan(x / 8));
+}
+
+__attribute__((target("avx2"))) static void swap_red_blue_avx2(const std::span<const std::uint8_t> source,
+                                                               const std::span<std::uint8_t>       destination) noexcept
+{
+	const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15, 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+	std::size_t   offset  = 0;
+
+	for (; offset + 32 <= destination.size(); offset += 32)
+	{
+		const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source.data() + offset));
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination.data() + offset), _mm256_shuffle_epi8(pixels, shuffle));
+	}
+
+	swap_red_blue_scalar(source.subspan(offset), destination.subspan(offset));
+}
+
+__attribute__((target("avx2"))) static void unfilter_avx2(const std::uint8_t                  filter,
+                                                          const std::span<std::uint8_t>       row,
+                                                          const std::span<const std::uint8_t> previous,
+                                                          const std::size_t                   pixel_size) noexcept
+{
+	std::size_t x = 0;
+
+	// The other filters go a pixel at a time, which wider registers do not speed up.
+	for (; 2 == filter && x + 32 <= row.size(); x += 32)
+	{
+		__m256i* const bytes = reinterpret_cast<__m256i*>(row.data() + x);
+
+		_mm256_storeu_si256(bytes, _mm256_add_epi8(_mm256_loadu_si256(bytes), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(previous.data() + x))));
+	}
+
+	unfilter_sse4_2(filter, row.subspan(x), previous.subspan(x), pixel_size);
+}
+
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+
+static void expand_bgr_neon(const std::span<const std::uint8_t> source,
+                            const std::span<std::uint8_t>       destination) noexcept
+{
+	const std::size_t count = destination.size() / 4;
+	std::size_t       x     = 0;
+
+	for (; x + 16 <= count; x += 16)
+	{
+		const uint8x16x3_t bgr  = vld3q_u8(source.data() + x * 3);
+		const uint8x16x4_t bgra = { { bgr.val[0], bgr.val[1], bgr.val[2], vdupq_n_u8(0xFF) } };
+
+		vst4q_u8(destination.data() + x * 4, bgra);
+	}
+
+	expand_bgr_scalar(source.subspan(x * 3), destination.subspan(x * 4));
+}
+
+static void flip_rows_neon(const std::span<const std::uint8_t> source,
+                           const std::span<std::uint8_t>       destination,
+                           const std::size_t                   row_size) noexcept
+{
+	const std::size_t rows = source.size() / row_size;
+
+	for (std::size_t y = 0; y < rows; ++y)
+	{
+		const std::uint8_t* const row    = source.data() + y * row_size;
+		std::uint8_t* const       target = destination.data() + (rows - 1 - y) * row_size;
+		std::size_t               offset = 0;
+
+		for (; offset + 16 <= row_size; offset += 16)
+		{
+			vst1q_u8(target + offset, vld1q_u8(row + offset));
+		}
+
+		std::memcpy(target + offset, row + offset, row_size - offset);
+	}
+}
+
+static void premultiply_neon(const std::span<std::uint8_t> pixels) noexcept
+{
+	std::size_t offset = 0;
+
+	// (x + ((x + 128) >> 8) + 128) >> 8 is the rounding of the scalar version, as two instructions.
+	for (; offset + 64 <= pixels.size(); offset += 64)
+	{
+		uint8x16x4_t bgra = vld4q_u8(pixels.data() + offset);
+
+		for (std::size_t channel = 0; channel < 3; ++channel)
+		{
+			const uint16x8_t low  = vmull_u8(vget_low_u8(bgra.val[channel]), vget_low_u8(bgra.val[3]));
+			const uint16x8_t high = vmull_high_u8(bgra.val[channel], bgra.val[3]);
+
+			bgra.val[channel] = vcombine_u8(vraddhn_u16(low, vrshrq_n_u16(low, 8)), vraddhn_u16(high, vrshrq_n_u16(high, 8)));
+		}
+
+		vst4q_u8(pixels.data() + offset, bgra);
+	}
+
+	premultiply_scalar(pixels.subspan(offset));
+}
+
+static void pack_and_mask_neon(const std::span<const std::uint8_t> pixels,
+                               const std::span<std::uint8_t>       mask) noexcept
+{
+	static constexpr std::array<std::uint8_t, 16> BIT_WEIGHTS = { 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01, 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01 };
+
+	const uint8x16_t weights = vld1q_u8(BIT_WEIGHTS.data());
+	std::size_t      x       = 0;
+
+	// Every transparent pixel keeps the weight of its bit, the weights of 8 pixels adding up to their mask byte.
+	for (; x + 16 <= pixels.size() / 4; x += 16)
+	{
+		const uint8x16_t transparent = vandq_u8(vceqzq_u8(vld4q_u8(pixels.data() + x * 4).val[3]), weights);
+
+		mask[x / 8]     = vaddv_u8(vget_low_u8(transparent));
+		mask[x / 8 + 1] = vaddv_u8(vget_high_u8(transparent));
+	}
+
+	pack_and_mask_scalar(pixels.subspan(x * 4), mask.subspan(x / 8));
+}
+
+static void swap_red_blue_neon(const std::span<const std::uint8_t> source,
+                               const std::span<std::uint8_t>       destination) noexcept
+{
+	std::size_t offset = 0;
+
+	for (; offset + 64 <= destination.size(); offset += 64)
+	{
+		const uint8x16x4_t pixels  = vld4q_u8(source.data() + offset);
+		const uint8x16x4_t swapped = { { pixels.val[2], pixels.val[1], pixels.val[0], pixels.val[3] } };
+
+		vst4q_u8(destination.data() + offset, swapped);
+	}
+
+	swap_red_blue_scalar(source.subspan(offset), destination.subspan(offset));
+}
+
+static void unfilter_neon(const std::uint8_t                  filter,
+                          const std::span<std::uint8_t>       row,
+                          const std::span<const std::uint8_t> previous,
+                          const std::size_t                   pixel_size) noexcept
+{
+	std::size_t x = 0;
+
+	for (; 2 == filter && x + 16 <= row.size(); x += 16)
+	{
+		vst1q_u8(row.data() + x, vaddq_u8(vld1q_u8(row.data() + x), vld1q_u8(previous.data() + x)));
+	}
+
+	unfilter_scalar(filter, row.subspan(x), previous.subspan(x), pixel_size);
+}
+
+#endif
+
+} // namespace icon_changer
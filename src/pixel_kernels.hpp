@@ -0,0 +1,142 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief The instruction sets the pixel kernels are implemented with.
+///
+enum class pixel_isa : std::uint8_t
+{
+	scalar, ///< Portable C++, the reference every other variant matches.
+	sse4_2, ///< SSE4.2 and the SSSE3 shuffles, x86 only.
+	avx2,   ///< AVX2, x86 only.
+	neon    ///< Advanced SIMD, AArch64 only.
+};
+
+///
+/// \brief The kernels converting rows of pixels, all variants of one instruction set.
+/// \details Every variant produces exactly the bytes the scalar one does.
+///
+struct pixel_kernels final
+{
+	///
+	/// \brief The instruction set of the kernels.
+	///
+	pixel_isa isa;
+
+	///
+	/// \brief Expands 24bpp BGR pixels into opaque 32bpp BGRA ones.
+	/// \param source: The BGR pixels, 3 bytes each, at least one per destination pixel.
+	/// \param destination: The BGRA pixels, 4 bytes each.
+	///
+	void (*expand_bgr)(std::span<const std::uint8_t> source,
+	                   std::span<std::uint8_t>       destination) noexcept;
+
+	///
+	/// \brief Looks up 8-bit palette indices into 32bpp BGRA pixels.
+	/// \param indices: The indices, at least one per destination pixel.
+	/// \param palette: The colors, each index having one.
+	/// \param destination: The BGRA pixels, 4 bytes each.
+	///
+	void (*expand_palette)(std::span<const std::uint8_t>       indices,
+	                       std::span<const std::uint32_t, 256> palette,
+	                       std::span<std::uint8_t>             destination) noexcept;
+
+	///
+	/// \brief Copies rows in reverse order, turning bottom-up rows into top-down ones and back.
+	/// \param source: The rows.
+	/// \param destination: The flipped rows, as large as the source.
+	/// \param row_size: Size of a row in bytes, not 0.
+	///
+	void (*flip_rows)(std::span<const std::uint8_t> source,
+	                  std::span<std::uint8_t>       destination,
+	                  std::size_t                   row_size) noexcept;
+
+	///
+	/// \brief Multiplies the colors of BGRA pixels by their alpha, in place.
+	/// \details Every color becomes color * alpha / 255, rounded to the nearest.
+	/// \param pixels: The BGRA pixels, 4 bytes each.
+	///
+	void (*premultiply)(std::span<std::uint8_t> pixels) noexcept;
+
+	///
+	/// \brief Packs a row of the 1bpp AND mask of an icon image from its alpha channel.
+	/// \details A pixel is transparent, its bit being set, if its alpha is 0. The
+	/// bits are packed starting from the most significant one, as in a DIB.
+	/// \param pixels: The BGRA pixels of the row, 4 bytes each.
+	/// \param mask: The mask row, at least one bit per pixel. Every byte holding a
+	/// bit of the row is overwritten, the bits past the last pixel being cleared.
+	///
+	void (*pack_and_mask)(std::span<const std::uint8_t> pixels,
+	                      std::span<std::uint8_t>       mask) noexcept;
+
+	///
+	/// \brief Swaps the red and blue channels, turning RGBA pixels into BGRA ones and back.
+	/// \param source: The pixels, 4 bytes each, at least one per destination pixel.
+	/// \param destination: The swapped pixels, the source itself or not overlapping it.
+	///
+	void (*swap_red_blue)(std::span<const std::uint8_t> source,
+	                      std::span<std::uint8_t>       destination) noexcept;
+
+	///
+	/// \brief Reverses the filter of a PNG row, in place.
+	/// \details The Sub, Average and Paeth filters depend on the pixel to the
+	/// left, so only 3 and 4 byte pixels are vectorized, one pixel at a time.
+	/// \param filter: The filter type, from 0 (None) to 4 (Paeth).
+	/// \param row: The filtered row, without its filter type byte.
+	/// \param previous: The row above, already unfiltered, zeros for the first row.
+	/// \param pixel_size: Bytes per pixel, 1 for less than 8 bits per pixel.
+	///
+	void (*unfilter)(std::uint8_t                  filter,
+	                 std::span<std::uint8_t>       row,
+	                 std::span<const std::uint8_t> previous,
+	                 std::size_t                   pixel_size) noexcept;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DECLARATIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Gets the fastest kernels the processor supports.
+/// \details They are selected on the first call, from what the processor
+/// reports through CPUID, and kept for the lifetime of the process.
+/// \returns The kernels.
+///
+extern const pixel_kernels& get_pixel_kernels() noexcept;
+
+///
+/// \brief Gets the kernels of an instruction set.
+/// \param isa: The instruction set.
+/// \returns The kernels, nullptr if they were not built for this architecture
+/// or the processor does not support them.
+///
+extern const pixel_kernels* get_pixel_kernels(pixel_isa isa) noexcept;
+
+} // namespace icon_changer
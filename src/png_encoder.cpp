@@ -0,0 +1,249 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include "png_encoder.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <span>
+#include <string_view>
+
+#include "deflate.hpp"
+#include "hash.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTANTS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief The 8 bytes every PNG file starts with.
+///
+static constexpr std::array<std::uint8_t, 8> SIGNATURE = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+static constexpr std::uint8_t BIT_DEPTH       = 8; ///< Bits per channel.
+static constexpr std::uint8_t COLOR_TYPE_RGBA = 6; ///< Truecolor with alpha.
+static constexpr std::size_t  CHANNELS_COUNT  = 4; ///< Bytes per pixel.
+static constexpr std::size_t  FILTERS_COUNT   = 5; ///< None, Sub, Up, Average and Paeth.
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Appends a chunk to the PNG file.
+/// \param png: The PNG file.
+/// \param type: The 4 letters of the chunk type.
+/// \param data: The chunk data.
+///
+static void write_chunk(std::vector<std::uint8_t>&    png,
+                        std::string_view              type,
+                        std::span<const std::uint8_t> data);
+
+///
+/// \brief Appends a 32-bit value in network byte order.
+/// \param bytes: The bytes being written.
+/// \param value: The value to be appended.
+///
+static void write_big_endian(std::vector<std::uint8_t>& bytes,
+                             std::uint32_t              value);
+
+///
+/// \brief Applies a filter to a row.
+/// \param filter: The filter type, from 0 (None) to 4 (Paeth).
+/// \param current: The row, preceded by one zero pixel.
+/// \param previous: The row above, preceded by one zero pixel.
+/// \param filtered: The filtered row.
+/// \returns The sum of the filtered bytes read as signed, in absolute value.
+///
+static std::uint64_t filter_row(std::size_t                   filter,
+                                std::span<const std::uint8_t> current,
+                                std::span<const std::uint8_t> previous,
+                                std::span<std::uint8_t>       filtered) noexcept;
+
+///
+/// \brief Predicts a byte from its neighbours, as the Paeth filter does.
+/// \details The prediction is the neighbour closest to left + up - up_left.
+/// \param left: The corresponding byte of the pixel to the left.
+/// \param up: The corresponding byte of the pixel above.
+/// \param up_left: The corresponding byte of the pixel above and to the left.
+/// \returns The predicted byte.
+///
+static std::uint8_t predict_paeth(std::uint8_t left,
+                                  std::uint8_t up,
+                                  std::uint8_t up_left) noexcept;
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<std::uint8_t> encode_png(const bgra_image& image)
+{
+	const std::size_t                                    stride     = static_cast<std::size_t>(image.width) * CHANNELS_COUNT;
+	std::vector<std::uint8_t>                            png        = { SIGNATURE.begin(), SIGNATURE.end() };
+	std::vector<std::uint8_t>                            header     = {};
+	std::vector<std::uint8_t>                            filtered   = {};
+	std::vector<std::uint8_t>                            previous   = std::vector<std::uint8_t>(CHANNELS_COUNT + stride);
+	std::vector<std::uint8_t>                            current    = std::vector<std::uint8_t>(CHANNELS_COUNT + stride);
+	std::array<std::vector<std::uint8_t>, FILTERS_COUNT> candidates = {};
+
+	write_big_endian(header, image.width);
+	write_big_endian(header, image.height);
+	header.insert(header.end(), { BIT_DEPTH, COLOR_TYPE_RGBA, 0, 0, 0 });
+	write_chunk(png, "IHDR", header);
+
+	filtered.reserve((stride + 1) * image.height);
+
+	for (std::vector<std::uint8_t>& candidate : candidates)
+	{
+		candidate.resize(stride);
+	}
+
+	for (std::size_t y = 0; y < image.height; ++y)
+	{
+		const std::uint8_t* const row         = image.pixels.data() + y * stride;
+		std::size_t               best_filter = 0;
+		std::uint64_t             best_sum    = std::numeric_limits<std::uint64_t>::max();
+
+		// The rows are preceded by a zero pixel, standing for the missing left neighbours.
+		for (std::size_t x = 0; x < stride; x += CHANNELS_COUNT)
+		{
+			current[CHANNELS_COUNT + x + 0] = row[x + 2];
+			current[CHANNELS_COUNT + x + 1] = row[x + 1];
+			current[CHANNELS_COUNT + x + 2] = row[x + 0];
+			current[CHANNELS_COUNT + x + 3] = row[x + 3];
+		}
+
+		// The filter leaving the smallest values, read as signed, usually compresses best.
+		for (std::size_t filter = 0; filter < FILTERS_COUNT; ++filter)
+		{
+			const std::uint64_t sum = filter_row(filter, current, previous, candidates[filter]);
+
+			if (sum < best_sum)
+			{
+				best_filter = filter;
+				best_sum    = sum;
+			}
+		}
+
+		filtered.push_back(static_cast<std::uint8_t>(best_filter));
+		filtered.insert(filtered.end(), candidates[best_filter].begin(), candidates[best_filter].end());
+		std::swap(previous, current);
+	}
+
+	write_chunk(png, "IDAT", zlib_compress(filtered));
+	write_chunk(png, "IEND", {});
+
+	return png;
+}
+
+static void write_chunk(std::vector<std::uint8_t>&          png,
+                        const std::string_view              type,
+                        const std::span<const std::uint8_t> data)
+{
+	const std::size_t type_offset = png.size() + sizeof(std::uint32_t);
+
+	write_big_endian(png, static_cast<std::uint32_t>(data.size()));
+	png.insert(png.end(), type.begin(), type.end());
+	png.insert(png.end(), data.begin(), data.end());
+
+	// The CRC covers the type and the data, not the length.
+	write_big_endian(png, crc32(std::span<const std::uint8_t>{ png }.subspan(type_offset)));
+}
+
+static void write_big_endian(std::vector<std::uint8_t>& bytes,
+                             const std::uint32_t        value)
+{
+	bytes.insert(bytes.end(), { static_cast<std::uint8_t>(value >> 24), static_cast<std::uint8_t>(value >> 16),
+	                            static_cast<std::uint8_t>(value >> 8), static_cast<std::uint8_t>(value) });
+}
+
+static std::uint64_t filter_row(const std::size_t                   filter,
+                                const std::span<const std::uint8_t> current,
+                                const std::span<const std::uint8_t> previous,
+                                const std::span<std::uint8_t>       filtered) noexcept
+{
+	const std::uint8_t* const row     = current.data() + CHANNELS_COUNT;
+	const std::uint8_t* const left    = current.data();
+	const std::uint8_t* const up      = previous.data() + CHANNELS_COUNT;
+	const std::uint8_t* const up_left = previous.data();
+	std::uint64_t             sum     = 0;
+
+	// One loop per filter, so that the compiler can vectorize them.
+	switch (filter)
+	{
+		case 0:
+			std::copy(row, row + filtered.size(), filtered.begin());
+			break;
+		case 1:
+			for (std::size_t x = 0; x < filtered.size(); ++x)
+			{
+				filtered[x] = static_cast<std::uint8_t>(row[x] - left[x]);
+			}
+			break;
+		case 2:
+			for (std::size_t x = 0; x < filtered.size(); ++x)
+			{
+				filtered[x] = static_cast<std::uint8_t>(row[x] - up[x]);
+			}
+			break;
+		case 3:
+			for (std::size_t x = 0; x < filtered.size(); ++x)
+			{
+				filtered[x] = static_cast<std::uint8_t>(row[x] - (left[x] + up[x]) / 2);
+			}
+			break;
+		default:
+			for (std::size_t x = 0; x < filtered.size(); ++x)
+			{
+				filtered[x] = static_cast<std::uint8_t>(row[x] - predict_paeth(left[x], up[x], up_left[x]));
+			}
+			break;
+	}
+
+	for (const std::uint8_t byte : filtered)
+	{
+		sum += static_cast<std::uint64_t>(std::abs(static_cast<std::int8_t>(byte)));
+	}
+
+	return sum;
+}
+
+static std::uint8_t predict_paeth(const std::uint8_t left,
+                                  const std::uint8_t up,
+                                  const std::uint8_t up_left) noexcept
+{
+	const std::int32_t estimate        = static_cast<std::int32_t>(left) + up - up_left;
+	const std::int32_t left_distance   = std::abs(estimate - left);
+	const std::int32_t up_distance     = std::abs(estimate - up);
+	const std::int32_t corner_distance = std::abs(estimate - up_left);
+
+	if (left_distance <= up_distance && left_distance <= corner_distance)
+	{
+		return left;
+	}
+
+	return up_distance <= corner_distance ? up : up_left;
+}
+
+} // namespace icon_changer
@@ -0,0 +1,549 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include "png_file.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <format>
+#include <string_view>
+
+#include "deflate.hpp"
+#include "hash.hpp"
+#include "pixel_kernels.hpp"
+#include "stats.hpp"
+#include "utility.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief A pass over the pixels, a single one covering them all unless the image is interlaced.
+///
+struct interlace_pass final
+{
+	std::uint32_t x;      ///< Column of the first pixel.
+	std::uint32_t y;      ///< Row of the first pixel.
+	std::uint32_t x_step; ///< Columns from one pixel of the pass to the next.
+	std::uint32_t y_step; ///< Rows from one row of the pass to the next.
+};
+
+///
+/// \brief How the samples of a row turn into BGRA pixels.
+///
+struct row_format final
+{
+	std::uint8_t                   color_type; ///< The color type of the IHDR chunk.
+	std::uint8_t                   bit_depth;  ///< Bits per sample or palette index.
+	std::size_t                    channels;   ///< Samples per pixel.
+	bool                           lookup;     ///< Whether the samples are looked up in colors, for indexed and up to 8-bit gray images.
+	std::array<std::uint32_t, 256> colors;     ///< The BGRA color of each index or gray level.
+	bool                           has_key;    ///< Whether the pixels of the key color are transparent.
+	std::array<std::uint16_t, 3>   key;        ///< The transparent gray level or RGB color of the tRNS chunk.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTANTS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief The 8 bytes every PNG file starts with.
+///
+static constexpr std::array<std::uint8_t, 8> SIGNATURE = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+static constexpr std::uint8_t COLOR_TYPE_GRAY       = 0; ///< Grayscale.
+static constexpr std::uint8_t COLOR_TYPE_RGB        = 2; ///< Truecolor.
+static constexpr std::uint8_t COLOR_TYPE_INDEXED    = 3; ///< Indexed color.
+static constexpr std::uint8_t COLOR_TYPE_GRAY_ALPHA = 4; ///< Grayscale with alpha.
+static constexpr std::uint8_t COLOR_TYPE_RGBA       = 6; ///< Truecolor with alpha.
+static constexpr std::size_t  IHDR_SIZE             = 13; ///< Bytes of the IHDR chunk data.
+static constexpr std::uint8_t FILTER_PAETH          = 4; ///< The last filter type.
+
+///
+/// \brief The single pass of an image that is not interlaced.
+///
+static constexpr std::array<interlace_pass, 1> PROGRESSIVE = { { { 0, 0, 1, 1 } } };
+
+///
+/// \brief The 7 passes of Adam7 interlacing.
+///
+static constexpr std::array<interlace_pass, 7> ADAM7 = {
+	{ { 0, 0, 8, 8 }, { 4, 0, 8, 8 }, { 0, 4, 4, 8 }, { 2, 0, 4, 4 }, { 0, 2, 2, 4 }, { 1, 0, 2, 2 }, { 0, 1, 1, 2 } }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Loads a big-endian number, as PNG stores them.
+/// \param bytes: The bytes of the number, up to 4.
+/// \returns The number.
+///
+static std::uint32_t load_big_endian(std::span<const std::uint8_t> bytes) noexcept;
+
+///
+/// \brief Gets the number of samples per pixel of a color type.
+/// \param color_type: The color type.
+/// \returns The number of samples, 0 if the color type is invalid.
+///
+static std::size_t get_channels_count(std::uint8_t color_type) noexcept;
+
+///
+/// \brief Converts an unfiltered row into BGRA pixels.
+/// \param format: How the samples turn into pixels.
+/// \param row: The unfiltered row.
+/// \param destination: The BGRA pixels, 4 bytes each.
+/// \param indices: A buffer for the unpacked indices of the row, at least one per pixel.
+///
+static void convert_row(const row_format&             format,
+                        std::span<const std::uint8_t> row,
+                        std::span<std::uint8_t>       destination,
+                        std::span<std::uint8_t>       indices) noexcept;
+
+////////////////////////////////////////////////////////////////////////////////
+// METHOD DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+png_file::png_file(const std::string_view           file_path,
+                   std::pmr::memory_resource* const resource)
+    : png_file{ *open_source(file_path), resource }
+{
+}
+
+png_file::png_file(byte_source&                     source,
+                   std::pmr::memory_resource* const resource,
+                   memory_budget* const             budget)
+    : header_obj{}
+    , buffer{ resource }
+    , file{}
+{
+	read_all(source, buffer, budget);
+	parse(buffer);
+}
+
+png_file::png_file(const std::span<const std::uint8_t> file_data)
+    : header_obj{}
+    , buffer{}
+    , file{}
+{
+	parse(file_data);
+}
+
+png_file::header png_file::get_header() const noexcept
+{
+	return header_obj;
+}
+
+std::span<const std::uint8_t> png_file::get_file() const noexcept
+{
+	return file;
+}
+
+std::pmr::vector<std::uint8_t> png_file::release_buffer() noexcept
+{
+	return std::move(buffer);
+}
+
+bgra_image png_file::decode(memory_budget* const budget) const
+{
+	const std::size_t                          pixel_bits  = get_channels_count(header_obj.color_type) * header_obj.bit_depth;
+	const std::size_t                          pixel_size  = std::max<std::size_t>(pixel_bits / 8, 1);
+	const std::size_t                          max_stride  = (static_cast<std::size_t>(header_obj.width) * pixel_bits + 7) / 8;
+	const std::span<const interlace_pass>      passes      = 1 == header_obj.interlace_method ? std::span<const interlace_pass>{ ADAM7 } : PROGRESSIVE;
+	const pixel_kernels&                       kernels     = get_pixel_kernels();
+	byte_cursor<const std::uint8_t>            cursor      = byte_cursor<const std::uint8_t>{ file };
+	row_format                                 format      = {};
+	std::array<std::uint32_t, 256>             palette     = {};
+	std::size_t                                palette_end = 0;
+	std::array<std::uint8_t, 256>              alphas      = {};
+	std::vector<std::span<const std::uint8_t>> data        = {};
+	bgra_image                                 decoded     = {};
+	bool                                       ended       = false;
+
+	format.color_type = header_obj.color_type;
+	format.bit_depth  = header_obj.bit_depth;
+	format.channels   = get_channels_count(header_obj.color_type);
+	format.lookup     = COLOR_TYPE_INDEXED == header_obj.color_type || (COLOR_TYPE_GRAY == header_obj.color_type && 8 >= header_obj.bit_depth);
+	alphas.fill(0xFF);
+	static_cast<void>(cursor.take(SIGNATURE.size(), "PNG signature"));
+
+	// The data of the IDAT chunks is only inflated once every chunk it depends on has been read.
+	while (!ended)
+	{
+		const std::size_t                   length   = load_big_endian(cursor.take(4, "PNG chunk length"));
+		const std::span<const std::uint8_t> chunk    = cursor.take(4 + length, "PNG chunk");
+		const std::uint32_t                 checksum = load_big_endian(cursor.take(4, "PNG chunk CRC"));
+		const std::string_view              type     = std::string_view{ reinterpret_cast<const char*>(chunk.data()), 4 };
+		const std::span<const std::uint8_t> bytes    = chunk.subspan(4);
+
+		if (crc32(chunk) != checksum)
+		{
+			throw std::runtime_error{ std::format("CRC of the {} chunk does not match!", type) };
+		}
+
+		if ("PLTE" == type)
+		{
+			if (0 == length || 0 != length % 3 || palette.size() * 3 < length)
+			{
+				throw std::runtime_error{ std::format("Palette of {} bytes is invalid!", length) };
+			}
+
+			for (palette_end = 0; palette_end < length / 3; ++palette_end)
+			{
+				palette[palette_end] = load_big_endian(bytes.subspan(palette_end * 3, 3));
+			}
+		}
+		else if ("tRNS" == type)
+		{
+			const std::size_t samples = COLOR_TYPE_GRAY == header_obj.color_type ? 1 : COLOR_TYPE_RGB == header_obj.color_type ? 3 : 0;
+
+			if (COLOR_TYPE_INDEXED == header_obj.color_type && alphas.size() >= length)
+			{
+				std::ranges::copy(bytes, alphas.begin());
+			}
+			else if (0 != samples && samples * 2 == length)
+			{
+				for (std::size_t index = 0; index < samples; ++index)
+				{
+					format.key[index] = static_cast<std::uint16_t>(load_big_endian(bytes.subspan(index * 2, 2)));
+				}
+
+				format.has_key = true;
+			}
+			else
+			{
+				throw std::runtime_error{ std::format("Transparency of {} bytes does not fit color type {}!", length, header_obj.color_type) };
+			}
+		}
+		else if ("IDAT" == type)
+		{
+			data.push_back(bytes);
+		}
+		else if ("IEND" == type)
+		{
+			ended = true;
+		}
+		else if ("IHDR" != type && 0 == (chunk[0] & 0x20))
+		{
+			// The case of the first letter tells whether a decoder may skip the chunk.
+			throw std::runtime_error{ std::format("Critical chunk {} is not supported!", type) };
+		}
+	}
+
+	if (COLOR_TYPE_INDEXED == header_obj.color_type && 0 == palette_end)
+	{
+		throw std::runtime_error{ "Indexed image has no palette!" };
+	}
+
+	if (data.empty())
+	{
+		throw std::runtime_error{ "PNG file has no image data!" };
+	}
+
+	// Indices past the end of the palette take its first color, as in a BMP file.
+	for (std::size_t index = 0; COLOR_TYPE_INDEXED == header_obj.color_type && index < format.colors.size(); ++index)
+	{
+		const std::size_t entry = index < palette_end ? index : 0;
+
+		format.colors[index] = palette[entry] | static_cast<std::uint32_t>(alphas[entry]) << 24;
+	}
+
+	// Gray levels are scaled to 8 bits, 0x0F of 4 bits becoming 0xFF.
+	for (std::uint32_t level = 0; COLOR_TYPE_GRAY == header_obj.color_type && format.lookup && level < (1U << header_obj.bit_depth); ++level)
+	{
+		const std::uint32_t gray        = level * 255 / ((1U << header_obj.bit_depth) - 1);
+		const bool          transparent = format.has_key && format.key[0] == level;
+
+		format.colors[level] = gray * 0x010101 | (transparent ? 0 : 0xFF000000);
+	}
+
+	decoded.width  = header_obj.width;
+	decoded.height = header_obj.height;
+
+	// The image is charged along with the 2 rows being unfiltered, which are larger for a single row of 16-bit samples.
+	if (nullptr != budget)
+	{
+		budget->charge(static_cast<std::uint64_t>(decoded.width) * decoded.height * 4 + 2 * (max_stride + 1), "Decoded image");
+	}
+
+	decoded.pixels.resize(static_cast<std::size_t>(decoded.width) * decoded.height * 4);
+
+	std::vector<std::uint8_t> current    = std::vector<std::uint8_t>(max_stride + 1);
+	std::vector<std::uint8_t> previous   = std::vector<std::uint8_t>(max_stride + 1);
+	std::vector<std::uint8_t> converted  = std::vector<std::uint8_t>(passes.size() > 1 ? static_cast<std::size_t>(decoded.width) * 4 : 0);
+	std::vector<std::uint8_t> indices    = std::vector<std::uint8_t>(format.lookup && 8 > header_obj.bit_depth ? decoded.width : 0);
+	std::size_t               pass_index = 0;
+	std::uint32_t             pass_width = 0;
+	std::uint32_t             pass_rows  = 0;
+	std::uint32_t             row_index  = 0;
+	std::size_t               stride     = 0;
+	std::size_t               filled     = 0;
+	std::size_t               chunk      = 0;
+
+	// Passes of small images can be empty, they have no rows at all, not even their filter types.
+	const auto start_pass = [&]()
+	{
+		for (; pass_index < passes.size(); ++pass_index)
+		{
+			const interlace_pass& pass = passes[pass_index];
+
+			pass_width = decoded.width > pass.x ? (decoded.width - pass.x + pass.x_step - 1) / pass.x_step : 0;
+			pass_rows  = decoded.height > pass.y ? (decoded.height - pass.y + pass.y_step - 1) / pass.y_step : 0;
+
+			if (0 != pass_width && 0 != pass_rows)
+			{
+				stride    = (static_cast<std::size_t>(pass_width) * pixel_bits + 7) / 8;
+				row_index = 0;
+				std::fill(previous.begin(), previous.end(), 0);
+				return;
+			}
+		}
+	};
+
+	const auto read_data = [&]()
+	{
+		return chunk < data.size() ? data[chunk++] : std::span<const std::uint8_t>{};
+	};
+
+	const auto write_rows = [&](std::span<const std::uint8_t> bytes)
+	{
+		while (!bytes.empty())
+		{
+			if (passes.size() == pass_index)
+			{
+				throw std::runtime_error{ "Image data is longer than the image!" };
+			}
+
+			const std::size_t count = std::min(bytes.size(), stride + 1 - filled);
+
+			std::memcpy(current.data() + filled, bytes.data(), count);
+			filled += count;
+			bytes   = bytes.subspan(count);
+
+			if (stride + 1 != filled)
+			{
+				continue;
+			}
+
+			if (FILTER_PAETH < current[0])
+			{
+				throw std::runtime_error{ std::format("Filter type {} is invalid!", current[0]) };
+			}
+
+			const interlace_pass&         pass        = passes[pass_index];
+			const std::span<std::uint8_t> row         = std::span<std::uint8_t>{ current }.subspan(1, stride);
+			const std::size_t             y           = pass.y + static_cast<std::size_t>(row_index) * pass.y_step;
+			std::uint8_t* const           destination = decoded.pixels.data() + y * decoded.width * 4;
+
+			kernels.unfilter(current[0], row, std::span<const std::uint8_t>{ previous }.subspan(1, stride), pixel_size);
+
+			if (1 == pass.x_step)
+			{
+				convert_row(format, row, std::span<std::uint8_t>{ destination, static_cast<std::size_t>(pass_width) * 4 }, indices);
+			}
+			else
+			{
+				convert_row(format, row, std::span<std::uint8_t>{ converted }.first(static_cast<std::size_t>(pass_width) * 4), indices);
+
+				for (std::size_t x = 0; x < pass_width; ++x)
+				{
+					std::memcpy(destination + (pass.x + x * pass.x_step) * 4, converted.data() + x * 4, 4);
+				}
+			}
+
+			std::swap(current, previous);
+			filled = 0;
+
+			if (pass_rows == ++row_index)
+			{
+				++pass_index;
+				start_pass();
+			}
+		}
+	};
+
+	start_pass();
+	zlib_decompress(read_data, write_rows);
+
+	if (passes.size() != pass_index)
+	{
+		throw std::runtime_error{ "Image data is shorter than the image!" };
+	}
+
+	return decoded;
+}
+
+void png_file::parse(const std::span<const std::uint8_t> file_data)
+{
+	byte_cursor<const std::uint8_t> cursor = byte_cursor<const std::uint8_t>{ file_data };
+	stats_timer                     timer  = stats_timer{ stats_phase::parse };
+
+	if (!std::ranges::equal(cursor.take(SIGNATURE.size(), "PNG signature"), SIGNATURE))
+	{
+		throw std::invalid_argument{ "PNG signature is invalid!" };
+	}
+
+	// The IHDR chunk comes first, its CRC is checked once the image is decoded.
+	if (IHDR_SIZE != load_big_endian(cursor.take(4, "PNG chunk length")) || !std::ranges::equal(cursor.take(4, "PNG chunk type"), std::string_view{ "IHDR" }))
+	{
+		throw std::invalid_argument{ "PNG file does not start with an IHDR chunk!" };
+	}
+
+	const std::span<const std::uint8_t> ihdr = cursor.take(IHDR_SIZE, "IHDR chunk");
+
+	header_obj = header{ load_big_endian(ihdr.first(4)), load_big_endian(ihdr.subspan(4, 4)), ihdr[8], ihdr[9], ihdr[10], ihdr[11], ihdr[12] };
+
+	LOG("width: {}", header_obj.width);
+	LOG("height: {}", header_obj.height);
+	LOG("bit_depth: {}", header_obj.bit_depth);
+	LOG("color_type: {}", header_obj.color_type);
+	LOG("compression_method: {}", header_obj.compression_method);
+	LOG("filter_method: {}", header_obj.filter_method);
+	LOG("interlace_method: {}\n", header_obj.interlace_method);
+
+	// Sizes fit in 31 bits, so that the decoded size cannot overflow.
+	if (0 == header_obj.width || 0 == header_obj.height || 0x7FFFFFFF < header_obj.width || 0x7FFFFFFF < header_obj.height)
+	{
+		throw std::invalid_argument{ std::format("Image of {}x{} pixels is invalid!", header_obj.width, header_obj.height) };
+	}
+
+	const std::uint8_t depth = header_obj.bit_depth;
+	const bool         valid = 0 != get_channels_count(header_obj.color_type)
+	                  && (COLOR_TYPE_GRAY == header_obj.color_type    ? 1 == depth || 2 == depth || 4 == depth || 8 == depth || 16 == depth
+	                      : COLOR_TYPE_INDEXED == header_obj.color_type ? 1 == depth || 2 == depth || 4 == depth || 8 == depth
+	                                                                    : 8 == depth || 16 == depth);
+
+	if (!valid)
+	{
+		throw std::invalid_argument{ std::format("Bit depth {} of color type {} is invalid!", depth, header_obj.color_type) };
+	}
+
+	if (0 != header_obj.compression_method || 0 != header_obj.filter_method || 1 < header_obj.interlace_method)
+	{
+		throw std::invalid_argument{ std::format("Compression method {}, filter method {} or interlace method {} is not supported!", header_obj.compression_method,
+		                                         header_obj.filter_method, header_obj.interlace_method) };
+	}
+
+	timer.next(stats_phase::read);
+	file = file_data;
+}
+
+static std::uint32_t load_big_endian(const std::span<const std::uint8_t> bytes) noexcept
+{
+	std::uint32_t value = 0;
+
+	for (const std::uint8_t byte : bytes)
+	{
+		value = value << 8 | byte;
+	}
+
+	return value;
+}
+
+static std::size_t get_channels_count(const std::uint8_t color_type) noexcept
+{
+	switch (color_type)
+	{
+		case COLOR_TYPE_GRAY:
+		case COLOR_TYPE_INDEXED:
+			return 1;
+		case COLOR_TYPE_GRAY_ALPHA:
+			return 2;
+		case COLOR_TYPE_RGB:
+			return 3;
+		case COLOR_TYPE_RGBA:
+			return 4;
+		default:
+			return 0;
+	}
+}
+
+static void convert_row(const row_format&                   format,
+                        const std::span<const std::uint8_t> row,
+                        const std::span<std::uint8_t>       destination,
+                        const std::span<std::uint8_t>       indices) noexcept
+{
+	const pixel_kernels& kernels = get_pixel_kernels();
+	const std::size_t    count   = destination.size() / 4;
+
+	if (format.lookup && 8 == format.bit_depth)
+	{
+		kernels.expand_palette(row, format.colors, destination);
+		return;
+	}
+
+	if (format.lookup)
+	{
+		// Indices and gray levels of less than 8 bits are packed starting from the most significant bits.
+		for (std::size_t x = 0; x < count; ++x)
+		{
+			const std::size_t bit = x * format.bit_depth;
+
+			indices[x] = static_cast<std::uint8_t>((row[bit / 8] >> (8 - format.bit_depth - bit % 8)) & ((1U << format.bit_depth) - 1));
+		}
+
+		kernels.expand_palette(indices, format.colors, destination);
+		return;
+	}
+
+	if (8 == format.bit_depth && COLOR_TYPE_RGBA == format.color_type)
+	{
+		kernels.swap_red_blue(row, destination);
+		return;
+	}
+
+	if (8 == format.bit_depth && COLOR_TYPE_RGB == format.color_type && !format.has_key)
+	{
+		kernels.expand_bgr(row, destination);
+		kernels.swap_red_blue(destination, destination);
+		return;
+	}
+
+	// The other formats are rare in icons, they are converted one sample at a time.
+	const std::size_t sample_size = format.bit_depth / 8;
+	const bool        gray        = 2 >= format.channels;
+
+	for (std::size_t x = 0; x < count; ++x)
+	{
+		const std::span<const std::uint8_t> pixel  = row.subspan(x * format.channels * sample_size, format.channels * sample_size);
+		const auto                          sample = [&pixel, sample_size](const std::size_t channel)
+		{
+			return static_cast<std::uint16_t>(load_big_endian(pixel.subspan(channel * sample_size, sample_size)));
+		};
+
+		const std::uint16_t red   = sample(0);
+		const std::uint16_t green = gray ? red : sample(1);
+		const std::uint16_t blue  = gray ? red : sample(2);
+		const bool          keyed = format.has_key && red == format.key[0] && (gray || (green == format.key[1] && blue == format.key[2]));
+		const std::uint16_t alpha = 2 == format.channels ? sample(1) : 4 == format.channels ? sample(3) : keyed ? 0 : 0xFFFF;
+		const std::uint32_t shift = 8 * static_cast<std::uint32_t>(sample_size - 1);
+
+		destination[x * 4]     = static_cast<std::uint8_t>(blue >> shift);
+		destination[x * 4 + 1] = static_cast<std::uint8_t>(green >> shift);
+		destination[x * 4 + 2] = static_cast<std::uint8_t>(red >> shift);
+		destination[x * 4 + 3] = static_cast<std::uint8_t>(alpha >> shift);
+	}
+}
+
+} // namespace icon_changer
@@ -0,0 +1,141 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+#include "bgra_image.hpp"
+#include "byte_source.hpp"
+#include "memory_budget.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief Represents a PNG file.
+/// \see https://www.w3.org/TR/png/
+///
+class png_file final
+{
+public:
+	///
+	/// \brief This data structure corresponds to the IHDR chunk.
+	///
+	struct header final
+	{
+		std::uint32_t width;              //< Image width in pixels.
+		std::uint32_t height;             //< Image height in pixels.
+		std::uint8_t  bit_depth;          //< Bits per sample or palette index: 1, 2, 4, 8 or 16.
+		std::uint8_t  color_type;         //< 0 for gray, 2 for RGB, 3 for indexed, 4 for gray with alpha and 6 for RGBA.
+		std::uint8_t  compression_method; //< Compression method, must be 0 (zlib).
+		std::uint8_t  filter_method;      //< Filter method, must be 0 (adaptive).
+		std::uint8_t  interlace_method;   //< 0 if the rows are in order, 1 for Adam7 interlacing.
+	};
+
+	///
+	/// \brief Reads a PNG file and parses its header.
+	/// \details The file is read with a single read into a buffer owned by this object.
+	/// \param file_path: Path to the PNG file.
+	/// \param resource: The memory resource to allocate from, it must outlive this object.
+	///
+	png_file(std::string_view           file_path,
+	         std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+	///
+	/// \brief Reads a PNG file from a byte source and parses its header.
+	/// \details The source is read until its end into a buffer owned by this object.
+	/// \param source: The byte source (e.g. a file or the standard input).
+	/// \param resource: The memory resource to allocate from, it must outlive this object.
+	/// \param budget: The budget the buffer is charged to, nullptr for none.
+	///
+	png_file(byte_source&               source,
+	         std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+	         memory_budget*             budget   = nullptr);
+
+	///
+	/// \brief Parses the header of a PNG file in memory.
+	/// \details No bytes are copied, the given bytes must outlive this object.
+	/// \param file_data: The content of the PNG file (e.g. memory mapped).
+	///
+	png_file(std::span<const std::uint8_t> file_data);
+
+	///
+	/// \brief Gets the parsed IHDR chunk.
+	/// \returns A copy of the header.
+	///
+	header get_header() const noexcept;
+
+	///
+	/// \brief Gets the whole PNG file, as it can be stored in an icon.
+	/// \returns A view of the file bytes.
+	///
+	std::span<const std::uint8_t> get_file() const noexcept;
+
+	///
+	/// \brief Releases the buffer owning the file read from a byte source.
+	/// \details The file view stays valid as long as the buffer lives.
+	/// \returns The file buffer, empty if the PNG file was parsed in memory.
+	///
+	[[nodiscard]] std::pmr::vector<std::uint8_t> release_buffer() noexcept;
+
+	///
+	/// \brief Decodes the image into 32bpp BGRA.
+	/// \details Every color type and bit depth is supported, interlaced or not,
+	/// along with the transparency of the tRNS chunk. The IDAT chunks are
+	/// inflated as they are walked, each row being unfiltered and converted as
+	/// soon as it is complete, so the decompressed data is never held whole.
+	/// 16-bit samples keep their most significant byte. The CRC of every chunk
+	/// is checked.
+	/// \param budget: The budget the decoded pixels are charged to before they
+	/// are allocated, nullptr for none.
+	/// \returns The decoded image.
+	///
+	bgra_image decode(memory_budget* budget = nullptr) const;
+
+private:
+	///
+	/// \brief Checks the signature and parses the IHDR chunk of a PNG file in memory.
+	/// \param file_data: The content of the PNG file.
+	///
+	void parse(std::span<const std::uint8_t> file_data);
+
+private:
+	///
+	/// \brief Parsed IHDR chunk.
+	///
+	header header_obj;
+
+	///
+	/// \brief Buffer owning the file read from a byte source.
+	///
+	std::pmr::vector<std::uint8_t> buffer;
+
+	///
+	/// \brief The content of the PNG file.
+	///
+	std::span<const std::uint8_t> file;
+};
+
+} // namespace icon_changer
@@ -0,0 +1,310 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include "resampler.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief The source pixels covered by a destination pixel along one axis.
+///
+struct contribution final
+{
+	std::uint32_t first;          ///< Index of the first covered source pixel.
+	std::uint32_t count;          ///< Number of covered source pixels.
+	std::size_t   weights_offset; ///< Offset of the weight of the first source pixel.
+};
+
+///
+/// \brief The contributions of the source pixels to every destination pixel along one axis.
+///
+struct axis final
+{
+	std::vector<contribution> contributions; ///< The contribution of each destination pixel.
+	std::vector<float>        weights;       ///< The weights of the covered source pixels, summing up to 1 per destination pixel.
+};
+
+///
+/// \brief The 4 channels of a pixel.
+///
+struct vector4 final
+{
+#if defined(__SSE2__)
+	__m128 lanes; ///< The channels in BGRA order, one per lane.
+#else
+	float lanes[4]; ///< The channels in BGRA order.
+#endif
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Computes the area covered by each destination pixel along one axis.
+/// \param source_size: Number of source pixels along the axis.
+/// \param size: Number of destination pixels along the axis.
+/// \returns The contributions of the source pixels.
+///
+static axis make_axis(std::uint32_t source_size,
+                      std::uint32_t size);
+
+///
+/// \brief Averages one source row horizontally.
+/// \param row: The BGRA pixels of the source row.
+/// \param columns: The contributions of the source columns.
+/// \param filtered: Receives the premultiplied destination pixels.
+///
+static void filter_row(const std::uint8_t* row,
+                       const axis&         columns,
+                       std::span<vector4>  filtered) noexcept;
+
+///
+/// \brief Gets a pixel with all channels set to 0.
+/// \returns The pixel.
+///
+static vector4 zero() noexcept;
+
+///
+/// \brief Loads a BGRA pixel and premultiplies its colors by its alpha.
+/// \param pixel: The 4 bytes of the pixel.
+/// \returns The premultiplied pixel.
+///
+static vector4 load_premultiplied(const std::uint8_t* pixel) noexcept;
+
+///
+/// \brief Adds a weighted pixel to a sum.
+/// \param sum: The sum.
+/// \param weight: The weight of the pixel.
+/// \param value: The pixel.
+/// \returns The new sum.
+///
+static vector4 multiply_add(vector4 sum,
+                            float   weight,
+                            vector4 value) noexcept;
+
+///
+/// \brief Divides the colors of a premultiplied pixel by its alpha and stores it as BGRA.
+/// \param value: The premultiplied pixel.
+/// \param pixel: Receives the 4 bytes of the pixel.
+///
+static void store_unpremultiplied(vector4       value,
+                                  std::uint8_t* pixel) noexcept;
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+void resample(const bgra_image&             source,
+              const std::uint32_t           width,
+              const std::uint32_t           height,
+              const std::span<std::uint8_t> pixels)
+{
+	assert(0 != source.width && 0 != source.height);
+	assert(static_cast<std::size_t>(source.width) * source.height * 4 == source.pixels.size());
+	assert(static_cast<std::size_t>(width) * height * 4 == pixels.size());
+
+	const axis           columns  = make_axis(source.width, width);
+	const axis           rows     = make_axis(source.height, height);
+	std::vector<vector4> filtered = std::vector<vector4>(width);
+	std::vector<vector4> sum      = std::vector<vector4>(width);
+
+	// Separable filter: each source row is averaged horizontally, then accumulated into the destination row.
+	for (std::uint32_t y = 0; y < height; ++y)
+	{
+		const contribution& contribution = rows.contributions[y];
+		std::uint8_t* const destination  = pixels.data() + static_cast<std::size_t>(height - 1 - y) * width * 4;
+
+		std::ranges::fill(sum, zero());
+
+		for (std::uint32_t index = 0; index < contribution.count; ++index)
+		{
+			const std::size_t row    = contribution.first + index;
+			const float       weight = rows.weights[contribution.weights_offset + index];
+
+			filter_row(source.pixels.data() + row * source.width * 4, columns, filtered);
+
+			for (std::uint32_t x = 0; x < width; ++x)
+			{
+				sum[x] = multiply_add(sum[x], weight, filtered[x]);
+			}
+		}
+
+		for (std::uint32_t x = 0; x < width; ++x)
+		{
+			store_unpremultiplied(sum[x], destination + x * 4);
+		}
+	}
+}
+
+static axis make_axis(const std::uint32_t source_size,
+                      const std::uint32_t size)
+{
+	const double scale = static_cast<double>(source_size) / size;
+	axis         axis  = {};
+
+	axis.contributions.reserve(size);
+
+	for (std::uint32_t index = 0; index < size; ++index)
+	{
+		const double        start = index * scale;
+		const double        end   = (index + 1) * scale;
+		const std::uint32_t first = static_cast<std::uint32_t>(start);
+		const std::uint32_t last  = std::min(static_cast<std::uint32_t>(std::ceil(end)), source_size);
+
+		axis.contributions.push_back(contribution{ first, last - first, axis.weights.size() });
+
+		for (std::uint32_t source_index = first; source_index < last; ++source_index)
+		{
+			const double covered = std::min(end, source_index + 1.0) - std::max(start, static_cast<double>(source_index));
+
+			axis.weights.push_back(static_cast<float>(covered / scale));
+		}
+	}
+
+	return axis;
+}
+
+static void filter_row(const std::uint8_t* const row,
+                       const axis&               columns,
+                       const std::span<vector4>  filtered) noexcept
+{
+	for (std::size_t x = 0; x < filtered.size(); ++x)
+	{
+		const contribution& contribution = columns.contributions[x];
+		vector4             sum          = zero();
+
+		for (std::uint32_t index = 0; index < contribution.count; ++index)
+		{
+			sum = multiply_add(sum, columns.weights[contribution.weights_offset + index], load_premultiplied(row + (contribution.first + index) * 4));
+		}
+
+		filtered[x] = sum;
+	}
+}
+
+#if defined(__SSE2__)
+
+static vector4 zero() noexcept
+{
+	return vector4{ _mm_setzero_ps() };
+}
+
+static vector4 load_premultiplied(const std::uint8_t* const pixel) noexcept
+{
+	const __m128 color_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+	const __m128 alpha_255  = _mm_set_ps(255.0F, 0.0F, 0.0F, 0.0F);
+	std::int32_t bytes      = 0;
+	__m128i      integers   = {};
+	__m128       value      = {};
+	__m128       alpha      = {};
+
+	std::memcpy(&bytes, pixel, sizeof(bytes));
+
+	integers = _mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), _mm_setzero_si128());
+	integers = _mm_unpacklo_epi16(integers, _mm_setzero_si128());
+	value    = _mm_cvtepi32_ps(integers);
+	alpha    = _mm_shuffle_ps(value, value, _MM_SHUFFLE(3, 3, 3, 3));
+
+	// The colors are multiplied by alpha / 255, the alpha by 255 / 255.
+	return vector4{ _mm_mul_ps(value, _mm_mul_ps(_mm_or_ps(_mm_and_ps(alpha, color_mask), alpha_255), _mm_set1_ps(1.0F / 255.0F))) };
+}
+
+static vector4 multiply_add(const vector4 sum,
+                            const float   weight,
+                            const vector4 value) noexcept
+{
+	return vector4{ _mm_add_ps(sum.lanes, _mm_mul_ps(_mm_set1_ps(weight), value.lanes)) };
+}
+
+static void store_unpremultiplied(const vector4       value,
+                                  std::uint8_t* const pixel) noexcept
+{
+	const __m128 color_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+	const __m128 alpha_one  = _mm_set_ps(1.0F, 0.0F, 0.0F, 0.0F);
+	const __m128 alpha      = _mm_shuffle_ps(value.lanes, value.lanes, _MM_SHUFFLE(3, 3, 3, 3));
+	const __m128 factor     = _mm_div_ps(_mm_set1_ps(255.0F), _mm_max_ps(alpha, _mm_set1_ps(1.0F / 256.0F)));
+	__m128       result     = _mm_mul_ps(value.lanes, _mm_or_ps(_mm_and_ps(factor, color_mask), alpha_one));
+	__m128i      integers   = {};
+	std::int32_t bytes      = 0;
+
+	result   = _mm_min_ps(_mm_max_ps(result, _mm_setzero_ps()), _mm_set1_ps(255.0F));
+	integers = _mm_cvtps_epi32(result);
+	integers = _mm_packs_epi32(integers, integers);
+	integers = _mm_packus_epi16(integers, integers);
+	bytes    = _mm_cvtsi128_si32(integers);
+
+	std::memcpy(pixel, &bytes, sizeof(bytes));
+}
+
+#else
+
+static vector4 zero() noexcept
+{
+	return vector4{};
+}
+
+static vector4 load_premultiplied(const std::uint8_t* const pixel) noexcept
+{
+	const float alpha = pixel[3] * (1.0F / 255.0F);
+
+	return vector4{ { pixel[0] * alpha, pixel[1] * alpha, pixel[2] * alpha, static_cast<float>(pixel[3]) } };
+}
+
+static vector4 multiply_add(vector4       sum,
+                            const float   weight,
+                            const vector4 value) noexcept
+{
+	for (std::size_t lane = 0; lane < 4; ++lane)
+	{
+		sum.lanes[lane] += weight * value.lanes[lane];
+	}
+
+	return sum;
+}
+
+static void store_unpremultiplied(const vector4       value,
+                                  std::uint8_t* const pixel) noexcept
+{
+	const float factor = 255.0F / std::max(value.lanes[3], 1.0F / 256.0F);
+
+	for (std::size_t lane = 0; lane < 4; ++lane)
+	{
+		const float channel = 3 == lane ? value.lanes[lane] : value.lanes[lane] * factor;
+
+		pixel[lane] = static_cast<std::uint8_t>(std::nearbyint(std::clamp(channel, 0.0F, 255.0F)));
+	}
+}
+
+#endif
+
+} // namespace icon_changer
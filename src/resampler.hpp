@@ -0,0 +1,48 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <span>
+
+#include "bgra_image.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DECLARATIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief Resizes an image with an area (box) filter.
+/// \details Each destination pixel is the average of the source pixels it
+/// covers, weighted by the covered area. Colors are premultiplied by alpha
+/// while averaging, so transparent pixels do not bleed into their neighbours.
+/// \param source: The image to be resized.
+/// \param width: Width of the destination in pixels.
+/// \param height: Height of the destination in pixels.
+/// \param pixels: The destination BGRA pixels, width * height * 4 bytes. The
+/// rows are written bottom-up, as stored in a DIB.
+///
+extern void resample(const bgra_image&       source,
+                     std::uint32_t           width,
+                     std::uint32_t           height,
+                     std::span<std::uint8_t> pixels);
+
+} // namespace icon_changer
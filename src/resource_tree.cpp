@@ -0,0 +1,390 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include "resource_tree.hpp"
+
+#include <cassert>
+#include <charconv>
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTANTS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief High bit of a directory entry's offset marking a subdirectory.
+///
+static constexpr std::uint32_t SUBDIRECTORY_FLAG = 0x80000000;
+
+///
+/// \brief High bit of a directory entry's name marking a string identifier.
+///
+static constexpr std::uint32_t NAME_FLAG = 0x80000000;
+
+///
+/// \brief Number of levels of a resource tree: type, name and language.
+///
+static constexpr std::size_t LEVELS_COUNT = 3;
+
+///
+/// \brief Alignment of each resource data blob inside the section.
+///
+static constexpr std::uint32_t DATA_ALIGNMENT = 8;
+
+////////////////////////////////////////////////////////////////////////////////
+// METHOD DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+resource_tree::resource_tree(const std::span<const std::uint8_t> section,
+                             const std::uint32_t                 directory_offset,
+                             const std::uint32_t                 section_rva)
+    : types{}
+{
+	std::vector<identifier> path        = {};
+	std::set<std::uint32_t> directories = {};
+
+	parse_directory(section, section_rva, directory_offset, path, directories);
+}
+
+resource_tree::identifier resource_tree::make_identifier(const std::string_view name)
+{
+	std::uint16_t  id     = 0;
+	std::u16string result = {};
+
+	// Same as the Win32 API, "#123" stands for the integer ID 123.
+	if (name.starts_with('#'))
+	{
+		const std::from_chars_result parsed = std::from_chars(name.data() + 1, name.data() + name.size(), id);
+
+		if (std::errc{} == parsed.ec && name.data() + name.size() == parsed.ptr)
+		{
+			return id;
+		}
+	}
+
+	for (const char character : name)
+	{
+		result.push_back(static_cast<char16_t>('a' <= character && 'z' >= character ? character - 'a' + 'A' : character));
+	}
+
+	return result;
+}
+
+std::string resource_tree::to_string(const identifier& identifier)
+{
+	static constexpr char32_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+	if (const std::uint16_t* const id = std::get_if<std::uint16_t>(&identifier))
+	{
+		return std::format("{}", *id);
+	}
+
+	const std::u16string& name   = std::get<std::u16string>(identifier);
+	std::string           result = {};
+
+	for (std::size_t index = 0; index < name.size(); ++index)
+	{
+		char32_t code_point = name[index];
+
+		// A surrogate pair encodes a code point above 0xFFFF, a lone surrogate is replaced.
+		if (0xD800 <= code_point && 0xDC00 > code_point && index + 1 < name.size() && 0xDC00 <= name[index + 1] && 0xE000 > name[index + 1])
+		{
+			code_point = 0x10000 + ((code_point - 0xD800) << 10) + (name[++index] - 0xDC00);
+		}
+		else if (0xD800 <= code_point && 0xE000 > code_point)
+		{
+			code_point = REPLACEMENT_CHARACTER;
+		}
+
+		if (0x80 > code_point)
+		{
+			result.push_back(static_cast<char>(code_point));
+		}
+		else if (0x800 > code_point)
+		{
+			result.push_back(static_cast<char>(0xC0 | code_point >> 6));
+			result.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+		}
+		else if (0x10000 > code_point)
+		{
+			result.push_back(static_cast<char>(0xE0 | code_point >> 12));
+			result.push_back(static_cast<char>(0x80 | (code_point >> 6 & 0x3F)));
+			result.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+		}
+		else
+		{
+			result.push_back(static_cast<char>(0xF0 | code_point >> 18));
+			result.push_back(static_cast<char>(0x80 | (code_point >> 12 & 0x3F)));
+			result.push_back(static_cast<char>(0x80 | (code_point >> 6 & 0x3F)));
+			result.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+		}
+	}
+
+	return result;
+}
+
+void resource_tree::set(const identifier&                   type,
+                        const identifier&                   name,
+                        const identifier&                   language,
+                        const std::span<const std::uint8_t> data)
+{
+	types[type][name][language] = resource{ data, 0 };
+}
+
+std::size_t resource_tree::remove(const identifier& type,
+                                  const identifier& name)
+{
+	const type_map::iterator names = types.find(type);
+	std::size_t              size  = 0;
+
+	if (types.end() == names)
+	{
+		return 0;
+	}
+
+	const name_map::iterator languages = names->second.find(name);
+
+	if (names->second.end() == languages)
+	{
+		return 0;
+	}
+
+	for (const auto& [language, resource] : languages->second)
+	{
+		size += resource.data.size();
+	}
+
+	names->second.erase(languages);
+
+	// Empty directories are not valid in a resource section.
+	if (names->second.empty())
+	{
+		types.erase(names);
+	}
+
+	return size;
+}
+
+const resource_tree::type_map& resource_tree::get_types() const noexcept
+{
+	return types;
+}
+
+std::vector<std::uint8_t> resource_tree::serialize(const std::uint32_t section_rva) const
+{
+	std::vector<std::uint8_t> bytes              = {};
+	std::uint32_t             directories_size   = 0;
+	std::uint32_t             data_entries_count = 0;
+	std::uint32_t             strings_size       = 0;
+	std::uint32_t             data_size          = 0;
+
+	const auto directory_size = [](const std::size_t entries_count)
+	{
+		return static_cast<std::uint32_t>(sizeof(directory) + entries_count * sizeof(directory_entry));
+	};
+
+	const auto string_size = [](const identifier& id)
+	{
+		const std::u16string* const name = std::get_if<std::u16string>(&id);
+
+		return nullptr == name ? 0 : static_cast<std::uint32_t>(sizeof(std::uint16_t) + name->size() * sizeof(char16_t));
+	};
+
+	// First pass computes the size of each area so that offsets are known upfront.
+	directories_size += directory_size(types.size());
+
+	for (const auto& [type, names] : types)
+	{
+		strings_size     += string_size(type);
+		directories_size += directory_size(names.size());
+
+		for (const auto& [name, languages] : names)
+		{
+			strings_size     += string_size(name);
+			directories_size += directory_size(languages.size());
+
+			for (const auto& [language, resource] : languages)
+			{
+				strings_size += string_size(language);
+				data_size    += align_up(static_cast<std::uint32_t>(resource.data.size()), DATA_ALIGNMENT);
+				++data_entries_count;
+			}
+		}
+	}
+
+	const std::uint32_t data_entries_offset = directories_size;
+	const std::uint32_t strings_offset      = data_entries_offset + data_entries_count * static_cast<std::uint32_t>(sizeof(data_entry));
+	const std::uint32_t data_offset         = align_up(strings_offset + strings_size, DATA_ALIGNMENT);
+
+	std::uint32_t next_directory  = 0;
+	std::uint32_t next_data_entry = data_entries_offset;
+	std::uint32_t next_string     = strings_offset;
+	std::uint32_t next_data       = data_offset;
+
+	bytes.resize(data_offset + data_size);
+
+	const auto write_name = [&](const identifier& id) -> std::uint32_t
+	{
+		if (const std::uint16_t* const integer = std::get_if<std::uint16_t>(&id))
+		{
+			return *integer;
+		}
+
+		const std::u16string& name   = std::get<std::u16string>(id);
+		const std::uint32_t   offset = next_string;
+
+		icon_changer::serialize(static_cast<std::uint16_t>(name.size()), bytes, offset);
+		std::memcpy(bytes.data() + offset + sizeof(std::uint16_t), name.data(), name.size() * sizeof(char16_t));
+
+		next_string += string_size(id);
+		return NAME_FLAG | offset;
+	};
+
+	const auto write_directory = [&](const auto& entries, const auto& write_child) -> std::uint32_t
+	{
+		const std::uint32_t offset       = next_directory;
+		std::uint32_t       entry_offset = offset + sizeof(directory);
+		directory           header       = {};
+
+		next_directory += directory_size(entries.size());
+
+		for (const auto& [id, child] : entries)
+		{
+			++(std::holds_alternative<std::u16string>(id) ? header.named_entries_count : header.id_entries_count);
+		}
+
+		icon_changer::serialize(header, bytes, offset);
+
+		for (const auto& [id, child] : entries)
+		{
+			icon_changer::serialize(directory_entry{ write_name(id), write_child(child) }, bytes, entry_offset);
+			entry_offset += sizeof(directory_entry);
+		}
+
+		return offset;
+	};
+
+	const auto write_resource = [&](const resource& resource) -> std::uint32_t
+	{
+		const std::uint32_t offset = next_data_entry;
+		const data_entry    entry  = { section_rva + next_data, static_cast<std::uint32_t>(resource.data.size()), resource.code_page, 0 };
+
+		icon_changer::serialize(entry, bytes, offset);
+		std::memcpy(bytes.data() + next_data, resource.data.data(), resource.data.size());
+
+		next_data_entry += sizeof(data_entry);
+		next_data       += align_up(entry.size, DATA_ALIGNMENT);
+		return offset;
+	};
+
+	const auto write_languages = [&](const language_map& languages) -> std::uint32_t
+	{
+		return SUBDIRECTORY_FLAG | write_directory(languages, write_resource);
+	};
+
+	const auto write_names = [&](const name_map& names) -> std::uint32_t
+	{
+		return SUBDIRECTORY_FLAG | write_directory(names, write_languages);
+	};
+
+	write_directory(types, write_names);
+
+	assert(directories_size == next_directory);
+	assert(strings_offset == next_data_entry);
+	assert(bytes.size() == next_data);
+
+	return bytes;
+}
+
+void resource_tree::parse_directory(const std::span<const std::uint8_t> section,
+                                    const std::uint32_t                 section_rva,
+                                    const std::uint32_t                 offset,
+                                    std::vector<identifier>&            path,
+                                    std::set<std::uint32_t>&            directories)
+{
+	// Entries sharing a subdirectory would have it parsed once per path to it, which grows with the cube of the entries.
+	if (!directories.insert(offset).second)
+	{
+		throw std::invalid_argument{ std::format("Resource directory at offset 0x{:X} is referenced more than once!", offset) };
+	}
+
+	const directory   header        = deserialize<directory>(section, offset);
+	const std::size_t entries_count = header.named_entries_count + header.id_entries_count;
+
+	for (std::size_t index = 0; index < entries_count; ++index)
+	{
+		const directory_entry entry = deserialize<directory_entry>(section, offset + sizeof(directory) + index * sizeof(directory_entry));
+
+		path.push_back(read_identifier(section, entry.name));
+
+		if (SUBDIRECTORY_FLAG & entry.offset)
+		{
+			if (LEVELS_COUNT == path.size())
+			{
+				throw std::invalid_argument{ std::format("Resource directory is nested deeper than {} levels!", LEVELS_COUNT) };
+			}
+
+			parse_directory(section, section_rva, entry.offset & ~SUBDIRECTORY_FLAG, path, directories);
+		}
+		else
+		{
+			if (LEVELS_COUNT != path.size())
+			{
+				throw std::invalid_argument{ std::format("Resource data found on level {}, expecting level {}!", path.size(), LEVELS_COUNT) };
+			}
+
+			const data_entry  data        = deserialize<data_entry>(section, entry.offset);
+			const std::size_t data_offset = static_cast<std::size_t>(data.data_rva) - section_rva;
+
+			if (section_rva > data.data_rva || data_offset > section.size() || data.size > section.size() - data_offset)
+			{
+				throw std::invalid_argument{ std::format("Resource data at RVA 0x{:X} lies outside of the resource section!", data.data_rva) };
+			}
+
+			types[path[0]][path[1]][path[2]] = resource{ section.subspan(data_offset, data.size), data.code_page };
+		}
+
+		path.pop_back();
+	}
+}
+
+resource_tree::identifier resource_tree::read_identifier(const std::span<const std::uint8_t> section,
+                                                         const std::uint32_t                 name)
+{
+	if (0 == (NAME_FLAG & name))
+	{
+		return static_cast<std::uint16_t>(name);
+	}
+
+	const std::size_t   offset = name & ~NAME_FLAG;
+	const std::uint16_t length = deserialize<std::uint16_t>(section, offset);
+	std::u16string      result = {};
+
+	if (length * sizeof(char16_t) > section.size() - offset - sizeof(length))
+	{
+		throw std::invalid_argument{ std::format("Resource name at offset 0x{:X} lies outside of the resource section!", offset) };
+	}
+
+	result.resize(length);
+	std::memcpy(result.data(), section.data() + offset + sizeof(length), length * sizeof(char16_t));
+
+	return result;
+}
+
+} // namespace icon_changer
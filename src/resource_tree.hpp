@@ -0,0 +1,217 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <map>
+#include <set>
+#include <span>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "utility.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTANTS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief Resource type of a single icon image.
+///
+inline constexpr std::uint16_t RT_ICON = 3;
+
+///
+/// \brief Resource type of an icon group (NEWHEADER + RESDIR entries).
+///
+inline constexpr std::uint16_t RT_GROUP_ICON = 14;
+
+///
+/// \brief Language identifier of language neutral resources.
+///
+inline constexpr std::uint16_t LANG_NEUTRAL = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief In-memory model of a PE resource directory (the `.rsrc` section).
+/// \details Resources are organized on three levels: type, name and language.
+/// The tree does not own the resource data, it only keeps views into buffers
+/// (the parsed executable, loaded icons) which must outlive it.
+/// \see https://learn.microsoft.com/en-us/windows/win32/debug/pe-format#the-rsrc-section
+///
+class resource_tree final
+{
+public:
+	///
+	/// \brief This data structure corresponds to IMAGE_RESOURCE_DIRECTORY.
+	///
+	struct PACKED directory final
+	{
+		std::uint32_t characteristics;     ///< Resource flags, reserved.
+		std::uint32_t time_date_stamp;     ///< Time the resource data was created.
+		std::uint16_t major_version;       ///< Major version number, set by the user.
+		std::uint16_t minor_version;       ///< Minor version number, set by the user.
+		std::uint16_t named_entries_count; ///< Number of entries identified by a string.
+		std::uint16_t id_entries_count;    ///< Number of entries identified by an integer.
+	};
+
+	///
+	/// \brief This data structure corresponds to IMAGE_RESOURCE_DIRECTORY_ENTRY.
+	///
+	struct PACKED directory_entry final
+	{
+		std::uint32_t name;   ///< Integer ID or, if the high bit is set, offset of the name string.
+		std::uint32_t offset; ///< Offset of a data entry or, if the high bit is set, of a subdirectory.
+	};
+
+	///
+	/// \brief This data structure corresponds to IMAGE_RESOURCE_DATA_ENTRY.
+	///
+	struct PACKED data_entry final
+	{
+		std::uint32_t data_rva;  ///< Relative virtual address of the resource data.
+		std::uint32_t size;      ///< Size of the resource data in bytes.
+		std::uint32_t code_page; ///< Code page used to decode code point values.
+		std::uint32_t reserved;  ///< Reserved, must be 0.
+	};
+
+	///
+	/// \brief Identifies a resource on any level of the tree.
+	/// \details Named identifiers are ordered before integer ones, which is the
+	/// order required by the PE format.
+	///
+	using identifier = std::variant<std::u16string, std::uint16_t>;
+
+	///
+	/// \brief A leaf of the tree.
+	///
+	struct resource final
+	{
+		std::span<const std::uint8_t> data;      ///< View of the resource data.
+		std::uint32_t                 code_page; ///< Code page of the resource data.
+	};
+
+	using language_map = std::map<identifier, resource>;
+	using name_map     = std::map<identifier, language_map>;
+	using type_map     = std::map<identifier, name_map>;
+
+public:
+	///
+	/// \brief Creates an empty resource tree.
+	///
+	resource_tree() = default;
+
+	///
+	/// \brief Parses the resource directory of an executable.
+	/// \param section: The raw data of the section containing the resource directory.
+	/// \param directory_offset: Offset of the root directory inside the section.
+	/// \param section_rva: Relative virtual address where the section is loaded.
+	///
+	resource_tree(std::span<const std::uint8_t> section,
+	              std::uint32_t                 directory_offset,
+	              std::uint32_t                 section_rva);
+
+	///
+	/// \brief Makes an identifier from a resource name.
+	/// \details Names are stored upper-case, same as the resource compiler does.
+	/// \param name: The ASCII name of the resource.
+	/// \returns The named identifier.
+	///
+	[[nodiscard]] static identifier make_identifier(std::string_view name);
+
+	///
+	/// \brief Formats an identifier for the user.
+	/// \param identifier: The identifier.
+	/// \returns The integer ID in decimal or the name in UTF-8.
+	///
+	[[nodiscard]] static std::string to_string(const identifier& identifier);
+
+	///
+	/// \brief Adds a resource or replaces the one with the same identifiers.
+	/// \param type: The resource type (e.g. RT_ICON).
+	/// \param name: The resource name or integer ID.
+	/// \param language: The resource language.
+	/// \param data: The resource data, must outlive the tree.
+	///
+	void set(const identifier&             type,
+	         const identifier&             name,
+	         const identifier&             language,
+	         std::span<const std::uint8_t> data);
+
+	///
+	/// \brief Removes a resource in every language.
+	/// \param type: The resource type (e.g. RT_ICON).
+	/// \param name: The resource name or integer ID.
+	/// \returns The size of the removed resource data in bytes.
+	///
+	std::size_t remove(const identifier& type,
+	                   const identifier& name);
+
+	///
+	/// \brief Gets all resources organized by type, name and language.
+	/// \returns A reference to the resource types.
+	///
+	const type_map& get_types() const noexcept;
+
+	///
+	/// \brief Serializes the tree into the raw data of a resource section.
+	/// \details Directories come first, followed by the data entries, the name
+	/// strings and finally the resource data.
+	/// \param section_rva: Relative virtual address where the section will be loaded.
+	/// \returns The raw section data.
+	///
+	[[nodiscard]] std::vector<std::uint8_t> serialize(std::uint32_t section_rva) const;
+
+private:
+	///
+	/// \brief Parses a directory and its subdirectories recursively.
+	/// \param section: The raw data of the resource section.
+	/// \param section_rva: Relative virtual address of the section.
+	/// \param offset: Offset of the directory inside the section.
+	/// \param path: Identifiers of the directories above this one.
+	/// \param directories: Offsets of the directories parsed so far.
+	///
+	void parse_directory(std::span<const std::uint8_t> section,
+	                     std::uint32_t                 section_rva,
+	                     std::uint32_t                 offset,
+	                     std::vector<identifier>&      path,
+	                     std::set<std::uint32_t>&      directories);
+
+	///
+	/// \brief Reads the identifier of a directory entry.
+	/// \param section: The raw data of the resource section.
+	/// \param name: The name field of the directory entry.
+	/// \returns The integer or named identifier.
+	///
+	[[nodiscard]] static identifier read_identifier(std::span<const std::uint8_t> section,
+	                                                std::uint32_t                 name);
+
+private:
+	///
+	/// \brief The resources organized by type, name and language.
+	///
+	type_map types;
+};
+
+} // namespace icon_changer
@@ -0,0 +1,642 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include "server.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <print>
+#include <stdexcept>
+#include <variant>
+#include <vector>
+
+#include "cli.hpp"
+#include "utility.hpp"
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif // _WIN32
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTANTS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief Largest number of arguments of a command.
+///
+static constexpr std::uint32_t MAX_ARGUMENTS_COUNT = 4096;
+
+///
+/// \brief Largest size of an argument in bytes.
+///
+static constexpr std::uint32_t MAX_ARGUMENT_SIZE = 64 * 1024;
+
+///
+/// \brief Seconds a client may take to send a command or to receive its result.
+///
+static constexpr std::int32_t CONNECTION_TIMEOUT = 30;
+
+///
+/// \brief Options whose value is a path, made absolute before a command is forwarded.
+///
+static constexpr std::array<std::string_view, 2> PATH_OPTIONS = { "--cache", "--depfile" };
+
+///
+/// \brief Options whose value is not a path, forwarded as is.
+///
+static constexpr std::array<std::string_view, 10> VALUE_OPTIONS = { "--jobs", "--cache-size", "--resize", "--sizes", "--depths", "--from-group", "--png", "--stats", "--keep", "--max-memory" };
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _WIN32
+
+///
+/// \brief Makes a socket address from a path.
+/// \param socket_path: The path to the socket.
+/// \returns The address.
+///
+static sockaddr_un make_address(std::string_view socket_path);
+
+///
+/// \brief Connects to a socket.
+/// \param socket_path: The path to the socket.
+/// \returns The connected socket, -1 if nothing listens on it.
+///
+static std::int32_t connect_socket(std::string_view socket_path);
+
+///
+/// \brief Reads exactly the size of a buffer from a socket.
+/// \param socket: The socket.
+/// \param bytes: The buffer to be filled.
+///
+static void receive(std::int32_t            socket,
+                    std::span<std::uint8_t> bytes);
+
+///
+/// \brief Writes a whole buffer to a socket.
+/// \param socket: The socket.
+/// \param bytes: The bytes to be written.
+///
+static void send(std::int32_t                  socket,
+                 std::span<const std::uint8_t> bytes);
+
+///
+/// \brief Reads a 32-bit integer from a socket.
+/// \param socket: The socket.
+/// \returns The integer.
+///
+static std::uint32_t receive_integer(std::int32_t socket);
+
+///
+/// \brief Writes a 32-bit integer to a socket.
+/// \param socket: The socket.
+/// \param value: The integer.
+///
+static void send_integer(std::int32_t  socket,
+                         std::uint32_t value);
+
+#endif // _WIN32
+
+///
+/// \brief Makes the paths of a command absolute.
+/// \param arguments: The arguments of the command, without the program name.
+/// \returns The arguments to be forwarded.
+///
+static std::vector<std::string> make_paths_absolute(std::span<const char* const> arguments);
+
+////////////////////////////////////////////////////////////////////////////////
+// METHOD DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+
+server::server(const std::string_view socket_path,
+               const std::size_t      threads_count,
+               const std::size_t      icons_capacity)
+    : socket_path{ socket_path }
+    , listener{ -1 }
+    , stopping{ false }
+    , connections_mutex{}
+    , connections{}
+    , icons_capacity{ icons_capacity }
+    , icons_mutex{}
+    , icons{}
+    , icons_index{}
+    , pool{ threads_count }
+{
+	throw std::runtime_error{ "The server needs Unix domain sockets, which are not supported on this platform!" };
+}
+
+server::~server() noexcept
+{
+}
+
+void server::run()
+{
+}
+
+void server::stop() noexcept
+{
+}
+
+void server::handle(std::int32_t)
+{
+}
+
+#else
+
+server::server(const std::string_view socket_path,
+               const std::size_t      threads_count,
+               const std::size_t      icons_capacity)
+    : socket_path{ socket_path }
+    , listener{ -1 }
+    , stopping{ false }
+    , connections_mutex{}
+    , connections{}
+    , icons_capacity{ 0 == icons_capacity ? 1 : icons_capacity }
+    , icons_mutex{}
+    , icons{}
+    , icons_index{}
+    , pool{ threads_count }
+{
+	const sockaddr_un  address  = make_address(socket_path);
+	const std::int32_t existing = connect_socket(socket_path);
+
+	if (-1 != existing)
+	{
+		close(existing);
+		throw std::runtime_error{ std::format("A server is already listening on \"{}\"!", socket_path) };
+	}
+
+	// Nothing listens on a socket file left behind by a server that is gone.
+	if (std::filesystem::is_socket(socket_path))
+	{
+		std::filesystem::remove(socket_path);
+	}
+
+	listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+	if (-1 == listener)
+	{
+		throw std::runtime_error{ std::format("Failed to create a socket! (error: {})", std::strerror(errno)) };
+	}
+
+	if (0 != bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) || 0 != listen(listener, SOMAXCONN))
+	{
+		const std::int32_t error = errno;
+
+		close(listener);
+		throw std::runtime_error{ std::format("Failed to listen on \"{}\"! (error: {})", socket_path, std::strerror(error)) };
+	}
+}
+
+server::~server() noexcept
+{
+	pool.wait();
+	close(listener);
+	unlink(socket_path.c_str());
+}
+
+void server::run()
+{
+	while (!stopping.load(std::memory_order_acquire))
+	{
+		const std::int32_t connection = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+
+		if (-1 == connection)
+		{
+			if (EINTR == errno || ECONNABORTED == errno || stopping.load(std::memory_order_acquire))
+			{
+				continue;
+			}
+
+			throw std::runtime_error{ std::format("Failed to accept a connection! (error: {})", std::strerror(errno)) };
+		}
+
+		pool.submit([this, connection]()
+		{
+			handle(connection);
+		});
+	}
+}
+
+void server::stop() noexcept
+{
+	stopping.store(true, std::memory_order_release);
+
+	// Wakes up the accept() blocking in run().
+	shutdown(listener, SHUT_RDWR);
+
+	// Wakes up the recv() of the commands still being received, the results of the running ones can still be sent.
+	const std::lock_guard lock = std::lock_guard{ connections_mutex };
+
+	for (const std::int32_t connection : connections)
+	{
+		shutdown(connection, SHUT_RD);
+	}
+}
+
+void server::handle(const std::int32_t connection)
+{
+	char*         buffer  = nullptr;
+	std::size_t   size    = 0;
+	std::FILE*    output  = open_memstream(&buffer, &size);
+	std::int32_t  status  = EXIT_SUCCESS;
+	const timeval timeout = { CONNECTION_TIMEOUT, 0 };
+
+	// A silent client would otherwise hold a worker forever.
+	setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+	{
+		const std::lock_guard lock = std::lock_guard{ connections_mutex };
+
+		// A connection accepted right before stop() is not in the set it shut down.
+		connections.insert(connection);
+
+		if (stopping.load(std::memory_order_acquire))
+		{
+			shutdown(connection, SHUT_RD);
+		}
+	}
+
+	try
+	{
+		if (nullptr == output)
+		{
+			throw std::runtime_error{ "Failed to capture the output of the command!" };
+		}
+
+		const std::uint32_t      arguments_count = receive_integer(connection);
+		std::vector<std::string> arguments       = { "icon-changer" };
+		std::vector<const char*> argument_values = {};
+
+		if (MAX_ARGUMENTS_COUNT < arguments_count)
+		{
+			throw std::invalid_argument{ std::format("Command has {} arguments, more than the {} limit!", arguments_count, MAX_ARGUMENTS_COUNT) };
+		}
+
+		for (std::uint32_t index = 0; index < arguments_count; ++index)
+		{
+			const std::uint32_t argument_size = receive_integer(connection);
+
+			if (MAX_ARGUMENT_SIZE < argument_size)
+			{
+				throw std::invalid_argument{ std::format("Argument of {} bytes is larger than the {} limit!", argument_size, MAX_ARGUMENT_SIZE) };
+			}
+
+			arguments.emplace_back(argument_size, '\0');
+			receive(connection, std::span{ reinterpret_cast<std::uint8_t*>(arguments.back().data()), argument_size });
+		}
+
+		for (const std::string& argument : arguments)
+		{
+			// The standard input of the server is not the client's, and nothing else may start a server.
+			if (STDIN_PATH == argument || "--batch" == argument || "--inventory" == argument || "--serve" == argument)
+			{
+				throw std::invalid_argument{ std::format("Argument \"{}\" cannot be run by the server!", argument) };
+			}
+
+			argument_values.push_back(argument.c_str());
+		}
+
+		change_icon_cli(static_cast<std::int32_t>(argument_values.size()), argument_values.data(), output,
+		                [this](const std::string_view icon_path, const icon::options& options, const icon_cache* const cache)
+		{
+			return load(icon_path, options, cache);
+		});
+	}
+	catch (const std::exception& exception)
+	{
+		status = EXIT_FAILURE;
+
+		if (nullptr != output)
+		{
+			std::println(output, RED "{}" CRESET, exception.what());
+		}
+	}
+
+	if (nullptr != output)
+	{
+		std::fclose(output);
+	}
+
+	try
+	{
+		send_integer(connection, static_cast<std::uint32_t>(status));
+		send_integer(connection, static_cast<std::uint32_t>(size));
+		send(connection, std::span{ reinterpret_cast<const std::uint8_t*>(buffer), size });
+	}
+	catch (const std::exception&)
+	{
+		// The client is gone, the command ran anyway.
+	}
+
+	{
+		const std::lock_guard lock = std::lock_guard{ connections_mutex };
+
+		connections.erase(connection);
+	}
+
+	std::free(buffer);
+	close(connection);
+}
+
+#endif // _WIN32
+
+std::shared_ptr<const icon> server::load(const std::string_view  icon_path,
+                                         const icon::options&    options,
+                                         const icon_cache* const cache)
+{
+	const auto load_icon = [icon_path, &options, cache]()
+	{
+		return std::make_shared<const icon>(nullptr != cache ? cache->load(icon_path, options) : icon{ icon_path, options });
+	};
+
+	const std::filesystem::path           path       = std::filesystem::absolute(icon_path);
+	std::error_code                       error      = {};
+	const std::uintmax_t                  file_size  = std::filesystem::file_size(path, error);
+	const std::filesystem::file_time_type write_time = error ? std::filesystem::file_time_type{} : std::filesystem::last_write_time(path, error);
+
+	// An icon that cannot be looked up is loaded as is, so that the command fails the way it does without the server.
+	if (error)
+	{
+		return load_icon();
+	}
+
+	std::string key = std::format("{}|{}|{}|{}|{}|", path.string(), file_size, write_time.time_since_epoch().count(), static_cast<std::int32_t>(options.mode),
+	                              options.png_min_size);
+
+	for (const std::vector<std::uint16_t>* const values : { &options.sizes, &options.entry_sizes, &options.entry_depths })
+	{
+		for (const std::uint16_t value : *values)
+		{
+			key += std::format("{},", value);
+		}
+
+		key += '|';
+	}
+
+	// Integer IDs are prefixed, same as in the keys of the icon cache, so that they do not share keys with names made of digits.
+	if (options.source_group.has_value())
+	{
+		key += std::format("{}{}|", std::holds_alternative<std::uint16_t>(*options.source_group) ? "#" : "", resource_tree::to_string(*options.source_group));
+	}
+
+	{
+		const std::lock_guard lock = std::lock_guard{ icons_mutex };
+
+		if (const auto found = icons_index.find(key); icons_index.end() != found)
+		{
+			icons.splice(icons.begin(), icons, found->second);
+			return found->second->second;
+		}
+	}
+
+	// Loaded without the lock, so that other commands are not held up.
+	std::shared_ptr<const icon> loaded = load_icon();
+	const std::lock_guard       lock   = std::lock_guard{ icons_mutex };
+
+	if (icons_index.contains(key))
+	{
+		return loaded;
+	}
+
+	icons.emplace_front(key, loaded);
+	icons_index.emplace(std::move(key), icons.begin());
+
+	if (icons_capacity < icons.size())
+	{
+		icons_index.erase(icons.back().first);
+		icons.pop_back();
+	}
+
+	return loaded;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+
+std::int32_t forward_cli(std::string_view,
+                         std::span<const char* const>,
+                         std::FILE*)
+{
+	throw std::runtime_error{ "The server needs Unix domain sockets, which are not supported on this platform!" };
+}
+
+#else
+
+std::int32_t forward_cli(const std::string_view             socket_path,
+                         const std::span<const char* const> arguments,
+                         std::FILE* const                   output)
+{
+	const std::vector<std::string> forwarded  = make_paths_absolute(arguments);
+	const std::int32_t             connection = connect_socket(socket_path);
+	std::string                    response   = {};
+	std::uint32_t                  status     = EXIT_FAILURE;
+
+	if (-1 == connection)
+	{
+		throw std::runtime_error{ std::format("No server is listening on \"{}\"!", socket_path) };
+	}
+
+	try
+	{
+		send_integer(connection, static_cast<std::uint32_t>(forwarded.size()));
+
+		for (const std::string& argument : forwarded)
+		{
+			send_integer(connection, static_cast<std::uint32_t>(argument.size()));
+			send(connection, std::span{ reinterpret_cast<const std::uint8_t*>(argument.data()), argument.size() });
+		}
+
+		status = receive_integer(connection);
+		response.resize(receive_integer(connection));
+		receive(connection, std::span{ reinterpret_cast<std::uint8_t*>(response.data()), response.size() });
+	}
+	catch (...)
+	{
+		close(connection);
+		throw;
+	}
+
+	close(connection);
+	std::fwrite(response.data(), 1, response.size(), output);
+
+	return static_cast<std::int32_t>(status);
+}
+
+static sockaddr_un make_address(const std::string_view socket_path)
+{
+	sockaddr_un address = {};
+
+	// One byte is left for the terminating null character.
+	if (socket_path.empty() || sizeof(address.sun_path) <= socket_path.size())
+	{
+		throw std::invalid_argument{ std::format("Socket path \"{}\" is empty or longer than {} characters!", socket_path, sizeof(address.sun_path) - 1) };
+	}
+
+	address.sun_family = AF_UNIX;
+	std::memcpy(address.sun_path, socket_path.data(), socket_path.size());
+
+	return address;
+}
+
+static std::int32_t connect_socket(const std::string_view socket_path)
+{
+	const sockaddr_un  address    = make_address(socket_path);
+	const std::int32_t connection = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+	if (-1 == connection)
+	{
+		throw std::runtime_error{ std::format("Failed to create a socket! (error: {})", std::strerror(errno)) };
+	}
+
+	if (0 != connect(connection, reinterpret_cast<const sockaddr*>(&address), sizeof(address)))
+	{
+		close(connection);
+		return -1;
+	}
+
+	return connection;
+}
+
+static void receive(const std::int32_t            socket,
+                    const std::span<std::uint8_t> bytes)
+{
+	std::size_t offset = 0;
+
+	while (offset < bytes.size())
+	{
+		const ssize_t count = recv(socket, bytes.data() + offset, bytes.size() - offset, 0);
+
+		if (0 < count)
+		{
+			offset += static_cast<std::size_t>(count);
+		}
+		else if (0 > count && (EAGAIN == errno || EWOULDBLOCK == errno))
+		{
+			throw std::runtime_error{ std::format("Connection timed out after {} of {} bytes!", offset, bytes.size()) };
+		}
+		else if (0 == count || EINTR != errno)
+		{
+			throw std::runtime_error{ std::format("Connection closed after {} of {} bytes!", offset, bytes.size()) };
+		}
+	}
+}
+
+static void send(const std::int32_t                  socket,
+                 const std::span<const std::uint8_t> bytes)
+{
+	std::size_t offset = 0;
+
+	while (offset < bytes.size())
+	{
+		// A client that went away must not kill the server with SIGPIPE.
+		const ssize_t count = ::send(socket, bytes.data() + offset, bytes.size() - offset, MSG_NOSIGNAL);
+
+		if (0 <= count)
+		{
+			offset += static_cast<std::size_t>(count);
+		}
+		else if (EINTR != errno)
+		{
+			throw std::runtime_error{ std::format("Failed to send {} bytes! (error: {})", bytes.size() - offset, std::strerror(errno)) };
+		}
+	}
+}
+
+static std::uint32_t receive_integer(const std::int32_t socket)
+{
+	std::array<std::uint8_t, sizeof(std::uint32_t)> bytes = {};
+
+	receive(socket, bytes);
+
+	return deserialize<std::uint32_t>(bytes, 0);
+}
+
+static void send_integer(const std::int32_t  socket,
+                         const std::uint32_t value)
+{
+	std::array<std::uint8_t, sizeof(std::uint32_t)> bytes = {};
+
+	serialize(value, bytes, 0);
+	send(socket, bytes);
+}
+
+#endif // _WIN32
+
+static std::vector<std::string> make_paths_absolute(const std::span<const char* const> arguments)
+{
+	std::vector<std::string> forwarded = {};
+
+	for (std::size_t index = 0; index < arguments.size(); ++index)
+	{
+		const std::string_view argument = arguments[index];
+		const bool             has_next = index + 1 < arguments.size();
+
+		forwarded.emplace_back(argument);
+
+		if (STDIN_PATH == argument || "--batch" == argument || "--inventory" == argument)
+		{
+			throw std::invalid_argument{ std::format("Argument \"{}\" cannot be forwarded to a server!", argument) };
+		}
+
+		if (has_next && PATH_OPTIONS.end() != std::ranges::find(PATH_OPTIONS, argument))
+		{
+			forwarded.push_back(std::filesystem::absolute(arguments[++index]).string());
+		}
+		else if (has_next && VALUE_OPTIONS.end() != std::ranges::find(VALUE_OPTIONS, argument))
+		{
+			forwarded.emplace_back(arguments[++index]);
+		}
+		else if (has_next && "--group" == argument)
+		{
+			const std::string_view value     = arguments[++index];
+			const std::size_t      separator = value.find('=');
+
+			// Malformed values are forwarded as they are, for the server to report.
+			forwarded.emplace_back(std::string_view::npos == separator || STDIN_PATH == value.substr(separator + 1)
+			                           ? std::string{ value }
+			                           : std::format("{}={}", value.substr(0, separator), std::filesystem::absolute(value.substr(separator + 1)).string()));
+		}
+		else if (!argument.starts_with("-"))
+		{
+			forwarded.back() = std::filesystem::absolute(argument).string();
+		}
+	}
+
+	return forwarded;
+}
+
+} // namespace icon_changer
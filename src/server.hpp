@@ -0,0 +1,183 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "icon.hpp"
+#include "icon_cache.hpp"
+#include "thread_pool.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief Long-lived process running icon changes sent over a Unix domain socket.
+/// \details Every connection carries the arguments of one command, which is run
+/// as by the CLI on a worker thread, its output and exit status being sent back.
+/// The parsed icons are kept in memory, the least recently used ones being
+/// dropped, so commands sharing icons skip reading and preparing them. Only
+/// POSIX platforms are supported.
+///
+class server final
+{
+public:
+	///
+	/// \brief Number of parsed icons kept by default.
+	///
+	static constexpr std::size_t DEFAULT_ICONS_CAPACITY = 64;
+
+	///
+	/// \brief Starts listening on a socket.
+	/// \details A socket file left behind by a server that is gone is replaced.
+	/// \param socket_path: The path to the socket.
+	/// \param threads_count: Number of commands run at once, 0 means one per hardware thread.
+	/// \param icons_capacity: Number of parsed icons kept.
+	///
+	server(std::string_view socket_path,
+	       std::size_t      threads_count  = 0,
+	       std::size_t      icons_capacity = DEFAULT_ICONS_CAPACITY);
+
+	///
+	/// \brief Waits for the running commands, then closes and removes the socket.
+	///
+	~server() noexcept;
+
+	server(const server&)            = delete;
+	server& operator=(const server&) = delete;
+
+	///
+	/// \brief Accepts and runs commands until stop() is called.
+	///
+	void run();
+
+	///
+	/// \brief Makes run() return, it can be called from any thread.
+	/// \details Connections whose command is still being received are shut
+	/// down, so that the server does not wait for silent clients.
+	///
+	void stop() noexcept;
+
+private:
+	///
+	/// \brief Runs the command of a connection and sends back its result.
+	/// \details A client that stays silent while its command is received, or
+	/// does not read its result, is dropped after a timeout.
+	/// \param connection: The connected socket, closed once the result is sent.
+	///
+	void handle(std::int32_t connection);
+
+	///
+	/// \brief Gets a parsed icon, loading it if it is not kept already.
+	/// \details Icons are told apart by path, size and modification time of
+	/// the file and by how they are loaded and prepared.
+	/// \param icon_path: The path to the icon file.
+	/// \param options: How the icon is loaded and prepared.
+	/// \param cache: The cache the icon is loaded from on a miss, nullptr for none.
+	/// \returns The parsed icon.
+	///
+	std::shared_ptr<const icon> load(std::string_view     icon_path,
+	                                 const icon::options& options,
+	                                 const icon_cache*    cache);
+
+private:
+	///
+	/// \brief The path to the socket.
+	///
+	std::string socket_path;
+
+	///
+	/// \brief The listening socket.
+	///
+	std::int32_t listener;
+
+	///
+	/// \brief Set once stop() is called.
+	///
+	std::atomic<bool> stopping;
+
+	///
+	/// \brief Guards the connections being handled.
+	///
+	std::mutex connections_mutex;
+
+	///
+	/// \brief The connections being handled.
+	///
+	std::unordered_set<std::int32_t> connections;
+
+	///
+	/// \brief Number of parsed icons kept.
+	///
+	std::size_t icons_capacity;
+
+	///
+	/// \brief Guards the kept icons.
+	///
+	std::mutex icons_mutex;
+
+	///
+	/// \brief The kept icons with their keys, most recently used first.
+	///
+	std::list<std::pair<std::string, std::shared_ptr<const icon>>> icons;
+
+	///
+	/// \brief The kept icons by key.
+	///
+	std::unordered_map<std::string, std::list<std::pair<std::string, std::shared_ptr<const icon>>>::iterator> icons_index;
+
+	///
+	/// \brief The workers running the commands, destroyed first so that they are done before the rest.
+	///
+	thread_pool pool;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DECLARATIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Runs a command on a server instead of in this process.
+/// \details Relative paths are made absolute, as the server runs in another
+/// directory. Commands reading the icon from the standard input and batches,
+/// whose manifests hold relative paths, are not forwarded.
+/// \param socket_path: The path to the socket of the server.
+/// \param arguments: The arguments of the command, without the program name.
+/// \param output: The stream the output of the command is printed to.
+/// \returns The exit status of the command.
+///
+extern std::int32_t forward_cli(std::string_view             socket_path,
+                                std::span<const char* const> arguments,
+                                std::FILE*                   output = stdout);
+
+} // namespace icon_changer
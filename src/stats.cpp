@@ -0,0 +1,340 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include "stats.hpp"
+
+#include <algorithm>
+#include <format>
+#include <string_view>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTANTS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief The names of the phases, as printed.
+///
+static constexpr std::array<std::string_view, STATS_PHASES_COUNT> PHASE_NAMES = { "open", "parse", "read", "convert", "write", "commit" };
+
+///
+/// \brief The names of the counters, as printed.
+///
+static constexpr std::array<std::string_view, STATS_COUNTERS_COUNT> COUNTER_NAMES = { "bytes_read", "bytes_written", "allocations", "allocated_bytes" };
+
+///
+/// \brief The percentiles printed for every phase and counter.
+///
+static constexpr std::array<std::uint64_t, 3> PERCENTILES = { 50, 90, 99 };
+
+///
+/// \brief Nanoseconds in a millisecond.
+///
+static constexpr double NANOSECONDS_PER_MILLISECOND = 1'000'000.0;
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief The distribution of a phase or counter over the samples.
+///
+struct distribution final
+{
+	std::uint64_t                                 total;       ///< The sum over all samples.
+	std::uint64_t                                 calls;       ///< Number of times the phase was entered, 0 for counters.
+	std::array<std::uint64_t, PERCENTILES.size()> percentiles; ///< The value of each percentile.
+	std::uint64_t                                 maximum;     ///< The largest value.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// GLOBAL VARIABLES
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief The record the calling thread reports to, nullptr for none.
+/// \details Constant initialized, so it can be used by an allocator hooked
+/// into operator new.
+///
+static constinit thread_local stats_record* current_record = nullptr;
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Computes the distribution of values over the samples.
+/// \details The percentiles only cover the samples with a value other than 0.
+/// \param values: The value of each sample.
+/// \param calls: Number of times the phase was entered, 0 for counters.
+/// \returns The distribution.
+///
+static distribution get_distribution(std::vector<std::uint64_t> values,
+                                     std::uint64_t              calls);
+
+///
+/// \brief Appends a phase or counter to the formatted statistics.
+/// \param output: The formatted statistics.
+/// \param name: The name of the phase or counter.
+/// \param value: Its distribution.
+/// \param time: Whether the values are nanoseconds, printed in milliseconds.
+/// \param format: How the statistics are printed.
+/// \param single: Whether there is a single sample, so that only the total is printed.
+///
+static void format_distribution(std::string&        output,
+                                std::string_view    name,
+                                const distribution& value,
+                                bool                time,
+                                stats_format        format,
+                                bool                single);
+
+////////////////////////////////////////////////////////////////////////////////
+// METHOD DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+stats_record::stats_record() noexcept
+    : nanoseconds{}
+    , calls{}
+    , counters{}
+{
+}
+
+void stats_record::add_time(const stats_phase   phase,
+                            const std::uint64_t nanoseconds) noexcept
+{
+	this->nanoseconds[static_cast<std::size_t>(phase)].fetch_add(nanoseconds, std::memory_order_relaxed);
+	calls[static_cast<std::size_t>(phase)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void stats_record::add(const stats_counter counter,
+                       const std::uint64_t value) noexcept
+{
+	counters[static_cast<std::size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+}
+
+stats_sample stats_record::get_sample() const noexcept
+{
+	stats_sample sample = {};
+
+	for (std::size_t index = 0; index < STATS_PHASES_COUNT; ++index)
+	{
+		sample.nanoseconds[index] = nanoseconds[index].load(std::memory_order_relaxed);
+		sample.calls[index]       = calls[index].load(std::memory_order_relaxed);
+	}
+
+	for (std::size_t index = 0; index < STATS_COUNTERS_COUNT; ++index)
+	{
+		sample.counters[index] = counters[index].load(std::memory_order_relaxed);
+	}
+
+	return sample;
+}
+
+stats_scope::stats_scope(stats_record* const record) noexcept
+    : previous{ current_record }
+{
+	current_record = record;
+}
+
+stats_scope::~stats_scope() noexcept
+{
+	current_record = previous;
+}
+
+stats_record* stats_scope::get_current() noexcept
+{
+	return current_record;
+}
+
+stats_timer::stats_timer(const stats_phase phase) noexcept
+    : record{ current_record }
+    , phase{ phase }
+    , start{}
+{
+	if (nullptr != record)
+	{
+		start = std::chrono::steady_clock::now();
+	}
+}
+
+stats_timer::~stats_timer() noexcept
+{
+	next(phase);
+}
+
+void stats_timer::next(const stats_phase phase) noexcept
+{
+	if (nullptr == record)
+	{
+		return;
+	}
+
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	record->add_time(this->phase, static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count()));
+	this->phase = phase;
+	start       = now;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+void count_stat(const stats_counter counter,
+                const std::uint64_t value) noexcept
+{
+	if (nullptr != current_record)
+	{
+		current_record->add(counter, value);
+	}
+}
+
+std::string format_stats(const std::span<const stats_sample> samples,
+                         const stats_format                  format)
+{
+	const bool  single = 1 == samples.size();
+	std::string output = stats_format::json == format ? std::format("{{\"samples\":{},\"phases\":{{", samples.size())
+	                                                  : std::format("Statistics of {} sample(s):\n", samples.size());
+
+	for (std::size_t index = 0; index < STATS_PHASES_COUNT; ++index)
+	{
+		std::vector<std::uint64_t> values = {};
+		std::uint64_t              calls  = 0;
+
+		for (const stats_sample& sample : samples)
+		{
+			values.push_back(sample.nanoseconds[index]);
+			calls += sample.calls[index];
+		}
+
+		format_distribution(output, PHASE_NAMES[index], get_distribution(std::move(values), calls), true, format, single);
+	}
+
+	if (stats_format::json == format)
+	{
+		output.back() = '}';
+		output += ",\"counters\":{";
+	}
+
+	for (std::size_t index = 0; index < STATS_COUNTERS_COUNT; ++index)
+	{
+		std::vector<std::uint64_t> values = {};
+
+		for (const stats_sample& sample : samples)
+		{
+			values.push_back(sample.counters[index]);
+		}
+
+		format_distribution(output, COUNTER_NAMES[index], get_distribution(std::move(values), 0), false, format, single);
+	}
+
+	if (stats_format::json == format)
+	{
+		output.back() = '}';
+		output += "}\n";
+	}
+
+	return output;
+}
+
+static distribution get_distribution(std::vector<std::uint64_t> values,
+                                     const std::uint64_t        calls)
+{
+	distribution result = { 0, calls, {}, 0 };
+
+	std::erase(values, 0);
+	std::ranges::sort(values);
+
+	if (values.empty())
+	{
+		return result;
+	}
+
+	for (const std::uint64_t value : values)
+	{
+		result.total += value;
+	}
+
+	// Nearest rank: the smallest value at least the given percentage of the samples do not exceed.
+	for (std::size_t index = 0; index < PERCENTILES.size(); ++index)
+	{
+		const std::size_t rank = (PERCENTILES[index] * values.size() + 99) / 100;
+
+		result.percentiles[index] = values[std::max(rank, std::size_t{ 1 }) - 1];
+	}
+
+	result.maximum = values.back();
+	return result;
+}
+
+static void format_distribution(std::string&         output,
+                                const std::string_view name,
+                                const distribution&    value,
+                                const bool             time,
+                                const stats_format     format,
+                                const bool             single)
+{
+	const auto format_value = [time](const std::uint64_t number)
+	{
+		return time ? std::format("{:.3f}", static_cast<double>(number) / NANOSECONDS_PER_MILLISECOND) : std::format("{}", number);
+	};
+
+	if (stats_format::json == format)
+	{
+		const std::string_view suffix = time ? "_ms" : "";
+
+		output += std::format("\"{}\":{{", name);
+
+		if (time)
+		{
+			output += std::format("\"calls\":{},", value.calls);
+		}
+
+		output += std::format("\"total{}\":{}", suffix, format_value(value.total));
+
+		for (std::size_t index = 0; index < PERCENTILES.size(); ++index)
+		{
+			output += std::format(",\"p{}{}\":{}", PERCENTILES[index], suffix, format_value(value.percentiles[index]));
+		}
+
+		output += std::format(",\"max{}\":{}}},", suffix, format_value(value.maximum));
+		return;
+	}
+
+	const std::string_view unit = time ? " ms" : "";
+
+	output += std::format("  {:<16}{:>14}{}", name, format_value(value.total), unit);
+
+	if (time)
+	{
+		output += std::format(" in {} call(s)", value.calls);
+	}
+
+	if (!single)
+	{
+		output += std::format(" (p50 {}{}, p90 {}{}, p99 {}{}, max {}{})", format_value(value.percentiles[0]), unit, format_value(value.percentiles[1]), unit,
+		                      format_value(value.percentiles[2]), unit, format_value(value.maximum), unit);
+	}
+
+	output += '\n';
+}
+
+} // namespace icon_changer
@@ -0,0 +1,245 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief The phases an icon change goes through.
+///
+enum class stats_phase : std::uint8_t
+{
+	open,    ///< Opening or mapping the files.
+	parse,   ///< Parsing the headers and entries of the files.
+	read,    ///< Reading the image and executable data.
+	convert, ///< Converting, resampling and compressing the images.
+	write,   ///< Building the resources and the new executable image.
+	commit   ///< Writing the executable to disk.
+};
+
+///
+/// \brief The quantities counted while changing icons.
+///
+enum class stats_counter : std::uint8_t
+{
+	bytes_read,     ///< Bytes read from files, the mapped ones included.
+	bytes_written,  ///< Bytes written to files.
+	allocations,    ///< Memory allocations.
+	allocated_bytes ///< Bytes of memory allocated.
+};
+
+///
+/// \brief How statistics are printed.
+///
+enum class stats_format : std::uint8_t
+{
+	text, ///< A human-readable table.
+	json  ///< A JSON object.
+};
+
+///
+/// \brief Number of phases.
+///
+inline constexpr std::size_t STATS_PHASES_COUNT = 6;
+
+///
+/// \brief Number of counters.
+///
+inline constexpr std::size_t STATS_COUNTERS_COUNT = 4;
+
+///
+/// \brief A copy of the statistics of one icon or executable.
+///
+struct stats_sample final
+{
+	std::array<std::uint64_t, STATS_PHASES_COUNT>   nanoseconds; ///< Time spent in each phase.
+	std::array<std::uint64_t, STATS_PHASES_COUNT>   calls;       ///< Number of times each phase was entered.
+	std::array<std::uint64_t, STATS_COUNTERS_COUNT> counters;    ///< Value of each counter.
+};
+
+///
+/// \brief Accumulates the statistics of one icon or executable.
+/// \details It can be updated from several threads at once.
+///
+class stats_record final
+{
+public:
+	///
+	/// \brief Initializes every phase and counter to 0.
+	///
+	stats_record() noexcept;
+
+	stats_record(const stats_record&)            = delete;
+	stats_record& operator=(const stats_record&) = delete;
+
+	///
+	/// \brief Adds the time spent in a phase.
+	/// \param phase: The phase.
+	/// \param nanoseconds: The time spent.
+	///
+	void add_time(stats_phase   phase,
+	              std::uint64_t nanoseconds) noexcept;
+
+	///
+	/// \brief Adds to a counter.
+	/// \param counter: The counter.
+	/// \param value: The value to be added.
+	///
+	void add(stats_counter counter,
+	         std::uint64_t value) noexcept;
+
+	///
+	/// \brief Copies the statistics.
+	/// \returns The copy.
+	///
+	stats_sample get_sample() const noexcept;
+
+private:
+	///
+	/// \brief Time spent in each phase, in nanoseconds.
+	///
+	std::array<std::atomic<std::uint64_t>, STATS_PHASES_COUNT> nanoseconds;
+
+	///
+	/// \brief Number of times each phase was entered.
+	///
+	std::array<std::atomic<std::uint64_t>, STATS_PHASES_COUNT> calls;
+
+	///
+	/// \brief Value of each counter.
+	///
+	std::array<std::atomic<std::uint64_t>, STATS_COUNTERS_COUNT> counters;
+};
+
+///
+/// \brief Makes a record the one the calling thread reports to, for its lifetime.
+/// \details Without a record nothing is measured, so the timers and counters
+/// cost a thread-local load and a branch.
+///
+class stats_scope final
+{
+public:
+	///
+	/// \brief Makes the record current.
+	/// \param record: The record, nullptr to stop reporting.
+	///
+	explicit stats_scope(stats_record* record) noexcept;
+
+	///
+	/// \brief Makes the previous record current again.
+	///
+	~stats_scope() noexcept;
+
+	stats_scope(const stats_scope&)            = delete;
+	stats_scope& operator=(const stats_scope&) = delete;
+
+	///
+	/// \brief Gets the record the calling thread reports to.
+	/// \details Threads started on behalf of the caller pass it to a scope of
+	/// their own.
+	/// \returns The record, nullptr if there is none.
+	///
+	static stats_record* get_current() noexcept;
+
+private:
+	///
+	/// \brief The record that was current before this scope.
+	///
+	stats_record* previous;
+};
+
+///
+/// \brief Measures the time spent in a phase until it is destroyed.
+///
+class stats_timer final
+{
+public:
+	///
+	/// \brief Starts measuring, if the calling thread has a record.
+	/// \param phase: The phase being entered.
+	///
+	explicit stats_timer(stats_phase phase) noexcept;
+
+	///
+	/// \brief Adds the time spent to the record.
+	///
+	~stats_timer() noexcept;
+
+	stats_timer(const stats_timer&)            = delete;
+	stats_timer& operator=(const stats_timer&) = delete;
+
+	///
+	/// \brief Ends the current phase and enters another one.
+	/// \param phase: The phase being entered.
+	///
+	void next(stats_phase phase) noexcept;
+
+private:
+	///
+	/// \brief The record the time is added to, nullptr if nothing is measured.
+	///
+	stats_record* record;
+
+	///
+	/// \brief The phase being measured.
+	///
+	stats_phase phase;
+
+	///
+	/// \brief When the phase was entered.
+	///
+	std::chrono::steady_clock::time_point start;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DECLARATIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Adds to a counter of the record of the calling thread, if it has one.
+/// \param counter: The counter.
+/// \param value: The value to be added.
+///
+extern void count_stat(stats_counter counter,
+                       std::uint64_t value) noexcept;
+
+///
+/// \brief Formats the statistics of a run.
+/// \details Every phase and counter gets its total and, over the samples that
+/// went through it, the 50th, 90th and 99th percentiles and the maximum.
+/// \param samples: The samples, one per icon or executable.
+/// \param format: How the statistics are printed.
+/// \returns The formatted statistics.
+///
+extern std::string format_stats(std::span<const stats_sample> samples,
+                                stats_format                  format);
+
+} // namespace icon_changer
@@ -0,0 +1,172 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+////////////////////////////////////////////////////////////////////////////////
+// METHOD DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+thread_pool::thread_pool(const std::size_t threads_count)
+    : threads_count{ 0 == threads_count ? std::max(1U, std::thread::hardware_concurrency()) : threads_count }
+    , queues{}
+    , mutex{}
+    , work_available{}
+    , work_done{}
+    , queued_count{ 0 }
+    , pending_count{ 0 }
+    , next_queue{ 0 }
+    , stopping{ false }
+    , workers{}
+{
+	queues = std::make_unique<queue[]>(this->threads_count);
+	workers.reserve(this->threads_count);
+
+	// The running workers read the count rather than the size of the vector, which changes as the others start.
+	for (std::size_t index = 0; index < this->threads_count; ++index)
+	{
+		workers.emplace_back(&thread_pool::run, this, index);
+	}
+}
+
+thread_pool::~thread_pool() noexcept
+{
+	wait();
+
+	{
+		const std::lock_guard lock = std::lock_guard{ mutex };
+
+		stopping = true;
+	}
+
+	work_available.notify_all();
+
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+void thread_pool::submit(std::function<void()> task)
+{
+	std::size_t index = 0;
+
+	{
+		const std::lock_guard lock = std::lock_guard{ mutex };
+
+		// Counted before being queued, so that a worker never takes an uncounted task.
+		index      = next_queue;
+		next_queue = (next_queue + 1) % threads_count;
+		++pending_count;
+		++queued_count;
+	}
+
+	{
+		const std::lock_guard lock = std::lock_guard{ queues[index].mutex };
+
+		queues[index].tasks.push_back(std::move(task));
+	}
+
+	work_available.notify_one();
+}
+
+void thread_pool::wait()
+{
+	std::unique_lock lock = std::unique_lock{ mutex };
+
+	work_done.wait(lock, [this]()
+	{
+		return 0 == pending_count;
+	});
+}
+
+std::size_t thread_pool::get_threads_count() const noexcept
+{
+	return threads_count;
+}
+
+void thread_pool::run(const std::size_t index)
+{
+	std::function<void()> task = nullptr;
+
+	while (true)
+	{
+		if (take(index, task))
+		{
+			task();
+			task = nullptr;
+
+			const std::lock_guard lock = std::lock_guard{ mutex };
+
+			if (0 == --pending_count)
+			{
+				work_done.notify_all();
+			}
+
+			continue;
+		}
+
+		std::unique_lock lock = std::unique_lock{ mutex };
+
+		work_available.wait(lock, [this]()
+		{
+			return stopping || 0 != queued_count;
+		});
+
+		if (stopping && 0 == queued_count)
+		{
+			return;
+		}
+	}
+}
+
+bool thread_pool::take(const std::size_t      index,
+                       std::function<void()>& task)
+{
+	for (std::size_t offset = 0; offset < threads_count; ++offset)
+	{
+		queue& queue = queues[(index + offset) % threads_count];
+
+		{
+			const std::lock_guard lock = std::lock_guard{ queue.mutex };
+
+			if (queue.tasks.empty())
+			{
+				continue;
+			}
+
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+		}
+
+		const std::lock_guard lock = std::lock_guard{ mutex };
+
+		assert(0 != queued_count);
+		--queued_count;
+		return true;
+	}
+
+	return false;
+}
+
+} // namespace icon_changer
@@ -0,0 +1,154 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPE DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief Fixed size pool of worker threads with work stealing.
+/// \details Each worker has its own queue, tasks are distributed round-robin
+/// in submission order. A worker takes tasks from the front of its queue and,
+/// when it runs dry, steals from the front of the others. Submitting tasks in
+/// decreasing order of cost therefore runs the most expensive ones first.
+///
+class thread_pool final
+{
+public:
+	///
+	/// \brief Starts the worker threads.
+	/// \param threads_count: Number of workers, 0 means one per hardware thread.
+	///
+	thread_pool(std::size_t threads_count = 0);
+
+	///
+	/// \brief Waits for the queued tasks and stops the workers.
+	///
+	~thread_pool() noexcept;
+
+	thread_pool(const thread_pool&)            = delete;
+	thread_pool& operator=(const thread_pool&) = delete;
+
+	///
+	/// \brief Queues a task to be run by one of the workers.
+	/// \param task: The task, it must not throw.
+	///
+	void submit(std::function<void()> task);
+
+	///
+	/// \brief Blocks until all submitted tasks have finished.
+	///
+	void wait();
+
+	///
+	/// \brief Gets the number of worker threads.
+	/// \returns The number of workers.
+	///
+	std::size_t get_threads_count() const noexcept;
+
+private:
+	///
+	/// \brief A worker's queue of tasks.
+	///
+	struct queue final
+	{
+		std::mutex                        mutex; ///< Protects the tasks.
+		std::deque<std::function<void()>> tasks; ///< The queued tasks.
+	};
+
+	///
+	/// \brief The loop run by each worker.
+	/// \param index: The index of the worker's own queue.
+	///
+	void run(std::size_t index);
+
+	///
+	/// \brief Takes a task from the worker's own queue or steals one.
+	/// \param index: The index of the worker's own queue.
+	/// \param task: Receives the task.
+	/// \returns true if a task was taken, false if all queues are empty.
+	///
+	bool take(std::size_t            index,
+	          std::function<void()>& task);
+
+private:
+	///
+	/// \brief Number of worker threads, set before any of them starts.
+	///
+	const std::size_t threads_count;
+
+	///
+	/// \brief One queue per worker.
+	///
+	std::unique_ptr<queue[]> queues;
+
+	///
+	/// \brief Protects the counters and the stopping flag.
+	///
+	std::mutex mutex;
+
+	///
+	/// \brief Wakes up workers when tasks are queued or the pool stops.
+	///
+	std::condition_variable work_available;
+
+	///
+	/// \brief Wakes up waiters when all tasks have finished.
+	///
+	std::condition_variable work_done;
+
+	///
+	/// \brief Number of tasks sitting in the queues.
+	///
+	std::size_t queued_count;
+
+	///
+	/// \brief Number of tasks submitted and not yet finished.
+	///
+	std::size_t pending_count;
+
+	///
+	/// \brief Index of the queue receiving the next task.
+	///
+	std::size_t next_queue;
+
+	///
+	/// \brief Set when the pool is being destroyed.
+	///
+	bool stopping;
+
+	///
+	/// \brief The worker threads.
+	///
+	std::vector<std::thread> workers;
+};
+
+} // namespace icon_changer
@@ -17,8 +17,13 @@
 
 #include "utility.hpp"
 
+#include <filesystem>
+#include <random>
 #include <stdexcept>
 
+#include "byte_source.hpp"
+#include "stats.hpp"
+
 ////////////////////////////////////////////////////////////////////////////////
 // FUNCTION DEFINITIONS
 ////////////////////////////////////////////////////////////////////////////////
@@ -26,17 +31,55 @@
 namespace icon_changer
 {
 
-std::ifstream open_file(const std::string_view file_path)
+std::vector<std::uint8_t> read_file(const std::string_view file_path)
+{
+	const std::unique_ptr<byte_source> source = open_source(file_path);
+	std::vector<std::uint8_t>          bytes  = {};
+
+	read_all(*source, bytes);
+	return bytes;
+}
+
+void write_file(const std::string_view              file_path,
+                const std::span<const std::uint8_t> bytes)
 {
-	std::ifstream file = std::ifstream{ file_path.data(), std::ios::binary };
+	const std::filesystem::path path           = std::filesystem::path{ file_path };
+	const std::filesystem::path temporary_path = std::filesystem::path{ path }.concat(std::format(".{:08x}.tmp", std::random_device{}()));
+	std::ofstream               file           = std::ofstream{ temporary_path, std::ios::binary | std::ios::trunc };
 
 	if (!file.is_open())
 	{
-		throw std::invalid_argument{ std::format("Failed to open \"{}\"!", file_path) };
+		throw std::runtime_error{ std::format("Failed to create \"{}\"!", temporary_path.string()) };
+	}
+
+	file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+	file.close();
+
+	if (!file)
+	{
+		std::filesystem::remove(temporary_path);
+		throw std::runtime_error{ std::format("Failed to write {} bytes to \"{}\"!", bytes.size(), temporary_path.string()) };
+	}
+
+	count_stat(stats_counter::bytes_written, bytes.size());
+
+	// The temporary file holds a full copy of the data, it is not left behind when it cannot replace the file.
+	try
+	{
+		if (std::filesystem::exists(path))
+		{
+			std::filesystem::permissions(temporary_path, std::filesystem::status(path).permissions());
+		}
+
+		std::filesystem::rename(temporary_path, path);
 	}
+	catch (...)
+	{
+		std::error_code error = {};
 
-	file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-	return std::move(file);
+		std::filesystem::remove(temporary_path, error);
+		throw;
+	}
 }
 
 } // namespace icon_changer
@@ -17,11 +17,17 @@
 // HEADER FILE INCLUDES
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <cstring>
+#include <format>
 #include <fstream>
 #include <print>
+#include <span>
+#include <stdexcept>
 #include <string_view>
 #include <vector>
 
+#include "field_layout.hpp"
+
 ////////////////////////////////////////////////////////////////////////////////
 // MACROS
 ////////////////////////////////////////////////////////////////////////////////
@@ -89,32 +95,88 @@ inline constexpr std::uint16_t VERSION_PATCH = 0;
 ////////////////////////////////////////////////////////////////////////////////
 
 ///
-/// \brief Opens the specified file in binary mode and sets exceptions for
-/// failbit and badbit.
-/// \param file_path: The path to the file to be opened.
-/// \returns An input file stream for reading the file.
+/// \brief Reads the whole content of a file with a single read.
+/// \param file_path: The path to the file to be read.
+/// \returns The bytes of the file.
+///
+extern std::vector<std::uint8_t> read_file(std::string_view file_path);
+
+///
+/// \brief Writes the content of a file with a single write.
+/// \details The bytes are written to a temporary file which then replaces the
+/// original one, so the file is left untouched if writing fails. The temporary
+/// file has a random name, so processes writing the same file do not collide.
+/// \param file_path: The path to the file to be written.
+/// \param bytes: The new content of the file.
+///
+extern void write_file(std::string_view              file_path,
+                       std::span<const std::uint8_t> bytes);
+
+///
+/// \brief Serializes the structure in place into a byte buffer.
+/// \details Structures with a layout are written field by field in
+/// little-endian byte order, see field_layout.hpp.
+/// \param obj: The structure to be serialized.
+/// \param bytes: The buffer to write to.
+/// \param offset: Offset of the structure from the beginning of the buffer.
+/// \throws std::runtime_error if the structure does not fit in the buffer.
+///
+template <typename T> void serialize(const T&                obj,
+                                     std::span<std::uint8_t> bytes,
+                                     std::size_t             offset);
+
+///
+/// \brief Deserializes a structure from a byte buffer.
+/// \details Structures with a layout are read field by field in
+/// little-endian byte order, see field_layout.hpp.
+/// \param bytes: The buffer to read from.
+/// \param offset: Offset of the structure from the beginning of the buffer.
+/// \returns A copy of the structure read from the buffer.
+/// \throws std::runtime_error if the structure does not fit in the buffer.
 ///
-extern std::ifstream open_file(std::string_view file_path);
+template <typename T> T deserialize(std::span<const std::uint8_t> bytes,
+                                   std::size_t                   offset);
 
 ///
-/// \brief Serializes the header into a byte vector.
-/// \param header: The header structure to be serialized.
-/// \returns A vector of bytes representing the serialized header.
+/// \brief Rounds a value up to the next multiple of an alignment.
+/// \param value: The value to be aligned.
+/// \param alignment: The alignment, must be a power of 2.
+/// \returns The aligned value.
 ///
-template <typename T> std::vector<std::uint8_t> serialize(const T& obj);
+template <typename T> constexpr T align_up(T value,
+                                           T alignment) noexcept;
 
 ////////////////////////////////////////////////////////////////////////////////
 // FUNCTION DEFINITIONS
 ////////////////////////////////////////////////////////////////////////////////
 
-template <typename T> std::vector<std::uint8_t> serialize(const T& obj)
+template <typename T> void serialize(const T&                      obj,
+                                     const std::span<std::uint8_t> bytes,
+                                     const std::size_t             offset)
+{
+	if (offset > bytes.size() || WIRE_SIZE<T> > bytes.size() - offset)
+	{
+		throw std::runtime_error{ std::format("Failed to write {} bytes at offset 0x{:X}!", WIRE_SIZE<T>, offset) };
+	}
+
+	write_wire(obj, bytes.data() + offset);
+}
+
+template <typename T> T deserialize(const std::span<const std::uint8_t> bytes,
+                                   const std::size_t                   offset)
 {
-	std::vector<std::uint8_t> bytes = {};
+	if (offset > bytes.size() || WIRE_SIZE<T> > bytes.size() - offset)
+	{
+		throw std::runtime_error{ std::format("Failed to read {} bytes at offset 0x{:X}!", WIRE_SIZE<T>, offset) };
+	}
 
-	bytes.resize(sizeof(obj));
-	std::memcpy(bytes.data(), &obj, sizeof(obj));
+	return read_wire<T>(bytes.data() + offset);
+}
 
-	return bytes;
+template <typename T> constexpr T align_up(const T value,
+                                           const T alignment) noexcept
+{
+	return (value + alignment - 1) & ~(alignment - 1);
 }
 
 } // namespace icon_changer
@@ -0,0 +1,108 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+#include "pe_file.hpp"
+#include "resource_tree.hpp"
+#include "utility.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION DEFINITIONS
+////////////////////////////////////////////////////////////////////////////////
+
+namespace icon_changer
+{
+
+///
+/// \brief Builds a minimal PE32+ executable with a `.text` section and, if
+/// there are resources, a `.rsrc` section holding them.
+/// \details The headers take 0x400 bytes and the `.text` section, filled with
+/// `nop` instructions, is loaded at 0x1000. The executable is only meant to be
+/// parsed and patched, it cannot run.
+/// \param resources: The resources of the executable, none for no `.rsrc` section.
+/// \param overlay: Bytes appended after the last section.
+/// \param text_size: Size of the `.text` section in bytes.
+/// \returns The content of the executable.
+///
+inline std::vector<std::uint8_t> build_executable(const resource_tree&                resources,
+                                                  const std::span<const std::uint8_t> overlay   = {},
+                                                  const std::uint32_t                 text_size = 0x200)
+{
+	static constexpr std::uint32_t PE_HEADER_OFFSET  = 0x80;
+	static constexpr std::uint32_t SECTION_ALIGNMENT = 0x1000;
+	static constexpr std::uint32_t FILE_ALIGNMENT    = 0x200;
+	static constexpr std::uint32_t HEADERS_SIZE      = 0x400;
+	static constexpr std::uint16_t OPTIONAL_SIZE     = 240;
+	static constexpr std::size_t   OPTIONAL_OFFSET   = PE_HEADER_OFFSET + sizeof(std::uint32_t) + sizeof(pe_file::coff_header);
+
+	const bool                with_resources = !resources.get_types().empty();
+	pe_file::section_header   text           = {};
+	pe_file::section_header   rsrc           = {};
+	std::vector<std::uint8_t> rsrc_data      = {};
+	std::vector<std::uint8_t> image          = {};
+
+	std::memcpy(text.name, ".text", sizeof(".text"));
+	text.virtual_size    = text_size;
+	text.virtual_address = SECTION_ALIGNMENT;
+	text.raw_data_size   = align_up(text_size, FILE_ALIGNMENT);
+	text.raw_data_offset = HEADERS_SIZE;
+
+	std::memcpy(rsrc.name, ".rsrc", sizeof(".rsrc"));
+	rsrc.virtual_address = align_up(text.virtual_address + text.virtual_size, SECTION_ALIGNMENT);
+	rsrc.raw_data_offset = text.raw_data_offset + text.raw_data_size;
+
+	if (with_resources)
+	{
+		rsrc_data          = resources.serialize(rsrc.virtual_address);
+		rsrc.virtual_size  = static_cast<std::uint32_t>(rsrc_data.size());
+		rsrc.raw_data_size = align_up(rsrc.virtual_size, FILE_ALIGNMENT);
+	}
+
+	image.resize(rsrc.raw_data_offset + rsrc.raw_data_size);
+	std::fill(image.begin() + text.raw_data_offset, image.begin() + rsrc.raw_data_offset, 0x90);
+
+	serialize(pe_file::dos_header{ 0x5A4D, {}, PE_HEADER_OFFSET }, image, 0);
+	serialize(std::uint32_t{ 0x00004550 }, image, PE_HEADER_OFFSET);
+	serialize(pe_file::coff_header{ 0x8664, static_cast<std::uint16_t>(with_resources ? 2 : 1), 0, 0, 0, OPTIONAL_SIZE, 0x22 }, image,
+	          PE_HEADER_OFFSET + sizeof(std::uint32_t));
+	serialize(std::uint16_t{ 0x020B }, image, OPTIONAL_OFFSET);
+	serialize(SECTION_ALIGNMENT, image, OPTIONAL_OFFSET + 32);
+	serialize(FILE_ALIGNMENT, image, OPTIONAL_OFFSET + 36);
+	serialize(align_up(with_resources ? rsrc.virtual_address + rsrc.virtual_size : rsrc.virtual_address, SECTION_ALIGNMENT), image, OPTIONAL_OFFSET + 56);
+	serialize(HEADERS_SIZE, image, OPTIONAL_OFFSET + 60);
+	serialize(std::uint32_t{ 16 }, image, OPTIONAL_OFFSET + 108);
+	serialize(text, image, OPTIONAL_OFFSET + OPTIONAL_SIZE);
+
+	if (with_resources)
+	{
+		serialize(pe_file::data_directory{ rsrc.virtual_address, rsrc.virtual_size }, image, OPTIONAL_OFFSET + 112 + 2 * sizeof(pe_file::data_directory));
+		serialize(rsrc, image, OPTIONAL_OFFSET + OPTIONAL_SIZE + sizeof(text));
+		std::memcpy(image.data() + rsrc.raw_data_offset, rsrc_data.data(), rsrc_data.size());
+	}
+
+	image.insert(image.end(), overlay.begin(), overlay.end());
+	return image;
+}
+
+} // namespace icon_changer
@@ -0,0 +1,96 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "bmp_file.cpp"
+
+#include <stdexcept>
+#include <vector>
+
+using namespace testing;
+using namespace icon_changer;
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Makes a BMP file of 2x2 pixels.
+/// \param dib_header: The DIB header, its size being the one of the whole header.
+/// \param extra: The bytes following the BITMAPINFOHEADER, the bit fields or the
+/// rest of a larger header.
+/// \param pixels: The pixel array, its rows padded to 4 bytes.
+/// \returns The bytes of the file.
+///
+static std::vector<std::uint8_t> make_bitmap(const bmp_file::dib_header&       dib_header,
+                                             const std::vector<std::uint32_t>& extra,
+                                             const std::vector<std::uint8_t>&  pixels)
+{
+	const std::uint32_t       image_offset = static_cast<std::uint32_t>(14 + 40 + extra.size() * 4);
+	std::vector<std::uint8_t> bytes        = std::vector<std::uint8_t>(image_offset);
+
+	serialize(bmp_file::header{ 0x4D42, static_cast<std::uint32_t>(image_offset + pixels.size()), 0, 0, image_offset }, bytes, 0);
+	serialize(dib_header, bytes, 14);
+
+	for (std::size_t index = 0; index < extra.size(); ++index)
+	{
+		serialize(extra[index], bytes, 14 + 40 + index * 4);
+	}
+
+	bytes.insert(bytes.end(), pixels.begin(), pixels.end());
+	return bytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// TESTS
+////////////////////////////////////////////////////////////////////////////////
+
+TEST(bmp_file, decode_rgb555_success)
+{
+	// Bottom-up: the white and red pixels are the top row.
+	std::vector<std::uint8_t> bytes   = make_bitmap(bmp_file::dib_header{ 40, 2, 2, 1, 16, 0, 8, 0, 0, 0, 0 }, {},
+	                                                { 0x1F, 0x00, 0xE0, 0x03, 0xFF, 0x7F, 0x00, 0x7C });
+	const bgra_image          decoded = bmp_file{ bytes }.decode();
+
+	ASSERT_EQ(2, decoded.width);
+	ASSERT_EQ(2, decoded.height);
+	EXPECT_THAT(decoded.pixels, ElementsAre(0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF));
+}
+
+TEST(bmp_file, decode_bit_fields_success)
+{
+	// A top-down BITMAPV5HEADER with 4 bits per channel, alpha included.
+	const std::vector<std::uint32_t> v5_header = { 0x0F00, 0x00F0, 0x000F, 0xF000, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+	std::vector<std::uint8_t>        bytes     = make_bitmap(bmp_file::dib_header{ 124, 2, -2, 1, 16, 3, 8, 0, 0, 0, 0 }, v5_header,
+	                                                         { 0x00, 0xFF, 0x8F, 0x00, 0x00, 0x00, 0x00, 0x80 });
+	const bgra_image                 decoded   = bmp_file{ bytes }.decode();
+
+	EXPECT_THAT(decoded.pixels, ElementsAre(0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x88, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x88));
+}
+
+TEST(bmp_file, decode_bit_fields_fail)
+{
+	std::vector<std::uint8_t> bytes = make_bitmap(bmp_file::dib_header{ 40, 2, 2, 1, 8, 3, 8, 0, 0, 0, 0 }, { 0xFF, 0xFF, 0xFF }, { 0, 0, 0, 0, 0, 0, 0, 0 });
+
+	ASSERT_THAT([&bytes]()
+	{
+		bmp_file{ bytes }.decode();
+	},
+	ThrowsMessage<std::invalid_argument>(HasSubstr("8 bits per pixel cannot have bit fields!")));
+}
@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "byte_source.cpp"
+
+#include <array>
+#include <filesystem>
+#include <stdexcept>
+
+using namespace testing;
+using namespace icon_changer;
+
+////////////////////////////////////////////////////////////////////////////////
+// TESTS
+////////////////////////////////////////////////////////////////////////////////
+
+TEST(byte_source, read_all_success)
+{
+	const std::string file_path = std::string{ TEST_DATA_PATH } + "image1.ico";
+
+	for (const source_kind kind : { source_kind::whole_file, source_kind::sequential })
+	{
+		const std::unique_ptr<byte_source> source = open_source(file_path, kind);
+		std::vector<std::uint8_t>          bytes  = {};
+
+		EXPECT_EQ(std::filesystem::file_size(file_path), source->get_size());
+
+		read_all(*source, bytes);
+		EXPECT_EQ(std::filesystem::file_size(file_path), bytes.size());
+		EXPECT_EQ(0, source->read(bytes));
+	}
+}
+
+TEST(byte_source, peek_success)
+{
+	const std::unique_ptr<byte_source> source = open_source(std::string{ TEST_DATA_PATH } + "image1.ico");
+	const std::vector<std::uint8_t>    header = { 0x00, 0x00, 0x01, 0x00, 0x01, 0x00 };
+	std::vector<std::uint8_t>          bytes  = {};
+
+	EXPECT_TRUE(std::ranges::equal(std::span{ header }.first(4), source->peek(4)));
+	EXPECT_TRUE(std::ranges::equal(header, source->peek(6)));
+
+	// The peeked bytes are read again.
+	read_all(*source, bytes);
+	ASSERT_LE(header.size(), bytes.size());
+	EXPECT_TRUE(std::ranges::equal(header, std::span{ bytes }.first(header.size())));
+}
+
+TEST(byte_source, open_fail)
+{
+	static constexpr std::string_view INVALID_PATH = "invalid.ico";
+
+	ASSERT_THAT([]()
+	{
+		open_source(INVALID_PATH);
+	},
+	ThrowsMessage<std::invalid_argument>(HasSubstr(std::format("Failed to open \"{}\"!", INVALID_PATH))));
+}
+
+TEST(byte_source, cursor_bounds_fail)
+{
+	const std::array<std::uint8_t, 6> bytes  = { 1, 0, 2, 0, 3, 0 };
+	byte_cursor<const std::uint8_t>   cursor = byte_cursor<const std::uint8_t>{ bytes };
+
+	EXPECT_EQ(1, cursor.read<std::uint16_t>("first"));
+	EXPECT_EQ(2, cursor.take(2, "second").front());
+	EXPECT_EQ(2, cursor.get_remaining());
+
+	ASSERT_THAT([&cursor]()
+	{
+		cursor.read<std::uint32_t>("third");
+	},
+	ThrowsMessage<std::runtime_error>(HasSubstr("Failed to read 4 bytes from third!")));
+
+	EXPECT_EQ(4, cursor.get_offset());
+}
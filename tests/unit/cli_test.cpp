@@ -0,0 +1,107 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "cli.cpp"
+
+using namespace testing;
+using namespace icon_changer;
+
+////////////////////////////////////////////////////////////////////////////////
+// TESTS
+////////////////////////////////////////////////////////////////////////////////
+
+TEST(cli, change_icon_cli_version_success)
+{
+	const char* arguments[] = { "icon-changer.exe", "--version" };
+	char*       buffer      = nullptr;
+	std::size_t size        = 0;
+	std::FILE*  output      = open_memstream(&buffer, &size);
+
+	change_icon_cli(sizeof(arguments) / sizeof(arguments[0]), arguments, output);
+	std::fclose(output);
+
+	EXPECT_THAT(std::string(buffer, size), HasSubstr("icon-changer version"));
+	std::free(buffer);
+}
+
+TEST(cli, change_icon_cli_v_success)
+{
+	const char* arguments[] = { "icon-changer.exe", "-v" };
+
+	change_icon_cli(sizeof(arguments) / sizeof(arguments[0]), arguments);
+}
+
+TEST(cli, change_icon_cli_1_parameter_missing_fail)
+{
+	const char* arguments[] = { "icon-changer.exe", "a.ico" };
+
+	ASSERT_THAT([&]()
+	{
+		change_icon_cli(sizeof(arguments) / sizeof(arguments[0]), arguments);
+	},
+	ThrowsMessage<std::runtime_error>(HasSubstr("1 parameter(s) missing!")));
+}
+
+TEST(cli, change_icon_cli_2_parameters_missing_fail)
+{
+	const char* arguments[] = { "icon-changer.exe" };
+
+	ASSERT_THAT([&]()
+	{
+		change_icon_cli(sizeof(arguments) / sizeof(arguments[0]), arguments);
+	},
+	ThrowsMessage<std::runtime_error>(HasSubstr("2 parameter(s) missing!")));
+}
+
+TEST(cli, change_icon_cli_group_executable_missing_fail)
+{
+	const char* arguments[] = { "icon-changer.exe", "--group", "2=document.ico" };
+
+	ASSERT_THAT([&]()
+	{
+		change_icon_cli(sizeof(arguments) / sizeof(arguments[0]), arguments);
+	},
+	ThrowsMessage<std::runtime_error>(HasSubstr("Path to the executable is missing!")));
+}
+
+TEST(cli, change_icon_cli_max_memory_overflow_fail)
+{
+	const char* arguments[] = { "icon-changer.exe", "--max-memory", "17592186044416", "a.ico", "a.exe" };
+
+	ASSERT_THAT([&]()
+	{
+		change_icon_cli(sizeof(arguments) / sizeof(arguments[0]), arguments);
+	},
+	ThrowsMessage<std::invalid_argument>(HasSubstr("Invalid value \"17592186044416\" for option \"--max-memory\"!")));
+}
+
+TEST(cli, change_icon_cli_inexistent_ico_fail)
+{
+	static constexpr std::string_view ICON_PATH = "inexistent.ico";
+
+	const char* arguments[] = { "icon-changer.exe", ICON_PATH.data(), "a.exe", "extra" };
+
+	ASSERT_THAT([&]()
+	{
+		change_icon_cli(sizeof(arguments) / sizeof(arguments[0]), arguments);
+	},
+	ThrowsMessage<std::invalid_argument>(HasSubstr(std::format("Failed to open \"{}\"!", ICON_PATH))));
+}
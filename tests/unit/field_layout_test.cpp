@@ -0,0 +1,71 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "bmp_file.hpp"
+#include "ico_file.hpp"
+
+#include <array>
+
+using namespace testing;
+using namespace icon_changer;
+
+////////////////////////////////////////////////////////////////////////////////
+// TESTS
+////////////////////////////////////////////////////////////////////////////////
+
+TEST(field_layout, size_success)
+{
+	EXPECT_EQ(6, WIRE_SIZE<ico_file::header>);
+	EXPECT_EQ(16, WIRE_SIZE<ico_file::entry>);
+	EXPECT_EQ(14, WIRE_SIZE<bmp_file::header>);
+	EXPECT_EQ(40, WIRE_SIZE<bmp_file::dib_header>);
+	EXPECT_EQ(4, WIRE_SIZE<std::uint32_t>);
+}
+
+TEST(field_layout, round_trip_success)
+{
+	static constexpr std::array<std::uint8_t, 14> BYTES = { 'B', 'M', 0x78, 0x56, 0x34, 0x12, 0x01, 0x00, 0x02, 0x00, 0x36, 0x04, 0x00, 0x00 };
+
+	std::array<std::uint8_t, 14> bytes  = {};
+	const bmp_file::header        header = deserialize<bmp_file::header>(BYTES, 0);
+
+	// The fields are read in little-endian byte order, without padding.
+	EXPECT_EQ(0x4D42, header.type);
+	EXPECT_EQ(0x12345678, header.file_size);
+	EXPECT_EQ(1, header.reserved1);
+	EXPECT_EQ(2, header.reserved2);
+	EXPECT_EQ(0x436, header.image_offset);
+
+	serialize(header, bytes, 0);
+	EXPECT_EQ(BYTES, bytes);
+
+	static_assert(-2 == read_wire<std::int32_t>(std::array<std::uint8_t, 4>{ 0xFE, 0xFF, 0xFF, 0xFF }.data()));
+}
+
+TEST(field_layout, write_bounds_fail)
+{
+	ASSERT_THAT(([]()
+	{
+		std::array<std::uint8_t, 5> bytes = {};
+
+		serialize(ico_file::header{ 0, 1, 1 }, bytes, 0);
+	}),
+	ThrowsMessage<std::runtime_error>(HasSubstr("Failed to write 6 bytes at offset 0x0!")));
+}
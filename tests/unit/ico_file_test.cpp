@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "ico_file.cpp"
+
+#include <array>
+#include <filesystem>
+#include <stdexcept>
+#include <vector>
+
+using namespace testing;
+using namespace icon_changer;
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Makes an ICO file whose two images are stored in reverse order, after a gap.
+/// \returns The bytes of the file.
+///
+static std::vector<std::uint8_t> make_reversed_icon()
+{
+	std::vector<std::uint8_t> bytes = std::vector<std::uint8_t>(6 + 2 * 16 + 4 + 3 + 5);
+
+	serialize(ico_file::header{ 0, 1, 2 }, bytes, 0);
+	serialize(ico_file::entry{ 16, 16, 0, 0, 1, 32, 5, 6 + 2 * 16 + 4 + 3 }, bytes, 6);
+	serialize(ico_file::entry{ 32, 32, 0, 0, 1, 32, 3, 6 + 2 * 16 + 4 }, bytes, 6 + 16);
+	std::ranges::fill(std::span{ bytes }.subspan(6 + 2 * 16 + 4, 3), 0xBB);
+	std::ranges::fill(std::span{ bytes }.subspan(6 + 2 * 16 + 4 + 3), 0xAA);
+
+	return bytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// TESTS
+////////////////////////////////////////////////////////////////////////////////
+
+TEST(ico_file, offsets_success)
+{
+	const std::vector<std::uint8_t> bytes     = make_reversed_icon();
+	const std::string               file_path = (std::filesystem::temp_directory_path() / "ico_file_offsets.ico").string();
+
+	write_file(file_path, bytes);
+
+	for (const source_kind kind : { source_kind::whole_file, source_kind::sequential })
+	{
+		const std::unique_ptr<byte_source> source   = open_source(file_path, kind);
+		ico_file                           streamed = ico_file{ *source };
+		ico_file                           parsed   = ico_file{ std::span<const std::uint8_t>{ bytes } };
+
+		for (ico_file* const file : { &streamed, &parsed })
+		{
+			const std::pmr::vector<std::span<const std::uint8_t>>& images = file->get_images();
+
+			ASSERT_EQ(2, images.size());
+			EXPECT_THAT(images[0], ElementsAre(0xAA, 0xAA, 0xAA, 0xAA, 0xAA));
+			EXPECT_THAT(images[1], ElementsAre(0xBB, 0xBB, 0xBB));
+		}
+	}
+
+	std::filesystem::remove(file_path);
+}
+
+TEST(ico_file, load_images_success)
+{
+	const std::string file_path = (std::filesystem::temp_directory_path() / "ico_file_load_images.ico").string();
+
+	write_file(file_path, make_reversed_icon());
+
+	ico_file                          ico_file = { file_path };
+	const std::array<std::size_t, 1> indices  = { 1 };
+
+	ico_file.load_images(indices);
+
+	// Only the requested image is read.
+	EXPECT_TRUE(ico_file.get_images()[0].empty());
+	EXPECT_THAT(ico_file.get_images()[1], ElementsAre(0xBB, 0xBB, 0xBB));
+	EXPECT_EQ(3, ico_file.release_arena().size());
+
+	std::filesystem::remove(file_path);
+}
+
+TEST(ico_file, image_outside_fail)
+{
+	std::vector<std::uint8_t> bytes = make_reversed_icon();
+
+	serialize(ico_file::entry{ 16, 16, 0, 0, 1, 32, 6, 6 + 2 * 16 + 4 + 3 }, bytes, 6);
+
+	ASSERT_THAT([&bytes]() { ico_file{ std::span<const std::uint8_t>{ bytes } }; },
+	            ThrowsMessage<std::runtime_error>(HasSubstr("ICO image of 6 bytes at offset 45 does not fit in the 50 bytes of the file!")));
+
+	serialize(ico_file::entry{ 16, 16, 0, 0, 1, 32, 6, 0 }, bytes, 6);
+
+	ASSERT_THAT([&bytes]() { ico_file{ std::span<const std::uint8_t>{ bytes } }; },
+	            ThrowsMessage<std::runtime_error>(HasSubstr("ICO image at offset 0 overlaps the 38 bytes of the header and entries!")));
+}
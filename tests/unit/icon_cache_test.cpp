@@ -0,0 +1,159 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "icon_cache.cpp"
+
+#include <fstream>
+
+using namespace testing;
+using namespace icon_changer;
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Counts the entries of a cache directory.
+/// \param directory_path: The cache directory.
+/// \returns The number of entries.
+///
+static std::size_t count_entries(const std::filesystem::path& directory_path)
+{
+	return std::ranges::distance(std::filesystem::directory_iterator{ directory_path }, std::filesystem::directory_iterator{});
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// TESTS
+////////////////////////////////////////////////////////////////////////////////
+
+TEST(hash, known_values_success)
+{
+	static constexpr std::string_view TEXT = "Nobody inspects the spammish repetition";
+
+	EXPECT_EQ(0xEF46DB3751D8E999ULL, hash({}));
+	EXPECT_EQ(0x44BC2CF5AD770999ULL, hash(std::span{ reinterpret_cast<const std::uint8_t*>("abc"), 3 }));
+	EXPECT_EQ(0xFBCEA83C8A378BF1ULL, hash(std::span{ reinterpret_cast<const std::uint8_t*>(TEXT.data()), TEXT.size() }));
+}
+
+TEST(hash, sha256_known_values_success)
+{
+	static constexpr std::string_view TEXT = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+
+	const std::span<const std::uint8_t> text    = { reinterpret_cast<const std::uint8_t*>(TEXT.data()), TEXT.size() };
+	const std::span<const std::uint8_t> split[] = { text.first(5), {}, text.subspan(5) };
+
+	EXPECT_EQ(0xE3, sha256({})[0]);
+	EXPECT_EQ(0x55, sha256({}).back());
+	EXPECT_EQ((sha256_digest{ 0x24, 0x8D, 0x6A, 0x61, 0xD2, 0x06, 0x38, 0xB8, 0xE5, 0xC0, 0x26, 0x93, 0x0C, 0x3E, 0x60, 0x39,
+	                          0xA3, 0x3C, 0xE4, 0x59, 0x64, 0xFF, 0x21, 0x67, 0xF6, 0xEC, 0xED, 0xD4, 0x19, 0xDB, 0x06, 0xC1 }),
+	          sha256(split));
+}
+
+TEST(icon_cache, load_hit_success)
+{
+	const std::filesystem::path directory_path = std::filesystem::temp_directory_path() / "icon_cache_hit";
+	const std::string           icon_path      = std::string{ TEST_DATA_PATH } + "image1.ico";
+
+	std::filesystem::remove_all(directory_path);
+
+	const icon_cache cache    = icon_cache{ directory_path.string() };
+	const icon       expected = { icon_path };
+	const icon       missed   = cache.load(icon_path, icon::options{});
+	const icon       hit      = cache.load(icon_path, icon::options{});
+
+	EXPECT_EQ(1, count_entries(directory_path));
+
+	for (const icon* icon : { &missed, &hit })
+	{
+		EXPECT_TRUE(std::ranges::equal(expected.get_header(), icon->get_header()));
+
+		ASSERT_EQ(expected.get_images().size(), icon->get_images().size());
+		EXPECT_TRUE(std::ranges::equal(expected.get_images().front(), icon->get_images().front()));
+	}
+
+	std::filesystem::remove_all(directory_path);
+}
+
+TEST(icon_cache, load_corrupt_entry_success)
+{
+	const std::filesystem::path directory_path = std::filesystem::temp_directory_path() / "icon_cache_corrupt";
+	const std::string           icon_path      = std::string{ TEST_DATA_PATH } + "image1.ico";
+
+	std::filesystem::remove_all(directory_path);
+
+	const icon_cache cache = icon_cache{ directory_path.string() };
+
+	static_cast<void>(cache.load(icon_path, icon::options{}));
+
+	// A truncated entry is treated as a miss and rewritten.
+	std::filesystem::resize_file(std::filesystem::directory_iterator{ directory_path }->path(), sizeof(std::uint32_t));
+
+	const icon expected = { icon_path };
+	const icon icon     = cache.load(icon_path, icon::options{});
+
+	EXPECT_TRUE(std::ranges::equal(expected.get_header(), icon.get_header()));
+	EXPECT_LT(sizeof(std::uint32_t), std::filesystem::directory_iterator{ directory_path }->file_size());
+
+	std::filesystem::remove_all(directory_path);
+}
+
+TEST(icon_cache, load_colliding_entry_success)
+{
+	const std::filesystem::path directory_path = std::filesystem::temp_directory_path() / "icon_cache_colliding";
+	const std::string           icon_path      = std::string{ TEST_DATA_PATH } + "image1.ico";
+	const std::string           other_path     = (directory_path / "other.ico").string();
+
+	std::filesystem::remove_all(directory_path);
+
+	const icon_cache cache = icon_cache{ (directory_path / "cache").string() };
+
+	static_cast<void>(cache.load(icon_path, icon::options{}));
+
+	// The entry of another icon is given the name, hash and size of this one, as a crafted collision would.
+	const std::filesystem::path entry_path = std::filesystem::directory_iterator{ directory_path / "cache" }->path();
+	std::vector<std::uint8_t>   entry      = read_file(entry_path.string());
+	std::vector<std::uint8_t>   other      = read_file(icon_path);
+
+	other.back() ^= 0xFF;
+	serialize(hash(other), entry, 2 * sizeof(std::uint32_t));
+	write_file(other_path, other);
+	write_file((directory_path / "cache" / std::format("{:016x}.icc", hash(other))).string(), entry);
+
+	const icon icon = cache.load(other_path, icon::options{});
+
+	EXPECT_EQ(other.back(), icon.get_images().back().back());
+
+	std::filesystem::remove_all(directory_path);
+}
+
+TEST(icon_cache, evict_success)
+{
+	const std::filesystem::path directory_path = std::filesystem::temp_directory_path() / "icon_cache_evict";
+
+	std::filesystem::remove_all(directory_path);
+
+	const icon_cache cache = icon_cache{ directory_path.string(), 0 };
+
+	static_cast<void>(cache.load(std::string{ TEST_DATA_PATH } + "image1.ico", icon::options{}));
+	EXPECT_EQ(0, count_entries(directory_path));
+
+	std::filesystem::remove_all(directory_path);
+}
@@ -11,15 +11,19 @@
 // For more information, please refer to https://unlicense.org
 ////////////////////////////////////////////////////////////////////////////////
 
+
 ////////////////////////////////////////////////////////////////////////////////
 // HEADER FILE INCLUDES
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <gtest/gtest.h>
+#include <gmock/gmock.h>
 
-#include "icon_mock.hpp"
+#include "executable_builder.hpp"
 #include "icon_changer.cpp"
 
+#include <filesystem>
+
 using namespace testing;
 using namespace icon_changer;
 
@@ -27,74 +31,63 @@ using namespace icon_changer;
 // TESTS
 ////////////////////////////////////////////////////////////////////////////////
 
-TEST(icon_changer, change_icon_cli_version_success)
+TEST(icon_changer, change_icon_success)
 {
-	const char* arguments[] = { "icon-changer.exe", "--version" };
+	const std::filesystem::path file_path = std::filesystem::temp_directory_path() / "icon_changer_change_icon.exe";
+	const std::string           icon_path = std::string{ TEST_DATA_PATH } + "image1.ico";
+	const icon                  expected  = { icon_path };
 
-	change_icon_cli(sizeof(arguments) / sizeof(arguments[0]), arguments);
-}
+	write_file(file_path.string(), build_executable(resource_tree{}));
 
-TEST(icon_changer, change_icon_cli_v_success)
-{
-	const char* arguments[] = { "icon-changer.exe", "-v" };
+	// The executable has no resource section, so one is appended.
+	EXPECT_EQ(pe_file::save_strategy::rewritten, change_icon(icon_path, file_path.string()));
+	EXPECT_EQ(pe_file::save_strategy::unchanged, change_icon(icon_path, file_path.string()));
 
-	change_icon_cli(sizeof(arguments) / sizeof(arguments[0]), arguments);
-}
+	const pe_file       pe_file   = { file_path.string() };
+	const resource_tree resources = pe_file.read_resources();
+	const auto&         group     = resources.get_types().at(RT_GROUP_ICON).at(u"MAINICON");
 
-TEST(icon_changer, change_icon_cli_1_parameter_missing_fail)
-{
-	const char* arguments[] = { "icon-changer.exe", "a.ico" };
+	ASSERT_EQ(1, group.size());
+	EXPECT_TRUE(std::ranges::equal(expected.get_header(), group.begin()->second.data));
+	ASSERT_EQ(expected.get_images().size(), resources.get_types().at(RT_ICON).size());
+	EXPECT_TRUE(std::ranges::equal(expected.get_images().front(), resources.get_types().at(RT_ICON).at(std::uint16_t{ 1 }).begin()->second.data));
 
-	ASSERT_THAT([&]()
-	{
-		change_icon_cli(sizeof(arguments) / sizeof(arguments[0]), arguments);
-	},
-	ThrowsMessage<std::runtime_error>(HasSubstr("1 parameter(s) missing!")));
+	std::filesystem::remove(file_path);
 }
 
-TEST(icon_changer, change_icon_cli_2_parameters_missing_fail)
-{
-	const char* arguments[] = { "icon-changer.exe" };
-
-	ASSERT_THAT([&]()
-	{
-		change_icon_cli(sizeof(arguments) / sizeof(arguments[0]), arguments);
-	},
-	ThrowsMessage<std::runtime_error>(HasSubstr("2 parameter(s) missing!")));
-}
-
-TEST(icon_changer, change_icon_cli_inexistent_ico_fail)
+TEST(icon_changer, change_icon_inexistent_ico_fail)
 {
 	static constexpr std::string_view ICON_PATH = "inexistent.ico";
 
-	const char* arguments[] = { "icon-changer.exe", ICON_PATH.data(), "a.exe", "extra" };
-
 	ASSERT_THAT([&]()
 	{
-		change_icon_cli(sizeof(arguments) / sizeof(arguments[0]), arguments);
+		change_icon(ICON_PATH, "a.exe");
 	},
 	ThrowsMessage<std::invalid_argument>(HasSubstr(std::format("\"{}\" does not exist!", ICON_PATH))));
 }
 
-TEST(icon_changer, change_icon_cli_inexistent_exe_fail)
+TEST(icon_changer, change_icon_inexistent_exe_fail)
 {
 	static constexpr std::string_view EXE_PATH = "inexistent.exe";
 
-	const std::string icon_path   = std::string{ TEST_DATA_PATH } + "image1.ico";
-	const char*       arguments[] = { "icon-changer.exe", icon_path.c_str(), EXE_PATH.data() };
+	const std::string icon_path = std::string{ TEST_DATA_PATH } + "image1.ico";
 
 	ASSERT_THAT([&]()
 	{
-		change_icon_cli(sizeof(arguments) / sizeof(arguments[0]), arguments);
+		change_icon(icon_path, EXE_PATH);
 	},
 	ThrowsMessage<std::invalid_argument>(HasSubstr(std::format("\"{}\" does not exist!", EXE_PATH))));
 }
 
-TEST(icon_changer, change_icon_gui)
+TEST(icon_changer, change_icon_groups_same_name_fail)
 {
-	ASSERT_THAT([]()
+	const icon                      icon   = { std::string{ TEST_DATA_PATH } + "image1.ico" };
+	const std::array<icon_group, 3> groups = { icon_group{ std::uint16_t{ 2 }, &icon }, icon_group{ resource_tree::make_identifier("DOCUMENT"), &icon },
+		                                       icon_group{ std::uint16_t{ 2 }, &icon } };
+
+	ASSERT_THAT([&]()
 	{
-		change_icon_gui();
+		change_icon(groups, "a.exe");
 	},
-	ThrowsMessage<std::runtime_error>(HasSubstr("GUI not yet implemented!")));
+	ThrowsMessage<std::invalid_argument>(HasSubstr("Icon group \"2\" is listed more than once!")));
 }
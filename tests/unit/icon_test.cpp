@@ -18,6 +18,7 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include "executable_builder.hpp"
 #include "icon.cpp"
 
 #include <stdexcept>
@@ -123,10 +124,10 @@ TEST(icon, constructor_image_incomplete_fail)
 
 TEST(icon, get_success)
 {
-	icon                                    icon            = { std::string{ TEST_DATA_PATH } + "image1.ico" };
-	const std::vector<std::uint8_t>         header          = icon.get_header();
-	std::vector<std::vector<std::uint8_t>>& images          = icon.get_images();
-	const std::vector<std::uint8_t>         expected_header = { 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x20, 0x20, 0x00, 0x00, 0x01, 0x00,
+	icon                                                 icon            = { std::string{ TEST_DATA_PATH } + "image1.ico" };
+	const std::vector<std::uint8_t>                      header          = { icon.get_header().begin(), icon.get_header().end() };
+	const std::span<const std::span<const std::uint8_t>> images          = icon.get_images();
+	const std::vector<std::uint8_t>                      expected_header = { 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x20, 0x20, 0x00, 0x00, 0x01, 0x00,
 																0x20, 0x00, 0xA8, 0x10, 0x00, 0x00, 0x01, 0x00 };
 
 	EXPECT_EQ(20, header.size());
@@ -136,3 +137,334 @@ TEST(icon, get_success)
 	EXPECT_EQ(0x10A8, images.front().size());
 	// TODO: check the content of the image
 }
+
+TEST(icon, get_mapped_success)
+{
+	icon                                                 stream_icon = { std::string{ TEST_DATA_PATH } + "image1.ico" };
+	icon                                                 mapped_icon = { std::string{ TEST_DATA_PATH } + "image1.ico", icon::load_mode::mapped };
+	const std::span<const std::span<const std::uint8_t>> images      = mapped_icon.get_images();
+
+	EXPECT_TRUE(std::ranges::equal(stream_icon.get_header(), mapped_icon.get_header()));
+
+	ASSERT_EQ(1, images.size());
+	EXPECT_TRUE(std::ranges::equal(stream_icon.get_images().front(), images.front()));
+}
+
+TEST(icon, resampled_success)
+{
+	const std::string                                    file_path = std::string{ TEST_DATA_PATH } + "cameraman.bmp";
+	icon                                                 icon      = { file_path, icon::options{ .sizes = { 16, 256 } } };
+	mapped_file                                          file      = { file_path };
+	const bgra_image                                     source    = bmp_file{ file.get_bytes() }.decode();
+	const std::span<const std::uint8_t>                  header    = icon.get_header();
+	const std::span<const std::span<const std::uint8_t>> images    = icon.get_images();
+
+	ASSERT_EQ(6 + 2 * 14, header.size());
+	EXPECT_EQ(2, header[4]);
+	EXPECT_EQ(16, header[6]);
+	EXPECT_EQ(32, header[12]);
+	EXPECT_EQ(1, header[18]);
+	EXPECT_EQ(0, header[20]);
+	EXPECT_EQ(2, header[32]);
+
+	ASSERT_EQ(2, images.size());
+	EXPECT_EQ(40 + 16 * 16 * 4 + 4 * 16, images[0].size());
+	ASSERT_EQ(40 + 256 * 256 * 4 + 32 * 256, images[1].size());
+
+	// Resampling to the same size keeps every pixel, the rows being stored bottom-up.
+	for (std::size_t y = 0; y < 256; ++y)
+	{
+		ASSERT_TRUE(std::ranges::equal(images[1].subspan(40 + (255 - y) * 256 * 4, 256 * 4),
+		                               std::span{ source.pixels }.subspan(y * 256 * 4, 256 * 4)));
+	}
+
+	// The image is opaque, so its AND mask is empty.
+	EXPECT_TRUE(std::ranges::all_of(images[1].subspan(40 + 256 * 256 * 4), [](const std::uint8_t byte)
+	{
+		return 0 == byte;
+	}));
+}
+
+TEST(icon, resampled_size_fail)
+{
+	ASSERT_THAT(([]()
+	{
+		icon icon = { std::string{ TEST_DATA_PATH } + "cameraman.bmp", icon::options{ .sizes = { 16, 0 } } };
+	}),
+	ThrowsMessage<std::invalid_argument>(HasSubstr("Size 0 is not between 1 and 256!")));
+}
+
+TEST(icon, memory_budget_fail)
+{
+	ASSERT_THAT(([]()
+	{
+		icon icon = { std::string{ TEST_DATA_PATH } + "image1.ico", icon::options{ .max_memory = 4096 } };
+	}),
+	ThrowsMessage<std::runtime_error>(HasSubstr("ICO images of 4264 bytes exceeds the memory budget")));
+
+	// The file fits, its decoded pixels do not.
+	ASSERT_THAT(([]()
+	{
+		icon icon = { std::string{ TEST_DATA_PATH } + "cameraman.bmp", icon::options{ .sizes = { 16 }, .max_memory = 128 * 1024 } };
+	}),
+	ThrowsMessage<std::runtime_error>(HasSubstr("Decoded image of 262144 bytes exceeds the memory budget")));
+}
+
+TEST(icon, converted_success)
+{
+	const std::filesystem::path file_path = std::filesystem::temp_directory_path() / "icon_converted.bmp";
+	std::vector<std::uint8_t>   bytes     = std::vector<std::uint8_t>(14 + 40 + 17 * 2 * 4, 0xFF);
+
+	// A top-down 32bpp image of 17x2 pixels, the first and last pixels of its top row being transparent.
+	serialize(bmp_file::header{ 0x4D42, static_cast<std::uint32_t>(bytes.size()), 0, 0, 14 + 40 }, bytes, 0);
+	serialize(bmp_file::dib_header{ 40, 17, -2, 1, 32, 0, 17 * 2 * 4, 0, 0, 0, 0 }, bytes, 14);
+	bytes[14 + 40 + 3]          = 0;
+	bytes[14 + 40 + 16 * 4 + 3] = 0;
+
+	write_file(file_path.string(), bytes);
+
+	const icon                                           converted = { file_path.string() };
+	const std::span<const std::uint8_t>                  header    = converted.get_header();
+	const std::span<const std::span<const std::uint8_t>> images    = converted.get_images();
+
+	std::filesystem::remove(file_path);
+
+	ASSERT_EQ(6 + 14, header.size());
+	EXPECT_EQ(17, header[6]);
+	EXPECT_EQ(2, header[7]);
+	EXPECT_EQ(32, deserialize<std::uint16_t>(header, 6 + 6));
+
+	// The rows are stored bottom-up, followed by the AND mask rows of 4 bytes.
+	ASSERT_EQ(1, images.size());
+	ASSERT_EQ(40 + 17 * 2 * 4 + 2 * 4, images[0].size());
+	EXPECT_EQ(4, deserialize<std::int32_t>(images[0], 8));
+	EXPECT_EQ(0, images[0][40 + 17 * 4 + 3]);
+	EXPECT_THAT(images[0].subspan(40 + 17 * 2 * 4), ElementsAre(0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x80, 0x00));
+}
+
+TEST(icon, png_success)
+{
+	const std::filesystem::path     file_path = std::filesystem::temp_directory_path() / "icon_png.png";
+	mapped_file                     bitmap    = { std::string{ TEST_DATA_PATH } + "cameraman.bmp" };
+	const bgra_image                source    = bmp_file{ bitmap.get_bytes() }.decode();
+	const std::vector<std::uint8_t> bytes     = encode_png(source);
+
+	write_file(file_path.string(), bytes);
+
+	const icon streamed  = { file_path.string() };
+	const icon mapped    = { file_path.string(), icon::load_mode::mapped };
+	const icon resampled = { file_path.string(), icon::options{ .sizes = { 256 } } };
+
+	std::filesystem::remove(file_path);
+
+	// Stored as it is, the side of 256 pixels being 0.
+	EXPECT_EQ(0, streamed.get_header()[6]);
+	EXPECT_EQ(bytes.size(), deserialize<std::uint32_t>(streamed.get_header(), 6 + 8));
+	ASSERT_EQ(1, streamed.get_images().size());
+	EXPECT_TRUE(std::ranges::equal(bytes, streamed.get_images()[0]));
+	EXPECT_TRUE(std::ranges::equal(bytes, mapped.get_images()[0]));
+
+	// Decoded to be resampled, to the same pixels as the BMP file.
+	for (std::size_t y = 0; y < 256; ++y)
+	{
+		ASSERT_TRUE(std::ranges::equal(resampled.get_images()[0].subspan(40 + (255 - y) * 256 * 4, 256 * 4),
+		                               std::span{ source.pixels }.subspan(y * 256 * 4, 256 * 4)));
+	}
+}
+
+TEST(icon, compressed_success)
+{
+	static constexpr std::array<std::uint8_t, 8> PNG_SIGNATURE = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+	const std::string                                    file_path   = std::string{ TEST_DATA_PATH } + "cameraman.bmp";
+	icon                                                 original    = { file_path, icon::options{ .sizes = { 16, 256 } } };
+	icon                                                 compressed  = { file_path, icon::options{ .sizes = { 16, 256 }, .png_min_size = 256 } };
+	const std::span<const std::uint8_t>                  header      = compressed.get_header();
+	const std::span<const std::span<const std::uint8_t>> images      = compressed.get_images();
+	const std::span<const icon::compression>             compression = compressed.get_compressions();
+
+	ASSERT_EQ(2, images.size());
+	EXPECT_TRUE(std::ranges::equal(original.get_images()[0], images[0]));
+	ASSERT_LT(images[1].size(), original.get_images()[1].size());
+	EXPECT_TRUE(std::ranges::equal(PNG_SIGNATURE, images[1].first(PNG_SIGNATURE.size())));
+
+	// The group entry of the compressed image gives the size of the PNG.
+	EXPECT_EQ(images[1].size(), deserialize<std::uint32_t>(header, 6 + 14 + 8));
+
+	ASSERT_EQ(1, compression.size());
+	EXPECT_EQ(256, compression[0].width);
+	EXPECT_EQ(256, compression[0].height);
+	EXPECT_EQ(original.get_images()[1].size(), compression[0].original_size);
+	EXPECT_EQ(images[1].size(), compression[0].size);
+}
+
+TEST(icon, compressed_not_square_success)
+{
+	static constexpr std::uint32_t WIDTH  = 32;
+	static constexpr std::uint32_t HEIGHT = 16;
+	static constexpr std::uint32_t SIZE   = WIRE_SIZE<bmp_file::dib_header> + WIDTH * HEIGHT * 4 + 4 * HEIGHT;
+
+	const std::filesystem::path file_path = std::filesystem::temp_directory_path() / "icon_compressed_not_square.ico";
+	std::vector<std::uint8_t>   bytes     = std::vector<std::uint8_t>(WIRE_SIZE<ico_file::header> + WIRE_SIZE<ico_file::entry> + SIZE, 0x40);
+
+	// The DIB holds the image and its mask, hence the doubled height.
+	serialize(ico_file::header{ 0, 1, 1 }, bytes, 0);
+	serialize(ico_file::entry{ WIDTH, HEIGHT, 0, 0, 1, 32, SIZE, WIRE_SIZE<ico_file::header> + WIRE_SIZE<ico_file::entry> }, bytes, WIRE_SIZE<ico_file::header>);
+	serialize(bmp_file::dib_header{ WIRE_SIZE<bmp_file::dib_header>, WIDTH, 2 * HEIGHT, 1, 32, 0, 0, 0, 0, 0, 0 }, bytes,
+	          WIRE_SIZE<ico_file::header> + WIRE_SIZE<ico_file::entry>);
+	write_file(file_path.string(), bytes);
+
+	icon                                     icon        = { file_path.string(), icon::options{ .png_min_size = WIDTH } };
+	const std::span<const icon::compression> compression = icon.get_compressions();
+
+	std::filesystem::remove(file_path);
+
+	ASSERT_EQ(1, compression.size());
+	EXPECT_EQ(WIDTH, compression[0].width);
+	EXPECT_EQ(HEIGHT, compression[0].height);
+}
+
+TEST(icon, deduplicated_success)
+{
+	const std::filesystem::path         file_path = std::filesystem::temp_directory_path() / "icon_deduplicated.ico";
+	const std::vector<std::uint8_t>     original  = read_file(std::string{ TEST_DATA_PATH } + "image1.ico");
+	const std::span<const std::uint8_t> image     = std::span{ original }.subspan(6 + 16);
+	std::vector<std::uint8_t>           bytes     = { 0x00, 0x00, 0x01, 0x00, 0x02, 0x00 };
+
+	// The same image is listed twice, each entry pointing to its own copy.
+	for (std::uint32_t index = 0; index < 2; ++index)
+	{
+		bytes.insert(bytes.end(), original.begin() + 6, original.begin() + 6 + 12);
+		bytes.resize(bytes.size() + 4);
+		serialize(static_cast<std::uint32_t>(6 + 2 * 16 + index * image.size()), bytes, bytes.size() - 4);
+	}
+
+	bytes.insert(bytes.end(), image.begin(), image.end());
+	bytes.insert(bytes.end(), image.begin(), image.end());
+	write_file(file_path.string(), bytes);
+
+	icon                                                 icon          = { file_path.string() };
+	const std::span<const std::uint8_t>                  header        = icon.get_header();
+	const std::span<const std::span<const std::uint8_t>> images        = icon.get_images();
+	const icon::deduplication                            deduplication = icon.get_deduplication();
+
+	std::filesystem::remove(file_path);
+
+	ASSERT_EQ(6 + 2 * 14, header.size());
+	EXPECT_EQ(2, header[4]);
+
+	// Both entries refer to the single RT_ICON resource.
+	EXPECT_EQ(1, deserialize<std::uint16_t>(header, 6 + 12));
+	EXPECT_EQ(1, deserialize<std::uint16_t>(header, 6 + 14 + 12));
+
+	ASSERT_EQ(1, images.size());
+	EXPECT_TRUE(std::ranges::equal(image, images.front()));
+
+	EXPECT_EQ(1, deduplication.images_count);
+	EXPECT_EQ(image.size(), deduplication.saved_size);
+}
+
+TEST(icon, selected_success)
+{
+	const std::filesystem::path       file_path = std::filesystem::temp_directory_path() / "icon_selected.ico";
+	const std::array<std::uint8_t, 3> widths    = { 16, 32, 48 };
+	std::vector<std::uint8_t>         bytes     = std::vector<std::uint8_t>(6 + 3 * 16);
+
+	// Three entries of one byte each, the second one of 8 bits per pixel.
+	serialize(ico_file::header{ 0, 1, 3 }, bytes, 0);
+
+	for (std::uint32_t index = 0; index < widths.size(); ++index)
+	{
+		serialize(ico_file::entry{ widths[index], widths[index], 0, 0, 1, static_cast<std::uint16_t>(1 == index ? 8 : 32), 1, 6 + 3 * 16 + index }, bytes,
+		          6 + index * 16);
+		bytes.push_back(static_cast<std::uint8_t>(index));
+	}
+
+	write_file(file_path.string(), bytes);
+
+	const icon                                           selected = { file_path.string(), icon::options{ .entry_sizes = { 32, 48 }, .entry_depths = { 32 } } };
+	const std::span<const std::uint8_t>                  header   = selected.get_header();
+	const std::span<const std::span<const std::uint8_t>> images   = selected.get_images();
+
+	ASSERT_THAT(([&file_path]()
+	{
+		icon icon = { file_path.string(), icon::options{ .entry_sizes = { 256 } } };
+	}),
+	ThrowsMessage<std::invalid_argument>(HasSubstr("None of the 3 entries of the icon has the selected sizes and bits per pixel!")));
+
+	std::filesystem::remove(file_path);
+
+	// Only the 48 pixel entry is kept, with the first ID.
+	ASSERT_EQ(6 + 14, header.size());
+	EXPECT_EQ(1, header[4]);
+	EXPECT_EQ(48, header[6]);
+	EXPECT_EQ(1, deserialize<std::uint16_t>(header, 6 + 12));
+
+	ASSERT_EQ(1, images.size());
+	EXPECT_THAT(images[0], ElementsAre(2));
+}
+
+TEST(icon, renumbered_header_success)
+{
+	const std::string                  file_path = std::string{ TEST_DATA_PATH } + "cameraman.bmp";
+	icon                               icon      = { file_path, icon::options{ .sizes = { 16, 32 } } };
+	const std::array<std::uint16_t, 2> ids       = { 7, 3 };
+	const std::vector<std::uint8_t>    header    = icon.get_header(ids);
+
+	EXPECT_EQ((std::vector<std::uint16_t>{ 1, 2 }), icon::get_image_ids(icon.get_header()));
+	EXPECT_EQ((std::vector<std::uint16_t>{ 7, 3 }), icon::get_image_ids(header));
+
+	// Only the IDs change.
+	ASSERT_EQ(icon.get_header().size(), header.size());
+	EXPECT_TRUE(std::ranges::equal(icon.get_header().first(6 + 12), std::span{ header }.first(6 + 12)));
+}
+
+TEST(icon, pe_success)
+{
+	const std::filesystem::path     file_path = std::filesystem::temp_directory_path() / "icon_source.exe";
+	const std::vector<std::uint8_t> small     = std::vector<std::uint8_t>(40, 0x11);
+	const std::vector<std::uint8_t> large     = std::vector<std::uint8_t>(90, 0x22);
+	const std::vector<std::uint8_t> german    = std::vector<std::uint8_t>(20, 0x33);
+	const std::vector<std::uint8_t> english   = std::vector<std::uint8_t>(30, 0x44);
+	std::vector<std::uint8_t>       main      = std::vector<std::uint8_t>(WIRE_SIZE<ico_file::header> + 2 * WIRE_SIZE<icon::group_entry>);
+	std::vector<std::uint8_t>       document  = std::vector<std::uint8_t>(WIRE_SIZE<ico_file::header> + WIRE_SIZE<icon::group_entry>);
+	resource_tree                   resources = {};
+
+	// The declared sizes are wrong on purpose, the ones of the images are kept.
+	serialize(ico_file::header{ 0, 1, 2 }, main, 0);
+	serialize(icon::group_entry{ 16, 16, 0, 0, 1, 32, 1, 7 }, main, WIRE_SIZE<ico_file::header>);
+	serialize(icon::group_entry{ 0, 0, 0, 0, 1, 32, 1, 8 }, main, WIRE_SIZE<ico_file::header> + WIRE_SIZE<icon::group_entry>);
+	serialize(ico_file::header{ 0, 1, 1 }, document, 0);
+	serialize(icon::group_entry{ 32, 32, 0, 0, 1, 8, 30, 9 }, document, WIRE_SIZE<ico_file::header>);
+	resources.set(RT_ICON, std::uint16_t{ 7 }, std::uint16_t{ 1033 }, small);
+	resources.set(RT_ICON, std::uint16_t{ 8 }, std::uint16_t{ 1033 }, large);
+	resources.set(RT_ICON, std::uint16_t{ 9 }, std::uint16_t{ 1031 }, german);
+	resources.set(RT_ICON, std::uint16_t{ 9 }, std::uint16_t{ 1033 }, english);
+	resources.set(RT_GROUP_ICON, resource_tree::make_identifier("MAINICON"), std::uint16_t{ 1033 }, main);
+	resources.set(RT_GROUP_ICON, std::uint16_t{ 5 }, std::uint16_t{ 1033 }, document);
+	write_file(file_path.string(), build_executable(resources));
+
+	// Named groups come first, so the main icon is copied by default.
+	const icon                          main_icon = { file_path.string() };
+	const std::span<const std::uint8_t> header    = main_icon.get_header();
+
+	ASSERT_EQ(2, main_icon.get_images().size());
+	EXPECT_THAT(main_icon.get_images()[0], ElementsAreArray(small));
+	EXPECT_THAT(main_icon.get_images()[1], ElementsAreArray(large));
+	EXPECT_EQ(90, deserialize<std::uint32_t>(header, 6 + 14 + 8));
+	EXPECT_EQ((std::vector<std::uint16_t>{ 1, 2 }), icon::get_image_ids(header));
+
+	// The image in the language of the group is preferred.
+	const icon document_icon = { file_path.string(), icon::options{ .entry_depths = { 8 }, .source_group = std::uint16_t{ 5 } } };
+
+	ASSERT_EQ(1, document_icon.get_images().size());
+	EXPECT_THAT(document_icon.get_images()[0], ElementsAreArray(english));
+
+	ASSERT_THAT(([&file_path]()
+	{
+		icon icon = { file_path.string(), icon::options{ .source_group = std::uint16_t{ 6 } } };
+	}),
+	ThrowsMessage<std::invalid_argument>(HasSubstr("does not have the icon group 6!")));
+
+	std::filesystem::remove(file_path);
+}
@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "executable_builder.hpp"
+#include "inventory.cpp"
+
+#include <filesystem>
+
+using namespace testing;
+using namespace icon_changer;
+
+////////////////////////////////////////////////////////////////////////////////
+// TESTS
+////////////////////////////////////////////////////////////////////////////////
+
+TEST(inventory, scan_icons_success)
+{
+	const std::filesystem::path     directory_path = std::filesystem::temp_directory_path() / "inventory_scan";
+	const std::filesystem::path     extract_path   = std::filesystem::temp_directory_path() / "inventory_extract";
+	const std::vector<std::uint8_t> small          = std::vector<std::uint8_t>(40, 0x11);
+	const std::vector<std::uint8_t> large          = std::vector<std::uint8_t>(90, 0x22);
+	std::vector<std::uint8_t>       header         = std::vector<std::uint8_t>(WIRE_SIZE<ico_file::header> + 3 * WIRE_SIZE<icon::group_entry>);
+	resource_tree                   resources      = {};
+
+	std::filesystem::remove_all(directory_path);
+	std::filesystem::remove_all(extract_path);
+	std::filesystem::create_directories(directory_path / "bin");
+
+	// The third entry refers to an image the executable does not have.
+	serialize(ico_file::header{ 0, 1, 3 }, header, 0);
+	serialize(icon::group_entry{ 16, 16, 0, 0, 1, 32, 40, 7 }, header, WIRE_SIZE<ico_file::header>);
+	serialize(icon::group_entry{ 0, 0, 0, 0, 1, 32, 90, 8 }, header, WIRE_SIZE<ico_file::header> + WIRE_SIZE<icon::group_entry>);
+	serialize(icon::group_entry{ 32, 32, 0, 0, 1, 32, 10, 9 }, header, WIRE_SIZE<ico_file::header> + 2 * WIRE_SIZE<icon::group_entry>);
+	resources.set(RT_ICON, std::uint16_t{ 7 }, std::uint16_t{ 1033 }, small);
+	resources.set(RT_ICON, std::uint16_t{ 8 }, std::uint16_t{ 1033 }, large);
+	resources.set(RT_GROUP_ICON, resource_tree::make_identifier("MAINICON"), std::uint16_t{ 1033 }, header);
+
+	write_file((directory_path / "bin" / "app.exe").string(), build_executable(resources));
+	write_file((directory_path / "readme.txt").string(), std::vector<std::uint8_t>{ 'M', 'Z' });
+	write_file((directory_path / "notes.txt").string(), std::vector<std::uint8_t>{ 'h', 'i' });
+
+	const std::vector<inventory_entry> entries = scan_icons(directory_path.string(), 2, extract_path.string());
+
+	// The text file starting with MZ is listed as a failing executable, the other one is skipped.
+	ASSERT_EQ(2, entries.size());
+	EXPECT_EQ((directory_path / "bin" / "app.exe").string(), entries[0].executable_path);
+	EXPECT_THAT(entries[1].error, HasSubstr("Failed to read"));
+	ASSERT_EQ(1, entries[0].groups.size());
+
+	const inventory_group& group = entries[0].groups[0];
+
+	EXPECT_EQ("MAINICON", resource_tree::to_string(group.name));
+	EXPECT_EQ(3, group.images.size());
+	EXPECT_EQ(hash(small), group.images[0].hash);
+	EXPECT_EQ(hash(large, hash(small)), group.hash);
+	EXPECT_FALSE(group.images[2].found);
+
+	// The extracted file holds the images that were found.
+	ico_file ico_file = icon_changer::ico_file{ (extract_path / "bin" / "app.exe" / "MAINICON.1033.ico").string() };
+
+	ASSERT_EQ(2, ico_file.get_header().entries_count);
+	EXPECT_EQ(0, ico_file.get_entries()[1].width);
+	EXPECT_THAT(ico_file.get_images()[0], ElementsAreArray(small));
+	EXPECT_THAT(ico_file.get_images()[1], ElementsAreArray(large));
+
+	const std::string csv = format_inventory(entries, inventory_format::csv);
+
+	EXPECT_THAT(csv, HasSubstr(std::format(",MAINICON,1033,{:016x},8,256,256,0,1,32,90,{:016x},\n", group.hash, hash(large))));
+	EXPECT_THAT(format_inventory(entries, inventory_format::json), HasSubstr("{\"id\":9,\"width\":32,\"height\":32,\"color_count\":0,\"planes\":1,\"bit_count\":32,\"size\":null,\"hash\":null}"));
+
+	std::filesystem::remove_all(directory_path);
+	std::filesystem::remove_all(extract_path);
+}
+
+TEST(inventory, scan_icons_extract_same_file_name_success)
+{
+	const std::filesystem::path                  directory_path = std::filesystem::temp_directory_path() / "inventory_same_name";
+	const std::filesystem::path                  extract_path   = std::filesystem::temp_directory_path() / "inventory_same_name_extract";
+	const std::vector<resource_tree::identifier> names          = { std::uint16_t{ 1 }, resource_tree::make_identifier("1"), resource_tree::make_identifier("MAIN ICON"),
+		                                                             resource_tree::make_identifier("MAIN_ICON") };
+	const std::vector<std::string>               file_names     = { "#1.1033.ico", "1.1033.ico", "MAIN_ICON.1033.ico", "MAIN_ICON_2.1033.ico" };
+	std::vector<std::vector<std::uint8_t>>       headers        = {};
+	std::vector<std::vector<std::uint8_t>>       images         = {};
+	resource_tree                                resources      = {};
+
+	std::filesystem::remove_all(directory_path);
+	std::filesystem::remove_all(extract_path);
+	std::filesystem::create_directories(directory_path);
+
+	// The resources only refer to their data, which is reserved up front so that it does not move.
+	headers.reserve(names.size());
+	images.reserve(names.size());
+
+	// Every group has an image of its own, so that each file can be told from the others.
+	for (std::size_t index = 0; index < names.size(); ++index)
+	{
+		std::vector<std::uint8_t>& header = headers.emplace_back(WIRE_SIZE<ico_file::header> + WIRE_SIZE<icon::group_entry>);
+
+		serialize(ico_file::header{ 0, 1, 1 }, header, 0);
+		serialize(icon::group_entry{ 16, 16, 0, 0, 1, 32, 40, static_cast<std::uint16_t>(index + 1) }, header, WIRE_SIZE<ico_file::header>);
+		resources.set(RT_ICON, static_cast<std::uint16_t>(index + 1), std::uint16_t{ 1033 }, images.emplace_back(40, static_cast<std::uint8_t>(index)));
+		resources.set(RT_GROUP_ICON, names[index], std::uint16_t{ 1033 }, header);
+	}
+
+	write_file((directory_path / "app.exe").string(), build_executable(resources));
+
+	const std::vector<inventory_entry> entries = scan_icons(directory_path.string(), 1, extract_path.string());
+
+	ASSERT_EQ(1, entries.size());
+	EXPECT_EQ("", entries[0].error);
+
+	for (std::size_t index = 0; index < file_names.size(); ++index)
+	{
+		ico_file ico_file = icon_changer::ico_file{ (extract_path / "app.exe" / file_names[index]).string() };
+
+		ASSERT_EQ(1, ico_file.get_images().size());
+		EXPECT_THAT(ico_file.get_images()[0], Each(static_cast<std::uint8_t>(index))) << file_names[index];
+	}
+
+	std::filesystem::remove_all(directory_path);
+	std::filesystem::remove_all(extract_path);
+}
+
+TEST(inventory, scan_icons_directory_fail)
+{
+	ASSERT_THAT([&]()
+	{
+		static_cast<void>(scan_icons((std::filesystem::temp_directory_path() / "inventory_missing").string(), 1));
+	},
+	ThrowsMessage<std::invalid_argument>(HasSubstr("is not a directory!")));
+}
@@ -0,0 +1,312 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "executable_builder.hpp"
+#include "mapped_file.hpp"
+#include "pe_file.cpp"
+#include "resource_tree.cpp"
+#include "utility.cpp"
+
+#include <filesystem>
+
+using namespace testing;
+using namespace icon_changer;
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Writes the executable of build_executable() with, optionally, a
+/// `.rsrc` section containing one resource.
+/// \param file_path: Path of the executable to be written.
+/// \param with_resources: Whether to add the `.rsrc` section.
+/// \param overlay: Bytes appended after the last section.
+///
+static void make_executable(const std::filesystem::path&     file_path,
+                            const bool                       with_resources,
+                            const std::vector<std::uint8_t>& overlay = {})
+{
+	static const std::vector<std::uint8_t> VERSION_DATA = { 1, 2, 3, 4, 5 };
+
+	resource_tree resources = {};
+
+	if (with_resources)
+	{
+		resources.set(std::uint16_t{ 16 }, std::uint16_t{ 1 }, std::uint16_t{ 1033 }, VERSION_DATA);
+	}
+
+	write_file(file_path.string(), build_executable(resources, overlay));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// TESTS
+////////////////////////////////////////////////////////////////////////////////
+
+TEST(resource_tree, serialize_parse_success)
+{
+	const std::vector<std::uint8_t> icon   = { 0x28, 0x00, 0x00, 0x00 };
+	const std::vector<std::uint8_t> header = { 0x00, 0x00, 0x01, 0x00, 0x01, 0x00 };
+	resource_tree                   tree   = {};
+
+	tree.set(RT_ICON, std::uint16_t{ 1 }, LANG_NEUTRAL, icon);
+	tree.set(RT_GROUP_ICON, resource_tree::make_identifier("MainIcon"), LANG_NEUTRAL, header);
+
+	const std::vector<std::uint8_t> bytes  = tree.serialize(0x5000);
+	const resource_tree             parsed = { bytes, 0, 0x5000 };
+
+	const resource_tree::resource& parsed_icon  = parsed.get_types().at(RT_ICON).at(std::uint16_t{ 1 }).at(LANG_NEUTRAL);
+	const resource_tree::resource& parsed_group = parsed.get_types().at(RT_GROUP_ICON).at(u"MAINICON").at(LANG_NEUTRAL);
+
+	EXPECT_THAT(parsed_icon.data, ElementsAreArray(icon));
+	EXPECT_THAT(parsed_group.data, ElementsAreArray(header));
+	EXPECT_EQ(resource_tree::identifier{ std::uint16_t{ 7 } }, resource_tree::make_identifier("#7"));
+	EXPECT_EQ("7", resource_tree::to_string(std::uint16_t{ 7 }));
+	EXPECT_EQ("ICON_\xC3\xA9_\xF0\x9F\x98\x80", resource_tree::to_string(u"ICON_\u00E9_\U0001F600"));
+}
+
+TEST(resource_tree, remove_success)
+{
+	const std::vector<std::uint8_t> icon   = { 0x28, 0x00, 0x00, 0x00 };
+	const std::vector<std::uint8_t> header = { 0x00, 0x00, 0x01, 0x00, 0x01, 0x00 };
+	resource_tree                   tree   = {};
+
+	tree.set(RT_ICON, std::uint16_t{ 1 }, LANG_NEUTRAL, icon);
+	tree.set(RT_GROUP_ICON, resource_tree::make_identifier("MAINICON"), LANG_NEUTRAL, header);
+	tree.set(RT_GROUP_ICON, resource_tree::make_identifier("MAINICON"), std::uint16_t{ 1033 }, header);
+
+	// Every language is removed, and the type along with its last resource.
+	EXPECT_EQ(2 * header.size(), tree.remove(RT_GROUP_ICON, resource_tree::make_identifier("MAINICON")));
+	EXPECT_EQ(0, tree.remove(RT_GROUP_ICON, resource_tree::make_identifier("MAINICON")));
+	EXPECT_FALSE(tree.get_types().contains(RT_GROUP_ICON));
+	EXPECT_EQ(1, tree.get_types().at(RT_ICON).size());
+
+	const std::vector<std::uint8_t> bytes  = tree.serialize(0x5000);
+	const resource_tree             parsed = { bytes, 0, 0x5000 };
+
+	EXPECT_EQ(1, parsed.get_types().size());
+}
+
+TEST(resource_tree, parse_outside_fail)
+{
+	const std::vector<std::uint8_t> data  = { 1, 2, 3 };
+	resource_tree                   tree  = {};
+	std::vector<std::uint8_t>       bytes = {};
+
+	tree.set(RT_ICON, std::uint16_t{ 1 }, LANG_NEUTRAL, data);
+	bytes = tree.serialize(0x1000);
+
+	ASSERT_THAT([&]()
+	{
+		resource_tree parsed = resource_tree(bytes, 0, 0x2000);
+	},
+	ThrowsMessage<std::invalid_argument>(HasSubstr("lies outside of the resource section!")));
+}
+
+TEST(resource_tree, parse_shared_directory_fail)
+{
+	const std::vector<std::uint8_t> data  = { 1, 2, 3 };
+	resource_tree                   tree  = {};
+	std::vector<std::uint8_t>       bytes = {};
+
+	tree.set(RT_ICON, std::uint16_t{ 1 }, LANG_NEUTRAL, data);
+	tree.set(RT_ICON, std::uint16_t{ 2 }, LANG_NEUTRAL, data);
+	bytes = tree.serialize(0x1000);
+
+	// The second name entry refers to the language directory of the first one.
+	const std::uint32_t first_names = deserialize<std::uint32_t>(bytes, 16 + 4) & 0x7FFFFFFF;
+	const std::uint32_t languages   = deserialize<std::uint32_t>(bytes, first_names + 16 + 4);
+
+	serialize(languages, bytes, first_names + 16 + 8 + 4);
+
+	ASSERT_THAT([&]()
+	{
+		resource_tree parsed = resource_tree(bytes, 0, 0x1000);
+	},
+	ThrowsMessage<std::invalid_argument>(HasSubstr("is referenced more than once!")));
+}
+
+TEST(pe_file, constructor_signature_fail)
+{
+	const std::filesystem::path file_path = std::filesystem::temp_directory_path() / "pe_file_signature.exe";
+
+	write_file(file_path.string(), std::vector<std::uint8_t>(0x100, 0));
+
+	ASSERT_THAT([&]()
+	{
+		pe_file pe_file = { file_path.string() };
+	},
+	ThrowsMessage<std::invalid_argument>(HasSubstr("Executable does not start with the MZ signature!")));
+}
+
+TEST(pe_file, constructor_section_in_headers_fail)
+{
+	static constexpr std::size_t SECTION_TABLE_OFFSET = 0x80 + sizeof(std::uint32_t) + sizeof(pe_file::coff_header) + 240;
+
+	const std::filesystem::path file_path = std::filesystem::temp_directory_path() / "pe_file_section_in_headers.exe";
+
+	make_executable(file_path, false);
+
+	std::vector<std::uint8_t> image   = read_file(file_path.string());
+	pe_file::section_header   section = deserialize<pe_file::section_header>(image, SECTION_TABLE_OFFSET);
+
+	section.raw_data_offset = 0x100;
+	serialize(section, image, SECTION_TABLE_OFFSET);
+	write_file(file_path.string(), image);
+
+	ASSERT_THAT([&]()
+	{
+		pe_file pe_file = { file_path.string() };
+	},
+	ThrowsMessage<std::invalid_argument>(HasSubstr("Section 0 starts at offset 0x100, inside the 0x400 bytes of headers!")));
+
+	std::filesystem::remove(file_path);
+}
+
+TEST(pe_file, save_last_section_success)
+{
+	const std::filesystem::path     file_path = std::filesystem::temp_directory_path() / "pe_file_last_section.exe";
+	const std::vector<std::uint8_t> overlay   = { 0xDE, 0xAD, 0xBE, 0xEF };
+	const std::vector<std::uint8_t> icon      = std::vector<std::uint8_t>(0x1234, 0x42);
+
+	make_executable(file_path, true, overlay);
+
+	{
+		pe_file       pe_file   = { file_path.string() };
+		resource_tree resources = pe_file.read_resources();
+
+		EXPECT_EQ(1, resources.get_types().size());
+		resources.set(RT_ICON, std::uint16_t{ 1 }, LANG_NEUTRAL, icon);
+		EXPECT_EQ(pe_file::save_strategy::extended, pe_file.save(file_path.string(), resources));
+	}
+
+	const std::vector<std::uint8_t> bytes     = read_file(file_path.string());
+	pe_file                         pe_file   = { file_path.string() };
+	const resource_tree             resources = pe_file.read_resources();
+
+	EXPECT_EQ(2, resources.get_types().size());
+	EXPECT_THAT(resources.get_types().at(RT_ICON).at(std::uint16_t{ 1 }).at(LANG_NEUTRAL).data, ElementsAreArray(icon));
+	EXPECT_EQ(0x600 + align_up<std::size_t>(0x1234 + 0x100, 0x200) + overlay.size(), bytes.size());
+	EXPECT_TRUE(std::equal(overlay.rbegin(), overlay.rend(), bytes.rbegin()));
+
+	std::filesystem::remove(file_path);
+}
+
+TEST(pe_file, save_new_section_success)
+{
+	const std::filesystem::path     file_path = std::filesystem::temp_directory_path() / "pe_file_new_section.exe";
+	const std::vector<std::uint8_t> header    = { 0x00, 0x00, 0x01, 0x00, 0x00, 0x00 };
+
+	make_executable(file_path, false);
+
+	{
+		pe_file       pe_file   = { file_path.string() };
+		resource_tree resources = pe_file.read_resources();
+
+		EXPECT_TRUE(resources.get_types().empty());
+		resources.set(RT_GROUP_ICON, resource_tree::make_identifier("MAINICON"), LANG_NEUTRAL, header);
+		EXPECT_EQ(pe_file::save_strategy::rewritten, pe_file.save(file_path.string(), resources));
+	}
+
+	pe_file             pe_file   = { file_path.string() };
+	const resource_tree resources = pe_file.read_resources();
+
+	EXPECT_THAT(resources.get_types().at(RT_GROUP_ICON).at(u"MAINICON").at(LANG_NEUTRAL).data, ElementsAreArray(header));
+
+	std::filesystem::remove(file_path);
+}
+
+TEST(pe_file, save_in_place_success)
+{
+	const std::filesystem::path     file_path = std::filesystem::temp_directory_path() / "pe_file_in_place.exe";
+	const std::filesystem::path     copy_path = std::filesystem::temp_directory_path() / "pe_file_in_place_copy.exe";
+	const std::vector<std::uint8_t> overlay   = { 0xDE, 0xAD, 0xBE, 0xEF };
+	const std::vector<std::uint8_t> data      = { 9, 8, 7 };
+
+	make_executable(file_path, true, overlay);
+
+	const std::vector<std::uint8_t> old_bytes = read_file(file_path.string());
+	pe_file                         pe_file   = { file_path.string() };
+	resource_tree                   resources = pe_file.read_resources();
+
+	// The new tree is as large as the old one, so it fits the raw size of the section.
+	resources.set(std::uint16_t{ 16 }, std::uint16_t{ 1 }, std::uint16_t{ 1033 }, data);
+
+	EXPECT_EQ(pe_file::save_strategy::rewritten, pe_file.save(copy_path.string(), resources));
+	EXPECT_EQ(pe_file::save_strategy::patched, pe_file.save(file_path.string(), resources));
+
+	const std::vector<std::uint8_t> bytes = read_file(file_path.string());
+
+	EXPECT_EQ(read_file(copy_path.string()), bytes);
+	EXPECT_EQ(old_bytes.size(), bytes.size());
+	EXPECT_TRUE(std::equal(old_bytes.begin() + 0x400, old_bytes.begin() + 0x600, bytes.begin() + 0x400));
+
+	std::filesystem::remove(file_path);
+	std::filesystem::remove(copy_path);
+}
+
+TEST(pe_file, read_mapped_success)
+{
+	const std::filesystem::path file_path = std::filesystem::temp_directory_path() / "pe_file_mapped.exe";
+
+	make_executable(file_path, true);
+
+	const mapped_file   mapping   = mapped_file{ file_path.string() };
+	const pe_file       pe_file   = { file_path.string(), mapping.get_bytes() };
+	const resource_tree resources = pe_file.read_resources();
+
+	EXPECT_THAT(resources.get_types().at(std::uint16_t{ 16 }).at(std::uint16_t{ 1 }).at(std::uint16_t{ 1033 }).data, ElementsAre(1, 2, 3, 4, 5));
+
+	std::filesystem::remove(file_path);
+}
+
+TEST(pe_file, save_mapped_success)
+{
+	const std::filesystem::path file_path = std::filesystem::temp_directory_path() / "pe_file_save_mapped.exe";
+	const std::filesystem::path copy_path = std::filesystem::temp_directory_path() / "pe_file_save_mapped_copy.exe";
+	const std::vector<std::uint8_t> icon  = std::vector<std::uint8_t>(0x1234, 0x42);
+	std::vector<std::uint8_t>   overlay   = std::vector<std::uint8_t>(3 * 1024 * 1024 + 17);
+
+	// The overlay spans several chunks and moves by less than its size, so it is moved over itself.
+	for (std::size_t index = 0; index < overlay.size(); ++index)
+	{
+		overlay[index] = static_cast<std::uint8_t>(index * 7 % 251);
+	}
+
+	make_executable(file_path, true, overlay);
+
+	{
+		const mapped_file mapping   = mapped_file{ file_path.string() };
+		const pe_file     pe_file   = { file_path.string(), mapping.get_bytes() };
+		resource_tree     resources = pe_file.read_resources();
+
+		resources.set(RT_ICON, std::uint16_t{ 1 }, LANG_NEUTRAL, icon);
+		EXPECT_EQ(pe_file::save_strategy::rewritten, pe_file.save(copy_path.string(), resources));
+		EXPECT_EQ(pe_file::save_strategy::extended, pe_file.save(file_path.string(), resources));
+	}
+
+	const std::vector<std::uint8_t> bytes = read_file(file_path.string());
+
+	EXPECT_EQ(read_file(copy_path.string()), bytes);
+	EXPECT_TRUE(std::equal(overlay.rbegin(), overlay.rend(), bytes.rbegin()));
+
+	std::filesystem::remove(file_path);
+	std::filesystem::remove(copy_path);
+}
@@ -0,0 +1,264 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "pixel_kernels.cpp"
+
+#include <random>
+#include <vector>
+
+using namespace testing;
+using namespace icon_changer;
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Generates pseudo-random bytes, about a third of them being 0.
+/// \param size: Number of bytes.
+/// \param seed: The seed of the pseudo-random generator.
+/// \returns The bytes.
+///
+static std::vector<std::uint8_t> generate_bytes(const std::size_t   size,
+                                                const std::uint64_t seed)
+{
+	std::mt19937_64           generator = std::mt19937_64{ seed };
+	std::vector<std::uint8_t> bytes     = std::vector<std::uint8_t>(size);
+
+	for (std::uint8_t& byte : bytes)
+	{
+		const std::uint64_t random = generator();
+
+		byte = 0 == random % 3 ? 0 : static_cast<std::uint8_t>(random >> 8);
+	}
+
+	return bytes;
+}
+
+///
+/// \brief Gets the vectorized kernels the processor running the tests supports.
+/// \returns The kernels, which are cross-checked against the scalar ones.
+///
+static std::vector<const pixel_kernels*> get_vector_kernels()
+{
+	std::vector<const pixel_kernels*> variants = {};
+
+	for (const pixel_isa isa : { pixel_isa::sse4_2, pixel_isa::avx2, pixel_isa::neon })
+	{
+		if (const pixel_kernels* const kernels = get_pixel_kernels(isa); nullptr != kernels)
+		{
+			variants.push_back(kernels);
+		}
+	}
+
+	return variants;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// TESTS
+////////////////////////////////////////////////////////////////////////////////
+
+TEST(pixel_kernels, expand_bgr_success)
+{
+	const pixel_kernels& scalar = *get_pixel_kernels(pixel_isa::scalar);
+
+	// Sized exactly, so that a vector variant reading past the last pixel is caught by the sanitizers.
+	for (std::size_t count = 0; count < 70; ++count)
+	{
+		const std::vector<std::uint8_t> source   = generate_bytes(count * 3, count);
+		std::vector<std::uint8_t>       expected = std::vector<std::uint8_t>(count * 4);
+
+		scalar.expand_bgr(source, expected);
+
+		for (const pixel_kernels* const kernels : get_vector_kernels())
+		{
+			std::vector<std::uint8_t> actual = std::vector<std::uint8_t>(count * 4);
+
+			kernels->expand_bgr(source, actual);
+			EXPECT_EQ(expected, actual) << "isa " << static_cast<int>(kernels->isa) << ", " << count << " pixels";
+		}
+	}
+}
+
+TEST(pixel_kernels, expand_palette_success)
+{
+	const pixel_kernels&            scalar  = *get_pixel_kernels(pixel_isa::scalar);
+	const std::vector<std::uint8_t> bytes   = generate_bytes(256 * 4, 0);
+	std::array<std::uint32_t, 256>  palette = {};
+
+	for (std::size_t index = 0; index < palette.size(); ++index)
+	{
+		palette[index] = load_little_endian<std::uint32_t>(bytes.data() + index * 4);
+	}
+
+	for (std::size_t count = 0; count < 70; ++count)
+	{
+		const std::vector<std::uint8_t> indices  = generate_bytes(count, count);
+		std::vector<std::uint8_t>       expected = std::vector<std::uint8_t>(count * 4);
+
+		scalar.expand_palette(indices, palette, expected);
+
+		for (const pixel_kernels* const kernels : get_vector_kernels())
+		{
+			std::vector<std::uint8_t> actual = std::vector<std::uint8_t>(count * 4);
+
+			kernels->expand_palette(indices, palette, actual);
+			EXPECT_EQ(expected, actual) << "isa " << static_cast<int>(kernels->isa) << ", " << count << " pixels";
+		}
+	}
+}
+
+TEST(pixel_kernels, flip_rows_success)
+{
+	const pixel_kernels&            scalar   = *get_pixel_kernels(pixel_isa::scalar);
+	const std::vector<std::uint8_t> source   = { 1, 2, 3, 4, 5, 6 };
+	std::vector<std::uint8_t>       expected = std::vector<std::uint8_t>(source.size());
+
+	scalar.flip_rows(source, expected, 2);
+	EXPECT_THAT(expected, ElementsAre(5, 6, 3, 4, 1, 2));
+
+	for (std::size_t row_size = 1; row_size < 70; ++row_size)
+	{
+		const std::vector<std::uint8_t> rows = generate_bytes(row_size * 3, row_size);
+
+		expected.assign(rows.size(), 0);
+		scalar.flip_rows(rows, expected, row_size);
+
+		for (const pixel_kernels* const kernels : get_vector_kernels())
+		{
+			std::vector<std::uint8_t> actual = std::vector<std::uint8_t>(rows.size());
+
+			kernels->flip_rows(rows, actual, row_size);
+			EXPECT_EQ(expected, actual) << "isa " << static_cast<int>(kernels->isa) << ", rows of " << row_size << " bytes";
+		}
+	}
+}
+
+TEST(pixel_kernels, premultiply_success)
+{
+	const pixel_kernels&      scalar = *get_pixel_kernels(pixel_isa::scalar);
+	std::vector<std::uint8_t> pixel  = { 200, 100, 255, 128 };
+
+	scalar.premultiply(pixel);
+	EXPECT_THAT(pixel, ElementsAre(100, 50, 128, 128));
+
+	for (std::size_t count = 0; count < 70; ++count)
+	{
+		const std::vector<std::uint8_t> pixels   = generate_bytes(count * 4, count);
+		std::vector<std::uint8_t>       expected = pixels;
+
+		scalar.premultiply(expected);
+
+		for (const pixel_kernels* const kernels : get_vector_kernels())
+		{
+			std::vector<std::uint8_t> actual = pixels;
+
+			kernels->premultiply(actual);
+			EXPECT_EQ(expected, actual) << "isa " << static_cast<int>(kernels->isa) << ", " << count << " pixels";
+		}
+	}
+}
+
+TEST(pixel_kernels, pack_and_mask_success)
+{
+	const pixel_kernels& scalar = *get_pixel_kernels(pixel_isa::scalar);
+
+	for (std::size_t count = 0; count < 70; ++count)
+	{
+		const std::vector<std::uint8_t> pixels   = generate_bytes(count * 4, count);
+		std::vector<std::uint8_t>       expected = std::vector<std::uint8_t>((count + 7) / 8, 0xAA);
+
+		scalar.pack_and_mask(pixels, expected);
+
+		for (std::size_t x = 0; x < count; ++x)
+		{
+			EXPECT_EQ(0 == pixels[x * 4 + 3], 0 != (expected[x / 8] & (0x80 >> (x % 8))));
+		}
+
+		for (const pixel_kernels* const kernels : get_vector_kernels())
+		{
+			std::vector<std::uint8_t> actual = std::vector<std::uint8_t>((count + 7) / 8, 0x55);
+
+			kernels->pack_and_mask(pixels, actual);
+			EXPECT_EQ(expected, actual) << "isa " << static_cast<int>(kernels->isa) << ", " << count << " pixels";
+		}
+	}
+}
+
+TEST(pixel_kernels, swap_red_blue_success)
+{
+	const pixel_kernels& scalar = *get_pixel_kernels(pixel_isa::scalar);
+
+	for (std::size_t count = 0; count < 70; ++count)
+	{
+		const std::vector<std::uint8_t> pixels   = generate_bytes(count * 4, count);
+		std::vector<std::uint8_t>       expected = std::vector<std::uint8_t>(pixels.size());
+
+		scalar.swap_red_blue(pixels, expected);
+
+		for (std::size_t x = 0; x < count; ++x)
+		{
+			EXPECT_THAT(std::span<const std::uint8_t>{ expected }.subspan(x * 4, 4), ElementsAre(pixels[x * 4 + 2], pixels[x * 4 + 1], pixels[x * 4], pixels[x * 4 + 3]));
+		}
+
+		for (const pixel_kernels* const kernels : get_vector_kernels())
+		{
+			std::vector<std::uint8_t> actual = pixels;
+
+			// In place, as the PNG decoder swaps the pixels it has just expanded.
+			kernels->swap_red_blue(actual, actual);
+			EXPECT_EQ(expected, actual) << "isa " << static_cast<int>(kernels->isa) << ", " << count << " pixels";
+		}
+	}
+}
+
+TEST(pixel_kernels, unfilter_success)
+{
+	const pixel_kernels&      scalar = *get_pixel_kernels(pixel_isa::scalar);
+	std::vector<std::uint8_t> row    = { 1, 2, 3, 4 };
+
+	scalar.unfilter(1, row, std::vector<std::uint8_t>(row.size()), 1);
+	EXPECT_THAT(row, ElementsAre(1, 3, 6, 10));
+
+	for (const std::size_t pixel_size : { 1, 2, 3, 4, 6, 8 })
+	{
+		for (std::size_t count = 0; count < 70; ++count)
+		{
+			const std::vector<std::uint8_t> filtered = generate_bytes(count * pixel_size, count);
+			const std::vector<std::uint8_t> previous = generate_bytes(count * pixel_size, count + 1);
+
+			for (std::uint8_t filter = 0; filter <= 4; ++filter)
+			{
+				std::vector<std::uint8_t> expected = filtered;
+
+				scalar.unfilter(filter, expected, previous, pixel_size);
+
+				for (const pixel_kernels* const kernels : get_vector_kernels())
+				{
+					std::vector<std::uint8_t> actual = filtered;
+
+					kernels->unfilter(filter, actual, previous, pixel_size);
+					EXPECT_EQ(expected, actual) << "isa " << static_cast<int>(kernels->isa) << ", filter " << static_cast<int>(filter) << ", " << count
+					                            << " pixels of " << pixel_size << " bytes";
+				}
+			}
+		}
+	}
+}
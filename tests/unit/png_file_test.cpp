@@ -0,0 +1,160 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "png_file.cpp"
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "png_encoder.hpp"
+
+using namespace testing;
+using namespace icon_changer;
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+///
+/// \brief Appends a chunk to a PNG file.
+/// \param png: The PNG file.
+/// \param type: The chunk type.
+/// \param data: The chunk data.
+///
+static void append_chunk(std::vector<std::uint8_t>&       png,
+                         const std::string_view           type,
+                         const std::vector<std::uint8_t>& data)
+{
+	const std::size_t type_offset = png.size() + 4;
+
+	for (std::size_t shift = 32; 0 != shift; shift -= 8)
+	{
+		png.push_back(static_cast<std::uint8_t>(data.size() >> (shift - 8)));
+	}
+
+	png.insert(png.end(), type.begin(), type.end());
+	png.insert(png.end(), data.begin(), data.end());
+
+	const std::uint32_t checksum = crc32(std::span<const std::uint8_t>{ png }.subspan(type_offset));
+
+	for (std::size_t shift = 32; 0 != shift; shift -= 8)
+	{
+		png.push_back(static_cast<std::uint8_t>(checksum >> (shift - 8)));
+	}
+}
+
+///
+/// \brief Makes a PNG file with a single IDAT chunk.
+/// \param ihdr: The 13 bytes of the IHDR chunk.
+/// \param chunks: The chunks between the IHDR and IDAT ones, each with its type.
+/// \param rows: The filtered rows, each starting with its filter type.
+/// \returns The bytes of the file.
+///
+static std::vector<std::uint8_t> make_png(const std::vector<std::uint8_t>&                                      ihdr,
+                                          const std::vector<std::pair<std::string, std::vector<std::uint8_t>>>& chunks,
+                                          const std::vector<std::uint8_t>&                                      rows)
+{
+	std::vector<std::uint8_t> png = { SIGNATURE.begin(), SIGNATURE.end() };
+
+	append_chunk(png, "IHDR", ihdr);
+
+	for (const auto& [type, data] : chunks)
+	{
+		append_chunk(png, type, data);
+	}
+
+	append_chunk(png, "IDAT", zlib_compress(rows));
+	append_chunk(png, "IEND", {});
+	return png;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// TESTS
+////////////////////////////////////////////////////////////////////////////////
+
+TEST(png_file, decode_rgba_success)
+{
+	std::mt19937 generator = std::mt19937{ 7 };
+	bgra_image   image     = { 37, 23, std::vector<std::uint8_t>(37 * 23 * 4) };
+	std::uint8_t value     = 0;
+
+	// Gradients with noise, so that the encoder picks every filter.
+	for (std::size_t offset = 0; offset < image.pixels.size(); ++offset)
+	{
+		value                = static_cast<std::uint8_t>(0 == generator() % 4 ? generator() : value + offset % 7);
+		image.pixels[offset] = value;
+	}
+
+	const std::vector<std::uint8_t> bytes   = encode_png(image);
+	const png_file                  png     = png_file{ bytes };
+	const bgra_image                decoded = png.decode();
+
+	EXPECT_EQ(37, png.get_header().width);
+	EXPECT_EQ(6, png.get_header().color_type);
+	EXPECT_EQ(bytes.size(), png.get_file().size());
+	EXPECT_EQ(image.width, decoded.width);
+	EXPECT_EQ(image.height, decoded.height);
+	EXPECT_EQ(image.pixels, decoded.pixels);
+}
+
+TEST(png_file, decode_interlaced_success)
+{
+	// A 3x3 8-bit gray image whose level 40 is transparent, in the 5 passes of Adam7 that are not empty.
+	const std::vector<std::uint8_t> bytes   = make_png({ 0, 0, 0, 3, 0, 0, 0, 3, 8, 0, 0, 0, 1 }, { { "tRNS", { 0, 40 } } },
+	                                                   { 0, 0, 0, 20, 0, 60, 80, 0, 10, 0, 70, 0, 30, 40, 50 });
+	const bgra_image                decoded = png_file{ bytes }.decode();
+
+	ASSERT_EQ(3 * 3 * 4, decoded.pixels.size());
+
+	for (std::size_t index = 0; index < 9; ++index)
+	{
+		const std::uint8_t level = static_cast<std::uint8_t>(index * 10);
+
+		EXPECT_THAT(std::span<const std::uint8_t>{ decoded.pixels }.subspan(index * 4, 4), ElementsAre(level, level, level, 40 == level ? 0 : 0xFF));
+	}
+}
+
+TEST(png_file, decode_indexed_success)
+{
+	// Red, blue and green with 2 bits per index, the second row repeating the first one with the Up filter.
+	const std::vector<std::uint8_t> bytes   = make_png({ 0, 0, 0, 3, 0, 0, 0, 2, 2, 3, 0, 0, 0 },
+	                                                   { { "PLTE", { 0xFF, 0, 0, 0, 0xFF, 0, 0, 0, 0xFF } }, { "tRNS", { 0x80 } } }, { 0, 0x24, 2, 0 });
+	const bgra_image                decoded = png_file{ bytes }.decode();
+
+	EXPECT_THAT(decoded.pixels, ElementsAre(0x00, 0x00, 0xFF, 0x80, 0xFF, 0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0x00, 0xFF, 0x80, 0xFF, 0x00, 0x00,
+	                                        0xFF, 0x00, 0xFF, 0x00, 0xFF));
+}
+
+TEST(png_file, decode_crc_fail)
+{
+	std::vector<std::uint8_t> bytes = make_png({ 0, 0, 0, 1, 0, 0, 0, 1, 8, 0, 0, 0, 0 }, {}, { 0, 0 });
+
+	// The last byte of the IDAT data, right before its CRC and the 12 bytes of the IEND chunk.
+	bytes[bytes.size() - 17] ^= 1;
+
+	ASSERT_THAT([&bytes]()
+	{
+		png_file{ bytes }.decode();
+	},
+	ThrowsMessage<std::runtime_error>(HasSubstr("CRC of the IDAT chunk does not match!")));
+}
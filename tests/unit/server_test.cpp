@@ -0,0 +1,154 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "executable_builder.hpp"
+#include "server.cpp"
+
+#include <optional>
+#include <thread>
+
+using namespace testing;
+using namespace icon_changer;
+
+////////////////////////////////////////////////////////////////////////////////
+// TESTS
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _WIN32
+
+TEST(server, forward_success)
+{
+	const std::string                socket_path = (std::filesystem::temp_directory_path() / "icon_changer_server_test.sock").string();
+	const std::array<const char*, 1> arguments   = { "--version" };
+	char*                            buffer      = nullptr;
+	std::size_t                      size        = 0;
+	std::FILE* const                 output      = open_memstream(&buffer, &size);
+	server                           daemon      = server{ socket_path, 1 };
+	std::thread                      listener    = std::thread{ [&daemon]()
+	{
+		daemon.run();
+	} };
+
+	EXPECT_EQ(EXIT_SUCCESS, forward_cli(socket_path, arguments, output));
+	ASSERT_THAT(([&socket_path]() { server{ socket_path }; }), ThrowsMessage<std::runtime_error>(HasSubstr("already listening")));
+
+	daemon.stop();
+	listener.join();
+	std::fclose(output);
+
+	EXPECT_THAT(std::string(buffer, size), HasSubstr("icon-changer version"));
+	std::free(buffer);
+}
+
+TEST(server, stop_idle_connection_success)
+{
+	const std::string                socket_path = (std::filesystem::temp_directory_path() / "icon_changer_server_idle_test.sock").string();
+	const std::array<const char*, 1> arguments   = { "--version" };
+	char*                            buffer      = nullptr;
+	std::size_t                      size        = 0;
+	std::FILE* const                 output      = open_memstream(&buffer, &size);
+	std::optional<server>            daemon      = std::optional<server>{ std::in_place, socket_path, 2 };
+	std::thread                      listener    = std::thread{ [&daemon]()
+	{
+		daemon->run();
+	} };
+
+	// A client that connects and sends nothing does not keep the other worker from serving.
+	const std::int32_t idle = connect_socket(socket_path);
+
+	ASSERT_NE(-1, idle);
+	EXPECT_EQ(EXIT_SUCCESS, forward_cli(socket_path, arguments, output));
+
+	// Stopping does not wait for the idle client, which gets a failure.
+	daemon->stop();
+	listener.join();
+	daemon.reset();
+
+	EXPECT_EQ(EXIT_FAILURE, receive_integer(idle));
+	close(idle);
+	std::fclose(output);
+	std::free(buffer);
+}
+
+TEST(server, forward_source_groups_success)
+{
+	const std::filesystem::path      directory_path = std::filesystem::temp_directory_path() / "icon_changer_server_groups";
+	const std::string                socket_path    = (directory_path / "server.sock").string();
+	const std::string                source_path    = (directory_path / "source.exe").string();
+	const std::string                target_path    = (directory_path / "target.exe").string();
+	const std::vector<std::uint8_t>  main           = std::vector<std::uint8_t>(40, 0x11);
+	const std::vector<std::uint8_t>  document       = std::vector<std::uint8_t>(90, 0x22);
+	std::vector<std::uint8_t>        main_header    = std::vector<std::uint8_t>(WIRE_SIZE<ico_file::header> + WIRE_SIZE<icon::group_entry>);
+	std::vector<std::uint8_t>        header         = std::vector<std::uint8_t>(WIRE_SIZE<ico_file::header> + WIRE_SIZE<icon::group_entry>);
+	resource_tree                    resources      = {};
+	const std::array<const char*, 4> main_group     = { "--from-group", "MAINICON", source_path.c_str(), target_path.c_str() };
+	const std::array<const char*, 4> document_group = { "--from-group", "5", source_path.c_str(), target_path.c_str() };
+	std::FILE* const                 output         = std::fopen("/dev/null", "w");
+
+	std::filesystem::remove_all(directory_path);
+	std::filesystem::create_directories(directory_path);
+
+	serialize(ico_file::header{ 0, 1, 1 }, main_header, 0);
+	serialize(icon::group_entry{ 16, 16, 0, 0, 1, 32, 40, 1 }, main_header, WIRE_SIZE<ico_file::header>);
+	serialize(ico_file::header{ 0, 1, 1 }, header, 0);
+	serialize(icon::group_entry{ 0, 0, 0, 0, 1, 32, 90, 2 }, header, WIRE_SIZE<ico_file::header>);
+	resources.set(RT_ICON, std::uint16_t{ 1 }, std::uint16_t{ 1033 }, main);
+	resources.set(RT_ICON, std::uint16_t{ 2 }, std::uint16_t{ 1033 }, document);
+	resources.set(RT_GROUP_ICON, resource_tree::make_identifier("MAINICON"), std::uint16_t{ 1033 }, main_header);
+	resources.set(RT_GROUP_ICON, std::uint16_t{ 5 }, std::uint16_t{ 1033 }, header);
+	write_file(source_path, build_executable(resources));
+	write_file(target_path, build_executable({}));
+
+	{
+		server      daemon   = server{ socket_path, 1 };
+		std::thread listener = std::thread{ [&daemon]()
+		{
+			daemon.run();
+		} };
+
+		// The second command copies another group of the same source, which must not be served the icon kept for the first one.
+		EXPECT_EQ(EXIT_SUCCESS, forward_cli(socket_path, main_group, output));
+		EXPECT_EQ(EXIT_SUCCESS, forward_cli(socket_path, document_group, output));
+
+		daemon.stop();
+		listener.join();
+	}
+
+	std::fclose(output);
+
+	const std::vector<std::uint8_t> bytes     = read_file(target_path);
+	const pe_file                   target    = { target_path, bytes };
+	const resource_tree             patched   = target.read_resources();
+	const resource_tree::name_map&  images    = patched.get_types().at(RT_ICON);
+
+	ASSERT_EQ(1, images.size());
+	EXPECT_THAT(images.begin()->second.begin()->second.data, ElementsAreArray(document));
+
+	std::filesystem::remove_all(directory_path);
+}
+
+TEST(server, forward_standard_input_fail)
+{
+	const std::array<const char*, 2> arguments = { "-", "app.exe" };
+
+	ASSERT_THAT([&arguments]() { forward_cli("/nonexistent.sock", arguments); }, ThrowsMessage<std::invalid_argument>(HasSubstr("cannot be forwarded")));
+}
+
+#endif // _WIN32
@@ -0,0 +1,71 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "stats.cpp"
+
+#include <vector>
+
+using namespace testing;
+using namespace icon_changer;
+
+////////////////////////////////////////////////////////////////////////////////
+// TESTS
+////////////////////////////////////////////////////////////////////////////////
+
+TEST(stats, scope_success)
+{
+	stats_record record = {};
+
+	count_stat(stats_counter::bytes_read, 10);
+
+	{
+		const stats_scope scope = stats_scope{ &record };
+		stats_timer       timer = stats_timer{ stats_phase::parse };
+
+		count_stat(stats_counter::bytes_read, 20);
+		timer.next(stats_phase::read);
+	}
+
+	count_stat(stats_counter::bytes_read, 40);
+
+	const stats_sample sample = record.get_sample();
+
+	EXPECT_EQ(20, sample.counters[static_cast<std::size_t>(stats_counter::bytes_read)]);
+	EXPECT_EQ(1, sample.calls[static_cast<std::size_t>(stats_phase::parse)]);
+	EXPECT_EQ(1, sample.calls[static_cast<std::size_t>(stats_phase::read)]);
+	EXPECT_EQ(0, sample.calls[static_cast<std::size_t>(stats_phase::write)]);
+	EXPECT_EQ(nullptr, stats_scope::get_current());
+}
+
+TEST(stats, percentiles_success)
+{
+	std::vector<stats_sample> samples = std::vector<stats_sample>(100);
+
+	for (std::size_t index = 0; index < samples.size(); ++index)
+	{
+		samples[index].counters[static_cast<std::size_t>(stats_counter::bytes_written)] = index + 1;
+	}
+
+	const std::string output = format_stats(samples, stats_format::json);
+
+	EXPECT_THAT(output, StartsWith("{\"samples\":100,"));
+	EXPECT_THAT(output, HasSubstr("\"bytes_written\":{\"total\":5050,\"p50\":50,\"p90\":90,\"p99\":99,\"max\":100}"));
+	EXPECT_THAT(output, HasSubstr("\"bytes_read\":{\"total\":0,\"p50\":0,\"p90\":0,\"p99\":0,\"max\":0}"));
+}
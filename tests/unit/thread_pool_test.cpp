@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "thread_pool.cpp"
+
+#include <atomic>
+#include <chrono>
+
+using namespace testing;
+using namespace icon_changer;
+
+////////////////////////////////////////////////////////////////////////////////
+// TESTS
+////////////////////////////////////////////////////////////////////////////////
+
+TEST(thread_pool, wait_success)
+{
+	static constexpr std::size_t TASKS_COUNT = 1000;
+
+	thread_pool              pool  = thread_pool{ 4 };
+	std::atomic<std::size_t> count = 0;
+
+	EXPECT_EQ(4, pool.get_threads_count());
+
+	for (std::size_t index = 0; index < TASKS_COUNT; ++index)
+	{
+		pool.submit([&count]()
+		{
+			++count;
+		});
+	}
+
+	pool.wait();
+	EXPECT_EQ(TASKS_COUNT, count);
+}
+
+TEST(thread_pool, steal_success)
+{
+	thread_pool              pool  = thread_pool{ 2 };
+	std::atomic<std::size_t> count = 0;
+	std::atomic<bool>        done  = false;
+
+	// The first worker is blocked, the task queued behind it has to be stolen.
+	pool.submit([&done]()
+	{
+		while (!done)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+		}
+	});
+
+	pool.submit([]()
+	{
+	});
+
+	pool.submit([&count, &done]()
+	{
+		++count;
+		done = true;
+	});
+
+	pool.wait();
+	EXPECT_EQ(1, count);
+}
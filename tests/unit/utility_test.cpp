@@ -0,0 +1,66 @@
+////////////////////////////////////////////////////////////////////////////////
+// This is free and unencumbered software released into the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+// ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to https://unlicense.org
+////////////////////////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////////////////////////
+// HEADER FILE INCLUDES
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "utility.cpp"
+
+#include <filesystem>
+#include <vector>
+
+using namespace testing;
+using namespace icon_changer;
+
+////////////////////////////////////////////////////////////////////////////////
+// TESTS
+////////////////////////////////////////////////////////////////////////////////
+
+TEST(utility, write_file_success)
+{
+	const std::filesystem::path     file_path = std::filesystem::temp_directory_path() / "utility_write.bin";
+	const std::vector<std::uint8_t> bytes     = { 1, 2, 3 };
+
+	write_file(file_path.string(), std::vector<std::uint8_t>{ 4 });
+	write_file(file_path.string(), bytes);
+
+	EXPECT_EQ(bytes, read_file(file_path.string()));
+
+	std::filesystem::remove(file_path);
+}
+
+TEST(utility, write_file_rename_fail)
+{
+	const std::filesystem::path directory_path = std::filesystem::temp_directory_path() / "utility_rename";
+	const std::filesystem::path file_path      = directory_path / "target";
+
+	std::filesystem::remove_all(directory_path);
+	std::filesystem::create_directories(file_path / "child");
+
+	// A file cannot replace a directory that is not empty.
+	ASSERT_THAT([&file_path]()
+	{
+		write_file(file_path.string(), std::vector<std::uint8_t>{ 1, 2, 3 });
+	},
+	Throws<std::filesystem::filesystem_error>());
+
+	// Nothing but the directory is left, the temporary file is removed.
+	EXPECT_EQ(1, std::distance(std::filesystem::directory_iterator{ directory_path }, std::filesystem::directory_iterator{}));
+
+	std::filesystem::remove_all(directory_path);
+}